@@ -41,8 +41,9 @@ done
 
 # ----------------------------
 # Pin the NIC IRQ workers to a single CPU.
-# The NIC worker CPU should match the CPU that jcs_host is pinned to.
-cpu_num=1
+# The NIC worker CPU should match the CPU that jcs_host is pinned to (threads: rt: cpus in dev_HOST.yaml).
+# Usage: configure_for_rt.sh [rt_cpu]
+cpu_num=${1:-1}
 for irq_num in $(cat /proc/interrupts | grep $ifname | cut -d: -f1 | sed "s/ //g") ; do
         echo device: $ifname , irq: $irq_num map to cpu: $cpu_num
     echo $cpu_num >/proc/irq/$irq_num/smp_affinity_list
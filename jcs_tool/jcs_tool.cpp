@@ -6,6 +6,7 @@
 #include "tool_manager.h"
 #include "jcs_user_external.h"
 #include "task_rt.h"
+#include "task_rt_config.h"
 #include "cmd_input_parser.h"
 
 using namespace jcs;
@@ -65,6 +66,25 @@ int main(int argc, char* argv[]) {
         host_args.debug_enabled = true;
     }
 
+    // Thread scheduling: defaults, then dev_HOST.yaml, then command line
+    task_rt::sched_named_set("rt", thread_host.rt_sched);
+    task_rt::sched_named_set("non_rt", thread_host.sched);
+    std::string host_config = config_path;
+    if (host_config.back() != '/') {
+        host_config += "/";
+    }
+    if (task_rt::sched_config_load_file(host_config + "dev_HOST.yaml") != RET_OK ||
+        task_rt::sched_config_cmd(cmd_parser) != RET_OK) {
+        std::cout << "ERROR: Invalid thread configuration\n";
+        return -1;
+    }
+    task_rt::sched_named_get("rt", &thread_host.rt_sched);
+    task_rt::sched_named_get("non_rt", &thread_host.sched);
+    if (print_debug) {
+        task_rt::sched_print("rt", thread_host.rt_sched);
+        task_rt::sched_print("non_rt", thread_host.sched);
+    }
+
     // Start JCS host
     jcs_host host(config_path, print_debug, print_rt_debug);
     
@@ -121,6 +141,10 @@ int main(int argc, char* argv[]) {
     // Wait for tasks to exit
     task_rt::task_wait_rt(&thread_host);
     task_rt::task_wait(&thread_host);
+
+    // RT loop wakeup latency report. -lat adds histograms and worst events.
+    int64_t cycle_time_ns = (int64_t)1e9 / (int64_t)host.base_frequency_get();
+    task_rt::cycle_stats_print("rt", &thread_host, cycle_time_ns, cmd_parser.cmd_option_exists("-lat"));
     return 0;
 }
 
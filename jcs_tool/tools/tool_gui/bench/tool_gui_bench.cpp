@@ -0,0 +1,354 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+// Headless tool_gui benchmark.
+//
+// Builds the tool_gui element store against the simulated jcs_host (make tool_gui_bench JCS_HOST_SIM=1)
+// and drives the RT and render paths from a single thread, without GLFW or OpenGL:
+//  - Every tick: jcs_host step_rt(), step_rt_always() on the host elements, then step_rt() on every
+//    element of every device. tool_gui only steps the selected device, so this is the worst case.
+//  - Every 1/fps of simulated time: step_gui() and render() of every element, each into its own
+//    ImGui window, then ImGui::Render(). Draw data is built but not drawn.
+// Reports ns/tick per element and ms/frame percentiles.
+//
+// Usage: tool_gui_bench -p <config path> [-t <simulated s>] [-hz <tick rate>] [-fps <frame rate>]
+//  -t    Simulated run time, default 10 s.
+//  -hz   Pace ticks at this rate. Default 0, as fast as possible.
+//  -fps  Frames per simulated second, default 20 as tool_gui.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "jcs_host.h"
+#include "cmd_input_parser.h"
+#include "imgui.h"
+#include "implot.h"
+#include "gui_interface.h"
+#include "gui_store.h"
+#include "param_worker.h"
+#include "rt_profile.h"
+#include "rt_jobs.h"
+#include "helpers.h"
+#include "tool_gui_settings.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+static int64_t ns_since(bench_clock::time_point t0) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - t0).count();
+}
+
+// gui_interface as tool_gui provides it, minus the window
+class bench_gui : public gui_interface {
+public:
+    bench_gui(jcs::jcs_host* host) :
+        host_(host), f32_input_signals_manual_(nullptr), f32_input_signals_commit_(false), store_(nullptr) {}
+
+    int start() {
+        if (host_->ready_devices() != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+        return host_->start();
+    }
+    int stop() { return host_->stop(); }
+    int reset() { return host_->reset(); }
+    std::vector<std::string>* get_f32_input_signal_names() { return &f32_input_signal_names_; }
+    std::vector<std::string>* get_f32_output_signal_names() { return &f32_output_signal_names_; }
+    std::vector<float> const* get_f32_output_signals() { return &f32_output_signals_; }
+    void f32_input_signal_set_rt(int index, float value) {
+        f32_input_signals_[index] = value;
+        f32_input_signals_set_[index] = true;
+        f32_input_signals_commit_ = true;
+    }
+    void f32_input_signals_manual_rt(std::vector<float> const* values) {
+        f32_input_signals_manual_ = values;
+        f32_input_signals_commit_ = true;
+    }
+    param_worker* get_param_worker() { return &param_worker_; }
+    std::vector<gui_device_base*> const* get_devices() { return store_; }
+    rt_profile* get_tick_profile() { return &tick_profile_; }
+    rt_jobs* get_rt_jobs() { return &rt_jobs_; }
+    // Every element steps every tick and the host runs for the whole bench
+    bool job_can_start(bool) { return true; }
+    int job_start(gui_type_base*, bool) { return jcs::RET_OK; }
+    int job_stop(gui_type_base*) { return jcs::RET_OK; }
+
+    jcs::jcs_host* host_;
+    std::vector<std::string> f32_input_signal_names_;
+    std::vector<std::string> f32_output_signal_names_;
+    std::vector<float> f32_output_signals_;
+    std::vector<float> f32_input_signals_;
+    std::vector<bool> f32_input_signals_set_;
+    std::vector<float> const* f32_input_signals_manual_;
+    bool f32_input_signals_commit_;
+    param_worker param_worker_;
+    std::vector<gui_device_base*>* store_;
+    rt_profile tick_profile_;
+    rt_jobs rt_jobs_;
+};
+
+// One row of the report
+struct bench_timing {
+    std::string name;
+    std::vector<int64_t> ns;
+
+    bench_timing(std::string const& n, int n_reserve) : name(n) { ns.reserve(n_reserve); }
+
+    void print(double scale) {
+        if (ns.empty()) {
+            return;
+        }
+        std::vector<int64_t> s = ns;
+        std::sort(s.begin(), s.end());
+        double sum = 0.0;
+        for (int i=0; i<s.size(); i++) {
+            sum += (double)s[i];
+        }
+        printf("%-48s %10.3f %10.3f %10.3f %10.3f %10.3f\n", name.c_str(),
+            scale * sum / (double)s.size(),
+            scale * (double)s[(s.size() - 1) * 50 / 100],
+            scale * (double)s[(s.size() - 1) * 99 / 100],
+            scale * (double)s[(s.size() - 1) * 999 / 1000],
+            scale * (double)s.back());
+    }
+};
+
+static void print_header(std::string const& title) {
+    printf("\n%-48s %10s %10s %10s %10s %10s\n", title.c_str(), "mean", "p50", "p99", "p99.9", "max");
+}
+
+int main(int argc, char* argv[]) {
+    cmd_input_parser cmd_parser(argc, argv);
+
+    std::string config_path = cmd_parser.cmd_option_get("-p");
+    if (config_path.empty()) {
+        std::cout << "Usage: tool_gui_bench -p <config path> [-t <simulated s>] [-hz <tick rate>] [-fps <frame rate>]\n";
+        return -1;
+    }
+    double run_time_s = 10.0;
+    double tick_hz = 0.0;
+    double fps = 20.0;
+    if (cmd_parser.cmd_option_exists("-t"))   { run_time_s = std::stod(cmd_parser.cmd_option_get("-t")); }
+    if (cmd_parser.cmd_option_exists("-hz"))  { tick_hz = std::stod(cmd_parser.cmd_option_get("-hz")); }
+    if (cmd_parser.cmd_option_exists("-fps")) { fps = std::stod(cmd_parser.cmd_option_get("-fps")); }
+    if (run_time_s <= 0.0 || tick_hz < 0.0 || fps <= 0.0) {
+        std::cout << "tool_gui_bench: Invalid -t, -hz or -fps\n";
+        return -1;
+    }
+
+    jcs::jcs_host host(config_path, false, false);
+    if (host.initialise() != jcs::RET_OK) {
+        std::cout << "tool_gui_bench: Host initialise failed\n";
+        return -1;
+    }
+    if (host.start_network() != jcs::RET_OK) {
+        std::cout << "tool_gui_bench: Host start_network failed\n";
+        return -1;
+    }
+
+    bench_gui gui(&host);
+
+    // Same start up order as tool_gui::step_parameter_startup()
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    io.DeltaTime = (float)(1.0 / fps);
+    // No renderer backend, build the font atlas ourselves
+    unsigned char* font_pixels;
+    int font_w;
+    int font_h;
+    io.Fonts->GetTexDataAsRGBA32(&font_pixels, &font_w, &font_h);
+
+    gui.f32_output_signals_.resize(host.sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+    gui.f32_input_signals_.resize(host.sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+    gui.f32_input_signals_set_.resize(gui.f32_input_signals_.size());
+
+    std::vector<gui_device_base*> store;
+    gui_device_host* host_ptr;
+    gui_store::build(&host, &gui, host.external_info_tree_get(), &store, &host_ptr);
+    gui.store_ = &store;
+    gui.rt_jobs_.build(&store);
+    if (host_ptr == nullptr) {
+        std::cout << "tool_gui_bench: No dev_host in the device tree\n";
+        return -1;
+    }
+
+    if (helpers::build_input_signal_names_list(&host, &gui.f32_input_signal_names_) != jcs::RET_OK) {
+        return -1;
+    }
+    if (helpers::build_output_signal_names_list(&host, &gui.f32_output_signal_names_) != jcs::RET_OK) {
+        return -1;
+    }
+    if (gui.param_worker_.start(tool_gui_settings::param_worker_threads) != jcs::RET_OK) {
+        return -1;
+    }
+    for (int i=0; i<store.size(); i++) {
+        if (store[i]->startup() != jcs::RET_OK) {
+            return -1;
+        }
+    }
+
+    if (gui.start() != jcs::RET_OK) {
+        std::cout << "tool_gui_bench: Host start failed\n";
+        return -1;
+    }
+
+    // Flatten to one row per element
+    std::vector<gui_type_base*> elements;
+    std::vector<std::string> element_names;
+    int host_offset = 0;
+    for (int d=0; d<store.size(); d++) {
+        if (store[d] == host_ptr) {
+            host_offset = elements.size();
+        }
+        std::vector<gui_type_base*> const& e = store[d]->elements_get();
+        for (int i=0; i<e.size(); i++) {
+            elements.push_back(e[i]);
+            element_names.push_back(store[d]->name_get() + ": " + e[i]->type_name_);
+        }
+    }
+    std::vector<gui_device_host_base*> const& host_elements = host_ptr->host_elements_get();
+
+    double base_hz = (double)host.base_frequency_get();
+    int n_ticks = (int)(run_time_s * base_hz);
+    int ticks_per_frame = std::max(1, (int)(base_hz / fps + 0.5));
+    int n_frames = n_ticks / ticks_per_frame;
+
+    std::vector<bench_timing> rt_timing;
+    std::vector<bench_timing> gui_timing;
+    for (int i=0; i<elements.size(); i++) {
+        rt_timing.push_back(bench_timing(element_names[i], n_ticks));
+        gui_timing.push_back(bench_timing(element_names[i], n_frames));
+    }
+    bench_timing host_step_timing("jcs_host step_rt", n_ticks);
+    bench_timing tick_timing("tool tick, all elements", n_ticks);
+    bench_timing frame_timing("frame, NewFrame to Render", n_frames);
+    // Per element tick cost, accumulated over step_rt_always() and step_rt()
+    std::vector<int64_t> tick_ns(elements.size());
+    double vertices = 0.0;
+
+    std::cout << "tool_gui_bench: " << store.size() << " devices, " << elements.size() << " elements, "
+              << n_ticks << " ticks at " << base_hz << " Hz, " << n_frames << " frames\n";
+
+    bench_clock::time_point t_next = bench_clock::now();
+    for (int t=0; t<n_ticks; t++) {
+        int64_t cycle_time_ns;
+        bench_clock::time_point t0 = bench_clock::now();
+        if (host.step_rt(&cycle_time_ns) != jcs::RET_OK) {
+            std::cout << "tool_gui_bench: Host step_rt failed\n";
+            return -1;
+        }
+        host_step_timing.ns.push_back(ns_since(t0));
+
+        // As tool_gui::step_rt()
+        bench_clock::time_point t_tick = bench_clock::now();
+        uint64_t tsc_tick = rt_profile::ticks_rt();
+        host.sig_output_get_rt(0, &gui.f32_output_signals_);
+        if (gui.f32_input_signals_commit_) {
+            std::fill(gui.f32_input_signals_.begin(), gui.f32_input_signals_.end(), 0.0f);
+            std::fill(gui.f32_input_signals_set_.begin(), gui.f32_input_signals_set_.end(), false);
+            gui.f32_input_signals_commit_ = false;
+        }
+        gui.f32_input_signals_manual_ = nullptr;
+        std::fill(tick_ns.begin(), tick_ns.end(), 0);
+        // Host elements are index aligned with elements from host_offset
+        for (int i=0; i<host_elements.size(); i++) {
+            t0 = bench_clock::now();
+            rt_profile::scope timer(&elements[host_offset + i]->rt_cost_always_);
+            if (host_elements[i]->step_rt_always() != jcs::RET_OK) {
+                std::cout << "tool_gui_bench: " << element_names[host_offset + i] << " step_rt_always failed\n";
+                return -1;
+            }
+            tick_ns[host_offset + i] += ns_since(t0);
+        }
+        for (int i=0; i<elements.size(); i++) {
+            t0 = bench_clock::now();
+            rt_profile::scope timer(&elements[i]->rt_cost_step_);
+            if (elements[i]->step_rt() != jcs::RET_OK) {
+                std::cout << "tool_gui_bench: " << element_names[i] << " step_rt failed\n";
+                return -1;
+            }
+            tick_ns[i] += ns_since(t0);
+        }
+        if (gui.f32_input_signals_manual_ != nullptr) {
+            for (int i=0; i<gui.f32_input_signals_.size(); i++) {
+                if (!gui.f32_input_signals_set_[i]) {
+                    gui.f32_input_signals_[i] = (*gui.f32_input_signals_manual_)[i];
+                }
+            }
+        }
+        if (gui.f32_input_signals_commit_) {
+            host.sig_input_set_rt(0, gui.f32_input_signals_);
+        }
+        tick_timing.ns.push_back(ns_since(t_tick));
+        gui.tick_profile_.add_rt(rt_profile::ticks_rt() - tsc_tick);
+        for (int i=0; i<elements.size(); i++) {
+            rt_timing[i].ns.push_back(tick_ns[i]);
+        }
+
+        // Frame, as tool_gui::step_parameter() with every element on screen
+        if ((t + 1) % ticks_per_frame == 0) {
+            bench_clock::time_point t_frame = bench_clock::now();
+            ImGui::NewFrame();
+            gui.param_worker_.step_gui();
+            for (int i=0; i<elements.size(); i++) {
+                t0 = bench_clock::now();
+                if (elements[i]->step_gui() != jcs::RET_OK) {
+                    std::cout << "tool_gui_bench: " << element_names[i] << " step_gui failed\n";
+                    return -1;
+                }
+                ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+                ImGui::SetNextWindowSize(io.DisplaySize);
+                std::string window_name = element_names[i] + "##" + std::to_string(i);
+                if (ImGui::Begin(window_name.c_str(), nullptr, ImGuiWindowFlags_NoSavedSettings)) {
+                    if (elements[i]->render() != jcs::RET_OK) {
+                        ImGui::End();
+                        std::cout << "tool_gui_bench: " << element_names[i] << " render failed\n";
+                        return -1;
+                    }
+                }
+                ImGui::End();
+                gui_timing[i].ns.push_back(ns_since(t0));
+            }
+            ImGui::Render();
+            frame_timing.ns.push_back(ns_since(t_frame));
+            vertices += (double)ImGui::GetDrawData()->TotalVtxCount;
+        }
+
+        if (tick_hz > 0.0) {
+            t_next += std::chrono::nanoseconds((int64_t)(1e9 / tick_hz));
+            std::this_thread::sleep_until(t_next);
+        }
+    }
+
+    host.stop();
+    gui.param_worker_.stop();
+
+    print_header("RT [ns/tick]");
+    host_step_timing.print(1.0);
+    tick_timing.print(1.0);
+    for (int i=0; i<rt_timing.size(); i++) {
+        rt_timing[i].print(1.0);
+    }
+
+    print_header("GUI step_gui + render [ms/frame]");
+    frame_timing.print(1e-6);
+    for (int i=0; i<gui_timing.size(); i++) {
+        gui_timing[i].print(1e-6);
+    }
+    if (!frame_timing.ns.empty()) {
+        printf("\nMean vertices per frame: %.0f\n", vertices / (double)frame_timing.ns.size());
+    }
+
+    ImPlot::DestroyContext();
+    ImGui::DestroyContext();
+    host.shutdown();
+    return 0;
+}
@@ -0,0 +1,251 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "decimator.h"
+#include "jcs_host.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Fractions of the output rate
+static double const passband = 0.4;
+static double const stopband = 0.5;
+// Blackman window transition width is about this many bins of the filter length
+static double const blackman_transition = 5.5;
+
+static long gcd(long a, long b) {
+    while (b != 0) {
+        long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+decimator::decimator() :
+    n_channels_(0),
+    filter_(false),
+    delay_s_(0.0),
+    cic_d_(1),
+    cic_rate_hz_(1.0),
+    cic_n_(0),
+    cic_slot_(0),
+    l_(1),
+    m_(1),
+    tpp_(1),
+    hist_w_(0),
+    phase_(1)
+{}
+
+int decimator::configure(int n_channels, int input_rate_hz, int output_rate_hz, bool filter) {
+    if (n_channels < 1 || input_rate_hz < 1 || output_rate_hz < 1 || output_rate_hz > input_rate_hz) {
+        std::cout << "decimator: Output rate must be in [1, " << input_rate_hz << "] Hz\n";
+        return jcs::RET_ERROR;
+    }
+    n_channels_ = n_channels;
+    filter_ = filter && (output_rate_hz < input_rate_hz);
+
+    // Stage 1
+    cic_d_ = 1;
+    if (filter_) {
+        cic_d_ = std::max(1, input_rate_hz / (cic_min_oversample * output_rate_hz));
+    }
+    cic_rate_hz_ = (double)input_rate_hz / (double)cic_d_;
+
+    // boxcar^K, DC gain 1
+    cic_h_.assign(1, 1.0);
+    for (int k=0; k<cic_order; k++) {
+        std::vector<double> h(cic_h_.size() + cic_d_ - 1, 0.0);
+        for (int i=0; i<cic_h_.size(); i++) {
+            for (int j=0; j<cic_d_; j++) {
+                h[i + j] += cic_h_[i] / (double)cic_d_;
+            }
+        }
+        cic_h_.swap(h);
+    }
+    // Pending output r takes the next input at tap r*D, every later tap has already been seen
+    cic_seed_.assign(cic_order, 0.0);
+    for (int r=0; r<cic_order; r++) {
+        for (int j=r*cic_d_+1; j<cic_h_.size(); j++) {
+            cic_seed_[r] += cic_h_[j];
+        }
+    }
+    cic_acc_.assign(cic_order * n_channels_, 0.0);
+    cic_out_.assign(n_channels_, 0.0);
+    cic_n_ = 0;
+    cic_slot_ = 0;
+
+    // Stage 2, remaining ratio output / (input / D)
+    long num = (long)output_rate_hz * cic_d_;
+    long den = input_rate_hz;
+    long g = gcd(num, den);
+    l_ = (int)(num / g);
+    m_ = (int)(den / g);
+
+    if (!filter_) {
+        // Hold the latest input
+        tpp_ = 1;
+        fir_.assign(l_, 1.0);
+        delay_s_ = 0.0;
+    } else {
+        double fs_up = (double)l_ * cic_rate_hz_;
+        double fc = 0.5 * (passband + stopband) * (double)output_rate_hz / fs_up;
+        int tpp0 = (int)std::ceil(blackman_transition * cic_rate_hz_ / ((stopband - passband) * (double)output_rate_hz));
+        tpp0 = std::max(tpp0, 4);
+        bool equalise = (cic_d_ > 1);
+        tpp_ = tpp0 + (equalise ? 2 : 0);
+        if ((long)tpp_ * l_ > fir_max_coefficients) {
+            std::cout << "decimator: " << input_rate_hz << " Hz to " << output_rate_hz << " Hz needs "
+                      << (long)tpp_ * l_ << " filter coefficients. Choose a rate with a simpler ratio to the base frequency\n";
+            return jcs::RET_ERROR;
+        }
+
+        // Windowed sinc prototype at the upsampled rate, each phase with DC gain 1
+        int len0 = tpp0 * l_;
+        double centre = 0.5 * (double)(len0 - 1);
+        std::vector<double> h0(len0);
+        double sum = 0.0;
+        for (int j=0; j<len0; j++) {
+            double x = 2.0 * fc * ((double)j - centre);
+            double sinc = (std::fabs(x) < 1e-12) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+            double w = 2.0 * M_PI * (double)j / (double)(len0 - 1);
+            double blackman = 0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+            h0[j] = 2.0 * fc * sinc * blackman;
+            sum += h0[j];
+        }
+        for (int j=0; j<len0; j++) {
+            h0[j] *= (double)l_ / sum;
+        }
+
+        // CIC droop equaliser [-a, 1+2a, -a] at the stage 2 input rate, exact at the passband edge
+        std::vector<double> h(tpp_ * l_, 0.0);
+        if (equalise) {
+            double f_p = passband * (double)output_rate_hz;
+            double num_p = std::sin(M_PI * f_p * (double)cic_d_ / (double)input_rate_hz);
+            double den_p = (double)cic_d_ * std::sin(M_PI * f_p / (double)input_rate_hz);
+            double droop = std::pow(std::fabs(num_p / den_p), (double)cic_order);
+            double w_p = 2.0 * M_PI * f_p / cic_rate_hz_;
+            double a = (1.0 / droop - 1.0) / (2.0 * (1.0 - std::cos(w_p)));
+            for (int j=0; j<len0; j++) {
+                h[j]          += -a * h0[j];
+                h[j + l_]     += (1.0 + 2.0 * a) * h0[j];
+                h[j + 2 * l_] += -a * h0[j];
+            }
+        } else {
+            h = h0;
+        }
+
+        // Phase p, oldest input first
+        fir_.assign(l_ * tpp_, 0.0);
+        for (int p=0; p<l_; p++) {
+            for (int k=0; k<tpp_; k++) {
+                fir_[p * tpp_ + k] = h[p + (tpp_ - 1 - k) * l_];
+            }
+        }
+        delay_s_ = 0.5 * (double)(cic_h_.size() - 1) / (double)input_rate_hz
+                 + 0.5 * (double)(h.size() - 1) / fs_up;
+    }
+    hist_.assign(2 * tpp_ * n_channels_, 0.0);
+    fir_out_.assign(n_channels_, 0.0);
+    hist_w_ = 0;
+    phase_ = l_;
+    return jcs::RET_OK;
+}
+
+void decimator::seed_rt(double const* x) {
+    int n = n_channels_;
+    // Steady state for a constant input, the next input completes slot 0
+    cic_n_ = 0;
+    cic_slot_ = 0;
+    for (int r=0; r<cic_order; r++) {
+        double* acc = &cic_acc_[r * n];
+        for (int c=0; c<n; c++) {
+            acc[c] = cic_seed_[r] * x[c];
+        }
+    }
+    for (int r=0; r<2*tpp_; r++) {
+        for (int c=0; c<n; c++) {
+            hist_[r * n + c] = x[c];
+        }
+    }
+    hist_w_ = 0;
+    phase_ = l_;
+}
+
+bool decimator::step_rt(double const* x, float* y, double* t_offset_s) {
+    if (cic_d_ == 1) {
+        return fir_push_rt(x, y, t_offset_s);
+    }
+    bool out;
+    cic_push_rt(x, &out);
+    if (!out) {
+        return false;
+    }
+    return fir_push_rt(cic_out_.data(), y, t_offset_s);
+}
+
+void decimator::cic_push_rt(double const* x, bool* out) {
+    int n = n_channels_;
+    int len = cic_h_.size();
+    // Tap of this input in the next output to complete, then D further per later output
+    int j0 = (cic_d_ - cic_n_) % cic_d_;
+    for (int r=0; r<cic_order; r++) {
+        int j = j0 + r * cic_d_;
+        if (j >= len) {
+            break;
+        }
+        double h = cic_h_[j];
+        double* acc = &cic_acc_[((cic_slot_ + r) % cic_order) * n];
+        for (int c=0; c<n; c++) {
+            acc[c] += h * x[c];
+        }
+    }
+    *out = false;
+    if (cic_n_ == 0) {
+        double* acc = &cic_acc_[cic_slot_ * n];
+        for (int c=0; c<n; c++) {
+            cic_out_[c] = acc[c];
+            acc[c] = 0.0;
+        }
+        cic_slot_ = (cic_slot_ + 1) % cic_order;
+        *out = true;
+    }
+    cic_n_ = (cic_n_ + 1) % cic_d_;
+}
+
+bool decimator::fir_push_rt(double const* x, float* y, double* t_offset_s) {
+    int n = n_channels_;
+    hist_w_ = (hist_w_ + 1) % tpp_;
+    double* row_a = &hist_[hist_w_ * n];
+    double* row_b = &hist_[(hist_w_ + tpp_) * n];
+    for (int c=0; c<n; c++) {
+        row_a[c] = x[c];
+        row_b[c] = x[c];
+    }
+    phase_ -= l_;
+    if (phase_ >= l_) {
+        return false;
+    }
+
+    // Newest tpp_ inputs are contiguous from the row after the newest
+    int p = phase_;
+    double const* h = &fir_[p * tpp_];
+    double const* rows = &hist_[(hist_w_ + 1) * n];
+    double* acc = fir_out_.data();
+    for (int c=0; c<n; c++) {
+        acc[c] = 0.0;
+    }
+    for (int k=0; k<tpp_; k++) {
+        double hk = h[k];
+        double const* row = rows + k * n;
+        for (int c=0; c<n; c++) {
+            acc[c] += hk * row[c];
+        }
+    }
+    for (int c=0; c<n; c++) {
+        y[c] = (float)acc[c];
+    }
+    *t_offset_s = filter_ ? ((double)p / ((double)l_ * cic_rate_hz_) - delay_s_) : 0.0;
+    phase_ += m_;
+    return true;
+}
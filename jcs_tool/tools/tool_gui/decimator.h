@@ -0,0 +1,76 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef DECIMATOR_H_
+#define DECIMATOR_H_
+
+#include <vector>
+
+// Anti-alias rate converter from the host base rate to any lower integer rate, all channels at once.
+//
+// Stage 1: CIC decimation by an integer D down to at least cic_min_oversample times the output rate.
+//          Evaluated as its FIR (boxcar^K) in polyphase form, each input adds into the K outputs it
+//          belongs to and an output's accumulator is cleared once emitted. Floats do not drift as
+//          they would in CIC integrators.
+// Stage 2: Polyphase FIR, upsample L, filter, downsample M, with L/M the remaining rational ratio.
+//          Blackman windowed sinc, passband to 0.4 of the output rate, stopband from its Nyquist.
+//          A 3 tap equaliser folded into the FIR flattens the CIC droop at the passband edge.
+//
+// With filter off, outputs hold the latest input. Any output rate works either way.
+// Per tick cost is K multiply-adds per channel, plus a taps_per_output_get() dot product per channel
+// in the ticks that emit an output. Channels are innermost in every loop.
+class decimator {
+public:
+    decimator();
+
+    // Non RT. Allocates. output_rate_hz must be in [1, input_rate_hz].
+    int configure(int n_channels, int input_rate_hz, int output_rate_hz, bool filter);
+
+    // RT. Fill the filter history as if x had always been the input. Costs about one output.
+    void seed_rt(double const* x);
+    // RT. One input frame. Returns true with an output frame in y when one is due.
+    // t_offset_s is the output's time relative to this input, group delay included.
+    bool step_rt(double const* x, float* y, double* t_offset_s);
+
+    // Status
+    int cic_decimation_get() const { return cic_d_; }
+    int interpolation_get() const { return l_; }
+    int decimation_get() const { return m_; }
+    int taps_per_output_get() const { return tpp_; }
+    double delay_s_get() const { return delay_s_; }
+
+    static int const cic_order = 4;
+    static int const cic_min_oversample = 8;
+    // Largest polyphase table, coefficients
+    static int const fir_max_coefficients = 1 << 20;
+
+private:
+    int n_channels_;
+    bool filter_;
+    double delay_s_;
+
+    // Stage 1
+    int cic_d_;                         // 1 = bypass
+    double cic_rate_hz_;                // Stage 1 output rate
+    std::vector<double> cic_h_;         // K*(D-1)+1 taps, DC gain 1
+    std::vector<double> cic_seed_;      // Per pending output, sum of the taps already past for a constant input
+    std::vector<double> cic_acc_;       // cic_order slots x n_channels
+    int cic_n_;                         // Inputs since the last output, mod D
+    int cic_slot_;                      // Slot of the next output to complete
+    std::vector<double> cic_out_;
+
+    // Stage 2
+    int l_;
+    int m_;
+    int tpp_;
+    std::vector<double> fir_;           // l_ phases x tpp_, oldest input first, gain l_ included
+    std::vector<double> hist_;          // 2*tpp_ rows x n_channels, each input written twice
+    int hist_w_;                        // Row of the newest input, [0, tpp_)
+    int phase_;                         // Next output position relative to the newest input, upsampled
+    std::vector<double> fir_out_;
+
+    void cic_push_rt(double const* x, bool* out);
+    bool fir_push_rt(double const* x, float* y, double* t_offset_s);
+};
+
+#endif
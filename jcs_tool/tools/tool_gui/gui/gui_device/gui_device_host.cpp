@@ -5,8 +5,6 @@
 #include <iostream>
 #include "implot.h"
 
-#include "tool_gui.h"//debug
-
 #include "imgui.h"
 #include "helpers.h"
 
@@ -16,7 +14,10 @@ gui_device_host::gui_device_host(jcs::jcs_host* host, gui_interface* gui_if, std
     gui_host_logger_ = new gui_host_logger(host_, gui_if_, name_);
     gui_plot_ = new gui_plot(host_, gui_if_, name_);
     gui_host_statistics_ = new gui_host_statistics(host_, gui_if_, name_);
+    gui_host_rt_profile_ = new gui_host_rt_profile(host_, gui_if_, name_);
     gui_host_oscilloscope_ = new gui_host_oscilloscope(host_, gui_if_, name_);
+    gui_host_multi_scope_ = new gui_host_multi_scope(host_, gui_if_, name_);
+    gui_host_fleet_tune_ = new gui_host_fleet_tune(host_, gui_if_, name_);
     gui_host_input_stimulus_ = new gui_host_input_stimulus(host_, gui_if_, name_);
     gui_host_analysis_ = new gui_host_analysis(host_, gui_if_, name_);
     gui_host_network_firmware_update_ = new gui_host_network_firmware_update(host_, gui_if_, name_);
@@ -25,7 +26,10 @@ gui_device_host::gui_device_host(jcs::jcs_host* host, gui_interface* gui_if, std
     gui_element_.push_back(static_cast<gui_type_base*>(gui_host_logger_));
     gui_element_.push_back(static_cast<gui_type_base*>(gui_plot_));
     gui_element_.push_back(static_cast<gui_type_base*>(gui_host_statistics_));
+    gui_element_.push_back(static_cast<gui_type_base*>(gui_host_rt_profile_));
     gui_element_.push_back(static_cast<gui_type_base*>(gui_host_oscilloscope_));
+    gui_element_.push_back(static_cast<gui_type_base*>(gui_host_multi_scope_));
+    gui_element_.push_back(static_cast<gui_type_base*>(gui_host_fleet_tune_));
     gui_element_.push_back(static_cast<gui_type_base*>(gui_host_input_stimulus_));
     gui_element_.push_back(static_cast<gui_type_base*>(gui_host_analysis_));
     gui_element_.push_back(static_cast<gui_type_base*>(gui_host_network_firmware_update_));
@@ -34,7 +38,10 @@ gui_device_host::gui_device_host(jcs::jcs_host* host, gui_interface* gui_if, std
     gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_logger_));
     gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_plot_));
     gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_statistics_));
+    gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_rt_profile_));
     gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_oscilloscope_));
+    gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_multi_scope_));
+    gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_fleet_tune_));
     gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_input_stimulus_));
     gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_analysis_));
     gui_element_host_ptr_.push_back(static_cast<gui_device_host_base*>(gui_host_network_firmware_update_));
@@ -54,6 +61,7 @@ int gui_device_host::startup() {
 
 int gui_device_host::step_rt_always() {
     for (int i=0; i<gui_element_host_ptr_.size(); i++) {
+        rt_profile::scope timer(&gui_element_[i]->rt_cost_always_);
         if (gui_element_host_ptr_[i]->step_rt_always() != jcs::RET_OK) {
             return jcs::RET_ERROR;
         }
@@ -64,6 +72,7 @@ int gui_device_host::step_rt_always() {
 
 int gui_device_host::step_rt() {
     for (int i=0; i<gui_element_.size(); i++) {
+        rt_profile::scope timer(&gui_element_[i]->rt_cost_step_);
         if (gui_element_[i]->step_rt() != jcs::RET_OK) { 
             return jcs::RET_ERROR;
         }
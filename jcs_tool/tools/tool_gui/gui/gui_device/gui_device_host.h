@@ -12,8 +12,11 @@
 
 #include "gui_plot.h"
 #include "gui_host_statistics.h"
+#include "gui_host_rt_profile.h"
 #include "gui_host_logger.h"
 #include "gui_host_oscilloscope.h"
+#include "gui_host_multi_scope.h"
+#include "gui_host_fleet_tune.h"
 #include "gui_host_input_stimulus.h"
 #include "gui_host_analysis.h"
 #include "gui_host_network_firmware.h"
@@ -30,13 +33,19 @@ public:
 
     int step_rt_always();
 
+    // Index aligned with elements_get()
+    std::vector<gui_device_host_base*> const& host_elements_get() { return gui_element_host_ptr_; }
+
 private:
     std::vector<gui_device_host_base*> gui_element_host_ptr_;
 
     gui_host_logger* gui_host_logger_;
     gui_plot* gui_plot_;
     gui_host_statistics* gui_host_statistics_;
+    gui_host_rt_profile* gui_host_rt_profile_;
     gui_host_oscilloscope* gui_host_oscilloscope_;
+    gui_host_multi_scope* gui_host_multi_scope_;
+    gui_host_fleet_tune* gui_host_fleet_tune_;
     gui_host_input_stimulus* gui_host_input_stimulus_;
     gui_host_analysis* gui_host_analysis_;
     gui_host_network_firmware_update* gui_host_network_firmware_update_;
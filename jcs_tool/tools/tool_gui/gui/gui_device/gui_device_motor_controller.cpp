@@ -49,6 +49,7 @@ int gui_device_motor_controller::startup() {
 
 int gui_device_motor_controller::step_rt() {
     for (int i=0; i<gui_element_.size(); i++) {
+        rt_profile::scope timer(&gui_element_[i]->rt_cost_step_);
         if (gui_element_[i]->step_rt() != jcs::RET_OK) { 
             return jcs::RET_ERROR;
         }
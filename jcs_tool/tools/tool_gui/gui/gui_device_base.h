@@ -23,6 +23,31 @@ public:
     virtual int step_rt() = 0;
     virtual int render() = 0; 
 
+    // Non-RT, every GUI frame. Passed to all elements.
+    virtual int step_gui() {
+        for (int i=0; i<gui_element_.size(); i++) {
+            if (gui_element_[i]->step_gui() != jcs::RET_OK) {
+                return jcs::RET_ERROR;
+            }
+        }
+        return jcs::RET_OK;
+    }
+
+    // Elements in tab order. For callers that step elements individually.
+    std::vector<gui_type_base*> const& elements_get() { return gui_element_; }
+
+    // Queue Read All on every element. Returns the jobs queued.
+    std::vector<param_job_ptr> read_all_parameters() {
+        std::vector<param_job_ptr> jobs;
+        for (int i=0; i<gui_element_.size(); i++) {
+            param_job_ptr job = gui_element_[i]->read_all_parameters();
+            if (job) {
+                jobs.push_back(job);
+            }
+        }
+        return jobs;
+    }
+
 protected:
     std::vector<gui_type_base*> gui_element_;
     std::string name_;
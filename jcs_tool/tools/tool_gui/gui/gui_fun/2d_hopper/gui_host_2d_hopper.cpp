@@ -27,8 +27,6 @@ gui_host_2d_hopper::gui_host_2d_hopper(jcs::jcs_host* host, gui_interface* gui_i
 }
 
 int gui_host_2d_hopper::startup() {
-    // Resize base rate float storage vector
-    f32_osignal_store_.resize(host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
     f32_isignal_store_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
 
     // Build a list of all available output float type, base rate signals
@@ -65,8 +63,8 @@ int gui_host_2d_hopper::startup() {
 
     // Startup
     for (int i=0; i<hopper_control_source_.size(); i++) {
-        // Connect the signal store
-        hopper_control_source_[i]->hopper_startup(&f32_osignal_store_, &f32_isignal_store_);
+        // Connect the shared base rate outputs and this element's inputs
+        hopper_control_source_[i]->hopper_startup(gui_if_->get_f32_output_signals(), &f32_isignal_store_);
         // Startup the contol sources
         if (hopper_control_source_[i]->startup(static_cast<double>(host_->base_frequency_get())) != jcs::RET_OK) {
             std::cout << "gui_host_2d_hopper: Control source: " << hopper_control_source_[i]->name_get() << " failed to start\n";
@@ -92,9 +90,11 @@ int gui_host_2d_hopper::step_rt() {
 
         case controller_state::running_s:
             // Only currently supporting base rates
-            host_->sig_output_get_rt(0, &f32_osignal_store_);
             hopper_control_source_[active_idx_]->step_rt_run();
-            host_->sig_input_set_rt(0, f32_isignal_store_);
+            // Controllers drive every input
+            for (int i=0; i<f32_isignal_store_.size(); i++) {
+                gui_if_->f32_input_signal_set_rt(i, f32_isignal_store_[i]);
+            }
             break;
     }
     return jcs::RET_OK;
@@ -29,10 +29,10 @@ private:
     int active_idx_;
     std::vector<std::string> source_names_;
 
-    std::vector<float> f32_osignal_store_;
-    std::vector<float> f32_isignal_store_;
     std::vector<std::string> f32_output_signal_names_;
     std::vector<std::string> f32_input_signal_names_;
+    // Inputs driven by the active controller
+    std::vector<float> f32_isignal_store_;
 
     enum class controller_state {
         stopped_s,
@@ -13,7 +13,7 @@ public:
 
     std::string const& name_get() { return name_; }
 
-    void hopper_startup(std::vector<float>* f32_jcs_osig, std::vector<float>* f32_jcs_isig);
+    void hopper_startup(std::vector<float> const* f32_jcs_osig, std::vector<float>* f32_jcs_isig);
 
     virtual int startup(double sample_rate_hz) = 0;
     virtual int step_rt_init() = 0;
@@ -25,7 +25,7 @@ public:
 protected:
     std::string name_;
     std::vector<float>* f32_ctl_osig_;
-    std::vector<float>* f32_ctl_isig_;
+    std::vector<float> const* f32_ctl_isig_;
 };
 
 #endif
\ No newline at end of file
@@ -33,6 +33,8 @@ hopper_2d_simple_kine::hopper_2d_simple_kine() :
 int hopper_2d_simple_kine::startup(double sample_rate_hz) {
     sine_x_.dt = 1.0 / sample_rate_hz;
     sine_y_.dt = 1.0 / sample_rate_hz;
+    sine_x_.frequency_update();
+    sine_y_.frequency_update();
 
     return jcs::RET_OK;
 }
@@ -67,9 +69,9 @@ int hopper_2d_simple_kine::render() {
     const double amp_max = 0.05;
     const double freq_max = 50.0;
     ImGui::SliderScalar("X sine amplitude", ImGuiDataType_Double, &sine_x_.amplitude, &zero, &amp_max);
-    ImGui::SliderScalar("X sine frequency", ImGuiDataType_Double, &sine_x_.frequency, &zero, &freq_max);
+    if (ImGui::SliderScalar("X sine frequency", ImGuiDataType_Double, &sine_x_.frequency, &zero, &freq_max)) { sine_x_.frequency_update(); }
     ImGui::SliderScalar("Y sine amplitude", ImGuiDataType_Double, &sine_y_.amplitude, &zero, &amp_max);
-    ImGui::SliderScalar("Y sine frequency", ImGuiDataType_Double, &sine_y_.frequency, &zero, &freq_max);
+    if (ImGui::SliderScalar("Y sine frequency", ImGuiDataType_Double, &sine_y_.frequency, &zero, &freq_max)) { sine_y_.frequency_update(); }
 
     ImGui::Separator();
 
@@ -6,6 +6,7 @@
 
 #include "hopper_2d.h"
 #include "helpers.h"
+#include "waveform_table.h"
 #include <cmath>
 
 class hopper_2d_simple_kine : public hopper_2d {
@@ -24,18 +25,27 @@ private:
     helpers::vec2 x_tip_;
     helpers::vec2 x_tip_mod_;
 
-    // Sine params so we can oscillate about the tool tip
+    // Sine params so we can oscillate about the tool tip.
+    // One cycle is tabled, the frequency sets the table step per tick.
     struct sine_params {
         double amplitude;
         double frequency;
         double dt;
-        unsigned int t;
+        waveform_table table;
         sine_params(double _dt) : amplitude(0.0), frequency(0.0), dt(_dt) {
-            t = 0;
+            int const n = 1024;
+            for (int i=0; i<n; i++) {
+                table.samples().push_back(sin(2.0*M_PI*(double)i/(double)n));
+            }
+            table.cyclic_set(true);
+            table.interpolate_set(true);
+            frequency_update();
+        }
+        void frequency_update() {
+            table.step_set(frequency*(double)table.size()*dt);
         }
         double step_rt() {
-            t++;
-            return amplitude*sin(2.0*M_PI*frequency*(double)t*dt);
+            return amplitude*table.step_rt();
         }
     };
     sine_params sine_x_;
@@ -7,6 +7,12 @@
 #include <vector>
 #include <string>
 
+class param_worker;
+class gui_device_base;
+class rt_profile;
+class rt_jobs;
+class gui_type_base;
+
 class gui_interface {
 public:
     virtual int start() = 0;
@@ -14,5 +20,32 @@ public:
     virtual int reset() = 0;
     virtual std::vector<std::string>* get_f32_input_signal_names() = 0;
     virtual std::vector<std::string>* get_f32_output_signal_names() = 0;
+
+    // Base rate float signals shared by all elements.
+    // Outputs are fetched from jcs_host once per RT tick, before any element steps.
+    // Inputs start each RT tick at zero. An element keeps its own input values and copies its
+    // slots in with f32_input_signal_set_rt() on the ticks it drives them. Manual values (Signal
+    // Plot sliders) fill only the slots no element set that tick. The merged inputs are sent to
+    // jcs_host once per RT tick, after all elements have stepped, if anything was set.
+    virtual std::vector<float> const* get_f32_output_signals() = 0;
+    virtual void f32_input_signal_set_rt(int index, float value) = 0;
+    virtual void f32_input_signals_manual_rt(std::vector<float> const* values) = 0;
+
+    // Background mailbox transactions. Never call blocking host_->read_*/write_* from render().
+    virtual param_worker* get_param_worker() = 0;
+
+    // All devices, for tools that report across them. Built once before startup().
+    virtual std::vector<gui_device_base*> const* get_devices() = 0;
+    // RT cost of a whole tool tick, all elements included
+    virtual rt_profile* get_tick_profile() = 0;
+    virtual rt_jobs* get_rt_jobs() = 0;
+
+    // Host run shared by tests on several devices at once. Use in place of start() and stop().
+    // job_start() starts the host if it is not running. job_stop() stops it once the last job
+    // has stopped, and does nothing for a job not started. An exclusive job restarts the host
+    // (stop, reset, start) and cannot share it with any other job.
+    virtual bool job_can_start(bool exclusive) = 0;
+    virtual int job_start(gui_type_base* job, bool exclusive) = 0;
+    virtual int job_stop(gui_type_base* job) = 0;
 };
 #endif
\ No newline at end of file
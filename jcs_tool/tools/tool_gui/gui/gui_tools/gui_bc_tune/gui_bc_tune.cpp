@@ -4,7 +4,9 @@
 #include "gui_bc_tune.h"
 #include <iostream>
 #include "helpers.h"
+#include "imgui_helpers.h"
 #include <cmath>
+#include <memory>
 
 #include "jcs_dev_motor_controller.h"
 
@@ -31,6 +33,9 @@ int gui_bc_tune::render() {
     // ImGui::Text("- Ensure device is not temperature clamped.");
 
     ImGui::Separator();
+    param_worker::render_job(job_);
+
+    ImGuiDisabled ui_busy(job_ && job_->active());
 
     // Choose channel
     helpers::combo_select("Controller channel", &channels_, &channel_combo_idx_, &active_channel_);
@@ -47,18 +52,32 @@ int gui_bc_tune::render() {
 
     if (ImGui::Button("Measure resistance and inductance")) {
         if (active_channel_ == "controller_0") {
-            if (do_test_r(&test_r_parameters_[0], "controller_0") != jcs::RET_OK) { return jcs::RET_OK; }
-            if (do_test_l(&test_l_parameters_[0], "controller_0") != jcs::RET_OK) { return jcs::RET_OK; }
+            measure(0, "controller_0");
         } else
         if (active_channel_ == "controller_1") {
-            if (do_test_r(&test_r_parameters_[1], "controller_1") != jcs::RET_OK) { return jcs::RET_OK; }
-            if (do_test_l(&test_l_parameters_[1], "controller_1") != jcs::RET_OK) { return jcs::RET_OK; }
+            measure(1, "controller_1");
         }
     }
 
     return jcs::RET_OK;
 }
 
+void gui_bc_tune::measure(int idx, std::string const& channel) {
+    // [0] = R, [1] = L. Completed tests are kept on failure.
+    std::shared_ptr<std::array<float, 2>> results = std::make_shared<std::array<float, 2>>();
+    results->at(0) = test_r_parameters_[idx].result;
+    results->at(1) = test_l_parameters_[idx].result;
+
+    job_ = gui_if_->get_param_worker()->submit("Measure R and L", [this, idx, channel, results](param_job& job) {
+        if (do_test_r(job, &test_r_parameters_[idx], channel, &results->at(0)) != jcs::RET_OK) { return jcs::RET_ERROR; }
+        if (do_test_l(job, &test_l_parameters_[idx], channel, &results->at(1)) != jcs::RET_OK) { return jcs::RET_ERROR; }
+        return jcs::RET_OK;
+    }, [this, idx, results](param_job& job) {
+        test_r_parameters_[idx].result = results->at(0);
+        test_l_parameters_[idx].result = results->at(1);
+    }, target_device_);
+}
+
 
 void gui_bc_tune::test_r_get_parameters(std::string const& channel, test_r* storage) {
     ImGui::PushID((channel + "r").c_str());
@@ -115,12 +134,14 @@ void gui_bc_tune::test_l_get_parameters(std::string const& channel, test_l* stor
     ImGui::PopID();
 }
 
-int gui_bc_tune::do_test_r(test_r* storage, std::string const& channel) {
+int gui_bc_tune::do_test_r(param_job& job, test_r const* storage, std::string const& channel, float* result) {
     //////////////////////////////////////////////////////////////////////////////////////////////////
     // Measure resistance
     std::cout << "Reading " << channel << " resistance\n";
+    job.progress_set(0.0f, "Resistance");
     // Save the original mode
-    PARAM_NOTIFY_ERROR( host_->read_enum(target_device_, channel+"_mode", &storage->original_mode), "Parameter failed: mode" )
+    std::string original_mode;
+    PARAM_NOTIFY_ERROR( host_->read_enum(target_device_, channel+"_mode", &original_mode), "Parameter failed: mode" )
 
     // Set parameters first
     PARAM_NOTIFY_ERROR( host_->write_float(target_device_,  channel+"_test_r_v_amplitude", storage->amplitude), "Parameter failed: test_r_v_amplitude" )
@@ -129,31 +150,42 @@ int gui_bc_tune::do_test_r(test_r* storage, std::string const& channel) {
     PARAM_NOTIFY_ERROR( host_->write_enum(target_device_, channel+"_mode", "test_r"), "Parameter failed: mode" )
     PARAM_NOTIFY_ERROR( host_->write_command(target_device_, channel+"_start"), "Parameter failed: start" )
     // Wait for test to finish
+    // Cancel stops waiting and restores the mode. The device finishes its timed test.
     bool running = true;
     do {
-        helpers::sleep_ms(100);
+        if (!job.sleep_ms(100)) {
+            PARAM_NOTIFY( host_->write_enum(target_device_, channel+"_mode", original_mode), "Parameter failed: mode" )
+            return jcs::RET_ERROR;
+        }
         PARAM_NOTIFY_ERROR( host_->read_bool(target_device_, channel+"_is_running", &running), "Parameter failed: is_running" )
     } while (running);
 
     // Sleep for a bit longer than test time
-    helpers::sleep_ms(2000);
+    job.progress_set(0.4f, "Resistance settling");
+    if (!job.sleep_ms(2000)) {
+        PARAM_NOTIFY( host_->write_enum(target_device_, channel+"_mode", original_mode), "Parameter failed: mode" )
+        return jcs::RET_ERROR;
+    }
 
-    storage->result = 0.0f;
-    PARAM_NOTIFY_ERROR( host_->read_float(target_device_, channel+"_R", &storage->result), "Parameter failed: R" )
-    std::cout << "Got resistance: " << storage->result << " Ohms\n\n";
+    float value = 0.0f;
+    PARAM_NOTIFY_ERROR( host_->read_float(target_device_, channel+"_R", &value), "Parameter failed: R" )
+    std::cout << "Got resistance: " << value << " Ohms\n\n";
+    *result = value;
 
     // Restore the original mode
-    PARAM_NOTIFY_ERROR( host_->write_enum(target_device_, channel+"_mode", storage->original_mode), "Parameter failed: mode" )
+    PARAM_NOTIFY_ERROR( host_->write_enum(target_device_, channel+"_mode", original_mode), "Parameter failed: mode" )
 
     return jcs::RET_OK;
 }
 
-int gui_bc_tune::do_test_l(test_l* storage, std::string const& channel) {
+int gui_bc_tune::do_test_l(param_job& job, test_l const* storage, std::string const& channel, float* result) {
     //////////////////////////////////////////////////////////////////////////////////////////////////
     // Measure resistance
     std::cout << "Reading " << channel << " inductance\n";
+    job.progress_set(0.5f, "Inductance");
     // Save the original mode
-    PARAM_NOTIFY_ERROR( host_->read_enum(target_device_, channel+"_mode", &storage->original_mode), "Parameter failed: mode" )
+    std::string original_mode;
+    PARAM_NOTIFY_ERROR( host_->read_enum(target_device_, channel+"_mode", &original_mode), "Parameter failed: mode" )
     // Set parameters first
     PARAM_NOTIFY_ERROR( host_->write_float(target_device_,  channel+"_test_l_v_bias",      storage->bias),     "Parameter failed: test_ls_v_dq_bias" )
     PARAM_NOTIFY_ERROR( host_->write_float(target_device_,  channel+"_test_l_v_amplitude", storage->amplitude),"Parameter failed: test_ls_v_dq_amplitude" )
@@ -164,15 +196,19 @@ int gui_bc_tune::do_test_l(test_l* storage, std::string const& channel) {
     PARAM_NOTIFY_ERROR( host_->write_command(target_device_, channel+"_start"), "Parameter failed: controller_0_start" )
     // Note: Here we demo that you don't have to poll the status of the test - you can just wait it out
     // Sleep for a bit longer than test time
-    helpers::sleep_ms(storage->time_ms + 2000);
+    if (!job.sleep_ms(storage->time_ms + 2000)) {
+        PARAM_NOTIFY( host_->write_enum(target_device_, channel+"_mode", original_mode), "Parameter failed: mode" )
+        return jcs::RET_ERROR;
+    }
 
     // Result is stored in motor_Lx
-    storage->result = 0.0f;
-    PARAM_NOTIFY_ERROR( host_->read_float(target_device_, channel+"_L", &storage->result), "Parameter failed: L" )
-    std::cout << "Got inductance: " << storage->result << " H\n";
+    float value = 0.0f;
+    PARAM_NOTIFY_ERROR( host_->read_float(target_device_, channel+"_L", &value), "Parameter failed: L" )
+    std::cout << "Got inductance: " << value << " H\n";
+    *result = value;
 
     // Restore the original mode
-    PARAM_NOTIFY_ERROR( host_->write_enum(target_device_, channel+"_mode", storage->original_mode), "Parameter failed: mode" )
+    PARAM_NOTIFY_ERROR( host_->write_enum(target_device_, channel+"_mode", original_mode), "Parameter failed: mode" )
 
     return jcs::RET_OK;
 }
@@ -10,6 +10,7 @@
 #include <string>
 #include "gui_type_base.h"
 #include "gui_interface.h"
+#include "param_worker.h"
 
 //////////////////////////////////////////////////////////////////////
 class gui_bc_tune : public gui_type_base {
@@ -32,7 +33,6 @@ private:
         float amplitude;
         int   time_ms;
         float result;
-        std::string original_mode;
         test_r() : amplitude(2.0f), time_ms(3000), result(0.0f) {}
     };
     std::array<test_r, 2> test_r_parameters_;
@@ -43,7 +43,6 @@ private:
         float frequency;
         int   time_ms;
         float result;
-        std::string original_mode;
         test_l() : bias(2.5f), amplitude(2.0f), frequency(1000.0f), time_ms(3000), result(0.0f) {}
     };
     std::array<test_l, 2> test_l_parameters_;
@@ -51,8 +50,13 @@ private:
 
     void test_r_get_parameters(std::string const& channel, test_r* storage);
     void test_l_get_parameters(std::string const& channel, test_l* storage);
-    int do_test_r(test_r* storage, std::string const& channel);
-    int do_test_l(test_l* storage, std::string const& channel);    
+    // Test in flight on the parameter worker. Controls are disabled until it finishes.
+    param_job_ptr job_;
+    void measure(int idx, std::string const& channel);
+
+    // Run on the parameter worker. Results are returned in result.
+    int do_test_r(param_job& job, test_r const* storage, std::string const& channel, float* result);
+    int do_test_l(param_job& job, test_l const* storage, std::string const& channel, float* result);
 };
 
 #endif
\ No newline at end of file
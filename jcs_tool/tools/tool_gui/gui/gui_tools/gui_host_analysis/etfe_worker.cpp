@@ -0,0 +1,319 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "etfe_worker.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "jcs_host.h"
+#include "task_rt_config.h"
+
+etfe_worker::etfe_worker() :
+    running_(false),
+    settings_changed_(true),
+    capture_reset_(false),
+    ready_new_(false),
+    segments_done_(0),
+    hop_(1),
+    win_sum_(0.0),
+    win_sumsq_(0.0)
+{
+}
+
+etfe_worker::~etfe_worker() {
+    stop();
+}
+
+int etfe_worker::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return jcs::RET_OK;
+    }
+    running_ = true;
+    thread_ = std::thread(&etfe_worker::run, this);
+    return jcs::RET_OK;
+}
+
+void etfe_worker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void etfe_worker::setup(settings const& s) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        settings_ = s;
+        settings_changed_ = true;
+    }
+    cv_.notify_one();
+}
+
+void etfe_worker::capture_reset() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capture_reset_ = true;
+        in_x_.clear();
+        in_y_.clear();
+    }
+    cv_.notify_one();
+}
+
+void etfe_worker::samples_push(double const* x, double const* y, int n) {
+    if (n <= 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_x_.insert(in_x_.end(), x, x + n);
+        in_y_.insert(in_y_.end(), y, y + n);
+    }
+    cv_.notify_one();
+}
+
+void etfe_worker::recompute() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        settings_changed_ = true;
+    }
+    cv_.notify_one();
+}
+
+bool etfe_worker::result_update() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ready_new_) {
+        return false;
+    }
+    std::swap(front_, ready_);
+    ready_new_ = false;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Worker thread
+void etfe_worker::run() {
+    task_rt::thd_sched sched;
+    if (task_rt::sched_named_get("analysis", &sched)) {
+        if (task_rt::sched_apply_self(sched) != jcs::RET_OK) {
+            std::cout << "etfe_worker: Could not apply analysis thread config\n";
+        }
+    }
+
+    while (true) {
+        bool reprocess = false;
+        bool reconfigure = false;
+        settings s;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return !running_ || settings_changed_ || capture_reset_ || !in_x_.empty(); });
+            if (!running_) {
+                break;
+            }
+            if (settings_changed_) {
+                s = settings_;
+                settings_changed_ = false;
+                reconfigure = true;
+                reprocess = true;
+            }
+            if (capture_reset_) {
+                x_.clear();
+                y_.clear();
+                capture_reset_ = false;
+                reprocess = true;
+            }
+            x_.insert(x_.end(), in_x_.begin(), in_x_.end());
+            y_.insert(y_.end(), in_y_.begin(), in_y_.end());
+            in_x_.clear();
+            in_y_.clear();
+        }
+
+        if (reconfigure) {
+            configure(s);
+        }
+        if (reprocess) {
+            accumulate_reset();
+        }
+        // Only segments completed since the last pass
+        int segments_before = segments_done_;
+        while ((cfg_.offset + segments_done_ * hop_ + cfg_.nwindow) <= x_.size()) {
+            if (cfg_.max_segments > 0 && segments_done_ >= cfg_.max_segments) {
+                break;
+            }
+            segment_process(cfg_.offset + segments_done_ * hop_);
+            segments_done_++;
+        }
+        if (reprocess || (segments_done_ != segments_before)) {
+            publish();
+        }
+    }
+}
+
+void etfe_worker::configure(settings const& s) {
+    cfg_ = s;
+    if (cfg_.nwindow < 2) {
+        cfg_.nwindow = 2;
+    }
+    if (cfg_.method == method_type::periodic) {
+        cfg_.window = window_type::rect;
+        cfg_.noverlap = 0;
+        cfg_.nfft = cfg_.nwindow;
+    }
+    if (cfg_.offset < 0) {
+        cfg_.offset = 0;
+    }
+    if (cfg_.nfft < cfg_.nwindow) {
+        cfg_.nfft = cfg_.nwindow;
+    }
+    cfg_.nfft += cfg_.nfft % 2;
+    hop_ = cfg_.nwindow - cfg_.noverlap;
+    if (hop_ < 1) {
+        hop_ = 1;
+    }
+
+    switch (cfg_.window) {
+        default:
+        case window_type::hamming: win_ = etfe::hamming(cfg_.nwindow); break;
+        case window_type::hann:    win_ = etfe::hann(cfg_.nwindow);    break;
+        case window_type::rect:    win_ = etfe::winrect(cfg_.nwindow); break;
+    }
+    win_sum_ = 0.0;
+    win_sumsq_ = 0.0;
+    for (int i=0; i<win_.size(); i++) {
+        win_sum_ += win_[i];
+        win_sumsq_ += win_[i] * win_[i];
+    }
+
+    // The KISS FFT plan is kept until the size changes
+    if (fft_.size() != cfg_.nfft) {
+        fft_.resize(cfg_.nfft);
+    }
+    seg_x_.resize(cfg_.nfft);
+    seg_y_.resize(cfg_.nfft);
+    fx_.resize(cfg_.nfft);
+    fy_.resize(cfg_.nfft);
+
+    int n_bins = cfg_.nfft / 2 + 1;
+    sxx_.resize(n_bins);
+    syy_.resize(n_bins);
+    sxy_.resize(n_bins);
+    sax_.resize(n_bins);
+    say_.resize(n_bins);
+    sx_.resize(n_bins);
+    sy_.resize(n_bins);
+
+    // Published bins
+    std::vector<int> lines;
+    for (int i=0; i<cfg_.lines.size(); i++) {
+        if (cfg_.lines[i] >= 0 && cfg_.lines[i] < n_bins) {
+            lines.push_back(cfg_.lines[i]);
+        }
+    }
+    if (lines.empty()) {
+        lines.resize(n_bins);
+        for (int i=0; i<n_bins; i++) {
+            lines[i] = i;
+        }
+    }
+    cfg_.lines.swap(lines);
+}
+
+void etfe_worker::accumulate_reset() {
+    segments_done_ = 0;
+    std::fill(sxx_.begin(), sxx_.end(), 0.0);
+    std::fill(syy_.begin(), syy_.end(), 0.0);
+    std::fill(sxy_.begin(), sxy_.end(), etfe::complex(0.0, 0.0));
+    std::fill(sax_.begin(), sax_.end(), 0.0);
+    std::fill(say_.begin(), say_.end(), 0.0);
+    std::fill(sx_.begin(), sx_.end(), etfe::complex(0.0, 0.0));
+    std::fill(sy_.begin(), sy_.end(), etfe::complex(0.0, 0.0));
+}
+
+void etfe_worker::segment_process(int start) {
+    std::fill(seg_x_.begin(), seg_x_.end(), 0.0);
+    std::fill(seg_y_.begin(), seg_y_.end(), 0.0);
+    for (int i=0; i<win_.size(); i++) {
+        seg_x_[i] = x_[start + i] * win_[i];
+        seg_y_[i] = y_[start + i] * win_[i];
+    }
+    fft_.transform(seg_x_.data(), fx_.data());
+    fft_.transform(seg_y_.data(), fy_.data());
+
+    for (int i=0; i<sxx_.size(); i++) {
+        double ax = std::abs(fx_[i]);
+        double ay = std::abs(fy_[i]);
+        // One sided
+        double k = (i > 0) ? 2.0 : 1.0;
+        sxx_[i] += ax * ax * k;
+        syy_[i] += ay * ay * k;
+        sxy_[i] += fx_[i] * std::conj(fy_[i]) * k;
+        sax_[i] += ax;
+        say_[i] += ay;
+        sx_[i] += fx_[i];
+        sy_[i] += fy_[i];
+    }
+}
+
+void etfe_worker::publish() {
+    int n_bins = (segments_done_ > 0) ? cfg_.lines.size() : 0;
+    bool periodic = (cfg_.method == method_type::periodic);
+    bool has_std = periodic && (segments_done_ > 1);
+    back_.f.resize(n_bins);
+    back_.mag.resize(n_bins);
+    back_.phase.resize(n_bins);
+    back_.ampx.resize(n_bins);
+    back_.ampy.resize(n_bins);
+    back_.pxx10.resize(n_bins);
+    back_.pyy10.resize(n_bins);
+    back_.coherence.resize(n_bins);
+    back_.std10.resize(has_std ? n_bins : 0);
+    back_.segments = segments_done_;
+
+    if (n_bins > 0) {
+        // Same scaling as etfe::ETFE, averaged over the segments done so far
+        double m = (double)segments_done_;
+        double pf = 1.0 / (cfg_.fs * win_sumsq_) / m;
+        double af = 1.0 / (double)(cfg_.nfft / 2) * (double)win_.size() / win_sum_ / m;
+        double df = cfg_.fs / (double)cfg_.nfft;
+        for (int l=0; l<n_bins; l++) {
+            int i = cfg_.lines[l];
+            etfe::complex txy;
+            if (periodic) {
+                // Ratio of the mean spectra, input noise does not bias it
+                txy = sy_[i] / sx_[i];
+            } else {
+                txy = std::conj(sxy_[i]) / sxx_[i];
+            }
+            back_.f[l]     = (double)i * df;
+            back_.mag[l]   = 20.0 * std::log10(std::abs(txy));
+            back_.phase[l] = 180.0 / etfe::pi * std::arg(txy);
+            back_.ampx[l]  = sax_[i] * af;
+            back_.ampy[l]  = say_[i] * af;
+            back_.pxx10[l] = 10.0 * std::log10(sxx_[i] * pf);
+            back_.pyy10[l] = 10.0 * std::log10(syy_[i] * pf);
+            back_.coherence[l] = std::norm(sxy_[i]) / (sxx_[i] * syy_[i]);
+
+            if (has_std) {
+                // Sample (co)variances over periods, sums without the one sided factor
+                double k = (i > 0) ? 2.0 : 1.0;
+                etfe::complex x_mean = sx_[i] / m;
+                etfe::complex y_mean = sy_[i] / m;
+                double var_x = (sxx_[i] / k - m * std::norm(x_mean)) / (m - 1.0);
+                double var_y = (syy_[i] / k - m * std::norm(y_mean)) / (m - 1.0);
+                etfe::complex cov_yx = (std::conj(sxy_[i]) / k - m * y_mean * std::conj(x_mean)) / (m - 1.0);
+                double var_txy = std::norm(txy) / m * (var_y / std::norm(y_mean) + var_x / std::norm(x_mean)
+                                                       - 2.0 * std::real(cov_yx / (y_mean * std::conj(x_mean))));
+                back_.std10[l] = 10.0 * std::log10(std::max(var_txy, 1e-300));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(back_, ready_);
+    ready_new_ = true;
+}
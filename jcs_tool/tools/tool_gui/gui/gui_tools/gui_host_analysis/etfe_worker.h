@@ -0,0 +1,136 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef ETFE_WORKER_H_
+#define ETFE_WORKER_H_
+
+#include <complex>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ETFE.hpp>
+
+// Welch frequency response estimate computed on a background thread.
+//
+// The GUI appends captured input/output samples as they arrive. The worker transforms
+// each Welch segment once, as soon as its last sample is available, and keeps running
+// sums. After each batch it publishes a complete result. A settings change or
+// recompute() reprocesses the held samples once, in the background.
+//
+// Periodic mode averages the spectra of whole excitation periods instead. Segments are
+// one period, unwindowed and not overlapped, starting after the transient. The estimate
+// is mean(Y) / mean(X) on the excited lines, with its variance from the spread over periods.
+//
+// All public functions are for the GUI thread.
+class etfe_worker {
+public:
+    enum class window_type {
+        hamming,
+        hann,
+        rect
+    };
+
+    enum class method_type {
+        welch,
+        periodic
+    };
+
+    struct settings {
+        method_type method;
+        window_type window;
+        int nwindow;
+        int noverlap;
+        int nfft;
+        double fs;
+        // Periodic mode. nwindow is the period.
+        int offset;                 // Samples skipped before the first period
+        int max_segments;           // Periods averaged, 0 for all available
+        std::vector<int> lines;     // Bins published, empty for all
+        settings() : method(method_type::welch), window(window_type::hamming), nwindow(2000), noverlap(1000), nfft(2000), fs(1000.0),
+                     offset(0), max_segments(0) {}
+    };
+
+    struct result {
+        std::vector<double> f;
+        std::vector<double> mag;    // 20*log10(|txy|)
+        std::vector<double> phase;  // deg
+        std::vector<double> ampx;
+        std::vector<double> ampy;
+        std::vector<double> pxx10;  // 10*log10(pxx)
+        std::vector<double> pyy10;
+        std::vector<double> coherence;
+        std::vector<double> std10;  // 10*log10(var(txy)), periodic mode with 2 or more periods
+        int segments;
+        result() : segments(0) {}
+    };
+
+    etfe_worker();
+    ~etfe_worker();
+
+    int start();
+    void stop();
+
+    void setup(settings const& s);
+    // Start a new capture. Drops all held samples.
+    void capture_reset();
+    // Append n samples of the current capture
+    void samples_push(double const* x, double const* y, int n);
+    // Reprocess the held samples
+    void recompute();
+
+    // Take the latest published result. Returns true if it changed.
+    bool result_update();
+    result const& result_get() const { return front_; }
+
+private:
+    void run();
+    // Worker thread
+    void configure(settings const& s);
+    void accumulate_reset();
+    void segment_process(int start);
+    void publish();
+
+    // Shared, guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_;
+    settings settings_;
+    bool settings_changed_;
+    bool capture_reset_;
+    std::vector<double> in_x_;
+    std::vector<double> in_y_;
+    result ready_;
+    bool ready_new_;
+
+    // Worker owned
+    std::thread thread_;
+    settings cfg_;
+    std::vector<double> x_;
+    std::vector<double> y_;
+    int segments_done_;
+    int hop_;
+    std::vector<double> win_;
+    double win_sum_;
+    double win_sumsq_;
+    etfe::FFT fft_;
+    std::vector<double> seg_x_;
+    std::vector<double> seg_y_;
+    std::vector<etfe::complex> fx_;
+    std::vector<etfe::complex> fy_;
+    // Unscaled running sums over segments
+    std::vector<double> sxx_;
+    std::vector<double> syy_;
+    std::vector<etfe::complex> sxy_;
+    std::vector<double> sax_;
+    std::vector<double> say_;
+    std::vector<etfe::complex> sx_;
+    std::vector<etfe::complex> sy_;
+    result back_;
+
+    // GUI owned
+    result front_;
+};
+
+#endif
@@ -7,10 +7,9 @@
 #include <cmath>
 #include <iostream>
 #include "helpers.h"
+#include "imgui_helpers.h"
 #include "ImGuiFileDialog.h"
 
-#include <ETFE.hpp>
-
 gui_host_analysis::gui_host_analysis(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) : 
     gui_type_base("Host analysis", host, gui_if, target_device),
     sample_time_(1),
@@ -20,11 +19,18 @@ gui_host_analysis::gui_host_analysis(jcs::jcs_host* host, gui_interface* gui_if,
     sampler_state_ = sampler_state::off_s;
     storage_count_ = 0;
     storage_length_ = 0;
+    f32_osignal_ = nullptr;
+    etfe_method_idx_ = 0;
+    etfe_window_idx_ = 0;
+    etfe_nwindow_idx_ = 4;
+    etfe_nfft_idx_ = 4;
+    etfe_overlap_ = 0.5f;
+    capture_count_ = 0;
+    etfe_pushed_ = 0;
 }
 
 int gui_host_analysis::startup() {
-    // Resize base rate float storage vector
-    f32_osignal_store_.resize(host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+    f32_osignal_ = gui_if_->get_f32_output_signals();
     f32_isignal_store_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
 
     storage_length_ = sample_time_ * host_->base_frequency_get();
@@ -33,16 +39,24 @@ int gui_host_analysis::startup() {
     // Update storage for new configured base rate
     plotter_.update_storage_length(sample_time_, host_->base_frequency_get());
 
+    // One second of samples at the base rate. Drained every GUI frame.
+    if (ring_.startup((int)host_->base_frequency_get(), 2) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+
     // Configure input stimulus
-    input_stimulus_ = new gui_stimulus(static_cast<double>(host_->base_frequency_get()));
+    input_stimulus_ = new gui_stimulus(static_cast<double>(host_->base_frequency_get()), gui_if_->get_param_worker());
+
+    etfe_setup();
+    if (etfe_.start() != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
 
     return jcs::RET_OK;
 }
 
 int gui_host_analysis::step_rt() {
     // Only currently supporting base rates
-    host_->sig_output_get_rt(0, &f32_osignal_store_);
-
     switch (sampler_state_) {
         default:
         case sampler_state::off_s:
@@ -61,16 +75,18 @@ int gui_host_analysis::step_rt() {
 
             // Channel 0 is input signal
             f32_isignal_store_[plotter_.source_combo_idx_y0_] = input_stimulus_->value_get();
-            plotter_.y0_[storage_count_] = static_cast<double>(f32_isignal_store_[plotter_.source_combo_idx_y0_]);
+            frame_rt_[0] = f32_isignal_store_[plotter_.source_combo_idx_y0_];
             // Channel 1 is output signal
-            plotter_.y1_[storage_count_] = static_cast<double>(f32_osignal_store_[plotter_.source_combo_idx_y1_]);
+            frame_rt_[1] = (*f32_osignal_)[plotter_.source_combo_idx_y1_];
+            // Plotter storage is written in step_gui()
+            ring_.push_rt((double)storage_count_, frame_rt_);
 
             storage_count_++;
             if (storage_count_ >= storage_length_) {
                 storage_count_ = 0;
                 sampler_state_ = sampler_state::done_s;
             }
-            host_->sig_input_set_rt(0, f32_isignal_store_);
+            gui_if_->f32_input_signal_set_rt(plotter_.source_combo_idx_y0_, f32_isignal_store_[plotter_.source_combo_idx_y0_]);
             break;
 
         case sampler_state::done_s:
@@ -84,6 +100,32 @@ int gui_host_analysis::step_rt_always() {
     return jcs::RET_OK;
 }
 
+int gui_host_analysis::step_gui() {
+    double idx_d;
+    while (ring_.pop(&idx_d, frame_gui_)) {
+        int idx = (int)idx_d;
+        // A new capture restarts at index 0
+        if (idx < capture_count_) {
+            capture_reset();
+        }
+        // Storage may have been resized since the sample was taken
+        if (idx < plotter_.y0_.size()) {
+            plotter_.y0_[idx] = static_cast<double>(frame_gui_[0]);
+            plotter_.y1_[idx] = static_cast<double>(frame_gui_[1]);
+        }
+        capture_count_ = idx + 1;
+    }
+
+    // Hand new samples to the estimator. It only transforms segments it has not seen.
+    int n = (capture_count_ < plotter_.y0_.size()) ? capture_count_ : plotter_.y0_.size();
+    if (n > etfe_pushed_) {
+        etfe_.samples_push(&plotter_.y0_[etfe_pushed_], &plotter_.y1_[etfe_pushed_], n - etfe_pushed_);
+        etfe_pushed_ = n;
+    }
+    etfe_.result_update();
+    return jcs::RET_OK;
+}
+
 int gui_host_analysis::render() {
     render_status();
     ImGui::Separator();
@@ -131,6 +173,7 @@ int gui_host_analysis::render_interface() {
             sample_time_ = sample_temp;
             storage_length_ = sample_time_ * host_->base_frequency_get();
             plotter_.update_storage_length(sample_time_, host_->base_frequency_get());
+            capture_reset();
         }
     }
 
@@ -142,8 +185,11 @@ int gui_host_analysis::render_interface() {
 
     input_stimulus_->render_parameters();
 
-    if (ImGui::Button("Start stimulus")) {
-        sampler_state_ = sampler_state::init_s;
+    {
+        ImGuiDisabled rendering(!input_stimulus_->table_ready());
+        if (ImGui::Button("Start stimulus")) {
+            sampler_start();
+        }
     }
     ImGui::SameLine();
     if (ImGui::Button("Abort")) {
@@ -272,6 +318,8 @@ int gui_host_analysis::write_channels_to_file() {
 int gui_host_analysis::emit_data(std::string const& path_and_file) {
     std::cout << "Writing to: " << path_and_file << "\n";
 
+    step_gui();
+
     std::ofstream config_file(path_and_file); 
 
     config_file << "t,";
@@ -286,64 +334,111 @@ int gui_host_analysis::emit_data(std::string const& path_and_file) {
     return jcs::RET_OK;
 }
 
+void gui_host_analysis::capture_reset() {
+    capture_count_ = 0;
+    etfe_pushed_ = 0;
+    etfe_.capture_reset();
+}
+
+void gui_host_analysis::sampler_start() {
+    // A periodic estimate needs the whole excitation in one capture
+    stimulus_periodic periodic;
+    if (etfe_method_idx_ == (int)etfe_worker::method_type::periodic && input_stimulus_->periodic_get(&periodic)) {
+        long int n = (long int)(periodic.transient_periods + periodic.periods) * periodic.period_samples;
+        int sample_time = (int)((n + sample_rate_ - 1) / sample_rate_);
+        if (sample_time > sample_time_) {
+            sample_time_ = sample_time;
+            storage_length_ = sample_time_ * host_->base_frequency_get();
+            plotter_.update_storage_length(sample_time_, host_->base_frequency_get());
+            capture_reset();
+        }
+        etfe_setup();
+    }
+    sampler_state_ = sampler_state::init_s;
+}
+
+void gui_host_analysis::etfe_setup() {
+    static int const nwindow_opts[] = {100, 200, 500, 1000, 2000, 5000, 10000};
+    static int const nfft_opts[]    = {100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000};
+
+    etfe_nfft_idx_ = (etfe_nwindow_idx_ > etfe_nfft_idx_) ? etfe_nwindow_idx_ : etfe_nfft_idx_;
+    etfe_worker::settings s;
+    s.window   = static_cast<etfe_worker::window_type>(etfe_window_idx_);
+    s.nwindow  = nwindow_opts[etfe_nwindow_idx_];
+    s.noverlap = (int)(s.nwindow * etfe_overlap_);
+    s.nfft     = nfft_opts[etfe_nfft_idx_];
+    s.fs       = static_cast<double>(sample_rate_);
+
+    // Periodic averaging over the periods of the active stimulus
+    stimulus_periodic periodic;
+    if (etfe_method_idx_ == (int)etfe_worker::method_type::periodic && input_stimulus_->periodic_get(&periodic)) {
+        s.method       = etfe_worker::method_type::periodic;
+        s.nwindow      = periodic.period_samples;
+        s.offset       = periodic.transient_periods * periodic.period_samples;
+        s.max_segments = periodic.periods;
+        s.lines        = periodic.lines;
+    }
+    etfe_.setup(s);
+}
+
 void gui_host_analysis::render_analysis() {
 
     // This is swiped almost verbatim from implot_demos:
     // https://github.com/epezent/implot_demos
 
-    // perform ETFE
-    int N = plotter_.y0_.size();
-    double Fs = static_cast<double>(sample_rate_);
     int fs_on_2 = sample_rate_ / 2;
-    static int window         = 0;
-    static int inwindow        = 4;
-    static int nwindow_opts[] = {100, 200, 500, 1000, 2000, 5000, 10000};
-    static int infft          = 4;
-    static int nfft_opts[]    = {100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000};
-    static float overlap      = 0.5f;
-
     static double Fc[] = {100,100};
-    static bool etfe_need_update = false;
-
-    static etfe::ETFE etfe(N, Fs, etfe::hamming(nwindow_opts[inwindow]), nwindow_opts[inwindow]/2, nfft_opts[infft]);        
+    bool etfe_need_update = false;
 
     ImGui::Text("Frequency Response");
     ImGui::Separator();
-    if (ImGui::Combo("FFT Size", &infft, "100\0""200\0""500\0""1000\0""2000\0""5000\0""10000\0""20000\0""50000\0")) {
-        inwindow = infft < inwindow ? infft : inwindow;
-        etfe_need_update = true;
-    }
-    if (ImGui::Combo("Window Type", &window,"hamming\0hann\0winrect\0")) {
+    if (ImGui::Combo("Estimator", &etfe_method_idx_, "Welch\0Periodic average\0")) {
         etfe_need_update = true;
     }
-    if (ImGui::Combo("Window Size", &inwindow,"100\0""200\0""500\0""1000\0""2000\0""5000\0""10000\0")) {
-        etfe_need_update = true;
+    stimulus_periodic periodic;
+    bool periodic_active = (etfe_method_idx_ == (int)etfe_worker::method_type::periodic) && input_stimulus_->periodic_get(&periodic);
+    if (etfe_method_idx_ == (int)etfe_worker::method_type::periodic && !periodic_active) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.0f, 1.0f), "Needs a periodic stimulus, e.g. Multisine. Using Welch.");
     }
-    if (ImGui::SliderFloat("Window Overlap",&overlap,0,1,"%.2f")) {
-        etfe_need_update = true;
+    {
+        // Periodic averaging uses whole periods, no window
+        ImGuiDisabled welch_only(periodic_active);
+        if (ImGui::Combo("FFT Size", &etfe_nfft_idx_, "100\0""200\0""500\0""1000\0""2000\0""5000\0""10000\0""20000\0""50000\0")) {
+            etfe_nwindow_idx_ = etfe_nfft_idx_ < etfe_nwindow_idx_ ? etfe_nfft_idx_ : etfe_nwindow_idx_;
+            etfe_need_update = true;
+        }
+        if (ImGui::Combo("Window Type", &etfe_window_idx_,"hamming\0hann\0winrect\0")) {
+            etfe_need_update = true;
+        }
+        if (ImGui::Combo("Window Size", &etfe_nwindow_idx_,"100\0""200\0""500\0""1000\0""2000\0""5000\0""10000\0")) {
+            etfe_need_update = true;
+        }
+        // Recompute once the slider is released, not on every drag step
+        ImGui::SliderFloat("Window Overlap",&etfe_overlap_,0.0f,0.9f,"%.2f");
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            etfe_need_update = true;
+        }
     }
 
     if (ImGui::Button("Recompute")) {
-        etfe_need_update = true;
+        if (periodic_active) {
+            // Picks up changed stimulus periods or lines
+            etfe_setup();
+        } else {
+            etfe_.recompute();
+        }
     }
 
-    ImGui::NewLine();
-    
+    // One background recompute over the held samples
     if (etfe_need_update) {
-        infft = inwindow > infft ? inwindow : infft;
-        int nwindow  = nwindow_opts[inwindow];
-        int noverlap = (int)(nwindow * overlap);
-        int nfft     = nfft_opts[infft];
-        etfe.setup(N,Fs,window == 0 ? etfe::hamming(nwindow) : window == 1 ? etfe::hann(nwindow) : etfe::winrect(nwindow), noverlap, nfft);
+        etfe_setup();
     }
 
-    if (etfe_need_update || sampler_state_ == sampler_state::sampling_s) {
-        etfe.estimate(&plotter_.y0_[0], &plotter_.y1_[0]);
-        etfe_need_update = false;
-    }        
-
-    // Hackity hacks...
-    const etfe::ETFE::Result& result = etfe.getResult();
+    etfe_worker::result const& result = etfe_.result_get();
+    ImGui::SameLine();
+    ImGui::Text(periodic_active ? "Periods: %d" : "Segments: %d", result.segments);
+    ImGui::NewLine();
 
     if (ImGui::BeginTabBar("Plots")) {
         if (ImGui::BeginTabItem("Magnitude")) {
@@ -357,6 +452,9 @@ void gui_host_analysis::render_analysis() {
                 ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.250f);
                 ImPlot::PlotShaded("##Mag1",result.f.data(),result.mag.data(),(int)result.f.size(),-INFINITY);
                 ImPlot::PlotLine("##Mag2",result.f.data(),result.mag.data(),(int)result.f.size());
+                if (!result.std10.empty()) {
+                    ImPlot::PlotLine("Std dev",result.f.data(),result.std10.data(),(int)result.f.size());
+                }
                 ImPlot::Annotation(Fc[0],-3,ImVec4(0.15f,0.15f,0.15f,1),ImVec2(5,-5),true,"Half-Power Point");
                 if (ImPlot::DragLineX(148884,&Fc[0],ImVec4(0.15f,0.15f,0.15f,1))) {
                     // filt_need_update = true;
@@ -380,6 +478,16 @@ void gui_host_analysis::render_analysis() {
             }
             ImGui::EndTabItem();
         }   
+        if (ImGui::BeginTabItem("Coherence")) {
+            if (ImPlot::BeginPlot("##Coherence",ImVec2(-1,-1))) {
+                ImPlot::SetupAxesLimits(1, fs_on_2, 0, 1.05);
+                ImPlot::SetupAxes("Frequency [Hz]","Coherence");
+                ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
+                ImPlot::PlotLine("##Coherence",result.f.data(),result.coherence.data(),(int)result.f.size());
+                ImPlot::EndPlot();
+            }
+            ImGui::EndTabItem();
+        }
         if (ImGui::BeginTabItem("Amplitude")) {
             if (ImPlot::BeginPlot("##Amp",ImVec2(-1,-1))) {
                 ImPlot::SetupAxesLimits(1, fs_on_2, 0, 1.0);
@@ -404,23 +512,16 @@ void gui_host_analysis::render_analysis() {
             ImGui::EndTabItem();
         }
         if (ImGui::BeginTabItem("Power")) {
-            static std::vector<double> pxx10, pyy10;
-            pxx10.resize(result.pxx.size());
-            pyy10.resize(result.pyy.size());
-            for (int i = 0; i < pxx10.size(); ++i) {
-                pxx10[i] = 10*std::log10(result.pxx[i]);
-                pyy10[i] = 10*std::log10(result.pyy[i]);
-            }
             if (ImPlot::BeginPlot("##Power",ImVec2(-1,-1))) {
                 ImPlot::SetupAxesLimits(1, fs_on_2, -100, 0);
                 ImPlot::SetupAxes("Frequency [Hz]","Power Spectral Density (dB/Hz)");
                 ImPlot::SetupLegend(ImPlotLocation_NorthEast);
                 ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.25f);
-                ImPlot::PlotShaded("x(f)",result.f.data(),pxx10.data(),(int)result.f.size(),-INFINITY);
-                ImPlot::PlotLine("x(f)",result.f.data(),pxx10.data(),(int)result.f.size());
+                ImPlot::PlotShaded("x(f)",result.f.data(),result.pxx10.data(),(int)result.f.size(),-INFINITY);
+                ImPlot::PlotLine("x(f)",result.f.data(),result.pxx10.data(),(int)result.f.size());
                 ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.25f);
-                ImPlot::PlotShaded("y(f)",result.f.data(),pyy10.data(),(int)result.f.size(),-INFINITY);
-                ImPlot::PlotLine("y(f)",result.f.data(),pyy10.data(),(int)result.f.size());
+                ImPlot::PlotShaded("y(f)",result.f.data(),result.pyy10.data(),(int)result.f.size(),-INFINITY);
+                ImPlot::PlotLine("y(f)",result.f.data(),result.pyy10.data(),(int)result.f.size());
 
                 ImPlot::EndPlot();
             }
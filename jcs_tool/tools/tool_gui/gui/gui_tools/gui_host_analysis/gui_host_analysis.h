@@ -13,6 +13,8 @@
 #include "gui_stimulus.h"
 #include "imgui.h"
 #include "helpers.h"
+#include "sample_ring.h"
+#include "etfe_worker.h"
 
 class gui_host_analysis : public gui_type_base, public gui_device_host_base {
 public:
@@ -23,6 +25,7 @@ public:
     int step_rt();
     int step_rt_always();
     int render();
+    int step_gui();
 
 private:
     // Sampler
@@ -59,7 +62,14 @@ private:
     };
     plotter plotter_;
 
-    std::vector<float> f32_osignal_store_;
+    // RT -> GUI samples {input, output}. Frame time is the storage index.
+    sample_ring ring_;
+    float frame_rt_[2];
+    float frame_gui_[2];
+
+    // Shared base rate outputs, see gui_interface
+    std::vector<float> const* f32_osignal_;
+    // Inputs driven by this element
     std::vector<float> f32_isignal_store_;
     // std::vector<std::string> f32_output_signal_names_;
     // std::vector<std::string> f32_input_signal_names_;
@@ -75,6 +85,20 @@ private:
     // Input stimulus
     gui_stimulus* input_stimulus_;
 
+    // Frequency response, estimated in the background as samples arrive
+    etfe_worker etfe_;
+    int etfe_method_idx_;
+    int etfe_window_idx_;
+    int etfe_nwindow_idx_;
+    int etfe_nfft_idx_;
+    float etfe_overlap_;
+    // Samples of the current capture received and handed to etfe_
+    int capture_count_;
+    int etfe_pushed_;
+    void etfe_setup();
+    void capture_reset();
+    void sampler_start();
+
     int render_plot();
     int render_interface();
     void render_status();
@@ -0,0 +1,667 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "gui_host_fleet_tune.h"
+#include "implot.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include "helpers.h"
+#include "imgui_helpers.h"
+#include "ImGuiFileDialog.h"
+
+// Poll period while a test runs, and settle time after the ready command
+static int const poll_ms = 100;
+static int const ready_settle_ms = 500;
+
+static char const* stage_name(int s) {
+    static char const* names[] = { "Ready", "Rs", "Ld", "Lq", "Gains", "Step response", "Done", "Failed" };
+    return names[s];
+}
+
+gui_host_fleet_tune::settings::settings() :
+    test_l{ test_inductance("d"), test_inductance("q") },
+    lq_equals_ld(true),
+    i_ctl_bw_hz(500.0f),
+    write_gains(true),
+    run_step(true)
+{}
+
+gui_host_fleet_tune::gui_host_fleet_tune(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
+    gui_type_base("Fleet tuning", host, gui_if, target_device),
+    running_(false),
+    run_wall_s_(0.0),
+    run_sum_s_(0.0)
+{}
+
+int gui_host_fleet_tune::startup() {
+    std::vector<jcs::jcs_device>* tree = host_->external_info_tree_get();
+    for (int i=0; i<tree->size(); i++) {
+        if (tree->at(i).node_type == "dev_motor_controller") {
+            device d;
+            d.name = tree->at(i).name;
+            d.selected = false;
+            d.stage_ = stage::ready_s;
+            d.phase_ = phase::start_s;
+            d.failed_at = stage::ready_s;
+            d.error_checked = false;
+            d.duration_s = 0.0;
+            d.rs = 0.0f;
+            d.ld = 0.0f;
+            d.lq = 0.0f;
+            devices_.push_back(d);
+        }
+    }
+    return jcs::RET_OK;
+}
+
+int gui_host_fleet_tune::step_rt() {
+    return jcs::RET_OK;
+}
+
+int gui_host_fleet_tune::step_rt_always() {
+    return jcs::RET_OK;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Run control
+
+void gui_host_fleet_tune::run_start() {
+    clock::time_point now = clock::now();
+    for (int i=0; i<devices_.size(); i++) {
+        device& d = devices_[i];
+        d.stage_ = stage::ready_s;
+        d.phase_ = phase::start_s;
+        d.failed_at = stage::ready_s;
+        d.job.reset();
+        d.stop_job.reset();
+        d.error_checked = false;
+        d.error = "";
+        d.t_start = now;
+        d.duration_s = 0.0;
+        d.rs = 0.0f;
+        d.ld = 0.0f;
+        d.lq = 0.0f;
+        d.gains = std::array<controller_gains, 2>();
+        d.step.clear();
+    }
+    report_text_ = "";
+    report_file_ = "";
+    run_ = std::make_shared<settings>(settings_);
+    t_run_start_ = now;
+    running_ = true;
+}
+
+void gui_host_fleet_tune::run_cancel() {
+    for (int i=0; i<devices_.size(); i++) {
+        device& d = devices_[i];
+        if (!d.selected || d.stage_ == stage::done_s || d.stage_ == stage::failed_s) {
+            continue;
+        }
+        if (d.job) {
+            d.job->cancel();
+        }
+        fail(i, "Cancelled");
+    }
+}
+
+bool gui_host_fleet_tune::busy() {
+    if (running_) {
+        return true;
+    }
+    for (int i=0; i<devices_.size(); i++) {
+        device const& d = devices_[i];
+        if ((d.job && d.job->active()) || (d.stop_job && d.stop_job->active())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool gui_host_fleet_tune::run_done() {
+    for (int i=0; i<devices_.size(); i++) {
+        if (devices_[i].selected && devices_[i].stage_ != stage::done_s && devices_[i].stage_ != stage::failed_s) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int gui_host_fleet_tune::step_gui() {
+    if (!running_) {
+        return jcs::RET_OK;
+    }
+    for (int i=0; i<devices_.size(); i++) {
+        device_step(i);
+    }
+    if (run_done()) {
+        running_ = false;
+        run_wall_s_ = std::chrono::duration<double>(clock::now() - t_run_start_).count();
+        run_sum_s_ = 0.0;
+        for (int i=0; i<devices_.size(); i++) {
+            if (devices_[i].selected) {
+                run_sum_s_ += devices_[i].duration_s;
+            }
+        }
+        report_text_ = report(false);
+        report_file_ = report(true);
+    }
+    return jcs::RET_OK;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Per device state machine. At most one job per device is in flight, its on_done moves the
+// device on. Waits between jobs are timed here.
+
+void gui_host_fleet_tune::device_step(int idx) {
+    device& d = devices_[idx];
+    if (!d.selected || d.stage_ == stage::done_s || d.stage_ == stage::failed_s) {
+        return;
+    }
+    if (d.job && d.job->active()) {
+        return;
+    }
+    switch (d.phase_) {
+        case phase::start_s:
+            stage_start(idx);
+            break;
+        case phase::poll_s:
+            if (clock::now() >= d.t_next) {
+                poll_submit(idx);
+            }
+            break;
+        case phase::settle_s:
+            if (clock::now() >= d.t_next) {
+                stage_read(idx);
+            }
+            break;
+        case phase::read_s:
+            break;
+    }
+}
+
+void gui_host_fleet_tune::submit(int idx, std::string const& name, std::function<int(param_job&)> fn, std::function<void()> on_ok) {
+    device& d = devices_[idx];
+    d.job = gui_if_->get_param_worker()->submit("Fleet tuning " + name + " " + d.name, fn, [this, idx, name, on_ok](param_job& job) {
+        // Only the device's current job moves it on
+        if (devices_[idx].job.get() != &job || devices_[idx].stage_ == stage::failed_s) {
+            return;
+        }
+        if (job.result() != jcs::RET_OK || job.get_status() != param_job::status::done) {
+            fail(idx, name + " failed");
+            return;
+        }
+        on_ok();
+    }, d.name);
+}
+
+void gui_host_fleet_tune::stage_start(int idx) {
+    device& d = devices_[idx];
+    std::string name = d.name;
+    std::shared_ptr<settings> run = run_;
+
+    // Starting a test. Poll until it stops running, then settle and read.
+    auto test_started = [this, idx]() {
+        devices_[idx].phase_ = phase::poll_s;
+        devices_[idx].error_checked = false;
+        devices_[idx].t_next = clock::now() + std::chrono::milliseconds(poll_ms);
+    };
+
+    switch (d.stage_) {
+        case stage::ready_s:
+            submit(idx, "ready", [this, name](param_job& job) {
+                PARAM_NOTIFY_ERROR( host_->write_bool(name, "host_sentry_active", false), name + ": Parameter failed: host_sentry_active" )
+                PARAM_NOTIFY_ERROR( host_->write_command(name, "start"), name + ": Parameter failed: start" )
+                return jcs::RET_OK;
+            }, [this, idx]() {
+                devices_[idx].phase_ = phase::settle_s;
+                devices_[idx].t_next = clock::now() + std::chrono::milliseconds(ready_settle_ms);
+            });
+            break;
+        case stage::rs_s:
+            submit(idx, "Rs start", [this, name, run](param_job& job) {
+                return run->test_r.start(host_, name);
+            }, test_started);
+            break;
+        case stage::ld_s:
+            submit(idx, "Ld start", [this, name, run](param_job& job) {
+                return run->test_l[0].start(host_, name);
+            }, test_started);
+            break;
+        case stage::lq_s:
+            if (run->lq_equals_ld) {
+                float lq = d.ld;
+                submit(idx, "Lq write", [this, name, lq](param_job& job) {
+                    PARAM_NOTIFY_ERROR( host_->write_float(name, "motor_Lq", lq), name + ": Parameter failed: motor_Lq" )
+                    return jcs::RET_OK;
+                }, [this, idx]() {
+                    devices_[idx].lq = devices_[idx].ld;
+                    stage_next(idx);
+                });
+            } else {
+                submit(idx, "Lq start", [this, name, run](param_job& job) {
+                    return run->test_l[1].start(host_, name);
+                }, test_started);
+            }
+            break;
+        case stage::gains_s:
+        {
+            float bw_rads = run->i_ctl_bw_hz * 2.0f * (float)M_PI;
+            d.gains[0] = compute_controller_gains(bw_rads, d.rs, d.ld);
+            d.gains[1] = compute_controller_gains(bw_rads, d.rs, d.lq);
+            if (!run->write_gains) {
+                stage_next(idx);
+                break;
+            }
+            std::array<controller_gains, 2> gains = d.gains;
+            submit(idx, "gains write", [this, name, gains](param_job& job) {
+                PARAM_NOTIFY_ERROR( host_->write_float(name, "i_d_kp", gains[0].kp), name + ": Parameter failed: i_d_kp" )
+                PARAM_NOTIFY_ERROR( host_->write_float(name, "i_d_ki", gains[0].ki), name + ": Parameter failed: i_d_ki" )
+                PARAM_NOTIFY_ERROR( host_->write_float(name, "i_q_kp", gains[1].kp), name + ": Parameter failed: i_q_kp" )
+                PARAM_NOTIFY_ERROR( host_->write_float(name, "i_q_ki", gains[1].ki), name + ": Parameter failed: i_q_ki" )
+                return jcs::RET_OK;
+            }, [this, idx]() {
+                stage_next(idx);
+            });
+            break;
+        }
+        case stage::step_s:
+            if (!run->run_step) {
+                stage_next(idx);
+                break;
+            }
+            submit(idx, "step response start", [this, name, run](param_job& job) {
+                return run->test_step.start(host_, name);
+            }, [this, idx, run]() {
+                devices_[idx].phase_ = phase::settle_s;
+                devices_[idx].t_next = clock::now() + std::chrono::milliseconds(run->test_step.run_time_ms());
+            });
+            break;
+        default:
+            break;
+    }
+}
+
+void gui_host_fleet_tune::poll_submit(int idx) {
+    device& d = devices_[idx];
+    std::string name = d.name;
+    bool check_error = !d.error_checked;
+    std::shared_ptr<std::array<bool, 2>> flags = std::make_shared<std::array<bool, 2>>();
+    // [0] = error, [1] = running
+    flags->at(0) = false;
+    flags->at(1) = true;
+    submit(idx, "poll", [this, name, check_error, flags](param_job& job) {
+        if (check_error) {
+            PARAM_NOTIFY_ERROR( host_->read_bool(name, "controller_is_error", &flags->at(0)), name + ": Parameter failed: controller_is_error" )
+            if (flags->at(0)) {
+                return jcs::RET_OK;
+            }
+        }
+        PARAM_NOTIFY_ERROR( host_->read_bool(name, "controller_is_running", &flags->at(1)), name + ": Parameter failed: controller_is_running" )
+        return jcs::RET_OK;
+    }, [this, idx, flags]() {
+        device& d = devices_[idx];
+        if (flags->at(0)) {
+            std::cout << "ERROR: " << d.name << ": controller_start failed to start the test. Check that motor controller is ready to go.\n";
+            fail(idx, "Test did not start");
+            return;
+        }
+        d.error_checked = true;
+        if (flags->at(1)) {
+            d.t_next = clock::now() + std::chrono::milliseconds(poll_ms);
+        } else {
+            d.phase_ = phase::settle_s;
+            d.t_next = clock::now() + std::chrono::milliseconds(test_settle_ms);
+        }
+    });
+}
+
+void gui_host_fleet_tune::stage_read(int idx) {
+    device& d = devices_[idx];
+    std::string name = d.name;
+    std::shared_ptr<settings> run = run_;
+    d.phase_ = phase::read_s;
+
+    switch (d.stage_) {
+        case stage::ready_s:
+        {
+            std::shared_ptr<bool> clamped = std::make_shared<bool>(false);
+            submit(idx, "temperature check", [this, name, clamped](param_job& job) {
+                PARAM_NOTIFY_ERROR( host_->read_bool(name, "temperature_penalty_ctrl_is_clamped", clamped.get()), name + ": Parameter failed: temperature_penalty_ctrl_is_clamped" )
+                return jcs::RET_OK;
+            }, [this, idx, clamped]() {
+                if (*clamped) {
+                    std::cout << "ERROR: " << devices_[idx].name << ": Device control is temperature clamped. Cannot continue with test.\n";
+                    fail(idx, "Temperature clamped");
+                    return;
+                }
+                stage_next(idx);
+            });
+            break;
+        }
+        case stage::rs_s:
+        case stage::ld_s:
+        case stage::lq_s:
+        {
+            stage s = d.stage_;
+            std::shared_ptr<float> value = std::make_shared<float>(0.0f);
+            submit(idx, std::string(stage_name((int)s)) + " read", [this, name, run, s, value](param_job& job) {
+                if (s == stage::rs_s) {
+                    return run->test_r.result_read(host_, name, value.get());
+                }
+                return run->test_l[(s == stage::ld_s) ? 0 : 1].result_read(host_, name, value.get());
+            }, [this, idx, s, value]() {
+                device& d = devices_[idx];
+                if (s == stage::rs_s) {
+                    d.rs = *value;
+                } else if (s == stage::ld_s) {
+                    d.ld = *value;
+                } else {
+                    d.lq = *value;
+                }
+                stage_next(idx);
+            });
+            break;
+        }
+        case stage::step_s:
+        {
+            std::shared_ptr<std::vector<float>> trace = std::make_shared<std::vector<float>>();
+            submit(idx, "step response read", [this, name, run, trace](param_job& job) {
+                return run->test_step.data_read(host_, name, trace.get());
+            }, [this, idx, trace]() {
+                devices_[idx].step.swap(*trace);
+                stage_next(idx);
+            });
+            break;
+        }
+        default:
+            stage_next(idx);
+            break;
+    }
+}
+
+void gui_host_fleet_tune::stage_next(int idx) {
+    device& d = devices_[idx];
+    d.stage_ = (stage)((int)d.stage_ + 1);
+    d.phase_ = phase::start_s;
+    if (d.stage_ == stage::done_s) {
+        d.duration_s = std::chrono::duration<double>(clock::now() - d.t_start).count();
+    }
+}
+
+void gui_host_fleet_tune::fail(int idx, std::string const& error) {
+    device& d = devices_[idx];
+    if (d.stage_ == stage::failed_s) {
+        return;
+    }
+    d.failed_at = d.stage_;
+    d.stage_ = stage::failed_s;
+    d.error = error;
+    d.duration_s = std::chrono::duration<double>(clock::now() - d.t_start).count();
+
+    // A test may have been left running. Queued behind any job still on the device's lane.
+    std::string name = d.name;
+    d.stop_job = gui_if_->get_param_worker()->submit("Fleet tuning stop " + name, [this, name](param_job& job) {
+        PARAM_NOTIFY_ERROR( host_->write_command(name, "controller_stop"), name + ": Parameter failed: controller_stop" )
+        return jcs::RET_OK;
+    }, nullptr, name);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Report
+
+std::string gui_host_fleet_tune::report(bool traces) {
+    std::string s = "";
+    s += "######################################################################## \n";
+    s += "# Fleet tuning\n";
+    s += "# Current controller bandwidth Hz   : " + std::to_string(run_->i_ctl_bw_hz) + "\n";
+    s += "# Current controller bandwidth Rad/s: " + std::to_string(run_->i_ctl_bw_hz * 2.0f * (float)M_PI) + "\n";
+    s += "# Lq = Ld: " + std::string(run_->lq_equals_ld ? "true" : "false") + ", gains written: " + std::string(run_->write_gains ? "true" : "false") + "\n";
+    s += "######################################################################## \n";
+
+    for (int i=0; i<devices_.size(); i++) {
+        device const& d = devices_[i];
+        if (!d.selected) {
+            continue;
+        }
+        // Stages before this one completed
+        stage reached = (d.stage_ == stage::failed_s) ? d.failed_at : d.stage_;
+
+        s += "\n";
+        s += d.name + ":\n";
+        if (d.stage_ == stage::failed_s) {
+            s += "  # FAILED in " + std::string(stage_name((int)d.failed_at)) + ": " + d.error + "\n";
+        }
+        if (reached > stage::rs_s) {
+            s += "  motor_Rs: " + std::to_string(d.rs) + "\n";
+        }
+        if (reached > stage::ld_s) {
+            s += "  motor_Ld: " + helpers::to_string_with_dp(d.ld, 8) + "\n";
+        }
+        if (reached > stage::lq_s) {
+            s += "  motor_Lq: " + helpers::to_string_with_dp(d.lq, 8) + "\n";
+        }
+        if (reached > stage::gains_s) {
+            s += "  # D-Axis gains\n";
+            s += "  i_d_kp: " + std::to_string(d.gains[0].kp) + "\n";
+            s += "  i_d_ki: " + std::to_string(d.gains[0].ki) + "\n";
+            s += "  # Q-Axis gains\n";
+            s += "  i_q_kp: " + std::to_string(d.gains[1].kp) + "\n";
+            s += "  i_q_ki: " + std::to_string(d.gains[1].ki) + "\n";
+        }
+        if (traces && !d.step.empty()) {
+            s += "  step_response:\n";
+            s += "    axis: " + mc_test_step_response::axis_names[run_->test_step.axis_index] + "\n";
+            s += "    mode: " + mc_test_step_response::mode_names[run_->test_step.mode_index] + "\n";
+            s += "    amplitude: " + std::to_string(run_->test_step.amplitude) + "\n";
+            s += "    sample_rate_hz: " + std::to_string(mc_test_step_response::sample_rate_hz) + "\n";
+            std::string data_key = "    data: [ ";
+            std::string pre_space(data_key.size(), ' ');
+            s += data_key;
+            for (int j=0; j<d.step.size(); j++) {
+                s += std::to_string(d.step[j]);
+                if (j == d.step.size() - 1) {
+                    s += " ]\n";
+                } else if ((j+1) % 16 == 0) {
+                    s += ",\n" + pre_space;
+                } else {
+                    s += ", ";
+                }
+            }
+        }
+    }
+    return s;
+}
+
+int gui_host_fleet_tune::report_write(std::string const& file_path) {
+    std::string path_and_file = file_path + "/fleet_tuning_report.yaml";
+    std::cout << "Writing to: " << path_and_file << "\n";
+
+    std::ofstream report_file(path_and_file);
+    if (!report_file.is_open()) {
+        std::cout << "ERROR: Failed to open " << path_and_file << "\n";
+        return jcs::RET_ERROR;
+    }
+    report_file << report_file_;
+    return jcs::RET_OK;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Render
+
+int gui_host_fleet_tune::render() {
+    if (devices_.empty()) {
+        ImGui::Text("No motor controllers in the network");
+        return jcs::RET_OK;
+    }
+    ImGui::Text("Measure resistance and inductance, compute current controller gains and run a step response on several motor controllers at once");
+    ImGui::Text("Notes:");
+    ImGui::Text("- Ensure cogging compensation is disabled on every device.");
+    ImGui::Text("- Each test uses the Tuning tab parameters below, the same for all devices.");
+    ImGui::Separator();
+    // Stays disabled after a cancel until the queued jobs have drained
+    bool busy_now = busy();
+    {
+        ImGuiDisabled ui_disabled(busy_now);
+        render_devices();
+        ImGui::Separator();
+        render_settings();
+    }
+    ImGui::Separator();
+
+    int n_selected = 0;
+    for (int i=0; i<devices_.size(); i++) {
+        if (devices_[i].selected) {
+            n_selected++;
+        }
+    }
+    {
+        ImGuiDisabled ui_disabled(busy_now || n_selected == 0);
+        if (ImGui::Button("Run on selected devices")) {
+            run_start();
+        }
+    }
+    if (running_) {
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel")) {
+            run_cancel();
+        }
+    }
+    render_results();
+    return jcs::RET_OK;
+}
+
+void gui_host_fleet_tune::render_devices() {
+    ImGui::Text("Motor controllers");
+    ImGui::SameLine();
+    if (ImGui::Button("Select All")) {
+        for (int i=0; i<devices_.size(); i++) {
+            devices_[i].selected = true;
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Select None")) {
+        for (int i=0; i<devices_.size(); i++) {
+            devices_[i].selected = false;
+        }
+    }
+    for (int i=0; i<devices_.size(); i++) {
+        ImGui::Checkbox(devices_[i].name.c_str(), &devices_[i].selected);
+        if ((i + 1) % 8 != 0 && i != devices_.size() - 1) {
+            ImGui::SameLine();
+        }
+    }
+}
+
+void gui_host_fleet_tune::render_settings() {
+    settings_.test_r.render_ui(false);
+    settings_.test_l[0].render_ui(false);
+
+    ImGui::Separator();
+    ImGui::Checkbox("Lq = Ld", &settings_.lq_equals_ld);
+    if (!settings_.lq_equals_ld) {
+        settings_.test_l[1].render_ui(false);
+    }
+
+    ImGui::Separator();
+    {
+        float value = settings_.i_ctl_bw_hz;
+        if (ImGui::InputFloat("Current controller bandwidth (Hz)", &value, 0.1f, 1.0f, "%.6f", ImGuiInputTextFlags_EscapeClearsAll)) {
+            settings_.i_ctl_bw_hz = value;
+        }
+    }
+    ImGui::Checkbox("Write current controller gains", &settings_.write_gains);
+
+    ImGui::Separator();
+    ImGui::Checkbox("Run step response test", &settings_.run_step);
+    if (settings_.run_step) {
+        settings_.test_step.render_ui();
+    }
+}
+
+void gui_host_fleet_tune::render_results() {
+    static ImGuiTableFlags table_flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_NoSavedSettings;
+    if (ImGui::BeginTable("Devices", 8, table_flags)) {
+        ImGui::TableSetupColumn("Device");
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("Rs (Ohm)");
+        ImGui::TableSetupColumn("Ld (uH)");
+        ImGui::TableSetupColumn("Lq (uH)");
+        ImGui::TableSetupColumn("Kp d/q");
+        ImGui::TableSetupColumn("Time (s)");
+        ImGui::TableSetupColumn("Error");
+        ImGui::TableHeadersRow();
+        clock::time_point now = clock::now();
+        for (int i=0; i<devices_.size(); i++) {
+            device const& d = devices_[i];
+            if (!d.selected) {
+                continue;
+            }
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", d.name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            bool in_progress = running_ && d.stage_ != stage::done_s && d.stage_ != stage::failed_s;
+            if (in_progress) {
+                static char const* phase_names[] = { "starting", "running", "settling", "reading" };
+                ImGui::Text("%s %s", stage_name((int)d.stage_), phase_names[(int)d.phase_]);
+            } else {
+                ImGui::Text("%s", stage_name((int)d.stage_));
+            }
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.6f", d.rs);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.3f", d.ld * 1000000.0f);
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.3f", d.lq * 1000000.0f);
+            ImGui::TableSetColumnIndex(5);
+            ImGui::Text("%.4f / %.4f", d.gains[0].kp, d.gains[1].kp);
+            ImGui::TableSetColumnIndex(6);
+            double t = in_progress ? std::chrono::duration<double>(now - d.t_start).count() : d.duration_s;
+            ImGui::Text("%.1f", t);
+            ImGui::TableSetColumnIndex(7);
+            ImGui::Text("%s", d.error.c_str());
+        }
+        ImGui::EndTable();
+    }
+
+    if (running_ || report_text_.empty()) {
+        return;
+    }
+    ImGui::Text("Run time: %.1f s wall, %.1f s summed over devices", run_wall_s_, run_sum_s_);
+    helpers::result_text_copyable(report_text_);
+
+    if (ImGui::Button("Write report to file")) {
+        IGFD::FileDialogConfig config;
+        config.path = ".";
+        ImGuiFileDialog::Instance()->OpenDialog("fleet_tune_dir_key", "Choose Directory", nullptr, config);
+    }
+    if (ImGuiFileDialog::Instance()->Display("fleet_tune_dir_key"))  {
+        if (ImGuiFileDialog::Instance()->IsOk()) {
+            report_write(ImGuiFileDialog::Instance()->GetCurrentPath());
+        }
+        ImGuiFileDialog::Instance()->Close();
+    }
+
+    bool have_traces = false;
+    for (int i=0; i<devices_.size(); i++) {
+        if (devices_[i].selected && !devices_[i].step.empty()) {
+            have_traces = true;
+        }
+    }
+    if (!have_traces) {
+        return;
+    }
+    if (ImPlot::BeginPlot("Step responses")) {
+        ImPlot::SetupAxes("t (s)", "y");
+        double dt = 1.0 / (double)mc_test_step_response::sample_rate_hz;
+        for (int i=0; i<devices_.size(); i++) {
+            device const& d = devices_[i];
+            if (!d.selected || d.step.empty()) {
+                continue;
+            }
+            ImPlot::PlotLine(d.name.c_str(), &d.step[0], d.step.size(), dt, 0.0);
+        }
+        ImPlot::EndPlot();
+    }
+}
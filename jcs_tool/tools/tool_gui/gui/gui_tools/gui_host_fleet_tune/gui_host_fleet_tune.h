@@ -0,0 +1,130 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef GUI_HOST_FLEET_TUNE_H_
+#define GUI_HOST_FLEET_TUNE_H_
+
+#include "jcs_host.h"
+#include "gui_type_base.h"
+#include "gui_interface.h"
+#include "gui_device_host_base.h"
+#include "gui_mc_tune.h"
+#include "mc_test_step_response.h"
+#include "param_worker.h"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runs the Tuning tab tests (R, Ld, Lq, current controller gains, step response) on several
+// motor controllers at once.
+// Every device steps through the tests on its own. A test is split into short mailbox
+// transactions (start, poll, read) on the device's parameter worker lane, and the waits in
+// between are timed on the GUI thread, so no worker thread sleeps and all devices run
+// together whatever the worker thread count. Results are collected into one report.
+class gui_host_fleet_tune : public gui_type_base, public gui_device_host_base {
+public:
+    gui_host_fleet_tune(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device);
+    ~gui_host_fleet_tune() {}
+
+    int startup();
+    int step_rt();
+    int step_rt_always();
+    int render();
+    int step_gui();
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    // Settings, shared by every device
+    struct settings {
+        test_resistance test_r;
+        // [0] = Ld, [1] = Lq
+        std::array<test_inductance, 2> test_l;
+        bool lq_equals_ld;
+        float i_ctl_bw_hz;
+        bool write_gains;
+        bool run_step;
+        mc_test_step_response test_step;
+        settings();
+    };
+    // Edited in the UI. Not editable until every job of a run has finished.
+    settings settings_;
+    // Copy taken when a run starts and not written after. Each job holds a reference,
+    // so edits made once the run is over never reach a job still queued.
+    std::shared_ptr<settings> run_;
+
+    enum class stage {
+        ready_s,
+        rs_s,
+        ld_s,
+        lq_s,
+        gains_s,
+        step_s,
+        done_s,
+        failed_s
+    };
+    enum class phase {
+        start_s,
+        poll_s,
+        settle_s,
+        read_s
+    };
+    struct device {
+        std::string name;
+        bool selected;
+
+        stage stage_;
+        phase phase_;
+        stage failed_at;
+        param_job_ptr job;
+        param_job_ptr stop_job;         // controller_stop after a failure
+        clock::time_point t_next;       // Next poll, or end of settling
+        bool error_checked;
+        std::string error;
+        clock::time_point t_start;
+        double duration_s;
+
+        // Results
+        float rs;
+        float ld;
+        float lq;
+        std::array<controller_gains, 2> gains;
+        std::vector<float> step;
+    };
+    std::vector<device> devices_;
+
+    bool running_;
+    clock::time_point t_run_start_;
+    double run_wall_s_;
+    double run_sum_s_;
+    // Built when a run finishes. The copyable text leaves out the step traces.
+    std::string report_text_;
+    std::string report_file_;
+
+    void run_start();
+    void run_cancel();
+    bool run_done();
+    // Running, or jobs of the last run still queued
+    bool busy();
+
+    // GUI thread, every frame
+    void device_step(int idx);
+    void stage_start(int idx);
+    void stage_read(int idx);
+    void stage_next(int idx);
+    void poll_submit(int idx);
+    void fail(int idx, std::string const& error);
+    void submit(int idx, std::string const& name, std::function<int(param_job&)> fn, std::function<void()> on_ok);
+
+    std::string report(bool traces);
+    int report_write(std::string const& file_path);
+
+    void render_settings();
+    void render_devices();
+    void render_results();
+};
+
+#endif
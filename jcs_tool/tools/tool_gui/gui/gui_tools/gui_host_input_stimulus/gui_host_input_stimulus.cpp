@@ -4,10 +4,14 @@
 #include "gui_host_input_stimulus.h"
 #include "jcs_user_external.h"
 #include "helpers.h"
+#include "imgui_helpers.h"
+#include "ImGuiFileDialog.h"
 
 gui_host_input_stimulus::gui_host_input_stimulus(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
     gui_type_base("Input stimulus", host, gui_if, target_device),
-    state_(state::off_s)
+    state_(state::off_s),
+    trajectory_active_(false),
+    trajectory_running_(false)
 {
     channels_.resize(6);
 }
@@ -16,9 +20,16 @@ int gui_host_input_stimulus::startup() {
     state_ = state::off_s;
     // Build the channels first
     for (int i=0; i<channels_.size(); i++) {
-        channels_[i] = new channel(static_cast<double>(host_->base_frequency_get()));
+        channels_[i] = new channel(static_cast<double>(host_->base_frequency_get()), gui_if_->get_param_worker());
     }
     f32_isignal_store_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+
+    trajectory_input_names_.clear();
+    trajectory_input_names_.push_back("None");
+    std::vector<std::string>* names = gui_if_->get_f32_input_signal_names();
+    for (int i=0; i<names->size(); i++) {
+        trajectory_input_names_.push_back((*names)[i]);
+    }
     return jcs::RET_OK;
 }
 
@@ -35,6 +46,20 @@ int gui_host_input_stimulus::step_rt_always() {
         case state::running_s:
             {
                 bool all_done = true;
+                if (trajectory_running_) {
+                    float const* frame;
+                    if (trajectory_.frame_next_rt(&frame)) {
+                        all_done = false;
+                    } else {
+                        trajectory_running_ = false;
+                    }
+                    for (int i=0; i<trajectory_map_.size(); i++) {
+                        if (trajectory_map_[i] > 0) {
+                            f32_isignal_store_[trajectory_map_[i] - 1] = frame[i];
+                            gui_if_->f32_input_signal_set_rt(trajectory_map_[i] - 1, frame[i]);
+                        }
+                    }
+                }
                 for (int i=0; i<channels_.size(); i++) {
                     if (channels_[i]->is_active_) {
                         if (channels_[i]->input_stimulus_->is_running()) {
@@ -42,13 +67,13 @@ int gui_host_input_stimulus::step_rt_always() {
                         }
                         channels_[i]->input_stimulus_->step_rt();
                         f32_isignal_store_[channels_[i]->input_combo_idx_] = channels_[i]->input_stimulus_->value_get();
+                        gui_if_->f32_input_signal_set_rt(channels_[i]->input_combo_idx_, f32_isignal_store_[channels_[i]->input_combo_idx_]);
                     }
                 }
                 if (all_done) {
                     state_ = state::off_s;
                 }
             }
-            host_->sig_input_set_rt(0, f32_isignal_store_);
             break;
     }
     return jcs::RET_OK;
@@ -57,12 +82,30 @@ int gui_host_input_stimulus::step_rt_always() {
 int gui_host_input_stimulus::render() {
     ImGui::Text("Select input stimuli");
     ImGui::Text("Notes:");
-    ImGui::Text("- Ensure Signal Plot -> Input signals active is unticked ");
+    ImGui::Text("- Stimulated inputs override the Signal Plot input sliders while running");
 
     ImGui::Separator();
     ImGui::Text("When stimuli configured, click start");
 
-    if (ImGui::Button("Stimulus start")) {
+    bool tables_ready = true;
+    for (int i=0; i<channels_.size(); i++) {
+        if (channels_[i]->is_active_ && !channels_[i]->input_stimulus_->table_ready()) {
+            tables_ready = false;
+        }
+    }
+    bool start;
+    {
+        ImGuiDisabled rendering(!tables_ready);
+        start = ImGui::Button("Stimulus start");
+    }
+    if (start && state_ == state::off_s) {
+        trajectory_running_ = false;
+        if (trajectory_active_ && trajectory_.is_open()) {
+            // Both buffers are filled before the RT thread sees the trajectory
+            if (trajectory_.play_start() == jcs::RET_OK) {
+                trajectory_running_ = true;
+            }
+        }
         for (int i=0; i<channels_.size(); i++) {
             if (channels_[i]->is_active_) {
                 channels_[i]->input_stimulus_->start();
@@ -76,6 +119,11 @@ int gui_host_input_stimulus::render() {
             channels_[i]->input_stimulus_->stop();
         }
         state_ = state::off_s;
+        trajectory_running_ = false;
+    }
+    if (state_ == state::off_s) {
+        // RT side no longer reads the trajectory
+        trajectory_.play_stop();
     }
     ImGui::Separator();
     ImGui::Text("Status: ");
@@ -90,6 +138,8 @@ int gui_host_input_stimulus::render() {
             break;
     }
 
+    trajectory_render();
+
     for (int i=0; i<channels_.size(); i++) {
         ImGui::Separator();
         ImGui::Text("Stimulus channel %u", i);
@@ -108,8 +158,74 @@ int gui_host_input_stimulus::render() {
     return jcs::RET_OK;
 }
 
-gui_host_input_stimulus::channel::channel(double base_freq_hz) {
-    input_stimulus_ = new gui_stimulus(base_freq_hz);
+void gui_host_input_stimulus::trajectory_load(std::string const& path_and_file) {
+    trajectory_map_.clear();
+    if (trajectory_.open(path_and_file) != jcs::RET_OK) {
+        return;
+    }
+    // Map file channels to input signals of the same name
+    std::vector<std::string> const& names = trajectory_.channel_names();
+    trajectory_map_.resize(names.size(), 0);
+    for (int i=0; i<names.size(); i++) {
+        for (int j=1; j<trajectory_input_names_.size(); j++) {
+            if (!names[i].empty() && names[i] == trajectory_input_names_[j]) {
+                trajectory_map_[i] = j;
+                break;
+            }
+        }
+    }
+}
+
+void gui_host_input_stimulus::trajectory_render() {
+    ImGui::Separator();
+    ImGui::Text("Trajectory file");
+    ImGui::SameLine();
+    if (trajectory_running_) {
+        ImGui::TextColored(ImVec4(0.5f, 0.0f, 0.0f, 1.0f), "Running");
+    } else {
+        ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.0f, 1.0f), "Off");
+    }
+
+    ImGuiDisabled running(state_ != state::off_s);
+
+    ImGui::Checkbox("Active##trajectory", &trajectory_active_);
+    ImGui::SameLine();
+    if (ImGui::Button("Load trajectory")) {
+        IGFD::FileDialogConfig config;
+        config.path = ".";
+        ImGuiFileDialog::Instance()->OpenDialog("trajectory_key", "Choose File", ".bin,.traj", config);
+    }
+    if (ImGuiFileDialog::Instance()->Display("trajectory_key")) {
+        if (ImGuiFileDialog::Instance()->IsOk()) {
+            trajectory_load(ImGuiFileDialog::Instance()->GetFilePathName());
+        }
+        ImGuiFileDialog::Instance()->Close();
+    }
+
+    if (!trajectory_.is_open()) {
+        ImGui::Text("No file loaded");
+        return;
+    }
+
+    double base_hz = static_cast<double>(host_->base_frequency_get());
+    ImGui::Text("%d channels, %lld frames, %.1f s", trajectory_.n_channels(), (long long)trajectory_.n_frames(), trajectory_.n_frames() / base_hz);
+    ImGui::Text("Played %lld frames, %llu underruns", (long long)trajectory_.frames_played(), (unsigned long long)trajectory_.underrun_count());
+    if (trajectory_.sample_rate_hz() != host_->base_frequency_get()) {
+        ImGui::TextColored(ImVec4(0.5f, 0.0f, 0.0f, 1.0f), "File rate %u Hz differs from base rate, frames are played one per tick", trajectory_.sample_rate_hz());
+    }
+
+    if (ImGui::TreeNode("Channel map")) {
+        std::vector<std::string> const& names = trajectory_.channel_names();
+        for (int i=0; i<trajectory_map_.size(); i++) {
+            std::string label = (names[i].empty() ? "Channel " + std::to_string(i) : names[i]) + "##trajectory" + std::to_string(i);
+            helpers::combo_select(label, &trajectory_input_names_, &trajectory_map_[i], nullptr);
+        }
+        ImGui::TreePop();
+    }
+}
+
+gui_host_input_stimulus::channel::channel(double base_freq_hz, param_worker* worker) {
+    input_stimulus_ = new gui_stimulus(base_freq_hz, worker);
     input_combo_idx_ = 0;
     is_active_ = false;
 }
\ No newline at end of file
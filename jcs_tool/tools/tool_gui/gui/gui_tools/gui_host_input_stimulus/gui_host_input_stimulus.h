@@ -13,6 +13,7 @@
 #include "imgui.h"
 
 #include "gui_stimulus.h"
+#include "trajectory_stream.h"
 
 class gui_host_input_stimulus : public gui_type_base, public gui_device_host_base {
 public:
@@ -31,16 +32,25 @@ private:
     };
     state state_;
 
+    // Inputs driven by this element, copied to the shared frame while running
     std::vector<float> f32_isignal_store_;
 
     struct channel {
         gui_stimulus* input_stimulus_;
         int input_combo_idx_;
         bool is_active_;
-        channel(double base_freq_hz);
+        channel(double base_freq_hz, param_worker* worker);
     };
     std::vector<channel*> channels_;
 
+    // Trajectory file, played into its mapped inputs before the stimulus channels
+    trajectory_stream trajectory_;
+    bool trajectory_active_;
+    bool trajectory_running_;
+    std::vector<std::string> trajectory_input_names_;  // "None", then the input signals
+    std::vector<int> trajectory_map_;                   // Combo index per file channel
+    void trajectory_load(std::string const& path_and_file);
+    void trajectory_render();
 };
 
 #endif
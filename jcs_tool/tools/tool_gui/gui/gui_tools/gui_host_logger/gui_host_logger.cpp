@@ -13,8 +13,6 @@ int gui_host_logger::startup() {
     if (sampler_.startup((double)jcs::external::time_now_ns()) != jcs::RET_OK) {
         return jcs::RET_ERROR;
     }
-    // Confiugure line storage
-    f32_output_signal_store_.resize(host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
     return jcs::RET_OK;
 }
 
@@ -23,8 +21,12 @@ int gui_host_logger::step_rt() {
 }
 
 int gui_host_logger::step_rt_always() {
-    host_->sig_output_get_rt(0, &f32_output_signal_store_);
-    sampler_.step_rt((double)jcs::external::time_now_ns(), &f32_output_signal_store_);
+    sampler_.step_rt((double)jcs::external::time_now_ns(), gui_if_->get_f32_output_signals());
+    return jcs::RET_OK;
+}
+
+int gui_host_logger::step_gui() {
+    sampler_.step_gui();
     return jcs::RET_OK;
 }
 
@@ -23,10 +23,10 @@ public:
     int step_rt();
     int step_rt_always();
     int render();
+    int step_gui();
 
 private:
     sampler sampler_;
-    std::vector<float> f32_output_signal_store_;
 };
 
 #endif
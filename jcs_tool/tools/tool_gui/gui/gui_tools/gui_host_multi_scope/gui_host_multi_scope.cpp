@@ -0,0 +1,410 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "gui_host_multi_scope.h"
+#include "implot.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include "helpers.h"
+#include "imgui_helpers.h"
+
+#include "jcs_dev_motor_controller.h"
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+gui_host_multi_scope::gui_host_multi_scope(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
+    gui_type_base("Multi Scope", host, gui_if, target_device)
+{
+    sources_         = &jcs::node_parameter::dev_motor_controller::oscilloscope_sources;
+    trigger_configs_ = &jcs::node_parameter::dev_motor_controller::oscilloscope_trigger_config;
+    sample_rate_     = jcs::node_parameter::dev_motor_controller::oscilloscope_sample_rate_hz;
+    sample_length_   = jcs::node_parameter::dev_motor_controller::oscilloscope_sample_length;
+    n_channels_      = jcs::node_parameter::dev_motor_controller::oscilloscope_n_channels;
+
+    trigger_source_combo_idx_ = 0;
+    trigger_source_ = sources_->at(0);
+    trigger_config_combo_idx_ = 0;
+    trigger_config_ = trigger_configs_->at(0);
+    trigger_level_ = 0.0f;
+    trigger_buffer_position_ = 0;
+    channel_source_combo_idx_.resize(n_channels_, 0);
+    channel_source_.resize(n_channels_, sources_->at(0));
+    trigger_timeout_s_ = 5.0f;
+
+    align_ = align_mode::trigger_s;
+
+    n_valid_ = 0;
+    capture_total_s_ = 0.0;
+    download_wall_s_ = 0.0;
+    download_sum_s_ = 0.0;
+    arm_skew_s_ = 0.0;
+}
+
+int gui_host_multi_scope::startup() {
+    std::vector<jcs::jcs_device>* tree = host_->external_info_tree_get();
+    for (int i=0; i<tree->size(); i++) {
+        if (tree->at(i).node_type == "dev_motor_controller") {
+            device d;
+            d.name = tree->at(i).name;
+            d.selected = false;
+            d.valid = false;
+            d.sample_rate = sample_rate_;
+            d.trigger_buffer_position = 0;
+            devices_.push_back(d);
+        }
+    }
+    return jcs::RET_OK;
+}
+
+int gui_host_multi_scope::step_rt() {
+    return jcs::RET_OK;
+}
+
+int gui_host_multi_scope::step_rt_always() {
+    return jcs::RET_OK;
+}
+
+int gui_host_multi_scope::render() {
+    if (devices_.empty()) {
+        ImGui::Text("No motor controllers in the network");
+        return jcs::RET_OK;
+    }
+    {
+        ImGuiDisabled ui_disabled(jobs_active());
+        render_devices();
+        ImGui::Separator();
+        render_settings();
+    }
+    ImGui::Separator();
+    render_summary();
+    ImGui::Separator();
+    render_plot();
+    return jcs::RET_OK;
+}
+
+bool gui_host_multi_scope::jobs_active() {
+    for (int i=0; i<jobs_.size(); i++) {
+        if (jobs_[i]->active()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void gui_host_multi_scope::render_devices() {
+    ImGui::Text("Motor controllers");
+    ImGui::SameLine();
+    if (ImGui::Button("Select All")) {
+        for (int i=0; i<devices_.size(); i++) {
+            devices_[i].selected = true;
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Select None")) {
+        for (int i=0; i<devices_.size(); i++) {
+            devices_[i].selected = false;
+        }
+    }
+    for (int i=0; i<devices_.size(); i++) {
+        ImGui::Checkbox(devices_[i].name.c_str(), &devices_[i].selected);
+        if ((i + 1) % 8 != 0 && i != devices_.size() - 1) {
+            ImGui::SameLine();
+        }
+    }
+}
+
+void gui_host_multi_scope::render_settings() {
+    ImGuiInputTextFlags input_text_flags = ImGuiInputTextFlags_EscapeClearsAll;
+    ImGui::PushItemWidth(300.0f);
+    {
+        int sample_temp = sample_rate_;
+        if (ImGui::InputInt("Sample Rate", &sample_temp, 1, 100, input_text_flags)) {
+            sample_rate_ = std::max(sample_temp, 1);
+        }
+    }
+    ImGui::Text("Sample buffer covers timespan (s): %.4f", (double)sample_length_ / (double)sample_rate_);
+    helpers::combo_select("Trigger Source", sources_, &trigger_source_combo_idx_, &trigger_source_);
+    helpers::combo_select("Trigger Config", trigger_configs_, &trigger_config_combo_idx_, &trigger_config_);
+    {
+        float trigger_temp = trigger_level_;
+        if (ImGui::InputFloat("Trigger Level", &trigger_temp, 0.1f, 1.0f, "%.3f", input_text_flags)) {
+            trigger_level_ = trigger_temp;
+        }
+    }
+    {
+        const unsigned int zero = 0;
+        const unsigned int max_buffer = sample_length_;
+        ImGui::SliderScalar("Trigger buffer position", ImGuiDataType_U32, &trigger_buffer_position_, &zero, &max_buffer);
+    }
+    for (int i=0; i<n_channels_; i++) {
+        helpers::combo_select("Channel " + std::to_string(i) + " Source", sources_, &channel_source_combo_idx_[i], &channel_source_[i]);
+    }
+    ImGui::InputFloat("Trigger timeout (s)", &trigger_timeout_s_, 1.0f, 10.0f, "%.1f", input_text_flags);
+    trigger_timeout_s_ = std::max(trigger_timeout_s_, 0.1f);
+    ImGui::PopItemWidth();
+
+    if (ImGui::Button("Write Settings")) {
+        write_settings();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Capture")) {
+        capture_start();
+    }
+    ImGui::SameLine();
+    ImGui::Text("All devices should trigger on the same event, e.g. the same current step.");
+}
+
+void gui_host_multi_scope::write_settings() {
+    jobs_.clear();
+    // Snapshot the settings, the worker does not touch the GUI copies
+    uint32_t sample_rate = sample_rate_;
+    std::string trigger_source = trigger_source_;
+    std::string trigger_config = trigger_config_;
+    float trigger_level = trigger_level_;
+    uint32_t trigger_buffer_position = trigger_buffer_position_;
+    std::vector<std::string> channel_sources = channel_source_;
+
+    for (int d=0; d<devices_.size(); d++) {
+        if (!devices_[d].selected) {
+            continue;
+        }
+        std::string name = devices_[d].name;
+        jobs_.push_back(gui_if_->get_param_worker()->submit("Multi scope settings " + name, [=](param_job& job) {
+            bool ok = true;
+            PARAM_NOTIFY_ACTION( host_->write_uint32(name, "oscilloscope_sample_rate_hz", sample_rate),    name + ": Parameter failed: oscilloscope_sample_rate_hz", ok = false; )
+            PARAM_NOTIFY_ACTION( host_->write_enum(name,   "oscilloscope_trigger_source", trigger_source), name + ": Parameter failed: oscilloscope_trigger_source", ok = false; )
+            PARAM_NOTIFY_ACTION( host_->write_enum(name,   "oscilloscope_trigger_config", trigger_config), name + ": Parameter failed: oscilloscope_trigger_config", ok = false; )
+            PARAM_NOTIFY_ACTION( host_->write_float(name,  "oscilloscope_trigger_level",  trigger_level),  name + ": Parameter failed: oscilloscope_trigger_level", ok = false; )
+            PARAM_NOTIFY_ACTION( host_->write_uint32(name, "oscilloscope_trigger_buffer_position", trigger_buffer_position), name + ": Parameter failed: oscilloscope_trigger_buffer_position", ok = false; )
+            for (int i=0; i<channel_sources.size(); i++) {
+                PARAM_NOTIFY_ACTION( host_->write_enum(name, "oscilloscope_channel_" + std::to_string(i) + "_source", channel_sources[i]), name + ": Parameter failed: oscilloscope_channel_" + std::to_string(i) + "_source", ok = false; )
+            }
+            return ok ? jcs::RET_OK : jcs::RET_ERROR;
+        }, nullptr, name));
+    }
+}
+
+void gui_host_multi_scope::capture_start() {
+    jobs_.clear();
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    double timeout_s = trigger_timeout_s_;
+    int n_channels = n_channels_;
+
+    std::vector<std::shared_ptr<capture>> captures(devices_.size());
+    for (int d=0; d<devices_.size(); d++) {
+        devices_[d].valid = false;
+        if (!devices_[d].selected) {
+            continue;
+        }
+        devices_[d].sample_rate = sample_rate_;
+        devices_[d].trigger_buffer_position = trigger_buffer_position_;
+        devices_[d].channel_source = channel_source_;
+        captures[d] = std::make_shared<capture>();
+    }
+    n_valid_ = 0;
+
+    // Arm every device first. The worker takes the oldest job whose lane is free, so all
+    // arm jobs are dispatched before any download occupies a thread.
+    for (int d=0; d<devices_.size(); d++) {
+        if (!captures[d]) {
+            continue;
+        }
+        std::string name = devices_[d].name;
+        std::shared_ptr<capture> c = captures[d];
+        jobs_.push_back(gui_if_->get_param_worker()->submit("Multi scope arm " + name, [this, name, c, t0](param_job& job) {
+            double t_before = seconds_since(t0);
+            PARAM_NOTIFY_ERROR( host_->write_command(name, "oscilloscope_wait_trigger"), name + ": Parameter failed: oscilloscope_wait_trigger" )
+            c->t_arm_s = 0.5 * (t_before + seconds_since(t0));
+            c->armed = true;
+            return jcs::RET_OK;
+        }, nullptr, name));
+    }
+
+    // Then wait for the trigger and download, one lane per device
+    for (int d=0; d<devices_.size(); d++) {
+        if (!captures[d]) {
+            continue;
+        }
+        std::string name = devices_[d].name;
+        std::shared_ptr<capture> c = captures[d];
+        jobs_.push_back(gui_if_->get_param_worker()->submit("Multi scope read " + name, [this, name, c, t0, timeout_s, n_channels](param_job& job) {
+            if (!c->armed) {
+                return jcs::RET_ERROR;
+            }
+            job.progress_set(0.0f, "Waiting for trigger");
+            bool is_done = false;
+            int poll_ms = trigger_poll_min_ms;
+            while (true) {
+                if (seconds_since(t0) - c->t_arm_s > timeout_s) {
+                    std::cout << name << ": Oscilloscope trigger timeout\n";
+                    return jcs::RET_ERROR;
+                }
+                PARAM_NOTIFY_ERROR( host_->read_bool(name, "oscilloscope_is_done", &is_done), name + ": Parameter failed: oscilloscope_is_done" )
+                if (is_done) {
+                    break;
+                }
+                // Done time is late by at most one poll interval
+                if (!job.sleep_ms(poll_ms)) {
+                    return jcs::RET_ERROR;
+                }
+                poll_ms = std::min(2 * poll_ms, (int)trigger_poll_max_ms);
+            }
+            c->t_done_s = seconds_since(t0);
+
+            c->data.resize(n_channels);
+            for (int i=0; i<n_channels; i++) {
+                if (job.cancel_requested()) {
+                    return jcs::RET_ERROR;
+                }
+                std::string channel = "oscilloscope_channel_" + std::to_string(i);
+                job.progress_set((float)i / (float)n_channels, channel);
+                PARAM_NOTIFY_ERROR( host_->read_float(name, channel, &c->data[i]), name + ": Parameter failed: " + channel )
+            }
+            c->download_s = seconds_since(t0) - c->t_done_s;
+            return jcs::RET_OK;
+        }, [this, d, c](param_job& job) {
+            if (job.result() == jcs::RET_OK) {
+                devices_[d].result.armed = c->armed;
+                devices_[d].result.t_arm_s = c->t_arm_s;
+                devices_[d].result.t_done_s = c->t_done_s;
+                devices_[d].result.download_s = c->download_s;
+                devices_[d].result.data.swap(c->data);
+                devices_[d].valid = true;
+            }
+            summary_update();
+        }, name));
+    }
+}
+
+void gui_host_multi_scope::summary_update() {
+    n_valid_ = 0;
+    double arm_min = 0.0;
+    double arm_max = 0.0;
+    double done_min = 0.0;
+    double end_max = 0.0;
+    download_sum_s_ = 0.0;
+    for (int d=0; d<devices_.size(); d++) {
+        if (!devices_[d].valid) {
+            continue;
+        }
+        capture const& c = devices_[d].result;
+        double end = c.t_done_s + c.download_s;
+        if (n_valid_ == 0) {
+            arm_min = c.t_arm_s;
+            arm_max = c.t_arm_s;
+            done_min = c.t_done_s;
+            end_max = end;
+        }
+        arm_min = std::min(arm_min, c.t_arm_s);
+        arm_max = std::max(arm_max, c.t_arm_s);
+        done_min = std::min(done_min, c.t_done_s);
+        end_max = std::max(end_max, end);
+        download_sum_s_ += c.download_s;
+        n_valid_++;
+    }
+    capture_total_s_ = end_max;
+    download_wall_s_ = end_max - done_min;
+    arm_skew_s_ = arm_max - arm_min;
+}
+
+void gui_host_multi_scope::render_summary() {
+    int n_jobs_active = 0;
+    for (int i=0; i<jobs_.size(); i++) {
+        if (jobs_[i]->active()) {
+            n_jobs_active++;
+        }
+    }
+    if (n_jobs_active > 0) {
+        std::string text = std::to_string(jobs_.size() - n_jobs_active) + "/" + std::to_string(jobs_.size()) + " transactions";
+        ImGui::ProgressBar((float)(jobs_.size() - n_jobs_active) / (float)jobs_.size(), ImVec2(300.0f, 0.0f), text.c_str());
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel")) {
+            for (int i=0; i<jobs_.size(); i++) {
+                jobs_[i]->cancel();
+            }
+        }
+    }
+
+    if (n_valid_ == 0) {
+        ImGui::Text("No capture");
+        return;
+    }
+    ImGui::Text("Devices: %d, capture: %.1f ms, download: %.1f ms wall, %.1f ms summed over devices, arm skew: %.2f ms",
+        n_valid_, 1e3 * capture_total_s_, 1e3 * download_wall_s_, 1e3 * download_sum_s_, 1e3 * arm_skew_s_);
+
+    ImGui::Text("Align");
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Trigger sample", align_ == align_mode::trigger_s)) {
+        align_ = align_mode::trigger_s;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Arm time (host clock)", align_ == align_mode::arm_time_s)) {
+        align_ = align_mode::arm_time_s;
+    }
+
+    static ImGuiTableFlags table_flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_NoSavedSettings;
+    if (ImGui::BeginTable("Devices", 4, table_flags)) {
+        ImGui::TableSetupColumn("Device");
+        ImGui::TableSetupColumn("Armed (ms)");
+        ImGui::TableSetupColumn("Done (ms)");
+        ImGui::TableSetupColumn("Download (ms)");
+        ImGui::TableHeadersRow();
+        for (int d=0; d<devices_.size(); d++) {
+            if (!devices_[d].valid) {
+                continue;
+            }
+            capture const& c = devices_[d].result;
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", devices_[d].name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.2f", 1e3 * c.t_arm_s);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f", 1e3 * c.t_done_s);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.2f", 1e3 * c.download_s);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void gui_host_multi_scope::render_plot() {
+    if (n_valid_ == 0) {
+        return;
+    }
+    double arm_ref = 0.0;
+    bool have_ref = false;
+    for (int d=0; d<devices_.size(); d++) {
+        if (devices_[d].valid && (!have_ref || devices_[d].result.t_arm_s < arm_ref)) {
+            arm_ref = devices_[d].result.t_arm_s;
+            have_ref = true;
+        }
+    }
+
+    for (int ch=0; ch<n_channels_; ch++) {
+        ImGui::PushID(ch);
+        std::string title = "Channel " + std::to_string(ch);
+        if (ImPlot::BeginPlot(title.c_str())) {
+            ImPlot::SetupAxes("t (s)", "y");
+            for (int d=0; d<devices_.size(); d++) {
+                device const& dev = devices_[d];
+                if (!dev.valid || ch >= dev.result.data.size() || dev.result.data[ch].empty()) {
+                    continue;
+                }
+                double dt = 1.0 / (double)dev.sample_rate;
+                // Trigger sample at t = 0, or first sample at the arm time
+                double x0 = -(double)dev.trigger_buffer_position * dt;
+                if (align_ == align_mode::arm_time_s) {
+                    x0 = dev.result.t_arm_s - arm_ref;
+                }
+                std::string label = dev.name + ": " + dev.channel_source[ch];
+                ImPlot::PlotLine(label.c_str(), &dev.result.data[ch][0], dev.result.data[ch].size(), dt, x0);
+            }
+            ImPlot::EndPlot();
+        }
+        ImGui::PopID();
+    }
+}
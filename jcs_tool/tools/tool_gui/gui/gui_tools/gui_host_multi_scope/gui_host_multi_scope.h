@@ -0,0 +1,99 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef GUI_HOST_MULTI_SCOPE_H_
+#define GUI_HOST_MULTI_SCOPE_H_
+
+#include "jcs_host.h"
+#include "gui_type_base.h"
+#include "gui_interface.h"
+#include "gui_device_host_base.h"
+#include "param_worker.h"
+#include <vector>
+#include <string>
+#include <chrono>
+#include "imgui.h"
+
+// Captures the oscilloscopes of several motor controllers together.
+// Every selected device is armed before any download starts, then each device is polled
+// and downloaded on its own parameter worker lane, so devices download in parallel up to
+// the worker thread count. Traces are aligned on the trigger sample, or on the host time
+// each device was armed.
+class gui_host_multi_scope : public gui_type_base, public gui_device_host_base {
+public:
+    gui_host_multi_scope(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device);
+    ~gui_host_multi_scope() {}
+
+    int startup();
+    int step_rt();
+    int step_rt_always();
+    int render();
+
+private:
+    std::vector<std::string> const* sources_;
+    std::vector<std::string> const* trigger_configs_;
+    int sample_length_;
+    int n_channels_;
+
+    // Settings, written to every selected device
+    int         sample_rate_;
+    int         trigger_source_combo_idx_;
+    std::string trigger_source_;
+    int         trigger_config_combo_idx_;
+    std::string trigger_config_;
+    float       trigger_level_;
+    int         trigger_buffer_position_;
+    std::vector<int>         channel_source_combo_idx_;
+    std::vector<std::string> channel_source_;
+    float       trigger_timeout_s_;
+    // Trigger polling interval, doubles from min to max while waiting
+    static const int trigger_poll_min_ms = 1;
+    static const int trigger_poll_max_ms = 20;
+
+    // Per device capture. Times are seconds from the start of the capture, host clock.
+    struct capture {
+        bool armed;
+        double t_arm_s;
+        double t_done_s;
+        double download_s;
+        std::vector<std::vector<float>> data;
+        capture() : armed(false), t_arm_s(0.0), t_done_s(0.0), download_s(0.0) {}
+    };
+    struct device {
+        std::string name;
+        bool selected;
+        bool valid;
+        capture result;
+        // Settings the result was captured with
+        int sample_rate;
+        int trigger_buffer_position;
+        std::vector<std::string> channel_source;
+    };
+    std::vector<device> devices_;
+
+    std::vector<param_job_ptr> jobs_;
+    bool jobs_active();
+    void write_settings();
+    void capture_start();
+
+    enum class align_mode {
+        trigger_s,
+        arm_time_s
+    };
+    align_mode align_;
+
+    // Last capture summary
+    int    n_valid_;
+    double capture_total_s_;
+    double download_wall_s_;
+    double download_sum_s_;
+    double arm_skew_s_;
+    void summary_update();
+
+    void render_devices();
+    void render_settings();
+    void render_summary();
+    void render_plot();
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include <cmath>
 #include <iostream>
 #include "helpers.h"
+#include "imgui_helpers.h"
 #include "ImGuiFileDialog.h"
 
 gui_host_oscilloscope::gui_host_oscilloscope(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) : 
@@ -18,6 +19,7 @@ gui_host_oscilloscope::gui_host_oscilloscope(jcs::jcs_host* host, gui_interface*
     // Default sample time is 1 sec
     sample_time_ = 1;
     input_stim_combo_idx_ = 0;
+    f32_osignal_ = nullptr;
     trigger_.reset();
     for (int i=0; i<channels_.size(); i++) {
         channels_[i] = new channel("Channel " + std::to_string(i),
@@ -28,8 +30,7 @@ gui_host_oscilloscope::gui_host_oscilloscope(jcs::jcs_host* host, gui_interface*
 }
 
 int gui_host_oscilloscope::startup() {
-    // Resize base rate float storage vector
-    f32_osignal_store_.resize(host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+    f32_osignal_ = gui_if_->get_f32_output_signals();
     f32_isignal_store_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
 
     storage_length_ = sample_time_ * host_->base_frequency_get();
@@ -39,18 +40,22 @@ int gui_host_oscilloscope::startup() {
         channels_[ch]->update_storage_length(sample_time_, host_->base_frequency_get());
     }
 
+    // One second of samples at the base rate. Drained every GUI frame.
+    if (ring_.startup((int)host_->base_frequency_get(), static_cast<int>(channels_.size())) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    frame_rt_.resize(channels_.size(), 0.0f);
+    frame_gui_.resize(channels_.size(), 0.0f);
+
     // Configure input stimulus
-    input_stimulus_ = new gui_stimulus(static_cast<double>(host_->base_frequency_get()));
+    input_stimulus_ = new gui_stimulus(static_cast<double>(host_->base_frequency_get()), gui_if_->get_param_worker());
     input_stim_combo_idx_ = 0;
 
     return jcs::RET_OK;
 }
 
 int gui_host_oscilloscope::step_rt() {
-
     // Only currently supporting base rates
-    host_->sig_output_get_rt(0, &f32_osignal_store_);
-
     switch (sampler_state_) {
         default:
         case sampler_state::off_s:
@@ -71,10 +76,11 @@ int gui_host_oscilloscope::step_rt() {
             // Fall through
         case sampler_state::sampling_s:
             step_rt_sources();
-            // Sampling
+            // Sampling. Channel storage is written in step_gui()
             for (int i=0; i<channels_.size(); i++) {
-                channels_[i]->data_[storage_count_] = f32_osignal_store_[channels_[i]->source_combo_idx_];
+                frame_rt_[i] = (*f32_osignal_)[channels_[i]->source_combo_idx_];
             }
+            ring_.push_rt((double)storage_count_, frame_rt_.data());
 
             storage_count_++;
             if (storage_count_ >= storage_length_) {
@@ -91,7 +97,7 @@ int gui_host_oscilloscope::step_rt() {
                     break;
 
                 case control_type::input_stimulus_s:
-                    host_->sig_input_set_rt(0, f32_isignal_store_);
+                    gui_if_->f32_input_signal_set_rt(input_stim_combo_idx_, f32_isignal_store_[input_stim_combo_idx_]);
                     break;
             }
             break;
@@ -108,6 +114,20 @@ int gui_host_oscilloscope::step_rt_always() {
     return jcs::RET_OK;
 }
 
+int gui_host_oscilloscope::step_gui() {
+    double idx_d;
+    while (ring_.pop(&idx_d, frame_gui_.data())) {
+        int idx = (int)idx_d;
+        for (int i=0; i<channels_.size(); i++) {
+            // Storage may have been resized since the sample was taken
+            if (idx < channels_[i]->data_.size()) {
+                channels_[i]->data_[idx] = frame_gui_[i];
+            }
+        }
+    }
+    return jcs::RET_OK;
+}
+
 int gui_host_oscilloscope::render() {
     render_status();
     ImGui::Separator();
@@ -218,8 +238,11 @@ int gui_host_oscilloscope::render_interface() {
             input_stimulus_->render_parameters();
             helpers::combo_select("Stimulus signal input", gui_if_->get_f32_input_signal_names(), &input_stim_combo_idx_, nullptr);
             trigger_.type = control_type::input_stimulus_s;
-            if (ImGui::Button("Start stimulus")) {
-                sampler_state_ = sampler_state::waiting_trigger_s;
+            {
+                ImGuiDisabled rendering(!input_stimulus_->table_ready());
+                if (ImGui::Button("Start stimulus")) {
+                    sampler_state_ = sampler_state::waiting_trigger_s;
+                }
             }
             ImGui::SameLine();
             if (ImGui::Button("Abort")) {
@@ -354,6 +377,8 @@ int gui_host_oscilloscope::write_channels_to_file() {
 int gui_host_oscilloscope::emit_data(std::string const& path_and_file) {
     std::cout << "Writing to: " << path_and_file << "\n";
 
+    step_gui();
+
     std::ofstream config_file(path_and_file); 
 
     // Write out header
@@ -388,7 +413,7 @@ bool gui_host_oscilloscope::step_rt_has_trigger() {
     switch (trigger_.type) {
         default:
         case control_type::output_signal_trigger_s:
-            if (fabsf(f32_osignal_store_[trigger_.osig_source_combo_idx]) < trigger_.level) {
+            if (fabsf((*f32_osignal_)[trigger_.osig_source_combo_idx]) < trigger_.level) {
                 return true;
             }
             break;
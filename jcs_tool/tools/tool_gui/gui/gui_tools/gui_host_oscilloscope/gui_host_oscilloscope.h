@@ -13,6 +13,7 @@
 #include <array>
 #include "gui_stimulus.h"
 #include "imgui.h"
+#include "sample_ring.h"
 
 class gui_host_oscilloscope : public gui_type_base, public gui_device_host_base {
 public:
@@ -23,6 +24,7 @@ public:
     int step_rt();
     int step_rt_always();
     int render();
+    int step_gui();
 
 private:
     // Sampler
@@ -58,7 +60,14 @@ private:
     };
     std::array<channel*, 8> channels_;
 
-    std::vector<float> f32_osignal_store_;
+    // RT -> GUI samples. Frame time is the storage index.
+    sample_ring ring_;
+    std::vector<float> frame_rt_;
+    std::vector<float> frame_gui_;
+
+    // Shared base rate outputs, see gui_interface
+    std::vector<float> const* f32_osignal_;
+    // Inputs driven by this element
     std::vector<float> f32_isignal_store_;
 
     // Trigger
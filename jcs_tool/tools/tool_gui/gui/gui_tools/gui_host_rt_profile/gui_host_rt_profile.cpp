@@ -0,0 +1,121 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "gui_host_rt_profile.h"
+#include "gui_device_base.h"
+#include "rt_jobs.h"
+#include "tool_gui_settings.h"
+#include "imgui.h"
+#include <vector>
+
+gui_host_rt_profile::gui_host_rt_profile(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
+    gui_type_base("RT profile", host, gui_if, target_device),
+    cycle_time_(1.0),
+    data_exchange_time_(1.0),
+    show_idle_(false)
+{}
+
+int gui_host_rt_profile::startup() {
+    // Calibrate the timestamp counter before the RT thread needs it
+    rt_profile::ns_per_tick();
+    return jcs::RET_OK;
+}
+
+int gui_host_rt_profile::step_rt() {
+    return jcs::RET_OK;
+}
+
+int gui_host_rt_profile::step_rt_always() {
+    jcs::statistics_timing timing = host_->statistics_timing_get();
+    if (timing.total_cycle_time_ns > 0) {
+        cycle_time_.add_rt((uint64_t)timing.total_cycle_time_ns);
+    }
+    if (timing.data_exchange_time_ns > 0) {
+        data_exchange_time_.add_rt((uint64_t)timing.data_exchange_time_ns);
+    }
+    return jcs::RET_OK;
+}
+
+void gui_host_rt_profile::reset_all() {
+    cycle_time_.reset();
+    data_exchange_time_.reset();
+    gui_if_->get_tick_profile()->reset();
+    gui_if_->get_rt_jobs()->reset();
+    std::vector<gui_device_base*> const* devices = gui_if_->get_devices();
+    for (int d=0; d<devices->size(); d++) {
+        std::vector<gui_type_base*> const& e = (*devices)[d]->elements_get();
+        for (int i=0; i<e.size(); i++) {
+            e[i]->rt_cost_step_.reset();
+            e[i]->rt_cost_always_.reset();
+        }
+    }
+}
+
+static void row_render(char const* device, char const* name, char const* call, rt_profile const& profile, bool show_idle) {
+    rt_profile::summary s = profile.summary_get();
+    if (s.count == 0 && !show_idle) {
+        return;
+    }
+    ImGui::TableNextRow();
+    ImGui::TableSetColumnIndex(0);
+    ImGui::TextUnformatted(device);
+    ImGui::TableSetColumnIndex(1);
+    ImGui::TextUnformatted(name);
+    ImGui::TableSetColumnIndex(2);
+    ImGui::TextUnformatted(call);
+    ImGui::TableSetColumnIndex(3);
+    ImGui::Text("%llu", (unsigned long long)s.count);
+    ImGui::TableSetColumnIndex(4);
+    ImGui::Text("%9.3f", s.min_ns/1000.0);
+    ImGui::TableSetColumnIndex(5);
+    ImGui::Text("%9.3f", s.mean_ns/1000.0);
+    ImGui::TableSetColumnIndex(6);
+    ImGui::Text("%9.3f", s.p99_ns/1000.0);
+    ImGui::TableSetColumnIndex(7);
+    ImGui::Text("%9.3f", s.max_ns/1000.0);
+}
+
+int gui_host_rt_profile::render() {
+    static ImGuiTableFlags table_flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_ScrollY;
+
+    if (ImGui::Button("Reset")) {
+        reset_all();
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Show idle", &show_idle_);
+    ImGui::SameLine();
+    ImGui::TextDisabled("p99 is within 19%%, max is exact");
+    ImGui::Text("Ticks over the %d us budget for tests on unselected devices: %llu", tool_gui_settings::rt_jobs_budget_us,
+        (unsigned long long)gui_if_->get_rt_jobs()->overruns_get());
+
+    if (ImGui::BeginTable("RT profile", 8, table_flags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Device",    ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Element",   ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Call",      ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Count",     ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Min (us)",  ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Mean (us)", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("p99 (us)",  ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Max (us)",  ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        char const* host = target_device_.c_str();
+        row_render(host, "Host", "Cycle Time", cycle_time_, true);
+        row_render(host, "Host", "Data Exchange Time", data_exchange_time_, true);
+        row_render(host, "Tool", "Tick, all elements", *gui_if_->get_tick_profile(), true);
+        row_render(host, "Tool", "Tests, unselected devices", gui_if_->get_rt_jobs()->cost_get(), true);
+
+        std::vector<gui_device_base*> const* devices = gui_if_->get_devices();
+        for (int d=0; d<devices->size(); d++) {
+            char const* device = (*devices)[d]->name_get().c_str();
+            std::vector<gui_type_base*> const& e = (*devices)[d]->elements_get();
+            for (int i=0; i<e.size(); i++) {
+                row_render(device, e[i]->type_name_.c_str(), "step_rt_always", e[i]->rt_cost_always_, false);
+                row_render(device, e[i]->type_name_.c_str(), "step_rt", e[i]->rt_cost_step_, show_idle_);
+            }
+        }
+        ImGui::EndTable();
+    }
+    return jcs::RET_OK;
+}
@@ -0,0 +1,35 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef GUI_HOST_RT_PROFILE_H_
+#define GUI_HOST_RT_PROFILE_H_
+
+#include "jcs_host.h"
+#include "gui_type_base.h"
+#include "gui_interface.h"
+#include "gui_device_host_base.h"
+#include "rt_profile.h"
+
+// RT cost of every element's step_rt() and step_rt_always(), next to the host cycle times.
+// Only the selected device's elements and running tests call step_rt(), others show no calls.
+class gui_host_rt_profile : public gui_type_base, public gui_device_host_base {
+public:
+    gui_host_rt_profile(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device);
+    ~gui_host_rt_profile() {}
+
+    int startup();
+    int step_rt();
+    int step_rt_always();
+    int render();
+
+private:
+    void reset_all();
+
+    // From statistics_timing, in ns
+    rt_profile cycle_time_;
+    rt_profile data_exchange_time_;
+
+    bool show_idle_;
+};
+
+#endif
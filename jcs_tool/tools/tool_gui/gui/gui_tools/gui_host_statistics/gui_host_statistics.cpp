@@ -36,6 +36,14 @@ int gui_host_statistics::startup() {
     thread_offset_controller_error_buffer_.update_size(new_buffer_size);
     thread_offset_controller_correction_buffer_.update_size(new_buffer_size);
 
+    // One second of points. Drained every GUI frame.
+    if (ring_.startup((int)host_->base_frequency_get(), frame_size) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    frame_rt_.resize(frame_size, 0.0f);
+    frame_gui_.resize(frame_size, 0.0f);
+
+    t_s_ = 0.0f;
     t_start_ns_ = (double)jcs::external::time_now_ns();
     return jcs::RET_OK;
 }
@@ -45,26 +53,40 @@ int gui_host_statistics::step_rt() {
 }
 
 int gui_host_statistics::step_rt_always() {
-    t_s_ = (float)(((double)jcs::external::time_now_ns() - t_start_ns_)*1e-9);
+    double t_s = ((double)jcs::external::time_now_ns() - t_start_ns_)*1e-9;
     // Get stats
     timing_ = host_->statistics_timing_get();
     health_ = host_->statistics_health_get();
+    transport_ = host_->statistics_transport_get();
 
-    // Populate plots
-    // Note: Not caring about locking or anything here. Just go for gold
-    cycle_buffer_.add_point(t_s_, (float)timing_.total_cycle_time_ns/1000.0f);
-    data_exchange_buffer_.add_point(t_s_, (float)timing_.data_exchange_time_ns/1000.0f);
+    // Publish plot points. Buffers are filled in step_gui()
+    frame_rt_[frame_cycle_us] = (float)timing_.total_cycle_time_ns/1000.0f;
+    frame_rt_[frame_data_exchange_us] = (float)timing_.data_exchange_time_ns/1000.0f;
     // Thread wakup delta
-    thread_timestamp_buffer_.add_point(t_s_, (float)(timing_.start_cycle_time_ns - start_cycle_time_old_ns_)/1000.0f);
+    frame_rt_[frame_wakeup_delta_us] = (float)(timing_.start_cycle_time_ns - start_cycle_time_old_ns_)/1000.0f;
     start_cycle_time_old_ns_ = timing_.start_cycle_time_ns;
 
-    to_mean_buffer_.add_point(t_s_, (float)health_.thread_offset.mean);
+    frame_rt_[frame_thread_offset_mean] = (float)health_.thread_offset.mean;
 
-    transport_ = host_->statistics_transport_get();
     // Thread offset PI controller
-    thread_offset_controller_error_buffer_.add_point(t_s_, (float)transport_.thread_offset_error_ns/1000.0f);
-    thread_offset_controller_correction_buffer_.add_point(t_s_, (float)transport_.thread_offset_correction_ns/1000.0f);
+    frame_rt_[frame_controller_error_us] = (float)transport_.thread_offset_error_ns/1000.0f;
+    frame_rt_[frame_controller_correction_us] = (float)transport_.thread_offset_correction_ns/1000.0f;
 
+    ring_.push_rt(t_s, frame_rt_.data());
+    return jcs::RET_OK;
+}
+
+int gui_host_statistics::step_gui() {
+    double t_s;
+    while (ring_.pop(&t_s, frame_gui_.data())) {
+        t_s_ = (float)t_s;
+        cycle_buffer_.add_point(t_s_, frame_gui_[frame_cycle_us]);
+        data_exchange_buffer_.add_point(t_s_, frame_gui_[frame_data_exchange_us]);
+        thread_timestamp_buffer_.add_point(t_s_, frame_gui_[frame_wakeup_delta_us]);
+        to_mean_buffer_.add_point(t_s_, frame_gui_[frame_thread_offset_mean]);
+        thread_offset_controller_error_buffer_.add_point(t_s_, frame_gui_[frame_controller_error_us]);
+        thread_offset_controller_correction_buffer_.add_point(t_s_, frame_gui_[frame_controller_correction_us]);
+    }
     return jcs::RET_OK;
 }
 
@@ -81,19 +103,19 @@ int gui_host_statistics::render() {
         ImGui::TableSetColumnIndex(0);
         ImGui::Text("Cycle Time (us)");
         ImGui::TableSetColumnIndex(1);
-        ImGui::Text("%7.3f", (float)timing_.total_cycle_time_ns/1000.0f);
+        ImGui::Text("%7.3f", frame_gui_[frame_cycle_us]);
 
         ImGui::TableNextRow();
         ImGui::TableSetColumnIndex(0);
         ImGui::Text("Data Exchange Time (us)");
         ImGui::TableSetColumnIndex(1);
-        ImGui::Text("%7.3f", (float)timing_.data_exchange_time_ns/1000.0f);
+        ImGui::Text("%7.3f", frame_gui_[frame_data_exchange_us]);
 
         ImGui::TableNextRow();
         ImGui::TableSetColumnIndex(0);
         ImGui::Text("Cycle - Data Exchange Time difference (us)");
         ImGui::TableSetColumnIndex(1);
-        ImGui::Text("%7.3f", fabsf((float)(timing_.data_exchange_time_ns-timing_.total_cycle_time_ns)/1000.0f));
+        ImGui::Text("%7.3f", fabsf(frame_gui_[frame_data_exchange_us] - frame_gui_[frame_cycle_us]));
 
         ImGui::EndTable();
     }
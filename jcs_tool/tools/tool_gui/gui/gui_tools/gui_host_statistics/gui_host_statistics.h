@@ -9,6 +9,8 @@
 #include "gui_interface.h"
 #include "gui_device_host_base.h"
 #include "helpers.h"
+#include "sample_ring.h"
+#include <vector>
 
 class gui_host_statistics : public gui_type_base, public gui_device_host_base {
 public:
@@ -19,6 +21,7 @@ public:
     int step_rt();
     int step_rt_always();
     int render();
+    int step_gui();
 
 private:
     // Some nice statistics plots
@@ -35,13 +38,29 @@ private:
     float t_s_;
     double t_start_ns_;
 
+    // RT -> GUI plot points
+    enum frame_idx {
+        frame_cycle_us = 0,
+        frame_data_exchange_us,
+        frame_wakeup_delta_us,
+        frame_thread_offset_mean,
+        frame_controller_error_us,
+        frame_controller_correction_us,
+        frame_size
+    };
+    sample_ring ring_;
+    std::vector<float> frame_rt_;
+    std::vector<float> frame_gui_;
+
     int max_history_s_;
     bool fit_y_;
     bool fit_x_;
 
+    // RT side only
     jcs::statistics_timing timing_{};
-    jcs::statistics_health health_{};
     jcs::statistics_transport transport_{};
+    // Health counters are not plotted. Read by render() as before.
+    jcs::statistics_health health_{};
 };
 
 #endif
\ No newline at end of file
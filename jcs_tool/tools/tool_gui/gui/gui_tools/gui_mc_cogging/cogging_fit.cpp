@@ -0,0 +1,198 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "cogging_fit.h"
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include "jcs_host.h"
+
+#include <Eigen/Dense>
+
+using namespace Eigen;
+
+// ===================================================================
+// Internal helpers
+// ===================================================================
+namespace {
+
+double angle_norm_pipi(double angle) {
+    angle = fmod(angle + M_PI, 2.0 * M_PI);
+    if (angle < 0.0) {
+        angle += 2.0 * M_PI;
+    }
+    return angle - M_PI;
+}
+
+int gcd(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+} // namespace
+
+// ===================================================================
+// Binned map
+// ===================================================================
+void cogging_fit::binned_map::reset(int n_bins) {
+    for (int d=0; d<2; d++) {
+        dir[d].sum_y.assign(n_bins, 0.0);
+        dir[d].sum_dth.assign(n_bins, 0.0);
+        dir[d].n.assign(n_bins, 0);
+    }
+}
+
+void cogging_fit::binned_map::add_rt(direction d, float theta, float y) {
+    int n_bins = dir[d].n.size();
+    if (n_bins == 0) {
+        return;
+    }
+    // Nearest bin centre
+    double pos = angle_norm_pipi(theta) * (double)n_bins / (2.0 * M_PI);
+    int k = (int)lround(pos);
+    double dth = angle_norm_pipi(theta - 2.0 * M_PI * (double)k / (double)n_bins);
+    k %= n_bins;
+    if (k < 0) {
+        k += n_bins;
+    }
+    dir[d].sum_y[k] += y;
+    dir[d].sum_dth[k] += dth;
+    dir[d].n[k]++;
+}
+
+int cogging_fit::binned_map::samples(direction d) const {
+    int n = 0;
+    for (int k=0; k<dir[d].n.size(); k++) {
+        n += dir[d].n[k];
+    }
+    return n;
+}
+
+bool cogging_fit::binned_map::bin_get(direction d, int k, double* theta, double* y) const {
+    int n = dir[d].n[k];
+    if (n == 0) {
+        return false;
+    }
+    *theta = 2.0 * M_PI * (double)k / (double)n_bins() + dir[d].sum_dth[k] / n;
+    *y = dir[d].sum_y[k] / n;
+    return true;
+}
+
+// ===================================================================
+// Fit
+// ===================================================================
+int cogging_fit::cogging_order(settings const& s) {
+    if (s.slots <= 0 || s.poles <= 0) {
+        return 0;
+    }
+    return (s.slots / gcd(s.slots, s.poles)) * s.poles;
+}
+
+std::vector<int> cogging_fit::orders_get(settings const& s, int table_size) {
+    std::vector<int> orders;
+    int base = cogging_order(s);
+    if (base == 0) {
+        base = 1;
+    }
+    for (int i=1; i<=s.low_orders; i++) {
+        orders.push_back(i);
+    }
+    for (int i=1; i<=s.harmonics; i++) {
+        orders.push_back(base * i);
+    }
+    std::sort(orders.begin(), orders.end());
+    orders.erase(std::unique(orders.begin(), orders.end()), orders.end());
+    orders.erase(std::remove_if(orders.begin(), orders.end(), [table_size](int m) { return 2 * m >= table_size; }), orders.end());
+    return orders;
+}
+
+int cogging_fit::fit(binned_map const& map, settings const& s, int table_size, fit_result* result) {
+    *result = fit_result();
+    result->orders = orders_get(s, table_size);
+
+    // Rows, one per non empty bin of each direction
+    std::vector<double> th;
+    std::vector<double> y;
+    std::vector<double> sign;
+    bool has_dir[2] = {false, false};
+    for (int d=0; d<2; d++) {
+        for (int k=0; k<map.n_bins(); k++) {
+            double t, v;
+            if (map.bin_get((direction)d, k, &t, &v)) {
+                th.push_back(t);
+                y.push_back(v);
+                sign.push_back(d == forward ? 1.0 : -1.0);
+                has_dir[d] = true;
+            }
+        }
+    }
+    bool both = has_dir[0] && has_dir[1];
+
+    // Columns: offset, friction (both directions only), cos and sin per order
+    int n_orders = result->orders.size();
+    int c0 = both ? 2 : 1;
+    int cols = c0 + 2 * n_orders;
+    int rows = th.size();
+    result->bins_used = rows;
+    if (rows <= cols) {
+        std::ostringstream ss;
+        ss << "Not enough data, " << rows << " bins for " << cols << " coefficients";
+        result->info = ss.str();
+        return jcs::RET_ERROR;
+    }
+
+    MatrixXd a(rows, cols);
+    VectorXd b(rows);
+    for (int r=0; r<rows; r++) {
+        a(r, 0) = 1.0;
+        if (both) {
+            a(r, 1) = sign[r];
+        }
+        for (int i=0; i<n_orders; i++) {
+            double w = (double)result->orders[i] * th[r];
+            a(r, c0 + 2*i)     = cos(w);
+            a(r, c0 + 2*i + 1) = sin(w);
+        }
+        b(r) = y[r];
+    }
+    ColPivHouseholderQR<MatrixXd> qr(a);
+    if (qr.rank() < cols) {
+        result->info = "Fit is rank deficient, too few bins covered for the orders";
+        return jcs::RET_ERROR;
+    }
+    VectorXd x = qr.solve(b);
+
+    result->offset = x(0);
+    result->friction = both ? x(1) : 0.0;
+    result->a.resize(n_orders);
+    result->b.resize(n_orders);
+    for (int i=0; i<n_orders; i++) {
+        result->a[i] = x(c0 + 2*i);
+        result->b[i] = x(c0 + 2*i + 1);
+    }
+    result->rms_residual = sqrt((a * x - b).squaredNorm() / rows);
+
+    result->table.resize(table_size);
+    for (int k=0; k<table_size; k++) {
+        result->table[k] = evaluate(*result, 2.0 * M_PI * (double)k / (double)table_size);
+    }
+
+    std::ostringstream ss;
+    ss << "Fitted " << n_orders << " orders to " << rows << " bins" << (both ? ", both directions" : ", one direction");
+    result->info = ss.str();
+    result->ok = true;
+    return jcs::RET_OK;
+}
+
+double cogging_fit::evaluate(fit_result const& result, double theta) {
+    double v = 0.0;
+    for (int i=0; i<result.orders.size(); i++) {
+        double w = (double)result.orders[i] * theta;
+        v += result.a[i] * cos(w) + result.b[i] * sin(w);
+    }
+    return v;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+// Cogging map identification.
+// Current samples are binned by rotor position, separately for each sweep direction.
+// A truncated Fourier series in the cogging harmonics is then fitted by least squares
+// to every bin of both directions, with a Coulomb friction term that takes the sign of
+// the direction. Friction and any bias drop out of the fit; the compensator table is
+// the fitted series evaluated on the table grid.
+//
+// Dependencies: Eigen3 (Eigen/Dense)
+//
+#ifndef COGGING_FIT_H_
+#define COGGING_FIT_H_
+
+#include <string>
+#include <vector>
+
+namespace cogging_fit {
+
+    enum direction {
+        forward = 0,
+        reverse = 1
+    };
+
+    // ---------------------------------------------------------------
+    // Position binned current. Bin k is centred on 2*pi*k/bins.
+    // add_rt() does not allocate.
+    // ---------------------------------------------------------------
+    struct binned_map {
+        struct bins {
+            std::vector<double> sum_y;
+            std::vector<double> sum_dth;    // Position offset from the bin centre
+            std::vector<int> n;
+        };
+        bins dir[2];
+
+        void reset(int n_bins);
+        int n_bins() const { return dir[0].n.size(); }
+        void add_rt(direction d, float theta, float y);
+        int samples(direction d) const;
+        // Mean position and value of bin k. Returns false if the bin is empty.
+        bool bin_get(direction d, int k, double* theta, double* y) const;
+    };
+
+    // ---------------------------------------------------------------
+    // Fit
+    // ---------------------------------------------------------------
+    struct settings {
+        int slots;          // Stator slots, 0 for a plain Fourier series
+        int poles;          // Rotor magnet poles, 0 for a plain Fourier series
+        int harmonics;      // Multiples of the cogging order, or orders of the plain series
+        int low_orders;     // Mechanical orders 1..low_orders added, eccentricity and magnet spread
+        settings() : slots(0), poles(0), harmonics(8), low_orders(0) {}
+    };
+
+    struct fit_result {
+        bool ok;
+        std::string info;
+
+        std::vector<int> orders;    // Mechanical orders of the series
+        std::vector<double> a;      // cos coefficient per order
+        std::vector<double> b;      // sin coefficient per order
+        double offset;              // Mean current, removed from the table
+        double friction;            // Half the forward - reverse difference, 0 if one direction
+        double rms_residual;
+        int bins_used;
+
+        std::vector<float> table;   // Series at 2*pi*k/table_size, offset removed
+        fit_result() : ok(false), offset(0.0), friction(0.0), rms_residual(0.0), bins_used(0) {}
+    };
+
+    // Orders fitted for a settings and table size. Orders at or above half the
+    // table size are dropped.
+    std::vector<int> orders_get(settings const& s, int table_size);
+
+    // Cogging order per mechanical revolution, lcm(slots, poles). 0 if not set.
+    int cogging_order(settings const& s);
+
+    int fit(binned_map const& map, settings const& s, int table_size, fit_result* result);
+
+    // Series value at theta, offset and friction excluded
+    double evaluate(fit_result const& result, double theta);
+
+}; // namespace cogging_fit
+
+#endif
@@ -7,15 +7,16 @@
 #include "helpers.h"
 #include "imgui_helpers.h"
 #include <cmath>
-#include <numeric>
+#include <algorithm>
 #include "ImGuiFileDialog.h"
+#include "implot.h"
 
 #include "jcs_dev_motor_controller.h"
 
 //////////////////////////////////////////////////////////////////////
 gui_mc_cogging::gui_mc_cogging(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
     gui_type_base("Cogging Compensation", host, gui_if, target_device),
-    plot_result_("Cogging raw", "th_m_0", "i_q", rotation_steps_),
+    signals_out_(*gui_if->get_f32_output_signals()),
     plot_final_("Cogging final", "th_m_0", "i_q", rotation_steps_),
     plot_vis_("Cogging visualisation", "th_m_0", "i_q", rotation_steps_)
 {
@@ -24,6 +25,17 @@ gui_mc_cogging::gui_mc_cogging(jcs::jcs_host* host, gui_interface* gui_if, std::
     cogging_compensator_upper_w_m_high_ = 200.0f;
     compensated_at_zero_pos_ = 0.0f;
 
+    sweep_mode_names_ = { "Stepped", "Continuous" };
+    sweep_mode_idx_ = (int)sweep_mode::stepped;
+    samples_per_position_ = 20;
+    bidirectional_ = true;
+    sweep_speed_ = 0.5f;
+    sweep_revolutions_ = 2;
+    sweep_lead_in_ = 0.5f;
+    dt_ = 1.0 / 1000.0;
+
+    fit_settings_.harmonics = 128;
+
     fb_th_m_0_idx_= 0;
     fb_w_m_0_idx_ = 1;
     fb_i_q_idx_ = 2;
@@ -38,21 +50,12 @@ gui_mc_cogging::gui_mc_cogging(jcs::jcs_host* host, gui_interface* gui_if, std::
 }
 
 int gui_mc_cogging::startup() {
-    // Get signal sizes
-    unsigned int host_sigs_out_sz = host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0);
-    unsigned int host_sigs_in_sz  = host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0);
-
-    // Per tick signal storage
-    signals_out_.resize(host_sigs_out_sz);
-    signals_in_.resize(host_sigs_in_sz);
-
+    dt_ = 1.0 / static_cast<double>(host_->base_frequency_get());
+    signals_in_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
     return jcs::RET_OK;
 }
 
 int gui_mc_cogging::step_rt() {
-
-    host_->sig_output_get_rt(0, &signals_out_);
-
     switch (state_) {
         default:
         case behaviour::standby_s:
@@ -61,41 +64,95 @@ int gui_mc_cogging::step_rt() {
 
         case behaviour::wait_position_s:
             // Compute the error and normalise to [-pi, pi]
-            theta_error_ = theta_command_ - signals_out_[fb_th_m_0_idx_];
-            theta_error_ = helpers::angle_norm_pipi(theta_error_);
+            theta_error_ = helpers::angle_norm_pipi(theta_command_ - signals_out_[fb_th_m_0_idx_]);
 
             // Wait until position is within threashold, with ideally 0 velocity
             if (fabsf(theta_error_) < theta_threshold_ && fabsf(signals_out_[fb_w_m_0_idx_]) < omega_threshold_) {
-                // Store th_m_0 and i_q directly into plot storage
-                plot_result_.x_[rotation_tick_] = signals_out_[fb_th_m_0_idx_];
-                plot_result_.y_[rotation_tick_] = signals_out_[fb_i_q_idx_];
+                if (sweep_mode_idx_ == (int)sweep_mode::continuous) {
+                    // At the start position, begin turning
+                    sweep_angle_ = 0.0;
+                    state_ = behaviour::sweep_s;
+                } else {
+                    average_count_ = 0;
+                    state_ = behaviour::average_s;
+                }
+            }
+            // Set new rotation
+            signals_in_[cmd_th_m_0_idx_] = helpers::angle_norm_pipi(theta_command_);
+            gui_if_->f32_input_signal_set_rt(cmd_th_m_0_idx_, signals_in_[cmd_th_m_0_idx_]);
+            break;
 
-                // Rotate to next position
+        case behaviour::average_s:
+            map_.add_rt(direction_, signals_out_[fb_th_m_0_idx_], signals_out_[fb_i_q_idx_]);
+            average_count_++;
+            if (average_count_ >= samples_per_position_) {
                 state_ = behaviour::rotate_s;
             }
-            // Set new rotation
-            signals_in_[cmd_th_m_0_idx_] = theta_command_;
-            host_->sig_input_set_rt(0, signals_in_);
+            signals_in_[cmd_th_m_0_idx_] = helpers::angle_norm_pipi(theta_command_);
+            gui_if_->f32_input_signal_set_rt(cmd_th_m_0_idx_, signals_in_[cmd_th_m_0_idx_]);
             break;
 
         case behaviour::rotate_s:
-            // Increment new position
-            theta_command_ = helpers::angle_norm_pipi(((float)rotation_tick_ * 2.0f * (float)M_PI) / (float)rotation_steps_);
-            rotation_tick_++;
-            if (rotation_tick_ > rotation_steps_) {
-                // DONE
-                // state_ = behaviour::standby_s;
-                state_ = behaviour::finish_s;
-                break;
+            positions_done_++;
+            if (direction_ == cogging_fit::forward) {
+                position_idx_++;
+                if (position_idx_ >= rotation_steps_) {
+                    if (!bidirectional_) {
+                        state_ = behaviour::finish_s;
+                        break;
+                    }
+                    // Reverse sweep approaches every position from above, starting one turn on
+                    direction_ = cogging_fit::reverse;
+                    position_idx_ = rotation_steps_;
+                }
+            } else {
+                position_idx_--;
+                if (position_idx_ <= 0) {
+                    state_ = behaviour::finish_s;
+                    break;
+                }
             }
+            theta_command_ = ((double)position_idx_ * 2.0 * M_PI) / (double)rotation_steps_;
             // Go wait for new position
             state_ = behaviour::wait_position_s;
             break;
+
+        case behaviour::sweep_s:
+            {
+                double step = (double)sweep_speed_ * dt_;
+                theta_command_ += (direction_ == cogging_fit::forward) ? step : -step;
+                sweep_angle_ += step;
+                if (sweep_angle_ > sweep_lead_in_) {
+                    map_.add_rt(direction_, signals_out_[fb_th_m_0_idx_], signals_out_[fb_i_q_idx_]);
+                }
+                if (sweep_angle_ >= sweep_lead_in_ + 2.0 * M_PI * sweep_revolutions_) {
+                    if (direction_ == cogging_fit::forward && bidirectional_) {
+                        // Turn back from here, the lead in covers the reversal
+                        direction_ = cogging_fit::reverse;
+                        sweep_angle_ = 0.0;
+                    } else {
+                        state_ = behaviour::finish_s;
+                    }
+                }
+            }
+            signals_in_[cmd_th_m_0_idx_] = helpers::angle_norm_pipi(theta_command_);
+            gui_if_->f32_input_signal_set_rt(cmd_th_m_0_idx_, signals_in_[cmd_th_m_0_idx_]);
+            break;
     }
 
     return jcs::RET_OK;
 }
 
+int gui_mc_cogging::step_gui() {
+    // Here rather than render() so the test finishes with its device unselected
+    if (state_ == behaviour::finish_s) {
+        gui_if_->job_stop(this);
+        compute_outputs();
+        state_ = behaviour::standby_s;
+    }
+    return jcs::RET_OK;
+}
+
 int gui_mc_cogging::render() {
 
     ImGui::Text("Cogging compensator coefficients tool");
@@ -137,6 +194,8 @@ int gui_mc_cogging::render() {
         helpers::combo_select("i_q source",     gui_if_->get_f32_output_signal_names(), &fb_i_q_idx_, NULL);
         helpers::combo_select("th_m_0 command", gui_if_->get_f32_input_signal_names(),  &cmd_th_m_0_idx_, NULL);
 
+        render_settings();
+
         ImGui::Separator();
         ImGui::Text("Starting this test will start JCS system. Ensure it is safe to do so.");
         if (ImGui::Button("Start test")) {
@@ -144,13 +203,14 @@ int gui_mc_cogging::render() {
             default:
             case behaviour::standby_s:
                 initialise();
-                // Start JCS host
-                if (gui_if_->start() != jcs::RET_OK) {
+                // Start JCS host, shared with tests on other devices
+                if (gui_if_->job_start(this, false) != jcs::RET_OK) {
                     state_ = behaviour::standby_s;
                     break;
                 }
                 // Get the zero position at which compensation takes place
                 if (host_->read_float(target_device_, "encoder_0_position_offset", &compensated_at_zero_pos_) != jcs::RET_OK) {
+                    gui_if_->job_stop(this);
                     state_ = behaviour::standby_s;
                     break;
                 }
@@ -158,7 +218,9 @@ int gui_mc_cogging::render() {
                 state_ = behaviour::wait_position_s;
                 break;
             case behaviour::wait_position_s:
+            case behaviour::average_s:
             case behaviour::rotate_s:
+            case behaviour::sweep_s:
             case behaviour::finish_s:
                 break;
             }
@@ -170,9 +232,11 @@ int gui_mc_cogging::render() {
             case behaviour::standby_s:
                 break;
             case behaviour::wait_position_s:
+            case behaviour::average_s:
             case behaviour::rotate_s:
+            case behaviour::sweep_s:
             case behaviour::finish_s:
-                gui_if_->stop();
+                gui_if_->job_stop(this);
                 state_ = behaviour::standby_s;
                 break;
             }
@@ -186,15 +250,14 @@ int gui_mc_cogging::render() {
                 break;
 
             case behaviour::wait_position_s:
+            case behaviour::average_s:
             case behaviour::rotate_s:
+            case behaviour::sweep_s:
                 ImGui::Text("RUNNING");
                 break;
 
             case behaviour::finish_s:
                 ImGui::Text("RUNNING");
-                gui_if_->stop();
-                compute_outputs();
-                state_ = behaviour::standby_s;
                 break;
         }
 
@@ -228,15 +291,17 @@ int gui_mc_cogging::render() {
                 case behaviour::standby_s:       ImGui::TableSetColumnIndex(1); ImGui::Text("standby_s"); break;
                 case behaviour::finish_s:        ImGui::TableSetColumnIndex(1); ImGui::Text("finish_s"); break;
                 case behaviour::wait_position_s: ImGui::TableSetColumnIndex(1); ImGui::Text("wait_position_s"); break;
+                case behaviour::average_s:       ImGui::TableSetColumnIndex(1); ImGui::Text("average_s"); break;
                 case behaviour::rotate_s:        ImGui::TableSetColumnIndex(1); ImGui::Text("rotate_s"); break;
+                case behaviour::sweep_s:         ImGui::TableSetColumnIndex(1); ImGui::Text("sweep_s"); break;
             }
 
             ImGui::EndTable();
         }
         {
-            float progress = (float)rotation_tick_ / (float)rotation_steps_;
+            float progress = progress_get();
             char buf[32];
-            sprintf(buf, "%d/%d", rotation_tick_, rotation_steps_);
+            sprintf(buf, "%.1f%%", 100.0f * progress);
             ImGui::ProgressBar(progress, ImVec2(0.0f, 0.0f), buf);
             ImGui::SameLine(0.0f, ImGui::GetStyle().ItemInnerSpacing.x);
             ImGui::Text("Test progress");
@@ -248,16 +313,24 @@ int gui_mc_cogging::render() {
         //     ImGui::Text("Position error");
         // }
 
-        plot_result_.plot();
+        render_map();
 
         ImGui::Separator();
         ImGui::Text("The final result has the following:");
         ImGui::Text(" - Angle in the range [0, 2pi].");
-        ImGui::Text(" - Any bias due to friction removed. (Subract mean i_q)");
+        ImGui::Text(" - Fitted series in the cogging orders. Mean i_q and friction removed.");
 
-        ImGui::Text("Raw output mean: %.3f", computed_mean_);
+        if (fit_.ok) {
+            ImGui::Text("%s", fit_.info.c_str());
+            ImGui::Text("Mean i_q: %.4f, friction i_q: %.4f, rms residual: %.4f", fit_.offset, fit_.friction, fit_.rms_residual);
+        } else if (!fit_.info.empty()) {
+            ImGui::TextColored(ImVec4(0.5f, 0.0f, 0.0f, 1.0f), "%s", fit_.info.c_str());
+        }
 
-        if (ImGui::Button("Recompute outputs")) { compute_outputs(); }
+        {
+            ImGuiDisabled running(state_ != behaviour::standby_s);
+            if (ImGui::Button("Recompute outputs")) { compute_outputs(); }
+        }
 
         plot_final_.plot();
         plot_vis_.plot();
@@ -310,21 +383,121 @@ int gui_mc_cogging::ready_test() {
 
 void gui_mc_cogging::initialise() {
     theta_error_ = 0.0f;
-    theta_command_ = 0.0f;
-    rotation_tick_ = 0;
-    computed_mean_ = 0.0f;
+    theta_command_ = 0.0;
+    direction_ = cogging_fit::forward;
+    position_idx_ = 0;
+    positions_done_ = 0;
+    average_count_ = 0;
+    sweep_angle_ = 0.0;
+    map_.reset(rotation_steps_);
+}
+
+float gui_mc_cogging::progress_get() {
+    int dirs = bidirectional_ ? 2 : 1;
+    int dir_done = (direction_ == cogging_fit::reverse) ? 1 : 0;
+    float progress;
+    if (sweep_mode_idx_ == (int)sweep_mode::continuous) {
+        double per_dir = sweep_lead_in_ + 2.0 * M_PI * sweep_revolutions_;
+        progress = (float)((dir_done * per_dir + sweep_angle_) / (dirs * per_dir));
+    } else {
+        progress = (float)positions_done_ / (float)(dirs * rotation_steps_);
+    }
+    if (state_ == behaviour::standby_s && positions_done_ == 0 && sweep_angle_ == 0.0) {
+        progress = 0.0f;
+    }
+    return std::min(progress, 1.0f);
+}
+
+void gui_mc_cogging::render_settings() {
+    const int i32_one = 1;
+
+    ImGuiDisabled running(state_ != behaviour::standby_s);
+
+    ImGui::Separator();
+    ImGui::Text("Sweep");
+    helpers::combo_select("Sweep mode", &sweep_mode_names_, &sweep_mode_idx_, NULL);
+    ImGui::Checkbox("Both directions (separates friction from cogging)", &bidirectional_);
+    if (sweep_mode_idx_ == (int)sweep_mode::continuous) {
+        ImGui::InputFloat("Speed (rad/s)", &sweep_speed_, 0.1f, 1.0f, "%.3f");
+        ImGui::InputScalar("Revolutions per direction", ImGuiDataType_S32, &sweep_revolutions_, &i32_one);
+        ImGui::InputFloat("Lead in (rad)", &sweep_lead_in_, 0.1f, 1.0f, "%.3f");
+        if (sweep_speed_ < 0.001f) { sweep_speed_ = 0.001f; }
+        if (sweep_revolutions_ < 1) { sweep_revolutions_ = 1; }
+        if (sweep_lead_in_ < 0.0f) { sweep_lead_in_ = 0.0f; }
+        double per_dir = sweep_lead_in_ + 2.0 * M_PI * sweep_revolutions_;
+        ImGui::Text("Sweep time: %.1f s", (bidirectional_ ? 2.0 : 1.0) * per_dir / sweep_speed_);
+    } else {
+        ImGui::InputScalar("Samples per position", ImGuiDataType_S32, &samples_per_position_, &i32_one);
+        ImGui::InputFloat("Position threshold (rad)", &theta_threshold_, 0.0001f, 0.001f, "%.5f");
+        ImGui::InputFloat("Velocity threshold (rad/s)", &omega_threshold_, 0.01f, 0.1f, "%.4f");
+        if (samples_per_position_ < 1) { samples_per_position_ = 1; }
+    }
+
+    ImGui::Text("Fit");
+    ImGui::InputScalar("Stator slots (0 for plain series)", ImGuiDataType_S32, &fit_settings_.slots, &i32_one);
+    ImGui::InputScalar("Rotor poles (0 for plain series)",  ImGuiDataType_S32, &fit_settings_.poles, &i32_one);
+    ImGui::InputScalar("Harmonics",                         ImGuiDataType_S32, &fit_settings_.harmonics, &i32_one);
+    ImGui::InputScalar("Low orders",                        ImGuiDataType_S32, &fit_settings_.low_orders, &i32_one);
+    if (fit_settings_.slots < 0) { fit_settings_.slots = 0; }
+    if (fit_settings_.poles < 0) { fit_settings_.poles = 0; }
+    if (fit_settings_.harmonics < 0) { fit_settings_.harmonics = 0; }
+    if (fit_settings_.low_orders < 0) { fit_settings_.low_orders = 0; }
+    int order = cogging_fit::cogging_order(fit_settings_);
+    int n_orders = cogging_fit::orders_get(fit_settings_, rotation_steps_).size();
+    if (order > 0) {
+        ImGui::Text("Cogging order %d per revolution, %d orders fitted", order, n_orders);
+    } else {
+        ImGui::Text("Plain Fourier series, %d orders fitted", n_orders);
+    }
+}
+
+void gui_mc_cogging::render_map() {
+    if (ImPlot::BeginPlot("Cogging map")) {
+        ImPlot::SetupAxes("th_m_0", "i_q");
+        if (!map_x_[0].empty()) {
+            ImPlot::PlotLine("Forward", map_x_[0].data(), map_y_[0].data(), map_x_[0].size());
+        }
+        if (!map_x_[1].empty()) {
+            ImPlot::PlotLine("Reverse", map_x_[1].data(), map_y_[1].data(), map_x_[1].size());
+        }
+        if (!fit_x_.empty()) {
+            ImPlot::PlotLine("Fit", fit_x_.data(), fit_y_.data(), fit_x_.size());
+        }
+        ImPlot::EndPlot();
+    }
 }
 
 void gui_mc_cogging::compute_outputs() {
-    computed_mean_ = std::accumulate(plot_result_.y_.begin(), plot_result_.y_.end(), 0.0) / plot_result_.y_.size();
+    // Bin means, both directions
+    for (int d=0; d<2; d++) {
+        map_x_[d].clear();
+        map_y_[d].clear();
+        for (int k=0; k<map_.n_bins(); k++) {
+            double th, y;
+            if (map_.bin_get((cogging_fit::direction)d, k, &th, &y)) {
+                map_x_[d].push_back(th);
+                map_y_[d].push_back(y);
+            }
+        }
+    }
+
+    fit_x_.clear();
+    fit_y_.clear();
+    if (cogging_fit::fit(map_, fit_settings_, rotation_steps_, &fit_) != jcs::RET_OK) {
+        std::cout << "Cogging fit failed: " << fit_.info << "\n";
+        return;
+    }
 
     // x and y for both plots are the same size
-    for (int i=0; i<plot_result_.y_.size(); i++) {
-        plot_final_.x_[i] = helpers::angle_norm_2pi(plot_result_.x_[i]);
-        plot_final_.y_[i] = plot_result_.y_[i] - computed_mean_;
+    for (int i=0; i<rotation_steps_; i++) {
+        plot_final_.x_[i] = (2.0 * M_PI * i) / rotation_steps_;
+        plot_final_.y_[i] = fit_.table[i];
 
         plot_vis_.x_[i] = (5.0 + plot_final_.y_[i]) * cos(plot_final_.x_[i]); 
         plot_vis_.y_[i] = (5.0 + plot_final_.y_[i]) * sin(plot_final_.x_[i]); 
+
+        fit_x_.push_back(plot_final_.x_[i]);
+        fit_y_.push_back(fit_.offset + fit_.table[i]);
     }
 }
 
@@ -362,6 +535,14 @@ int gui_mc_cogging::emit_config(std::string const& file_path) {
     config_file << "  # Compensation was performed at rotor position offset:\n";
     config_file << "  # encoder_0_position_offset: " << compensated_at_zero_pos_ << "\n";
     config_file << "  #\n";
+    config_file << "  #\n";
+    config_file << "  # Fitted series, " << fit_.orders.size() << " orders";
+    if (cogging_fit::cogging_order(fit_settings_) > 0) {
+        config_file << ", slots " << fit_settings_.slots << ", poles " << fit_settings_.poles;
+    }
+    config_file << ", rms residual " << fit_.rms_residual << "\n";
+    config_file << "  # Removed mean i_q " << fit_.offset << ", friction i_q " << fit_.friction << "\n";
+    config_file << "  #\n";
     config_file << "  # Coefficients map - " << plot_final_.y_.size() << " points\n";
 
     std::string coefs_key = "  cogging_compensator_coeffs: [ ";
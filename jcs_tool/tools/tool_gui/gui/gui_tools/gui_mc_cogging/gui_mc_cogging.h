@@ -11,6 +11,7 @@
 #include "helpers.h"
 #include "gui_type_base.h"
 #include "gui_interface.h"
+#include "cogging_fit.h"
 
 //////////////////////////////////////////////////////////////////////
 class gui_mc_cogging : public gui_type_base {
@@ -21,20 +22,40 @@ public:
     int startup();
     int step_rt();
     int render();
+    int step_gui();
+    bool job_active() { return state_ != behaviour::standby_s; }
 
 private:
     // Configure parameters
+    // Compensator table points, also the number of position bins
     const static int rotation_steps_ = 1024;
     
     float theta_threshold_ = 0.0005f;
     float omega_threshold_ = 0.05f;
-    
+
+    // Stepped sweep settles at each table position and averages samples there.
+    // Continuous sweep turns at a constant slow speed and bins every sample.
+    enum class sweep_mode {
+        stepped = 0,
+        continuous = 1
+    };
+    std::vector<std::string> sweep_mode_names_;
+    int sweep_mode_idx_;
+    int samples_per_position_;
+    bool bidirectional_;
+    float sweep_speed_;         // rad/s
+    int sweep_revolutions_;     // Per direction
+    float sweep_lead_in_;       // rad, not binned after a start or reversal
+    double dt_;
+
     void initialise();
 
     enum class behaviour {
         standby_s,
         wait_position_s,
+        average_s,
         rotate_s,
+        sweep_s,
         finish_s
     };
     behaviour state_;
@@ -47,7 +68,9 @@ private:
     int ready_test();
 
     // Storage
-    std::vector<float> signals_out_;
+    // Shared base rate outputs, see gui_interface
+    std::vector<float> const& signals_out_;
+    // Inputs driven by this element
     std::vector<float> signals_in_;
     // Indices into storage
     int fb_th_m_0_idx_;
@@ -55,19 +78,32 @@ private:
     int fb_i_q_idx_;
     int cmd_th_m_0_idx_;
 
-    float computed_mean_;
-
     // helpers
     float theta_error_;
-    float theta_command_;
-    int rotation_tick_;
+    double theta_command_;      // Unwrapped
+    cogging_fit::direction direction_;
+    int position_idx_;
+    int positions_done_;
+    int average_count_;
+    double sweep_angle_;        // Travelled in the current direction
+    float progress_get();
     void compute_outputs();
 
+    // Measurement and fit
+    cogging_fit::binned_map map_;
+    cogging_fit::settings fit_settings_;
+    cogging_fit::fit_result fit_;
+    std::vector<double> map_x_[2];
+    std::vector<double> map_y_[2];
+    std::vector<double> fit_x_;
+    std::vector<double> fit_y_;
+    void render_settings();
+    void render_map();
+
     int write_coeffs_to_file();
     int emit_config(std::string const& file_path);
 
     // Results
-    helpers::plot_measurement plot_result_;
     helpers::plot_measurement plot_final_;
     helpers::plot_measurement plot_vis_;
     float compensated_at_zero_pos_;
@@ -10,6 +10,7 @@
 //////////////////////////////////////////////////////////////////////
 gui_mc_current_test::gui_mc_current_test(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
     gui_type_base("Current Test", host, gui_if, target_device),
+    f32_output_signal_store_(*gui_if->get_f32_output_signals()),
     sampler_(host->base_frequency_get(), gui_if->get_f32_output_signal_names(), 4, 10, 10),
     i_ramp_(1.0 / static_cast<double>(host_->base_frequency_get())),
     i_rotate_(1.0 / static_cast<double>(host_->base_frequency_get())),
@@ -29,10 +30,7 @@ int gui_mc_current_test::startup() {
     if (sampler_.startup((double)jcs::external::time_now_ns()) != jcs::RET_OK) {
         return jcs::RET_ERROR;
     }
-    // Confiugure line storage
-    f32_output_signal_store_.resize(host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
     f32_input_signal_store_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
-
     // Signal index helpers
     can_start_ = true;
     if (helpers::signals_names_contains(gui_if_->get_f32_output_signal_names(), target_device_+"::th_m_encoder_0", &signal_out_th_m_0_idx_) != jcs::RET_OK) { can_start_ = false; }
@@ -51,8 +49,6 @@ int gui_mc_current_test::startup() {
 }
 
 int gui_mc_current_test::step_rt() {
-    host_->sig_output_get_rt(0, &f32_output_signal_store_);
-
     sampler_.step_rt((double)jcs::external::time_now_ns(), &f32_output_signal_store_);
 
     switch (state_) {
@@ -66,7 +62,7 @@ int gui_mc_current_test::step_rt() {
             if (!i_ramp_.is_done()) {
                 break;
             }
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
 
             i_rotate_.start_speed(0.0, rotate_speed_rads_, true, sampler_.get_sample_time_s());
             sampler_.start();
@@ -80,16 +76,35 @@ int gui_mc_current_test::step_rt() {
                 sampler_.stop();
                 state_ = state::finish_s;
             }
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
             break;
     }
     return jcs::RET_OK;
 }
 
+void gui_mc_current_test::input_signals_set_rt() {
+    // Only this test's own inputs go to the shared frame
+    gui_if_->f32_input_signal_set_rt(signal_in_source_i_d_.index_, f32_input_signal_store_[ signal_in_source_i_d_.index_ ]);
+    gui_if_->f32_input_signal_set_rt(signal_in_source_th_m_.index_, f32_input_signal_store_[ signal_in_source_th_m_.index_ ]);
+    gui_if_->f32_input_signal_set_rt(signal_in_source_w_m_.index_, f32_input_signal_store_[ signal_in_source_w_m_.index_ ]);
+}
+
 int gui_mc_current_test::step_rt_always() {
     return jcs::RET_OK;
 }
 
+int gui_mc_current_test::step_gui() {
+    sampler_.step_gui();
+
+    // Here rather than render() so the test finishes with its device unselected
+    if (state_ == state::finish_s) {
+        sampler_.stop();
+        gui_if_->job_stop(this);
+        state_ = state::off_s;
+    }
+    return jcs::RET_OK;
+}
+
 int gui_mc_current_test::render() {
 
     ImGui::Text("Current test tool");
@@ -138,8 +153,8 @@ int gui_mc_current_test::render() {
                     f32_input_signal_store_[ signal_in_source_th_m_.index_ ] = 0.0f;
                     f32_input_signal_store_[ signal_in_source_w_m_.index_ ] = 0.0f;
                     i_ramp_.start(0.0, test_current_, ramp_time_s_, 0.5, dwell_time_s_);
-                    // Start JCS host
-                    if (gui_if_->start() != jcs::RET_OK) {
+                    // Start JCS host, shared with tests on other devices
+                    if (gui_if_->job_start(this, false) != jcs::RET_OK) {
                         state_ = state::off_s;
                         break;
                     }
@@ -163,7 +178,7 @@ int gui_mc_current_test::render() {
                 case state::finish_s:
                     f32_input_signal_store_[ signal_in_source_i_d_.index_ ] = 0.0f;
                     sampler_.stop();
-                    gui_if_->stop();
+                    gui_if_->job_stop(this);
                     state_ = state::off_s;
                     break;
             }
@@ -190,9 +205,6 @@ int gui_mc_current_test::render() {
 
             case state::finish_s:
                 ImGui::TextColored(ImVec4(0.0f, 0.5f, 0.0f, 1.0f), "Stopping");
-                sampler_.stop();
-                gui_if_->stop();
-                state_ = state::off_s;
                 break;
         }
         ImGui::Separator();
@@ -23,8 +23,13 @@ public:
     int step_rt();
     int step_rt_always();
     int render();    
+    int step_gui();
+    bool job_active() { return state_ != state::off_s; }
 
 private:
+    // Shared base rate outputs, see gui_interface
+    std::vector<float> const& f32_output_signal_store_;
+
     enum class state {
         off_s,
         ramp_to_current_s,
@@ -35,6 +40,7 @@ private:
 
     int ready_test();
     void get_test_parameters();
+    void input_signals_set_rt();
 
     bool is_ready_;
     bool can_start_;
@@ -51,8 +57,8 @@ private:
     std::vector<std::string> required_input_signal_names_;
     std::vector<std::string> required_output_signal_names_;
 
+    // Inputs driven by this test, see input_signals_set_rt()
     std::vector<float> f32_input_signal_store_;
-    std::vector<float> f32_output_signal_store_;
 
     helpers::combo_source signal_in_source_i_d_;
     helpers::combo_source signal_in_source_th_m_;
@@ -7,6 +7,7 @@
 #include "helpers.h"
 #include "imgui_helpers.h"
 #include "jcs_dev_motor_controller.h"
+#include <memory>
 
 //////////////////////////////////////////////////////////////////////
 gui_mc_encoder::gui_mc_encoder(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
@@ -33,17 +34,20 @@ int gui_mc_encoder::render() {
     ImGui::Text("Encoder tool");
 
     ImGui::Separator();
+    param_worker::render_job(job_);
+
+    ImGuiDisabled ui_busy(job_ && job_->active());
     if (ImGui::Button("Click to make motor controller ready for tests!")) {
-        if (ready_test() != jcs::RET_OK) { return jcs::RET_OK; }
-        is_ready_ = true;
+        job_ = gui_if_->get_param_worker()->submit("Ready", [this](param_job& job) {
+            return ready_test(job);
+        }, [this](param_job& job) {
+            is_ready_ = (job.result() == jcs::RET_OK);
+        }, target_device_);
     }
 
     {
         ImGuiDisabled ui_disabled(!is_ready_);
-        auto clean_up_on_error = [&]() {
-            is_ready_ = false;
-        };
-        CHECK_CLEANUP_OK( render_zero_encoder(), clean_up_on_error(); )
+        render_zero_encoder();
     }
 
     return jcs::RET_OK;
@@ -90,46 +94,17 @@ int gui_mc_encoder::render_zero_encoder() {
     }
 
     if (ImGui::Button("Start zero")) {
-        {
-            bool ctrl_is_temperature_clamped = false;
-            PARAM_NOTIFY_ERROR( host_->read_bool(target_device_,  "temperature_penalty_ctrl_is_clamped", &ctrl_is_temperature_clamped), "Parameter failed: temperature_penalty_ctrl_is_clamped" )
-
-            if (ctrl_is_temperature_clamped) {
-                std::cout << "ERROR: Device control is temperature clamped. Cannot continue with test.\n";
-                return jcs::RET_ERROR;
-            }
-        }
-
-        PARAM_NOTIFY_ERROR( host_->write_float(target_device_,  "i_d_alignment", i_d_alignment_), "Parameter failed: i_d_alignment" )
-        PARAM_NOTIFY_ERROR( host_->write_uint16(target_device_, "i_d_alignment_ramp_time_ms",   i_d_alignment_ramp_time_ms_),   "Parameter failed: i_d_alignment_ramp_time_ms" )
-        PARAM_NOTIFY_ERROR( host_->write_uint16(target_device_, "i_d_alignment_settle_time_ms", i_d_alignment_settle_time_ms_), "Parameter failed: i_d_alignment_settle_time_ms" )
-        // Configure controller mode into align mode
-        PARAM_NOTIFY_ERROR( host_->write_enum(target_device_,   "controller_mode", "test_align"), "Parameter failed: controller_mode" )
-        // Starting the controller starts the test
-        PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "controller_start"), "Parameter failed: controller_start" )
-
-        // Wait for the dwell period
-        bool in_dwell = false;
-        long int time_start_dwell_ms = helpers::time_now_ms();
-        long int dwell_timeout_ms = (long int)i_d_alignment_ramp_time_ms_ + i_d_alignment_settle_time_ms_ + 6000;
-        while (!in_dwell) {
-            // Note: This blocks the UI - TODO small state machine?
-            PARAM_NOTIFY_ERROR( host_->read_bool(target_device_, "align_in_dwell", &in_dwell), "Parameter failed: align_in_dwell" )
-            helpers::sleep_ms(100);
-
-            if ( (helpers::time_now_ms() - time_start_dwell_ms) > dwell_timeout_ms) {
-                std::cout << "ERROR: Timeout waiting for dwell. Motor controller might be in an error state.\n";
-                return jcs::RET_ERROR;
+        std::shared_ptr<float> offset = std::make_shared<float>(encoder_position_offset_);
+        std::string encoder = active_encoder_.source_;
+        job_ = gui_if_->get_param_worker()->submit("Zero " + encoder, [this, encoder, offset](param_job& job) {
+            return zero_encoder(job, encoder, offset.get());
+        }, [this, offset](param_job& job) {
+            if (job.result() != jcs::RET_OK) {
+                is_ready_ = false;
+                return;
             }
-        }
-
-        std::string cmd_position_zero = active_encoder_.source_ + "_position_zero";
-        PARAM_NOTIFY_ERROR( host_->write_command(target_device_, cmd_position_zero), "Parameter failed: " + cmd_position_zero )
-        // Stop the test
-        PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "controller_stop"), "Parameter failed: controller_stop" )
-        helpers::sleep_ms(200);
-        std::string cmd_position_offset = active_encoder_.source_ + "_position_offset";
-        PARAM_NOTIFY_ERROR( host_->read_float(target_device_, cmd_position_offset, &encoder_position_offset_), "Parameter failed: " + cmd_position_offset )
+            encoder_position_offset_ = *offset;
+        }, target_device_);
     }
 
     ImGui::Separator();
@@ -139,12 +114,62 @@ int gui_mc_encoder::render_zero_encoder() {
     return jcs::RET_OK;
 }
 
-int gui_mc_encoder::ready_test() {
+int gui_mc_encoder::zero_encoder(param_job& job, std::string const& encoder, float* offset) {
+    {
+        bool ctrl_is_temperature_clamped = false;
+        PARAM_NOTIFY_ERROR( host_->read_bool(target_device_,  "temperature_penalty_ctrl_is_clamped", &ctrl_is_temperature_clamped), "Parameter failed: temperature_penalty_ctrl_is_clamped" )
+
+        if (ctrl_is_temperature_clamped) {
+            std::cout << "ERROR: Device control is temperature clamped. Cannot continue with test.\n";
+            return jcs::RET_ERROR;
+        }
+    }
+
+    PARAM_NOTIFY_ERROR( host_->write_float(target_device_,  "i_d_alignment", i_d_alignment_), "Parameter failed: i_d_alignment" )
+    PARAM_NOTIFY_ERROR( host_->write_uint16(target_device_, "i_d_alignment_ramp_time_ms",   i_d_alignment_ramp_time_ms_),   "Parameter failed: i_d_alignment_ramp_time_ms" )
+    PARAM_NOTIFY_ERROR( host_->write_uint16(target_device_, "i_d_alignment_settle_time_ms", i_d_alignment_settle_time_ms_), "Parameter failed: i_d_alignment_settle_time_ms" )
+    // Configure controller mode into align mode
+    PARAM_NOTIFY_ERROR( host_->write_enum(target_device_,   "controller_mode", "test_align"), "Parameter failed: controller_mode" )
+    // Starting the controller starts the test
+    PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "controller_start"), "Parameter failed: controller_start" )
+
+    // Wait for the dwell period
+    bool in_dwell = false;
+    long int time_start_dwell_ms = helpers::time_now_ms();
+    long int dwell_ms = (long int)i_d_alignment_ramp_time_ms_ + i_d_alignment_settle_time_ms_;
+    long int dwell_timeout_ms = dwell_ms + 6000;
+    while (!in_dwell) {
+        PARAM_NOTIFY_ERROR( host_->read_bool(target_device_, "align_in_dwell", &in_dwell), "Parameter failed: align_in_dwell" )
+        if (!job.sleep_ms(100)) {
+            std::cout << "Encoder zero cancelled\n";
+            PARAM_NOTIFY( host_->write_command(target_device_, "controller_stop"), "Parameter failed: controller_stop" )
+            return jcs::RET_ERROR;
+        }
+
+        long int elapsed_ms = helpers::time_now_ms() - time_start_dwell_ms;
+        job.progress_set((dwell_ms > 0 && elapsed_ms < dwell_ms) ? (float)elapsed_ms / (float)dwell_ms : 1.0f, "Aligning");
+        if (elapsed_ms > dwell_timeout_ms) {
+            std::cout << "ERROR: Timeout waiting for dwell. Motor controller might be in an error state.\n";
+            return jcs::RET_ERROR;
+        }
+    }
+
+    std::string cmd_position_zero = encoder + "_position_zero";
+    PARAM_NOTIFY_ERROR( host_->write_command(target_device_, cmd_position_zero), "Parameter failed: " + cmd_position_zero )
+    // Stop the test
+    PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "controller_stop"), "Parameter failed: controller_stop" )
+    job.sleep_ms(200);
+    std::string cmd_position_offset = encoder + "_position_offset";
+    PARAM_NOTIFY_ERROR( host_->read_float(target_device_, cmd_position_offset, offset), "Parameter failed: " + cmd_position_offset )
+    return jcs::RET_OK;
+}
+
+int gui_mc_encoder::ready_test(param_job& job) {
     //////////////////////////////////////////////////////////////////////////////////////////////////
     // Disable the host sentry as we do not plan to enter synchronous mode     
     PARAM_NOTIFY_ERROR( host_->write_bool(target_device_, "host_sentry_active", false), "Parameter failed: host_sentry_active" )
     // Start the motor controller and wait for it to calibrate
     PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "start"), "Parameter failed: start" )
-    helpers::sleep_ms(500);
+    job.sleep_ms(500);
     return jcs::RET_OK;
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "helpers.h"
 #include "gui_type_base.h"
 #include "gui_interface.h"
+#include "param_worker.h"
 
 //////////////////////////////////////////////////////////////////////
 class gui_mc_encoder : public gui_type_base {
@@ -30,8 +31,13 @@ private:
     float encoder_position_offset_;
 
 
+    // Zero or ready in flight on the parameter worker. Controls are disabled until it finishes.
+    param_job_ptr job_;
+
     int render_zero_encoder();
-    int ready_test();
+    // Run on the parameter worker
+    int zero_encoder(param_job& job, std::string const& encoder, float* offset);
+    int ready_test(param_job& job);
 
     helpers::combo_source active_encoder_;
     std::vector<std::string> const encoders_;
@@ -12,6 +12,7 @@
 //////////////////////////////////////////////////////////////////////
 gui_mc_encoder_calib::gui_mc_encoder_calib(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
     gui_type_base("Encoder Calibrator", host, gui_if, target_device),
+    f32_output_signal_store_(*gui_if->get_f32_output_signals()),
     encoders_({"encoder_0", "encoder_1"}),
     active_encoder_("encoder_0", 0),
     configured_encoder_("encoder_0"), configured_estimator_("estimator_0"),
@@ -32,6 +33,9 @@ gui_mc_encoder_calib::gui_mc_encoder_calib(jcs::jcs_host* host, gui_interface* g
     ramp_time_s_ = 1.0f;
     dwell_time_s_ = 1.0f;
     rotation_tick_ = 0;
+    corrector_ = corrector_type::harmonic_s;
+    harmonic_order_ = 8;
+    harmonic_model_valid_ = false;
     // 1 revolution over test time
     rotate_speed_rads_ = (float)(2.0 * M_PI / (double)test_time_s_);
 
@@ -62,10 +66,7 @@ gui_mc_encoder_calib::gui_mc_encoder_calib(jcs::jcs_host* host, gui_interface* g
 
 int gui_mc_encoder_calib::startup() {
     state_ = state::off_s;
-    // Confiugure line storage
-    f32_output_signal_store_.resize(host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
     f32_input_signal_store_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
-
     // Signal index helpers
     can_start_ = true;
 
@@ -74,8 +75,6 @@ int gui_mc_encoder_calib::startup() {
 }
 
 int gui_mc_encoder_calib::step_rt() {
-    host_->sig_output_get_rt(0, &f32_output_signal_store_);
-
     switch (state_) {
         default:
         case state::finish_s:
@@ -91,7 +90,7 @@ int gui_mc_encoder_calib::step_rt() {
             if (!i_ramp_.is_done()) {
                 break;
             }
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
 
             i_rotate_.start_speed(0.0, rotate_speed_rads_, true, test_time_s_);
             rotation_tick_ = 0;
@@ -101,7 +100,7 @@ int gui_mc_encoder_calib::step_rt() {
         case state::rotate_s:
             // Set theta command
             f32_input_signal_store_[ signal_in_source_th_m_.index_ ] = i_rotate_.step();
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
 
             if (i_rotate_.is_done()) {
                 // Start the ramp down
@@ -123,7 +122,7 @@ int gui_mc_encoder_calib::step_rt() {
         case state::finish_ramp_s:
             // Ramp fown nicely to stop the rotor from jumping when setting D=0
             f32_input_signal_store_[ signal_in_source_d_.index_ ] = i_ramp_.step();
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
             if (i_ramp_.is_done()) {
                 state_ = state::finish_s;
             }
@@ -132,11 +131,18 @@ int gui_mc_encoder_calib::step_rt() {
     return jcs::RET_OK;
 }
 
+void gui_mc_encoder_calib::input_signals_set_rt() {
+    // Only this test's own inputs go to the shared frame
+    gui_if_->f32_input_signal_set_rt(signal_in_source_d_.index_, f32_input_signal_store_[ signal_in_source_d_.index_ ]);
+    gui_if_->f32_input_signal_set_rt(signal_in_source_th_m_.index_, f32_input_signal_store_[ signal_in_source_th_m_.index_ ]);
+}
+
 int gui_mc_encoder_calib::step_rt_always() {
     return jcs::RET_OK;
 }
 
-int gui_mc_encoder_calib::render() {
+int gui_mc_encoder_calib::step_gui() {
+    // Non RT state transitions. Here rather than render() so the test runs with its device unselected.
     switch (state_) {
         default:
         case state::finish_ramp_s:
@@ -144,6 +150,12 @@ int gui_mc_encoder_calib::render() {
             break;
 
         case state::initialise_s:
+            // Restarts the host, so nothing else may be running
+            if (!gui_if_->job_can_start(true)) {
+                std::cout << "gui_mc_encoder_calib: " << target_device_ << " can not start while tests run on other devices\n";
+                state_ = state::off_s;
+                break;
+            }
             // Store config
             PARAM_NOTIFY_ACTION( host_->read_bool(target_device_, configured_encoder_+"_theta_bypass",           &conf_enc_theta_bypass_),          "Parameter failed: "+configured_encoder_+"_theta_bypass",           state_ = state::off_s; break; )
             PARAM_NOTIFY_ACTION( host_->read_bool(target_device_, configured_encoder_+"_theta_bypass_direction", &conf_enc_theta_bypass_direction_),"Parameter failed: "+configured_encoder_+"_theta_bypass_direction", state_ = state::off_s; break; )
@@ -153,10 +165,6 @@ int gui_mc_encoder_calib::render() {
             PARAM_NOTIFY( host_->write_bool(target_device_, configured_encoder_+"_theta_bypass_direction", true), "Parameter failed: "+configured_encoder_+"_theta_bypass_direction" )
             PARAM_NOTIFY( host_->write_bool(target_device_, configured_estimator_+"_theta_passthrough",    true), "Parameter failed: "+configured_estimator_+"_theta_passthrough" )
 
-            // Stop and reset so encoder parameters are sampled
-            gui_if_->stop();
-            gui_if_->reset();
-
             // Clear the corrected plots
             std::fill(th_m_corrected_corrected_->y_.begin(), th_m_corrected_corrected_->y_.end(), 0.0f);
             std::fill(th_m_error_corrected_->y_.begin(), th_m_error_corrected_->y_.end(), 0.0f);
@@ -166,8 +174,8 @@ int gui_mc_encoder_calib::render() {
             i_ramp_.start(0.0, test_current_, ramp_time_s_, 0.5, dwell_time_s_);
             rotation_tick_ = 0;
 
-            // Start JCS host
-            if (gui_if_->start() != jcs::RET_OK) {
+            // Stop, reset so encoder parameters are sampled, then start JCS host
+            if (gui_if_->job_start(this, true) != jcs::RET_OK) {
                 state_ = state::finish_s;
                 break;
             }
@@ -195,12 +203,18 @@ int gui_mc_encoder_calib::render() {
             PARAM_NOTIFY( host_->write_bool(target_device_, configured_encoder_+"_theta_bypass_direction", conf_enc_theta_bypass_direction_),"Parameter failed: "+configured_encoder_+"_theta_bypass_direction" )
             PARAM_NOTIFY( host_->write_bool(target_device_, configured_estimator_+"_theta_passthrough",    conf_est_theta_passthrough_),     "Parameter failed: "+configured_estimator_+"_theta_passthrough" )
             f32_input_signal_store_[ signal_in_source_d_.index_ ] = 0.0f;
-            gui_if_->stop();
-            gui_if_->reset();
+            gui_if_->job_stop(this);
+            // Restored config is sampled on reset
+            if (gui_if_->job_can_start(true)) {
+                gui_if_->reset();
+            }
             state_ = state::off_s;
             break;
     }
+    return jcs::RET_OK;
+}
 
+int gui_mc_encoder_calib::render() {
     ImGui::Text("Encoder lineariser tool");
     ImGui::Separator();
     ImGui::Text("This tool generates encoder linearisation coefficients.");
@@ -318,8 +332,31 @@ int gui_mc_encoder_calib::render() {
 
         ImGui::Separator();
         ImGui::Text("Calibration");
+        if (ImGui::RadioButton("Harmonic fit", corrector_ == corrector_type::harmonic_s)) {
+            corrector_ = corrector_type::harmonic_s;
+        }
+        ImGui::SameLine();
+        if (ImGui::RadioButton("Table interpolation", corrector_ == corrector_type::table_s)) {
+            corrector_ = corrector_type::table_s;
+        }
+        if (corrector_ == corrector_type::harmonic_s) {
+            const int i32_one = 1;
+            ImGui::InputScalar("Harmonic order", ImGuiDataType_S32, &harmonic_order_, &i32_one);
+            // Table lerp on the device attenuates orders near the table Nyquist order
+            if (harmonic_order_ < 1) { harmonic_order_ = 1; }
+            if (harmonic_order_ > calib_points_ / 4) { harmonic_order_ = calib_points_ / 4; }
+        }
         if (ImGui::Button("Compute new calibration")) {
-            mc_encoder_corrector::build_correction_table(&correction_table_, th_m_orig_reference_->y_, th_m_orig_recorded_->y_, calib_points_);
+            if (corrector_ == corrector_type::harmonic_s) {
+                harmonic_model_valid_ = (mc_encoder_corrector::build_correction_table_harmonic(&correction_table_, &harmonic_model_,
+                                            th_m_orig_reference_->y_, th_m_orig_recorded_->y_, calib_points_, harmonic_order_) == jcs::RET_OK);
+                if (!harmonic_model_valid_) {
+                    std::cout << "ERROR: Harmonic fit failed. Run the test first.\n";
+                }
+            } else {
+                mc_encoder_corrector::build_correction_table(&correction_table_, th_m_orig_reference_->y_, th_m_orig_recorded_->y_, calib_points_);
+                harmonic_model_valid_ = false;
+            }
             // Apply the correction and sundry
             for (int i=0; i<th_m_orig_reference_->y_.size(); ++i) {
                 float th_m = static_cast<float>(th_m_orig_recorded_->y_.at(i));
@@ -365,6 +402,7 @@ int gui_mc_encoder_calib::render() {
         ImGui::Separator();
         ImGui::Text("Encoder RMS error  : %7.5f", correction_table_.rms_error);
         ImGui::Text("Corrected RMS error: %7.5f", correction_table_.rms_error_corrected);
+        render_harmonic_model();
 
         ImGui::Separator();
         helpers::result_text_copyable(configured_encoder_+"_linearisation_coeffs: ", 9, correction_table_.corrections, 8);
@@ -377,6 +415,29 @@ int gui_mc_encoder_calib::render() {
     return jcs::RET_OK;
 }
 
+void gui_mc_encoder_calib::render_harmonic_model() {
+    if (!harmonic_model_valid_) {
+        return;
+    }
+    ImGui::Text("Model residual RMS: %7.5f, offset: %7.5f", harmonic_model_.rms_residual, harmonic_model_.offset);
+
+    static ImGuiTableFlags table_flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | 
+                                         ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings;
+    if (ImGui::BeginTable("Harmonics", 3, table_flags)) {
+        ImGui::TableSetupColumn("Harmonic", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Amplitude (rad)", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Phase (deg)", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+        for (int k=0; k<harmonic_model_.order; k++) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%d", k + 1);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%.6f", harmonic_model_.amplitude[k]);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%.1f", harmonic_model_.phase[k] * 180.0 / M_PI);
+        }
+        ImGui::EndTable();
+    }
+}
+
 int gui_mc_encoder_calib::ready_test() {
     {
         bool ctrl_is_temperature_clamped = false;
@@ -24,8 +24,13 @@ public:
     int step_rt();
     int step_rt_always();
     int render();    
+    int step_gui();
+    bool job_active() { return state_ != state::off_s; }
 
 private:
+    // Shared base rate outputs, see gui_interface
+    std::vector<float> const& f32_output_signal_store_;
+
     static const int calib_points_ = 64;
     static const int test_time_s_ = 10;
 
@@ -46,6 +51,7 @@ private:
 
     int ready_test();
     void get_test_parameters();
+    void input_signals_set_rt();
 
     enum class vi_mode {
         current_s,
@@ -65,8 +71,8 @@ private:
     rotate i_rotate_;
     int rotation_tick_;
 
+    // Inputs driven by this test, see input_signals_set_rt()
     std::vector<float> f32_input_signal_store_;
-    std::vector<float> f32_output_signal_store_;
 
     helpers::combo_source signal_in_source_d_;
     helpers::combo_source signal_in_source_th_m_;
@@ -91,6 +97,17 @@ private:
     // Calibrator
     mc_encoder_corrector::correction_table correction_table_;
 
+    // Interpolate the recorded error into the table, or fit a harmonic model and sample it
+    enum class corrector_type {
+        table_s,
+        harmonic_s
+    };
+    corrector_type corrector_;
+    int harmonic_order_;
+    mc_encoder_corrector::harmonic_model harmonic_model_;
+    bool harmonic_model_valid_;
+    void render_harmonic_model();
+
     // Original settings storage
     bool conf_enc_theta_bypass_;
     bool conf_enc_theta_bypass_direction_;
@@ -3,10 +3,17 @@
 //
 #include "mc_encoder_corrector.h"
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include "helpers.h"
 #include "jcs_host_types.h"
 
+#include <Eigen/Dense>
+
+// [0, 2pi) without loops
+static inline double wrap_2pi(double angle) {
+    return angle - M_TWO_PI * floor(angle / M_TWO_PI);
+}
 
 int mc_encoder_corrector::build_correction_table(
     correction_table* result,
@@ -81,23 +88,169 @@ float mc_encoder_corrector::apply_correction(float encoder_angle, const std::vec
     int table_size = correction_table.size();
     
     // Normalize angle to [0, 2π]
-    encoder_angle = helpers::angle_norm_2pi(encoder_angle);
+    encoder_angle = wrap_2pi(encoder_angle);
 
     float table_position = (encoder_angle * table_size) / M_TWO_PI;
-    int index_low = static_cast<int>(table_position);
-    int index_high = (index_low + 1) % table_size;
+    int index = static_cast<int>(table_position);
+    float fraction = table_position - index;
+    // Rounding can put the angle on 2π
+    int index_low = index % table_size;
+    int index_high = (index + 1) % table_size;
     
-    float fraction = table_position - index_low;
     float correction = (1.0f - fraction) * correction_table[index_low] + fraction * correction_table[index_high];
     
     float corrected = encoder_angle + correction;
     
     // Normalize result
-    corrected = helpers::angle_norm_2pi(corrected);
+    corrected = wrap_2pi(corrected);
     
     return corrected;
 }
 
+int mc_encoder_corrector::fit_harmonic_model(
+    harmonic_model* model,
+    const std::vector<double>& reference_positions,
+    const std::vector<double>& recorded_positions,
+    int order)
+{
+    if (model == nullptr) {
+        return jcs::RET_ERROR;
+    }
+    if (reference_positions.size() != recorded_positions.size()) {
+        return jcs::RET_ERROR;
+    }
+    if (order < 0) {
+        return jcs::RET_ERROR;
+    }
+    int cols = 1 + 2 * order;
+    if (reference_positions.size() <= cols) {
+        return jcs::RET_ERROR;
+    }
+
+    // Normal equations, accumulated one sample at a time.
+    // Columns are [1, cos(th), sin(th), ... cos(order th), sin(order th)]
+    Eigen::MatrixXd ata = Eigen::MatrixXd::Zero(cols, cols);
+    Eigen::VectorXd atb = Eigen::VectorXd::Zero(cols);
+    Eigen::VectorXd phi(cols);
+    for (size_t i = 0; i < reference_positions.size(); ++i) {
+        double error = helpers::angle_norm_pipi(reference_positions[i] - recorded_positions[i]);
+        double c1 = cos(recorded_positions[i]);
+        double s1 = sin(recorded_positions[i]);
+        double c = 1.0;
+        double s = 0.0;
+        phi(0) = 1.0;
+        for (int k = 1; k <= order; ++k) {
+            double ck = c * c1 - s * s1;
+            s = s * c1 + c * s1;
+            c = ck;
+            phi(2*k - 1) = c;
+            phi(2*k)     = s;
+        }
+        ata.selfadjointView<Eigen::Lower>().rankUpdate(phi);
+        atb += phi * error;
+    }
+    ata.triangularView<Eigen::StrictlyUpper>() = ata.transpose();
+
+    Eigen::LDLT<Eigen::MatrixXd> ldlt(ata);
+    if (ldlt.info() != Eigen::Success || !ldlt.isPositive()) {
+        return jcs::RET_ERROR;
+    }
+    Eigen::VectorXd x = ldlt.solve(atb);
+
+    model->order = order;
+    model->offset = x(0);
+    model->a.resize(order);
+    model->b.resize(order);
+    model->amplitude.resize(order);
+    model->phase.resize(order);
+    for (int k = 0; k < order; ++k) {
+        model->a[k] = x(2*k + 1);
+        model->b[k] = x(2*k + 2);
+        model->amplitude[k] = std::sqrt(model->a[k] * model->a[k] + model->b[k] * model->b[k]);
+        model->phase[k] = atan2(model->b[k], model->a[k]);
+    }
+
+    double sum_squared_error = 0.0;
+    for (size_t i = 0; i < reference_positions.size(); ++i) {
+        double error = helpers::angle_norm_pipi(reference_positions[i] - recorded_positions[i]);
+        double r = error - evaluate_harmonic_model(*model, recorded_positions[i]);
+        sum_squared_error += r * r;
+    }
+    model->rms_residual = std::sqrt(sum_squared_error / reference_positions.size());
+    return jcs::RET_OK;
+}
+
+double mc_encoder_corrector::evaluate_harmonic_model(const harmonic_model& model, double angle) {
+    double c1 = cos(angle);
+    double s1 = sin(angle);
+    double c = 1.0;
+    double s = 0.0;
+    double value = model.offset;
+    for (int k = 0; k < model.order; ++k) {
+        double ck = c * c1 - s * s1;
+        s = s * c1 + c * s1;
+        c = ck;
+        value += model.a[k] * c + model.b[k] * s;
+    }
+    return value;
+}
+
+int mc_encoder_corrector::build_correction_table_harmonic(
+    correction_table* result,
+    harmonic_model* model,
+    const std::vector<double>& reference_positions,
+    const std::vector<double>& recorded_positions,
+    int table_size,
+    int order)
+{
+    if (result == nullptr) {
+        return jcs::RET_ERROR;
+    }
+
+    result->table_size = 0;
+    result->rms_error = 0.0;
+    result->rms_error_corrected = 0.0;
+
+    if (reference_positions.empty()) {
+        return jcs::RET_ERROR;
+    }
+    if (table_size < 2) {
+        return jcs::RET_ERROR;
+    }
+    // The table is interpolated linearly on the device, keep order to a quarter of its size,
+    // well below its Nyquist order. The calibrator clamps to the same limit.
+    if (4 * order > table_size) {
+        return jcs::RET_ERROR;
+    }
+    if (result->corrections.size() != table_size) {
+        return jcs::RET_ERROR;
+    }
+    if (result->corrections_increment.size() != table_size) {
+        return jcs::RET_ERROR;
+    }
+    if (fit_harmonic_model(model, reference_positions, recorded_positions, order) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+
+    result->table_size = table_size;
+    result->rms_error = calculate_RMS_error(reference_positions, recorded_positions);
+
+    for (int i = 0; i < table_size; ++i) {
+        double table_angle = (M_TWO_PI * i) / table_size;
+        result->corrections_increment[i] = static_cast<float>(evaluate_harmonic_model(*model, table_angle));
+    }
+
+    // Accumulate corrections
+    for (int i = 0; i < table_size; ++i) {
+        result->corrections[i] += result->corrections_increment[i];
+    }
+
+    // As the device applies it, from the table
+    result->rms_error_corrected = validate_correction(reference_positions, recorded_positions, result->corrections_increment);
+
+    return jcs::RET_OK;
+}
+
 double mc_encoder_corrector::interpolate_correction(double query_angle, const std::vector<std::pair<double, double>>& sorted_data) {
     if (sorted_data.empty()) {
         return 0.0;
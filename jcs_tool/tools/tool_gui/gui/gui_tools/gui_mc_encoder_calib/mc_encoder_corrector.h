@@ -26,6 +26,36 @@ namespace mc_encoder_corrector {
 
     double interpolate_correction(double query_angle, const std::vector<std::pair<double, double>>& sorted_data);
 
+    // Harmonic error model
+    // error(th) = offset + sum over k = 1..order of a[k-1] cos(k th) + b[k-1] sin(k th)
+    // Low orders are eccentricity (1), tilt (2) and magnet non-uniformity. Fitted by least
+    // squares over every recorded sample, the table is then sampled from the model.
+    struct harmonic_model {
+        int order;
+        double offset;
+        std::vector<double> a;
+        std::vector<double> b;
+        std::vector<double> amplitude;  // Per harmonic, rad
+        std::vector<double> phase;      // Per harmonic, rad
+        double rms_residual;
+    };
+
+    int fit_harmonic_model(harmonic_model* model,
+                           const std::vector<double>& reference_positions,
+                           const std::vector<double>& recorded_positions,
+                           int order);
+
+    // Any angle, the model is periodic. No branches, one sin/cos pair per call.
+    double evaluate_harmonic_model(const harmonic_model& model, double angle);
+
+    // order must be at most table_size / 4
+    int build_correction_table_harmonic(correction_table* result,
+                                        harmonic_model* model,
+                                        const std::vector<double>& reference_positions,
+                                        const std::vector<double>& recorded_positions,
+                                        int table_size,
+                                        int order);
+
     double calculate_RMS_error(const std::vector<double>& reference,const std::vector<double>& recorded);
     double validate_correction(const std::vector<double>& reference,
                                const std::vector<double>& recorded,
@@ -11,6 +11,7 @@
 //////////////////////////////////////////////////////////////////////
 gui_mc_thermal_calib::gui_mc_thermal_calib(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
     gui_type_base("Thermal Model Calibrator", host, gui_if, target_device),
+    f32_output_signal_store_(*gui_if->get_f32_output_signals()),
     sampler_labels_({"v_d", "i_d", "t_housing"}),
     sampler_(host->base_frequency_get(), gui_if->get_f32_output_signal_names(), 3, 10, 300, &sampler_labels_),
     i_ramp_(1.0 / static_cast<double>(host_->base_frequency_get())),
@@ -68,9 +69,6 @@ int gui_mc_thermal_calib::startup() {
     if (sampler_.startup((double)jcs::external::time_now_ns()) != jcs::RET_OK) {
         return jcs::RET_ERROR;
     }
-
-    // Configure signal storage
-    f32_output_signal_store_.resize(host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
     f32_input_signal_store_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
 
     can_start_ = true;
@@ -88,8 +86,6 @@ int gui_mc_thermal_calib::startup() {
 
 
 int gui_mc_thermal_calib::step_rt() {
-    host_->sig_output_get_rt(0, &f32_output_signal_store_);
-
     // Feed sampler on every tick — it handles its own decimation
     sampler_.step_rt((double)jcs::external::time_now_ns(), &f32_output_signal_store_);
 
@@ -104,7 +100,7 @@ int gui_mc_thermal_calib::step_rt() {
 
         case state::ramp_to_current_s:
             f32_input_signal_store_[ signal_in_source_i_d_.index_ ] = i_ramp_.step();
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
             if (i_ramp_.is_done()) {
                 // Start holding at current level
                 hold_tick_ = 0;
@@ -117,7 +113,7 @@ int gui_mc_thermal_calib::step_rt() {
 
         case state::hold_step_s:
             // Hold the current level, sampler is recording
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
             hold_tick_++;
             if (hold_tick_ >= hold_tick_max_) {
                 // Move to next step or cooldown
@@ -139,7 +135,7 @@ int gui_mc_thermal_calib::step_rt() {
 
         case state::ramp_to_next_s:
             f32_input_signal_store_[ signal_in_source_i_d_.index_ ] = i_ramp_.step();
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
             if (i_ramp_.is_done()) {
                 if (current_profile_step_ >= static_cast<int>(profile_.size())) {
                     // Entering cooldown phase
@@ -162,7 +158,7 @@ int gui_mc_thermal_calib::step_rt() {
         case state::cooldown_s:
             // Zero current, just recording the cooldown
             f32_input_signal_store_[ signal_in_source_i_d_.index_ ] = 0.0f;
-            host_->sig_input_set_rt(0, f32_input_signal_store_);
+            input_signals_set_rt();
             hold_tick_++;
             if (hold_tick_ >= hold_tick_max_) {
                 state_ = state::finish_s;
@@ -174,14 +170,20 @@ int gui_mc_thermal_calib::step_rt() {
 }
 
 
+void gui_mc_thermal_calib::input_signals_set_rt() {
+    // Only this test's own inputs go to the shared frame
+    gui_if_->f32_input_signal_set_rt(signal_in_source_i_d_.index_, f32_input_signal_store_[ signal_in_source_i_d_.index_ ]);
+}
+
 int gui_mc_thermal_calib::step_rt_always() {
     return jcs::RET_OK;
 }
 
+int gui_mc_thermal_calib::step_gui() {
+    sampler_.step_gui();
 
-int gui_mc_thermal_calib::render() {
     // ---------------------------------------------------------------
-    // State transitions that happen in render (non-RT)
+    // Non RT state transitions. Here rather than render() so the test runs with its device unselected.
     // ---------------------------------------------------------------
     switch (state_) {
         default:
@@ -201,11 +203,17 @@ int gui_mc_thermal_calib::render() {
             // Add some margin
             total_test_time_s += 10;
             if (total_test_time_s > sampler_.get_sample_time_s()) {
-                sampler_.set_sample_time_s(total_test_time_s);
+                // May have been force started
+                sampler_.stop();
+                if (sampler_.set_sample_time_s(total_test_time_s) != jcs::RET_OK) {
+                    std::cout << "Error: Could not set the sampler time to " << total_test_time_s << "s\n";
+                    state_ = state::off_s;
+                    break;
+                }
             }
 
-            // Start JCS host
-            if (gui_if_->start() != jcs::RET_OK) {
+            // Start JCS host, shared with tests on other devices
+            if (gui_if_->job_start(this, false) != jcs::RET_OK) {
                 state_ = state::off_s;
                 break;
             }
@@ -213,9 +221,9 @@ int gui_mc_thermal_calib::render() {
 
             // Start the controller in current DQ mode (d-axis injection, no rotation)
             PARAM_NOTIFY_ACTION( host_->write_enum(target_device_, "controller_mode", "current_dq"),
-                "Parameter failed: controller_mode", state_ = state::off_s; break; )
+                "Parameter failed: controller_mode", gui_if_->job_stop(this); state_ = state::off_s; break; )
             PARAM_NOTIFY_ACTION( host_->write_command(target_device_, "controller_start"),
-                "Parameter failed: controller_start", state_ = state::off_s; break; )
+                "Parameter failed: controller_start", gui_if_->job_stop(this); state_ = state::off_s; break; )
 
             // Begin sampling
             sampler_.start();
@@ -236,11 +244,16 @@ int gui_mc_thermal_calib::render() {
         case state::finish_s:
             f32_input_signal_store_[ signal_in_source_i_d_.index_ ] = 0.0f;
             sampler_.stop();
-            gui_if_->stop();
+            gui_if_->job_stop(this);
             state_ = state::off_s;
             break;
     }
 
+    return jcs::RET_OK;
+}
+
+
+int gui_mc_thermal_calib::render() {
     // ---------------------------------------------------------------
     // UI Layout
     // ---------------------------------------------------------------
@@ -399,9 +412,15 @@ int gui_mc_thermal_calib::render() {
         ImGui::Separator();
         ImGui::Text("Fitting");
 
-        if (ImGui::Button("Derive signals from sampler data")) {
+        bool fit_busy = fit_job_ && fit_job_->active();
+        bool do_derive = false;
+        {
+            ImGuiDisabled derive_disabled(fit_busy);
+            do_derive = ImGui::Button("Derive signals from sampler data");
+        }
+        if (do_derive) {
             // TODO: Extract time, v_d, i_d, t_housing arrays from sampler channels.
-            // The sampler stores data in its scrolling_buffer per channel.
+            // The sampler stores time once and one value column per channel.
             // You will need to expose a method on the sampler or its channels
             // to retrieve the recorded data as a contiguous vector, e.g.:
             //   sampler_.get_channel_data(0, &time_vec, &data_vec);
@@ -452,7 +471,6 @@ int gui_mc_thermal_calib::render() {
             } else {
                 std::cout << "ERROR: Failed to derive signals from sampler data.\n";
             }
-            
         }
 
         if (has_derived_data_) {
@@ -476,47 +494,11 @@ int gui_mc_thermal_calib::render() {
         // Run the fit
         // ---------------------------------------------------------------
         ImGui::Separator();
-        {
+        if (!param_worker::render_job(fit_job_)) {
             ImGuiDisabled fit_disabled(!has_derived_data_);
 
             if (ImGui::Button("Compute thermal model fit")) {
-                mc_thermal_fitter::initial_guess guess;
-                guess.r1 = static_cast<double>(guess_r1_);
-                guess.c1 = static_cast<double>(guess_c1_);
-                guess.r2 = static_cast<double>(guess_r2_);
-                guess.c2 = static_cast<double>(guess_c2_);
-
-                if (model_order_ == model_order::first_order_s) {
-                    fit_result_ = mc_thermal_fitter::fit_1st_order(recorded_data_, guess);
-                } else {
-                    fit_result_ = mc_thermal_fitter::fit_2nd_order(recorded_data_, guess);
-                }
-                has_fit_result_ = true;
-
-                // Reconfigure validation plots to match sampler timebase
-                plot_t1_.update_storage_length(sampler_.get_sample_time_s(), sampler_.get_sample_rate_hz());
-                plot_t2_.update_storage_length(sampler_.get_sample_time_s(), sampler_.get_sample_rate_hz());
-                plot_power_.update_storage_length(sampler_.get_sample_time_s(), sampler_.get_sample_rate_hz());
-
-                // Re-grab channel pointers after resize
-                plot_t1_measured_  = plot_t1_.get_channel("Measured");
-                plot_t1_predicted_ = plot_t1_.get_channel("Predicted");
-                plot_t2_measured_  = plot_t2_.get_channel("Measured");
-                plot_t2_predicted_ = plot_t2_.get_channel("Predicted");
-                plot_power_ch_     = plot_power_.get_channel("Power");
-
-                // Populate validation plots
-                size_t n = fit_result_.t1_predicted.size();
-                for (size_t i = 0; i < n && i < plot_t1_measured_->y_.size(); ++i) {
-                    plot_t1_measured_->y_[i]  = static_cast<float>(recorded_data_.t1_measured[i]);
-                    plot_t1_predicted_->y_[i] = static_cast<float>(fit_result_.t1_predicted[i]);
-                }
-                for (size_t i = 0; i < n && i < plot_t2_measured_->y_.size(); ++i) {
-                    plot_t2_measured_->y_[i]  = static_cast<float>(recorded_data_.t2_measured[i]);
-                    plot_t2_predicted_->y_[i] = static_cast<float>(fit_result_.t2_predicted[i]);
-                }
-
-                std::cout << "Fit result: " << fit_result_.info << "\n";
+                fit_start();
             }
         }
 
@@ -533,7 +515,7 @@ int gui_mc_thermal_calib::render() {
         ImGui::Separator();
         ImGui::Text("Write results to device");
         {
-            ImGuiDisabled write_disabled(!has_fit_result_ || !fit_result_.converged);
+            ImGuiDisabled write_disabled(!has_fit_result_ || !fit_result_.converged || fit_busy);
 
             if (ImGui::Button("Write thermal model to device")) {
                 PARAM_NOTIFY( host_->write_float(target_device_, "thermal_model_r1",
@@ -655,7 +637,6 @@ void gui_mc_thermal_calib::render_profile_editor() {
         ImGui::TableSetupColumn("Duration (s)", ImGuiTableColumnFlags_WidthFixed, 150.0f);
         ImGui::TableHeadersRow();
 
-        int remove_idx = -1;
         for (int i = 0; i < static_cast<int>(profile_.size()); ++i) {
             ImGui::TableNextRow();
             ImGui::PushID(i);
@@ -698,6 +679,69 @@ void gui_mc_thermal_calib::render_profile_editor() {
 }
 
 
+void gui_mc_thermal_calib::fit_start() {
+    mc_thermal_fitter::initial_guess guess;
+    guess.r1 = static_cast<double>(guess_r1_);
+    guess.c1 = static_cast<double>(guess_c1_);
+    guess.r2 = static_cast<double>(guess_r2_);
+    guess.c2 = static_cast<double>(guess_c2_);
+    bool is_2nd = (model_order_ == model_order::second_order_s);
+
+    // The job owns a copy of the data and its result
+    std::shared_ptr<mc_thermal_fitter::recorded_data const> data = std::make_shared<mc_thermal_fitter::recorded_data>(recorded_data_);
+    std::shared_ptr<mc_thermal_fitter::fit_result> result = std::make_shared<mc_thermal_fitter::fit_result>();
+
+    fit_job_ = gui_if_->get_param_worker()->submit("Thermal model fit", [data, result, guess, is_2nd](param_job& job) {
+        mc_thermal_fitter::fit_progress progress = [&job](int iteration, int max_iterations, double rms) {
+            job.progress_set(static_cast<float>(iteration) / static_cast<float>(max_iterations),
+                             "Iteration " + std::to_string(iteration) + ", RMS " + std::to_string(rms) + " K");
+            return !job.cancel_requested();
+        };
+        if (is_2nd) {
+            *result = mc_thermal_fitter::fit_2nd_order(*data, guess, progress);
+        } else {
+            *result = mc_thermal_fitter::fit_1st_order(*data, guess, progress);
+        }
+        return jcs::RET_OK;
+    }, [this, result](param_job& job) {
+        if (job.get_status() != param_job::status::done) {
+            std::cout << "Fit stopped: " << result->info << "\n";
+            return;
+        }
+        fit_apply(*result);
+    }, target_device_ + "/fit");
+}
+
+void gui_mc_thermal_calib::fit_apply(mc_thermal_fitter::fit_result const& result) {
+    fit_result_ = result;
+    has_fit_result_ = true;
+
+    // Reconfigure validation plots to match sampler timebase
+    plot_t1_.update_storage_length(sampler_.get_sample_time_s(), sampler_.get_sample_rate_hz());
+    plot_t2_.update_storage_length(sampler_.get_sample_time_s(), sampler_.get_sample_rate_hz());
+    plot_power_.update_storage_length(sampler_.get_sample_time_s(), sampler_.get_sample_rate_hz());
+
+    // Re-grab channel pointers after resize
+    plot_t1_measured_  = plot_t1_.get_channel("Measured");
+    plot_t1_predicted_ = plot_t1_.get_channel("Predicted");
+    plot_t2_measured_  = plot_t2_.get_channel("Measured");
+    plot_t2_predicted_ = plot_t2_.get_channel("Predicted");
+    plot_power_ch_     = plot_power_.get_channel("Power");
+
+    // Populate validation plots
+    size_t n = fit_result_.t1_predicted.size();
+    for (size_t i = 0; i < n && i < plot_t1_measured_->y_.size(); ++i) {
+        plot_t1_measured_->y_[i]  = static_cast<float>(recorded_data_.t1_measured[i]);
+        plot_t1_predicted_->y_[i] = static_cast<float>(fit_result_.t1_predicted[i]);
+    }
+    for (size_t i = 0; i < n && i < plot_t2_measured_->y_.size(); ++i) {
+        plot_t2_measured_->y_[i]  = static_cast<float>(recorded_data_.t2_measured[i]);
+        plot_t2_predicted_->y_[i] = static_cast<float>(fit_result_.t2_predicted[i]);
+    }
+
+    std::cout << "Fit result: " << fit_result_.info << "\n";
+}
+
 void gui_mc_thermal_calib::render_fit_results() {
     ImGui::Separator();
     ImGui::Text("Fit results");
@@ -24,8 +24,13 @@ public:
     int step_rt();
     int step_rt_always();
     int render();    
+    int step_gui();
+    bool job_active() { return state_ != state::off_s; }
 
 private:
+    // Shared base rate outputs, see gui_interface
+    std::vector<float> const& f32_output_signal_store_;
+
     // ---------------------------------------------------------------
     // State machine
     // ---------------------------------------------------------------
@@ -42,11 +47,17 @@ private:
 
     int ready_test();
     void get_test_parameters();
+    void input_signals_set_rt();
     void render_profile_editor();
     void render_prerequisites();
     void render_fit_results();
     void render_fit_plots();
 
+    // Fit runs on the parameter worker, on its own lane so parameter traffic is not held up
+    param_job_ptr fit_job_;
+    void fit_start();
+    void fit_apply(mc_thermal_fitter::fit_result const& result);
+
     bool is_ready_;
     bool can_start_;
 
@@ -82,8 +93,8 @@ private:
     // ---------------------------------------------------------------
     // Signal storage and routing
     // ---------------------------------------------------------------
+    // Inputs driven by this test, see input_signals_set_rt()
     std::vector<float> f32_input_signal_store_;
-    std::vector<float> f32_output_signal_store_;
 
     // Input signal: d-axis current command
     helpers::combo_source signal_in_source_i_d_;
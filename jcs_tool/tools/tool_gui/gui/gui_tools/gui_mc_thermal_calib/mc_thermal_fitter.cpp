@@ -8,8 +8,8 @@
 #include <sstream>
 
 #include <Eigen/Dense>
-#include <unsupported/Eigen/NumericalDiff>
 #include <unsupported/Eigen/LevenbergMarquardt>
+#include <unsupported/Eigen/MatrixFunctions>
 
 using namespace Eigen;
 
@@ -18,57 +18,202 @@ using namespace Eigen;
 // ===================================================================
 namespace {
 
-// Forward Euler simulation of 1st order thermal model.
-// T2 is taken from measured data (thermistor).
-void sim_1st_order(const mc_thermal_fitter::recorded_data& data,
-                   double r1, double c1,
-                   std::vector<double>& t1_out)
+// ===================================================================
+// Linear thermal network, x' = A x + B u
+//
+// Positivity enforcement via log-parameterisation: we optimise over
+// log(param), so the actual parameter is exp(x) which is always > 0.
+// This also gives LM uniform sensitivity across orders of magnitude —
+// a step of 0.1 in log-space is 10% regardless of the absolute value.
+// The initial guess is passed as log(guess); results are exp()'d back.
+//
+// da[k], db[k] are dA/dlog(p_k), dB/dlog(p_k). The sensitivities
+// S_k = dx/dlog(p_k) follow S_k' = A S_k + da[k] x + db[k] u.
+// ===================================================================
+struct thermal_model {
+    MatrixXd a;
+    MatrixXd b;
+    std::vector<MatrixXd> da;
+    std::vector<MatrixXd> db;
+};
+
+// x = [T1], u = [P, T2_measured], p = [R1, C1]
+thermal_model model_1st_order(double r1, double c1)
 {
-    const size_t n = data.time_s.size();
-    t1_out.resize(n);
+    const double g1 = 1.0 / (r1 * c1);
+    thermal_model m;
+    m.a = MatrixXd::Constant(1, 1, -g1);
+    m.b.resize(1, 2);
+    m.b << 1.0 / c1, g1;
+
+    m.da.assign(2, MatrixXd::Constant(1, 1, g1));
+    m.db.assign(2, MatrixXd::Zero(1, 2));
+    m.db[0] << 0.0, -g1;
+    m.db[1] << -1.0 / c1, -g1;
+    return m;
+}
+
+// x = [T1, T2], u = [P, Ta], p = [R1, C1, R2, C2]
+thermal_model model_2nd_order(double r1, double c1, double r2, double c2)
+{
+    const double g1  = 1.0 / (r1 * c1);
+    const double g12 = 1.0 / (r1 * c2);
+    const double g2  = 1.0 / (r2 * c2);
+    thermal_model m;
+    m.a.resize(2, 2);
+    m.a << -g1,  g1,
+            g12, -g12 - g2;
+    m.b.resize(2, 2);
+    m.b << 1.0 / c1, 0.0,
+           0.0,      g2;
+
+    m.da.assign(4, MatrixXd::Zero(2, 2));
+    m.db.assign(4, MatrixXd::Zero(2, 2));
+    // R1
+    m.da[0] <<  g1,  -g1,
+               -g12,  g12;
+    // C1
+    m.da[1] << g1, -g1,
+               0.0, 0.0;
+    m.db[1](0, 0) = -1.0 / c1;
+    // R2
+    m.da[2](1, 1) = g2;
+    m.db[2](1, 1) = -g2;
+    // C2
+    m.da[3] <<  0.0,  0.0,
+               -g12,  g12 + g2;
+    m.db[3](1, 1) = -g2;
+    return m;
+}
 
-    double t1 = data.t_initial;
-    t1_out[0] = t1;
+// Exact discretisation with inputs held over each sample (zero-order hold).
+// The state z = [x; S_1; ...; S_p] and input u form one linear system:
+//   exp([[M, N], [0, 0]] * dt) = [[Ad, Bd], [0, I]]
+// Recorded timestamps are float, so dt takes a handful of distinct values.
+// (Ad, Bd) are cached per dt.
+class zoh_stepper {
+public:
+    zoh_stepper(const thermal_model& m, bool sensitivities) : next_(0)
+    {
+        const int nx = static_cast<int>(m.a.rows());
+        const int nu = static_cast<int>(m.b.cols());
+        const int np = sensitivities ? static_cast<int>(m.da.size()) : 0;
+        nz_ = nx * (1 + np);
+        z_next_.resize(nz_);
+
+        mc_ = MatrixXd::Zero(nz_ + nu, nz_ + nu);
+        for (int k = 0; k <= np; ++k) {
+            mc_.block(k * nx, k * nx, nx, nx) = m.a;
+        }
+        mc_.block(0, nz_, nx, nu) = m.b;
+        for (int k = 0; k < np; ++k) {
+            mc_.block((k + 1) * nx, 0, nx, nx)  = m.da[k];
+            mc_.block((k + 1) * nx, nz_, nx, nu) = m.db[k];
+        }
+    }
 
-    for (size_t i = 1; i < n; ++i) {
-        double dt = data.time_s[i] - data.time_s[i - 1];
-        double p  = data.power_w[i - 1];
-        double t2 = data.t2_measured[i - 1];
+    int size() const { return nz_; }
 
-        double dT1 = (1.0 / c1) * (p - (t1 - t2) / r1) * dt;
-        t1 += dT1;
-        t1_out[i] = t1;
+    void step(double dt, const VectorXd& u, VectorXd* z)
+    {
+        const entry& e = discretise(dt);
+        // No temporaries, this runs once per sample
+        z_next_.noalias() = e.ad * (*z);
+        z_next_.noalias() += e.bd * u;
+        z->swap(z_next_);
     }
-}
 
-// Forward Euler simulation of 2nd order thermal model.
-void sim_2nd_order(const mc_thermal_fitter::recorded_data& data,
-                   double r1, double c1, double r2, double c2,
-                   std::vector<double>& t1_out,
-                   std::vector<double>& t2_out)
-{
-    const size_t n = data.time_s.size();
-    t1_out.resize(n);
-    t2_out.resize(n);
+private:
+    struct entry {
+        double dt;
+        MatrixXd ad;
+        MatrixXd bd;
+    };
 
-    double t1 = data.t_initial;
-    double t2 = data.t_initial;
-    t1_out[0] = t1;
-    t2_out[0] = t2;
+    const entry& discretise(double dt)
+    {
+        for (size_t i = 0; i < cache_.size(); ++i) {
+            if (cache_[i].dt == dt) {
+                return cache_[i];
+            }
+        }
+        MatrixXd e = (mc_ * dt).exp();
+        entry n;
+        n.dt = dt;
+        n.ad = e.topLeftCorner(nz_, nz_);
+        n.bd = e.topRightCorner(nz_, mc_.cols() - nz_);
+
+        const size_t cache_size = 16;
+        if (cache_.size() < cache_size) {
+            cache_.push_back(n);
+            return cache_.back();
+        }
+        cache_[next_] = n;
+        const entry& r = cache_[next_];
+        next_ = (next_ + 1) % cache_size;
+        return r;
+    }
 
-    double ta = data.t_ambient;
+    int nz_;
+    MatrixXd mc_;
+    VectorXd z_next_;
+    std::vector<entry> cache_;
+    size_t next_;
+};
 
-    for (size_t i = 1; i < n; ++i) {
-        double dt = data.time_s[i] - data.time_s[i - 1];
-        double p  = data.power_w[i - 1];
+thermal_model model_from_log_params(const VectorXd& x)
+{
+    if (x.size() == 2) {
+        return model_1st_order(std::exp(x(0)), std::exp(x(1)));
+    }
+    return model_2nd_order(std::exp(x(0)), std::exp(x(1)), std::exp(x(2)), std::exp(x(3)));
+}
 
-        double dT1 = (1.0 / c1) * (p - (t1 - t2) / r1) * dt;
-        double dT2 = (1.0 / c2) * ((t1 - t2) / r1 - (t2 - ta) / r2) * dt;
+// Simulate the model over the recorded inputs. Any output may be null.
+//   x_out:  states, state j of sample i at [i + j*n]
+//   fvec:   residuals against the measured states, same layout
+//   fjac:   d(residual)/dlog(p), one column per parameter
+void run_model(const mc_thermal_fitter::recorded_data& data,
+               const thermal_model& m,
+               std::vector<double>* x_out,
+               VectorXd* fvec,
+               MatrixXd* fjac)
+{
+    const int n  = static_cast<int>(data.time_s.size());
+    const int nx = static_cast<int>(m.a.rows());
+    const int np = static_cast<int>(m.da.size());
+    const bool second_order = (nx == 2);
+    const std::vector<double>* measured[2] = { &data.t1_measured, &data.t2_measured };
+
+    zoh_stepper stepper(m, fjac != nullptr);
+    VectorXd z = VectorXd::Zero(stepper.size());
+    VectorXd u(2);
+    for (int j = 0; j < nx; ++j) {
+        z(j) = data.t_initial;
+    }
+    if (x_out != nullptr) {
+        x_out->resize(n * nx);
+    }
 
-        t1 += dT1;
-        t2 += dT2;
-        t1_out[i] = t1;
-        t2_out[i] = t2;
+    for (int i = 0; i < n; ++i) {
+        if (i > 0) {
+            u(0) = data.power_w[i - 1];
+            u(1) = second_order ? data.t_ambient : data.t2_measured[i - 1];
+            stepper.step(data.time_s[i] - data.time_s[i - 1], u, &z);
+        }
+        for (int j = 0; j < nx; ++j) {
+            if (x_out != nullptr) {
+                (*x_out)[i + j * n] = z(j);
+            }
+            if (fvec != nullptr) {
+                (*fvec)(i + j * n) = z(j) - (*measured[j])[i];
+            }
+            if (fjac != nullptr) {
+                for (int k = 0; k < np; ++k) {
+                    (*fjac)(i + j * n, k) = z((k + 1) * nx + j);
+                }
+            }
+        }
     }
 }
 
@@ -84,80 +229,27 @@ double compute_rms(const std::vector<double>& predicted, const std::vector<doubl
 }
 
 // ===================================================================
-// Eigen LM functors
-//
-// Positivity enforcement via log-parameterisation: we optimise over
-// log(param), so the actual parameter is exp(x) which is always > 0.
-// This also gives LM uniform sensitivity across orders of magnitude —
-// a step of 0.1 in log-space is 10% regardless of the absolute value.
-// The initial guess is passed as log(guess); results are exp()'d back.
+// Eigen LM functor with an analytic Jacobian.
+// 1st order: [log(R1), log(C1)], n residuals on T1.
+// 2nd order: [log(R1), log(C1), log(R2), log(C2)], 2*n residuals (T1 then T2).
 // ===================================================================
-
-// 1st order functor: 2 parameters [log(R1), log(C1)], n_samples residuals on T1
-struct Functor1stOrder : Eigen::DenseFunctor<double> {
+struct thermal_functor : Eigen::DenseFunctor<double> {
     const mc_thermal_fitter::recorded_data* data;
 
-    Functor1stOrder(const mc_thermal_fitter::recorded_data* d)
-        : DenseFunctor<double>(2, static_cast<int>(d->time_s.size())), data(d) {}
+    thermal_functor(const mc_thermal_fitter::recorded_data* d, bool second_order)
+        : DenseFunctor<double>(second_order ? 4 : 2,
+                               static_cast<int>(d->time_s.size()) * (second_order ? 2 : 1)),
+          data(d) {}
 
     int operator()(const InputType& x, ValueType& fvec) const
     {
-        double r1 = std::exp(x(0));
-        double c1 = std::exp(x(1));
-
-        const int n = static_cast<int>(data->time_s.size());
-        double t1 = data->t_initial;
-        fvec(0) = t1 - data->t1_measured[0];
-
-        for (int i = 1; i < n; ++i) {
-            double dt = data->time_s[i] - data->time_s[i - 1];
-            double p  = data->power_w[i - 1];
-            double t2 = data->t2_measured[i - 1];
-
-            double dT1 = (1.0 / c1) * (p - (t1 - t2) / r1) * dt;
-            t1 += dT1;
-            fvec(i) = t1 - data->t1_measured[i];
-        }
+        run_model(*data, model_from_log_params(x), nullptr, &fvec, nullptr);
         return 0;
     }
-};
 
-// 2nd order functor: 4 parameters [log(R1), log(C1), log(R2), log(C2)],
-// 2*n_samples residuals (T1 and T2 interleaved)
-struct Functor2ndOrder : Eigen::DenseFunctor<double> {
-    const mc_thermal_fitter::recorded_data* data;
-
-    Functor2ndOrder(const mc_thermal_fitter::recorded_data* d)
-        : DenseFunctor<double>(4, static_cast<int>(d->time_s.size()) * 2), data(d) {}
-
-    int operator()(const InputType& x, ValueType& fvec) const
+    int df(const InputType& x, JacobianType& fjac) const
     {
-        double r1 = std::exp(x(0));
-        double c1 = std::exp(x(1));
-        double r2 = std::exp(x(2));
-        double c2 = std::exp(x(3));
-
-        const int n = static_cast<int>(data->time_s.size());
-        double t1 = data->t_initial;
-        double t2 = data->t_initial;
-        double ta = data->t_ambient;
-
-        fvec(0)     = t1 - data->t1_measured[0];
-        fvec(0 + n) = t2 - data->t2_measured[0];
-
-        for (int i = 1; i < n; ++i) {
-            double dt = data->time_s[i] - data->time_s[i - 1];
-            double p  = data->power_w[i - 1];
-
-            double dT1 = (1.0 / c1) * (p - (t1 - t2) / r1) * dt;
-            double dT2 = (1.0 / c2) * ((t1 - t2) / r1 - (t2 - ta) / r2) * dt;
-
-            t1 += dT1;
-            t2 += dT2;
-
-            fvec(i)     = t1 - data->t1_measured[i];
-            fvec(i + n) = t2 - data->t2_measured[i];
-        }
+        run_model(*data, model_from_log_params(x), nullptr, nullptr, &fjac);
         return 0;
     }
 };
@@ -186,6 +278,98 @@ bool lm_converged(Eigen::LevenbergMarquardtSpace::Status s) {
         && s <= Eigen::LevenbergMarquardtSpace::GtolTooSmall;
 }
 
+mc_thermal_fitter::fit_result fit_model(
+    const mc_thermal_fitter::recorded_data& data,
+    const mc_thermal_fitter::initial_guess& guess,
+    bool second_order,
+    mc_thermal_fitter::fit_progress progress)
+{
+    mc_thermal_fitter::fit_result result;
+    result.r1 = guess.r1;
+    result.c1 = guess.c1;
+    result.r2 = second_order ? guess.r2 : 0.0;
+    result.c2 = second_order ? guess.c2 : 0.0;
+    result.rms_error_t1 = 0.0;
+    result.rms_error_t2 = 0.0;
+    result.iterations = 0;
+    result.converged = false;
+    result.info = "";
+
+    if (data.time_s.size() < 10) {
+        result.info = "Insufficient data (need at least 10 samples)";
+        return result;
+    }
+
+    thermal_functor functor(&data, second_order);
+    Eigen::LevenbergMarquardt<thermal_functor> lm(functor);
+
+    const int max_fev = second_order ? 2000 : 1000;
+    lm.setMaxfev(max_fev);
+    lm.setXtol(1.0e-10);
+    lm.setFtol(1.0e-10);
+    lm.setGtol(1.0e-10);
+
+    // Initial parameters: log() because the model uses exp() for positivity
+    VectorXd x(second_order ? 4 : 2);
+    x(0) = std::log(guess.r1);
+    x(1) = std::log(guess.c1);
+    if (second_order) {
+        x(2) = std::log(guess.r2);
+        x(3) = std::log(guess.c2);
+    }
+
+    // Step by step so progress can be reported and the fit cancelled
+    bool cancelled = false;
+    auto status = lm.minimizeInit(x);
+    if (status != Eigen::LevenbergMarquardtSpace::ImproperInputParameters) {
+        do {
+            status = lm.minimizeOneStep(x);
+            if (progress) {
+                double rms = lm.fnorm() / std::sqrt(static_cast<double>(functor.values()));
+                if (!progress(static_cast<int>(lm.iterations()), max_fev, rms)) {
+                    cancelled = true;
+                    break;
+                }
+            }
+        } while (status == Eigen::LevenbergMarquardtSpace::Running);
+    }
+
+    // exp() back to get actual parameter values
+    result.r1 = std::exp(x(0));
+    result.c1 = std::exp(x(1));
+    if (second_order) {
+        result.r2 = std::exp(x(2));
+        result.c2 = std::exp(x(3));
+    }
+    result.iterations = static_cast<int>(lm.iterations());
+    result.converged = !cancelled && lm_converged(status);
+
+    // Validation traces
+    if (second_order) {
+        mc_thermal_fitter::simulate_2nd_order(data, result.r1, result.c1, result.r2, result.c2,
+                                              &result.t1_predicted, &result.t2_predicted);
+    } else {
+        mc_thermal_fitter::simulate_1st_order(data, result.r1, result.c1, &result.t1_predicted);
+        result.t2_predicted = data.t2_measured;
+    }
+
+    result.rms_error_t1 = compute_rms(result.t1_predicted, data.t1_measured);
+    if (second_order) {
+        result.rms_error_t2 = compute_rms(result.t2_predicted, data.t2_measured);
+    }
+
+    std::ostringstream ss;
+    ss << (cancelled ? "Cancelled" : lm_status_string(status))
+       << " in " << result.iterations << " iterations. "
+       << "RMS T1 error: " << result.rms_error_t1 << " K";
+    if (second_order) {
+        ss << ", RMS T2 error: " << result.rms_error_t2 << " K";
+    }
+    result.info = ss.str();
+
+    return result;
+}
+
 } // anonymous namespace
 
 // ===================================================================
@@ -341,123 +525,19 @@ mc_thermal_fitter::initial_guess mc_thermal_fitter::estimate_initial_params(
 
 mc_thermal_fitter::fit_result mc_thermal_fitter::fit_1st_order(
     const recorded_data& data,
-    const initial_guess& guess)
+    const initial_guess& guess,
+    fit_progress progress)
 {
-    fit_result result;
-    result.r1 = guess.r1;
-    result.c1 = guess.c1;
-    result.r2 = 0.0;
-    result.c2 = 0.0;
-    result.rms_error_t1 = 0.0;
-    result.rms_error_t2 = 0.0;
-    result.iterations = 0;
-    result.converged = false;
-    result.info = "";
-
-    if (data.time_s.size() < 10) {
-        result.info = "Insufficient data (need at least 10 samples)";
-        return result;
-    }
-
-    // Set up functor + NumericalDiff for automatic Jacobian
-    Functor1stOrder functor(&data);
-    Eigen::NumericalDiff<Functor1stOrder> num_diff(functor);
-    Eigen::LevenbergMarquardt<Eigen::NumericalDiff<Functor1stOrder>> lm(num_diff);
-
-    lm.setMaxfev(1000);
-    lm.setXtol(1.0e-10);
-    lm.setFtol(1.0e-10);
-    lm.setGtol(1.0e-10);
-
-    // Initial parameters: log() because functor uses exp() for positivity
-    VectorXd x(2);
-    x(0) = std::log(guess.r1);
-    x(1) = std::log(guess.c1);
-
-    auto status = lm.minimize(x);
-
-    // exp() back to get actual parameter values
-    result.r1 = std::exp(x(0));
-    result.c1 = std::exp(x(1));
-    result.iterations = static_cast<int>(lm.iterations());
-    result.converged = lm_converged(status);
-
-    // Validation traces
-    sim_1st_order(data, result.r1, result.c1, result.t1_predicted);
-    result.t2_predicted = data.t2_measured;
-
-    result.rms_error_t1 = compute_rms(result.t1_predicted, data.t1_measured);
-
-    std::ostringstream ss;
-    ss << lm_status_string(status)
-       << " in " << result.iterations << " iterations. "
-       << "RMS T1 error: " << result.rms_error_t1 << " K";
-    result.info = ss.str();
-
-    return result;
+    return fit_model(data, guess, false, progress);
 }
 
 
 mc_thermal_fitter::fit_result mc_thermal_fitter::fit_2nd_order(
     const recorded_data& data,
-    const initial_guess& guess)
+    const initial_guess& guess,
+    fit_progress progress)
 {
-    fit_result result;
-    result.r1 = guess.r1;
-    result.c1 = guess.c1;
-    result.r2 = guess.r2;
-    result.c2 = guess.c2;
-    result.rms_error_t1 = 0.0;
-    result.rms_error_t2 = 0.0;
-    result.iterations = 0;
-    result.converged = false;
-    result.info = "";
-
-    if (data.time_s.size() < 10) {
-        result.info = "Insufficient data (need at least 10 samples)";
-        return result;
-    }
-
-    Functor2ndOrder functor(&data);
-    Eigen::NumericalDiff<Functor2ndOrder> num_diff(functor);
-    Eigen::LevenbergMarquardt<Eigen::NumericalDiff<Functor2ndOrder>> lm(num_diff);
-
-    lm.setMaxfev(2000);
-    lm.setXtol(1.0e-10);
-    lm.setFtol(1.0e-10);
-    lm.setGtol(1.0e-10);
-
-    VectorXd x(4);
-    x(0) = std::log(guess.r1);
-    x(1) = std::log(guess.c1);
-    x(2) = std::log(guess.r2);
-    x(3) = std::log(guess.c2);
-
-    auto status = lm.minimize(x);
-
-    result.r1 = std::exp(x(0));
-    result.c1 = std::exp(x(1));
-    result.r2 = std::exp(x(2));
-    result.c2 = std::exp(x(3));
-    result.iterations = static_cast<int>(lm.iterations());
-    result.converged = lm_converged(status);
-
-    std::vector<double> t1_pred, t2_pred;
-    sim_2nd_order(data, result.r1, result.c1, result.r2, result.c2, t1_pred, t2_pred);
-    result.t1_predicted = std::move(t1_pred);
-    result.t2_predicted = std::move(t2_pred);
-
-    result.rms_error_t1 = compute_rms(result.t1_predicted, data.t1_measured);
-    result.rms_error_t2 = compute_rms(result.t2_predicted, data.t2_measured);
-
-    std::ostringstream ss;
-    ss << lm_status_string(status)
-       << " in " << result.iterations << " iterations. "
-       << "RMS T1 error: " << result.rms_error_t1 << " K, "
-       << "RMS T2 error: " << result.rms_error_t2 << " K";
-    result.info = ss.str();
-
-    return result;
+    return fit_model(data, guess, true, progress);
 }
 
 
@@ -466,7 +546,7 @@ void mc_thermal_fitter::simulate_1st_order(
     double r1, double c1,
     std::vector<double>* t1_out)
 {
-    sim_1st_order(data, r1, c1, *t1_out);
+    run_model(data, model_1st_order(r1, c1), t1_out, nullptr, nullptr);
 }
 
 
@@ -476,7 +556,11 @@ void mc_thermal_fitter::simulate_2nd_order(
     std::vector<double>* t1_out,
     std::vector<double>* t2_out)
 {
-    sim_2nd_order(data, r1, c1, r2, c2, *t1_out, *t2_out);
+    std::vector<double> x;
+    run_model(data, model_2nd_order(r1, c1, r2, c2), &x, nullptr, nullptr);
+    const size_t n = data.time_s.size();
+    t1_out->assign(x.begin(), x.begin() + n);
+    t2_out->assign(x.begin() + n, x.end());
 }
 
 
@@ -6,11 +6,17 @@
 // time-series data of power dissipated, winding temperature (from V/I),
 // and housing temperature (from thermistor).
 //
-// Dependencies: Eigen3, lsqcpp (header-only, on top of Eigen)
+// The models are discretised exactly with inputs held between samples
+// (zero-order hold), so results do not depend on the sample rate. The
+// Jacobian comes from forward sensitivity equations propagated with the
+// state, one simulation pass per LM iteration.
+//
+// Dependencies: Eigen3 (Eigen/Dense, unsupported LevenbergMarquardt and MatrixFunctions)
 //
 #ifndef MC_THERMAL_FITTER_H_
 #define MC_THERMAL_FITTER_H_
 
+#include <functional>
 #include <vector>
 #include <string>
 
@@ -69,17 +75,23 @@ namespace mc_thermal_fitter {
     // Fit functions
     // ---------------------------------------------------------------
 
+    // Called after each LM iteration with the iteration count, the limit and the
+    // current RMS residual [K]. Return false to stop the fit.
+    typedef std::function<bool(int iteration, int max_iterations, double rms)> fit_progress;
+
     // Fit a 1st order thermal model (R1, C1 only).
     // T2 is treated as measured (thermistor).
     // dT1/dt = (1/C1) * (P - (T1 - T2_measured) / R1)
     fit_result fit_1st_order(const recorded_data& data,
-                             const initial_guess& guess);
+                             const initial_guess& guess,
+                             fit_progress progress = nullptr);
 
     // Fit a 2nd order thermal model (R1, C1, R2, C2).
     // dT1/dt = (1/C1) * (P - (T1 - T2) / R1)
     // dT2/dt = (1/C2) * ((T1 - T2) / R1 - (T2 - Ta) / R2)
     fit_result fit_2nd_order(const recorded_data& data,
-                             const initial_guess& guess);
+                             const initial_guess& guess,
+                             fit_progress progress = nullptr);
 
     // ---------------------------------------------------------------
     // Simulation — for validation and plotting
@@ -6,15 +6,48 @@
 #include "helpers.h"
 #include "imgui_helpers.h"
 #include <cmath>
+#include <memory>
 #include "jcs_dev_motor_controller.h"
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Wait for a started test to complete. Stops the controller if the job is cancelled.
+static int test_wait(jcs::jcs_host* host, std::string const& target, param_job& job, int test_time_ms) {
+    auto cancelled = [&]() {
+        std::cout << "Test cancelled\n";
+        PARAM_NOTIFY( host->write_command(target, "controller_stop"), "Parameter failed: controller_stop" )
+        return jcs::RET_ERROR;
+    };
+
+    // Check for error
+    bool test_error = true;
+    if (!job.sleep_ms(100)) { return cancelled(); }
+    PARAM_NOTIFY_ERROR( host->read_bool(target, "controller_is_error", &test_error), "Parameter failed: controller_is_error" )
+    if (test_error) {
+        std::cout << "ERROR: controller_start failed to start the test. Check that motor controller is ready to go.\n";
+        return jcs::RET_ERROR;
+    }
+
+    // Wait for completion
+    long int time_start_ms = helpers::time_now_ms();
+    bool running = true;
+    do {
+        if (!job.sleep_ms(100)) { return cancelled(); }
+        PARAM_NOTIFY_ERROR( host->read_bool(target, "controller_is_running", &running), "Parameter failed: controller_is_running" )
+        float fraction = (test_time_ms > 0) ? (float)(helpers::time_now_ms() - time_start_ms) / (float)test_time_ms : 0.0f;
+        job.progress_set((fraction < 1.0f) ? fraction : 1.0f, "Running");
+    } while (running);
+    job.progress_set(1.0f, "Settling");
+    if (!job.sleep_ms(test_settle_ms)) { return cancelled(); }
+    return jcs::RET_OK;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 // test_resistance
 test_resistance::test_resistance()
     : amplitude(1.0f), time_ms(3000), ramp_ms(500), result(0.0f)
 {}
 
-void test_resistance::render_ui() {
+void test_resistance::render_ui(bool show_result) {
     ImGui::PushID("test_r");
     ImGui::Separator();
     ImGui::Text("Phase resistance test parameters");
@@ -38,42 +71,40 @@ void test_resistance::render_ui() {
         }
     }
 
-    ImGui::Text("Measured resistance (Ohms): %.6f", result);
-    helpers::result_text_copyable("motor_Rs: ", result);
+    if (show_result) {
+        ImGui::Text("Measured resistance (Ohms): %.6f", result);
+        helpers::result_text_copyable("motor_Rs: ", result);
+    }
     ImGui::PopID();
 }
 
-int test_resistance::execute(jcs::jcs_host* host, std::string const& target) {
+int test_resistance::execute(jcs::jcs_host* host, std::string const& target, param_job& job, float* result_out) {
     std::cout << "Reading synchronous resistance\n";
 
+    if (start(host, target) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    if (test_wait(host, target, job, ramp_ms + time_ms) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    return result_read(host, target, result_out);
+}
+
+int test_resistance::start(jcs::jcs_host* host, std::string const& target) {
     PARAM_NOTIFY_ERROR( host->write_float(target,  "test_rs_v_dq_test_amplitude", amplitude), "Parameter failed: test_rs_v_dq_test_amplitude" )
     PARAM_NOTIFY_ERROR( host->write_uint16(target, "test_rs_test_time_ms",        time_ms),   "Parameter failed: test_rs_test_time_ms" )
     PARAM_NOTIFY_ERROR( host->write_uint16(target, "test_rs_ramp_time_ms",        ramp_ms),   "Parameter failed: test_rs_ramp_time_ms" )
 
     PARAM_NOTIFY_ERROR( host->write_enum(target,    "controller_mode", "test_rs"), "Parameter failed: controller_mode" )
     PARAM_NOTIFY_ERROR( host->write_command(target, "controller_start"),           "Parameter failed: controller_start" )
+    return jcs::RET_OK;
+}
 
-    // Check for error
-    bool test_error = true;
-    helpers::sleep_ms(100);
-    PARAM_NOTIFY_ERROR( host->read_bool(target, "controller_is_error", &test_error), "Parameter failed: controller_is_error" )
-    if (test_error) {
-        std::cout << "ERROR: controller_start failed to start the test. Check that motor controller is ready to go.\n";
-        return jcs::RET_ERROR;
-    }
-
-    // Wait for completion
-    bool running = true;
-    do {
-        helpers::sleep_ms(100);
-        PARAM_NOTIFY_ERROR( host->read_bool(target, "controller_is_running", &running), "Parameter failed: controller_is_running" )
-    } while (running);
-    helpers::sleep_ms(2000);
-
-    // Read result
-    result = 0.0f;
-    PARAM_NOTIFY_ERROR( host->read_float(target, "motor_Rs", &result), "Res read failed: motor_Rs" )
-    std::cout << "Got resistance: " << result << " Ohms\n\n";
+int test_resistance::result_read(jcs::jcs_host* host, std::string const& target, float* result_out) {
+    float value = 0.0f;
+    PARAM_NOTIFY_ERROR( host->read_float(target, "motor_Rs", &value), "Res read failed: motor_Rs" )
+    std::cout << target << ": Got resistance: " << value << " Ohms\n\n";
+    *result_out = value;
 
     return jcs::RET_OK;
 }
@@ -86,7 +117,7 @@ test_inductance::test_inductance(std::string const& axis)
       result(0.0f)
 {}
 
-void test_inductance::render_ui() {
+void test_inductance::render_ui(bool show_result) {
     ImGui::PushID((axis + "l").c_str());
     ImGui::Separator();
     ImGui::Text("Phase inductance test parameters for %s-axis", axis.c_str());
@@ -128,14 +159,26 @@ void test_inductance::render_ui() {
         }
     }
 
-    ImGui::Text("Measured inductance (H): %.6f, %.6f (uH)", result, result * 1000000.0f);
-    helpers::result_text_copyable("motor_L" + axis + ": ", result);
+    if (show_result) {
+        ImGui::Text("Measured inductance (H): %.6f, %.6f (uH)", result, result * 1000000.0f);
+        helpers::result_text_copyable("motor_L" + axis + ": ", result);
+    }
     ImGui::PopID();
 }
 
-int test_inductance::execute(jcs::jcs_host* host, std::string const& target) {
+int test_inductance::execute(jcs::jcs_host* host, std::string const& target, param_job& job, float* result_out) {
     std::cout << "Reading " << axis << " axis phase inductance\n";
 
+    if (start(host, target) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    if (test_wait(host, target, job, ramp_ms + settle_ms + time_ms) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    return result_read(host, target, result_out);
+}
+
+int test_inductance::start(jcs::jcs_host* host, std::string const& target) {
     std::string meas_axis = axis == "d" ? "measure_test_axis_d" : "measure_test_axis_q";
     PARAM_NOTIFY_ERROR( host->write_enum(target,   "test_ls_dq_test_axis",   meas_axis),  "Parameter failed: test_ls_dq_test_axis" )
     PARAM_NOTIFY_ERROR( host->write_float(target,  "test_ls_v_dq_bias",      bias),       "Parameter failed: test_ls_v_dq_bias" )
@@ -147,32 +190,18 @@ int test_inductance::execute(jcs::jcs_host* host, std::string const& target) {
 
     PARAM_NOTIFY_ERROR( host->write_enum(target,   "controller_mode", "test_dq_l"), "Parameter failed: controller_mode" )
     PARAM_NOTIFY_ERROR( host->write_command(target, "controller_start"),            "Parameter failed: controller_start" )
+    return jcs::RET_OK;
+}
 
-    // Check for error
-    bool test_error = true;
-    helpers::sleep_ms(100);
-    PARAM_NOTIFY_ERROR( host->read_bool(target, "controller_is_error", &test_error), "Parameter failed: controller_is_error" )
-    if (test_error) {
-        std::cout << "ERROR: controller_start failed to start the test. Check that motor controller is ready to go.\n";
-        return jcs::RET_ERROR;
-    }
-
-    // Wait for completion
-    bool running = true;
-    do {
-        helpers::sleep_ms(100);
-        PARAM_NOTIFY_ERROR( host->read_bool(target, "controller_is_running", &running), "Parameter failed: controller_is_running" )
-    } while (running);
-    helpers::sleep_ms(2000);
-
-    // Read result
-    result = 0.0f;
+int test_inductance::result_read(jcs::jcs_host* host, std::string const& target, float* result_out) {
+    float value = 0.0f;
     if (axis == "d") {
-        PARAM_NOTIFY_ERROR( host->read_float(target, "motor_Ld", &result), "Res read failed: motor_Ld" )
+        PARAM_NOTIFY_ERROR( host->read_float(target, "motor_Ld", &value), "Res read failed: motor_Ld" )
     } else if (axis == "q") {
-        PARAM_NOTIFY_ERROR( host->read_float(target, "motor_Lq", &result), "Res read failed: motor_Lq" )
+        PARAM_NOTIFY_ERROR( host->read_float(target, "motor_Lq", &value), "Res read failed: motor_Lq" )
     }
-    std::cout << "Got inductance: " << result << " H\n\n";
+    std::cout << target << ": Got inductance: " << value << " H\n\n";
+    *result_out = value;
 
     return jcs::RET_OK;
 }
@@ -226,18 +255,19 @@ int gui_mc_tune::render() {
     ImGui::Text("- Ensure device is not temperature clamped.");
 
     ImGui::Separator();
+    param_worker::render_job(job_);
+
+    ImGuiDisabled ui_busy(job_ && job_->active());
     if (ImGui::Button("Click to make motor controller ready for tests!")) {
-        if (ready_test() != jcs::RET_OK) {
-            return jcs::RET_OK;
-        }
+        job_ = gui_if_->get_param_worker()->submit("Ready", [this](param_job& job) {
+            return ready_test(job);
+        }, [this](param_job& job) {
+            is_ready_ = (job.result() == jcs::RET_OK);
+        }, target_device_);
     }
     {
         ImGuiDisabled ui_disabled(!is_ready_);
 
-        auto clean_up_on_error = [&]() {
-            is_ready_ = false;
-        };
-
         /////////////////////////////////////////////////////////////////////////////////////////////
         // Resistance and Ldq parameters
         test_r_.render_ui();
@@ -257,29 +287,7 @@ int gui_mc_tune::render() {
         }
 
         if (ImGui::Button("Measure phase resistance and inductance")) {
-            // Temperature clamp check
-            {
-                bool ctrl_is_temperature_clamped = false;
-                PARAM_NOTIFY_CLEANUP_OK( host_->read_bool(target_device_, "temperature_penalty_ctrl_is_clamped", &ctrl_is_temperature_clamped), "Parameter failed: temperature_penalty_ctrl_is_clamped", clean_up_on_error(); )
-
-                if (ctrl_is_temperature_clamped) {
-                    std::cout << "ERROR: Device control is temperature clamped. Cannot continue with test.\n";
-                    clean_up_on_error();
-                    return jcs::RET_OK;
-                }
-            }
-            // Run resistance test
-            CHECK_CLEANUP_OK( test_r_.execute(host_, target_device_), clean_up_on_error(); )
-            // Run Ld test
-            CHECK_CLEANUP_OK( test_l_[0].execute(host_, target_device_), clean_up_on_error(); )
-            // Run Lq test (or copy from Ld)
-            if (lq_equals_ld_) {
-                test_l_[1].copy_result_from(test_l_[0]);
-                // Write Lq out
-                PARAM_NOTIFY_CLEANUP_OK( host_->write_float(target_device_, "motor_Lq", test_l_[1].result), "Parameter failed: motor_Lq", clean_up_on_error(); )
-            } else {
-                CHECK_CLEANUP_OK( test_l_[1].execute(host_, target_device_), clean_up_on_error(); )
-            }
+            measure_rl();
         }
 
         /////////////////////////////////////////////////////////////////////////////////////////////
@@ -304,10 +312,7 @@ int gui_mc_tune::render() {
         render_controller_gains("q", controller_gains_[1]);
 
         if (ImGui::Button("Write current controller gains")) {
-            PARAM_NOTIFY_CLEANUP_OK( host_->write_float(target_device_, "i_d_kp", controller_gains_[0].kp), "Parameter failed: i_d_kp", clean_up_on_error(); )
-            PARAM_NOTIFY_CLEANUP_OK( host_->write_float(target_device_, "i_d_ki", controller_gains_[0].ki), "Parameter failed: i_d_ki", clean_up_on_error(); )
-            PARAM_NOTIFY_CLEANUP_OK( host_->write_float(target_device_, "i_q_kp", controller_gains_[1].kp), "Parameter failed: i_q_kp", clean_up_on_error(); )
-            PARAM_NOTIFY_CLEANUP_OK( host_->write_float(target_device_, "i_q_ki", controller_gains_[1].ki), "Parameter failed: i_q_ki", clean_up_on_error(); )
+            write_gains();
         }
 
         ImGui::Separator();
@@ -346,24 +351,100 @@ int gui_mc_tune::render() {
 
         test_step_.render_ui();
         if (ImGui::Button("Start step response test")) {
-            CHECK_CLEANUP_OK( test_step_.execute(host_, target_device_), clean_up_on_error(); )
+            step_response();
         }
         test_step_.render_plot();
     }
     return jcs::RET_OK;
 }
 
-int gui_mc_tune::ready_test() {
+void gui_mc_tune::measure_rl() {
+    // Results land here as each test completes, then are applied on the GUI thread
+    // [0] = Rs, [1] = Ld, [2] = Lq
+    std::shared_ptr<std::array<float, 3>> results = std::make_shared<std::array<float, 3>>();
+    results->at(0) = test_r_.result;
+    results->at(1) = test_l_[0].result;
+    results->at(2) = test_l_[1].result;
+    bool lq_equals_ld = lq_equals_ld_;
+
+    job_ = gui_if_->get_param_worker()->submit("Measure R and L", [this, results, lq_equals_ld](param_job& job) {
+        // Temperature clamp check
+        {
+            bool ctrl_is_temperature_clamped = false;
+            PARAM_NOTIFY_ERROR( host_->read_bool(target_device_, "temperature_penalty_ctrl_is_clamped", &ctrl_is_temperature_clamped), "Parameter failed: temperature_penalty_ctrl_is_clamped" )
+
+            if (ctrl_is_temperature_clamped) {
+                std::cout << "ERROR: Device control is temperature clamped. Cannot continue with test.\n";
+                return jcs::RET_ERROR;
+            }
+        }
+        // Run resistance test
+        if (test_r_.execute(host_, target_device_, job, &results->at(0)) != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+        // Run Ld test
+        if (test_l_[0].execute(host_, target_device_, job, &results->at(1)) != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+        // Run Lq test (or copy from Ld)
+        if (lq_equals_ld) {
+            results->at(2) = results->at(1);
+            // Write Lq out
+            PARAM_NOTIFY_ERROR( host_->write_float(target_device_, "motor_Lq", results->at(2)), "Parameter failed: motor_Lq" )
+        } else {
+            if (test_l_[1].execute(host_, target_device_, job, &results->at(2)) != jcs::RET_OK) {
+                return jcs::RET_ERROR;
+            }
+        }
+        return jcs::RET_OK;
+    }, [this, results](param_job& job) {
+        // Completed tests are kept on failure
+        test_r_.result = results->at(0);
+        test_l_[0].result = results->at(1);
+        test_l_[1].result = results->at(2);
+        if (job.result() != jcs::RET_OK) {
+            is_ready_ = false;
+        }
+    }, target_device_);
+}
+
+void gui_mc_tune::write_gains() {
+    std::array<controller_gains, 2> gains = controller_gains_;
+    job_ = gui_if_->get_param_worker()->submit("Write gains", [this, gains](param_job& job) {
+        PARAM_NOTIFY_ERROR( host_->write_float(target_device_, "i_d_kp", gains[0].kp), "Parameter failed: i_d_kp" )
+        PARAM_NOTIFY_ERROR( host_->write_float(target_device_, "i_d_ki", gains[0].ki), "Parameter failed: i_d_ki" )
+        PARAM_NOTIFY_ERROR( host_->write_float(target_device_, "i_q_kp", gains[1].kp), "Parameter failed: i_q_kp" )
+        PARAM_NOTIFY_ERROR( host_->write_float(target_device_, "i_q_ki", gains[1].ki), "Parameter failed: i_q_ki" )
+        return jcs::RET_OK;
+    }, [this](param_job& job) {
+        if (job.result() != jcs::RET_OK) {
+            is_ready_ = false;
+        }
+    }, target_device_);
+}
+
+void gui_mc_tune::step_response() {
+    std::shared_ptr<std::vector<float>> data = std::make_shared<std::vector<float>>();
+    job_ = gui_if_->get_param_worker()->submit("Step response", [this, data](param_job& job) {
+        return test_step_.execute(host_, target_device_, job, data.get());
+    }, [this, data](param_job& job) {
+        if (job.result() != jcs::RET_OK) {
+            is_ready_ = false;
+            return;
+        }
+        test_step_.apply(*data);
+    }, target_device_);
+}
+
+int gui_mc_tune::ready_test(param_job& job) {
     PARAM_NOTIFY_ERROR( host_->write_bool(target_device_, "host_sentry_active", false), "Parameter failed: host_sentry_active" )
     PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "start"), "Parameter failed: start" )
-    is_ready_ = true;
-    helpers::sleep_ms(500);
+    job.sleep_ms(500);
     return jcs::RET_OK;
 }
 
-int gui_mc_tune::standby_test() {
+int gui_mc_tune::standby_test(param_job& job) {
     PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "stop"), "Parameter failed: stop" )
-    is_ready_ = false;
-    helpers::sleep_ms(500);
+    job.sleep_ms(500);
     return jcs::RET_OK;
 }
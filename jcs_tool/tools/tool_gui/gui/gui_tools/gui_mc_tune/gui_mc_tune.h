@@ -12,6 +12,7 @@
 #include "gui_type_base.h"
 #include "gui_interface.h"
 #include "mc_test_step_response.h"
+#include "param_worker.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 class test_resistance {
@@ -24,8 +25,13 @@ public:
     float result;
 
     test_resistance();
-    void render_ui();
-    int execute(jcs::jcs_host* host, std::string const& target);
+    void render_ui(bool show_result = true);
+    // Runs on the parameter worker. Parameters must not change while it runs.
+    int execute(jcs::jcs_host* host, std::string const& target, param_job& job, float* result_out);
+    // execute() in parts, for callers that wait on several devices at once.
+    // Configure and start, wait for controller_is_running to clear and settle, then read.
+    int start(jcs::jcs_host* host, std::string const& target);
+    int result_read(jcs::jcs_host* host, std::string const& target, float* result_out);
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -44,8 +50,12 @@ public:
     float result;
 
     test_inductance(std::string const& axis);
-    void render_ui();
-    int execute(jcs::jcs_host* host, std::string const& target);
+    void render_ui(bool show_result = true);
+    // Runs on the parameter worker. Parameters must not change while it runs.
+    int execute(jcs::jcs_host* host, std::string const& target, param_job& job, float* result_out);
+    // execute() in parts, see test_resistance
+    int start(jcs::jcs_host* host, std::string const& target);
+    int result_read(jcs::jcs_host* host, std::string const& target, float* result_out);
     void copy_result_from(test_inductance const& other);
 };
 
@@ -56,6 +66,9 @@ struct controller_gains {
     controller_gains() : kp(0.0f), ki(0.0f) {}
 };
 controller_gains compute_controller_gains(float bw_rads, float resistance, float inductance);
+
+// Settle time after a test stops running, before its result is read
+int const test_settle_ms = 2000;
 void render_controller_gains(std::string const& axis, controller_gains const& gains);
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -87,9 +100,15 @@ private:
     // Step response test
     mc_test_step_response test_step_;
 
-    // Device state helpers
-    int ready_test();
-    int standby_test();
+    // Test in flight on the parameter worker. All controls are disabled until it finishes.
+    param_job_ptr job_;
+    void measure_rl();
+    void write_gains();
+    void step_response();
+
+    // Device state helpers. Run on the parameter worker.
+    int ready_test(param_job& job);
+    int standby_test(param_job& job);
 };
 
 #endif
@@ -23,7 +23,7 @@ mc_test_step_response::mc_test_step_response()
       plot("Step Response", "t (s)", "y",
            jcs::node_parameter::dev_motor_controller::oscilloscope_sample_length)
 {
-    plot.update_sample_rate(30000);
+    plot.update_sample_rate(sample_rate_hz);
     plot.add_channel("response", ImVec4(0.0f, 1.0f, 0.4f, 1.0f));
 }
 
@@ -66,12 +66,29 @@ void mc_test_step_response::render_plot() {
     plot.plot();
 }
 
-int mc_test_step_response::execute(jcs::jcs_host* host, std::string const& target) {
+int mc_test_step_response::execute(jcs::jcs_host* host, std::string const& target, param_job& job, std::vector<float>* data) {
+    job.progress_set(0.0f, "Configuring");
+    if (start(host, target) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+
+    job.progress_set(0.2f, "Running");
+    if (!job.sleep_ms(run_time_ms())) {
+        std::cout << "Step response test cancelled\n";
+        PARAM_NOTIFY( host->write_command(target, "controller_stop"), "Parameter failed: controller_stop" )
+        return jcs::RET_ERROR;
+    }
+
+    job.progress_set(0.9f, "Reading oscilloscope");
+    return data_read(host, target, data);
+}
+
+int mc_test_step_response::start(jcs::jcs_host* host, std::string const& target) {
     std::string const& axis_enum = axis_enum_values[axis_index];
     std::string const& mode_enum = mode_enum_values[mode_index];
     std::string const& axis      = axis_names[axis_index];
 
-    std::cout << "Running step response test: axis=" << axis << " mode=" << mode_names[mode_index] << "\n";
+    std::cout << target << ": Running step response test: axis=" << axis << " mode=" << mode_names[mode_index] << "\n";
 
     // Set test parameters
     PARAM_NOTIFY_ERROR( host->write_enum(target,   "test_step_response_dq_test_axis", axis_enum),  "Parameter failed: test_step_response_dq_test_axis" )
@@ -83,7 +100,7 @@ int mc_test_step_response::execute(jcs::jcs_host* host, std::string const& targe
 
     // Configure oscilloscope
     PARAM_NOTIFY_ERROR( host->write_enum(target,   "oscilloscope_trigger_config", "osc_trigger_rising_edge"), "Parameter failed: oscilloscope_trigger_config" )
-    PARAM_NOTIFY_ERROR( host->write_uint32(target, "oscilloscope_sample_rate_hz", 30000), "Parameter failed: oscilloscope_sample_rate_hz" )
+    PARAM_NOTIFY_ERROR( host->write_uint32(target, "oscilloscope_sample_rate_hz", sample_rate_hz), "Parameter failed: oscilloscope_sample_rate_hz" )
     PARAM_NOTIFY_ERROR( host->write_float(target,  "oscilloscope_trigger_level", 0.01f),  "Parameter failed: oscilloscope_trigger_level" )
     PARAM_NOTIFY_ERROR( host->write_uint32(target, "oscilloscope_trigger_buffer_position", 0), "Parameter failed: oscilloscope_trigger_buffer_position" )
 
@@ -99,24 +116,24 @@ int mc_test_step_response::execute(jcs::jcs_host* host, std::string const& targe
 
     PARAM_NOTIFY_ERROR( host->write_command(target, "oscilloscope_wait_trigger"), "Parameter failed: oscilloscope_wait_trigger" )
     PARAM_NOTIFY_ERROR( host->write_command(target, "controller_start"),          "Parameter failed: controller_start" )
+    return jcs::RET_OK;
+}
 
-    helpers::sleep_ms(time_ms + 2000);
+int mc_test_step_response::data_read(jcs::jcs_host* host, std::string const& target, std::vector<float>* data) {
+    data->resize(jcs::node_parameter::dev_motor_controller::oscilloscope_sample_length);
+    PARAM_NOTIFY_ERROR( host->read_float(target, "oscilloscope_channel_0", data), "Parameter failed: oscilloscope_channel_0" )
 
-    // Read oscilloscope data into the plot channel
+    return jcs::RET_OK;
+}
+
+void mc_test_step_response::apply(std::vector<float> const& data) {
     plot_measurement_multi::channel* ch = plot.get_channel("response");
     if (ch == nullptr) {
         std::cout << "ERROR: plot channel 'response' not found\n";
-        return jcs::RET_ERROR;
+        return;
     }
-
-    // Read as float vector then copy to double channel
-    std::vector<float> data;
-    data.resize(jcs::node_parameter::dev_motor_controller::oscilloscope_sample_length);
-    PARAM_NOTIFY_ERROR( host->read_float(target, "oscilloscope_channel_0", &data), "Parameter failed: oscilloscope_channel_0" )
-
+    // Float vector to double channel
     for (int i = 0; i < (int)data.size() && i < (int)ch->y_.size(); i++) {
         ch->y_[i] = (double)data[i];
     }
-
-    return jcs::RET_OK;
 }
\ No newline at end of file
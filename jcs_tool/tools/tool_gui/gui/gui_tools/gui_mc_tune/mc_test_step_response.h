@@ -6,6 +6,7 @@
 
 #include "jcs_host.h"
 #include "plot_measurement_multi.h"
+#include "param_worker.h"
 #include <string>
 #include <vector>
 
@@ -30,7 +31,18 @@ public:
     mc_test_step_response();
     void render_ui();
     void render_plot();
-    int execute(jcs::jcs_host* host, std::string const& target);
+    // Runs on the parameter worker. Parameters must not change while it runs.
+    // Oscilloscope data is returned in data, see apply().
+    int execute(jcs::jcs_host* host, std::string const& target, param_job& job, std::vector<float>* data);
+    // GUI thread. Copy execute() data into the plot.
+    void apply(std::vector<float> const& data);
+
+    // execute() in parts, for callers that wait on several devices at once.
+    // Configure, arm and start, wait run_time_ms(), then read.
+    int start(jcs::jcs_host* host, std::string const& target);
+    int run_time_ms() const { return time_ms + 2000; }
+    int data_read(jcs::jcs_host* host, std::string const& target, std::vector<float>* data);
+    static int const sample_rate_hz = 30000;
 
 private:
     // Enum values sent to device
@@ -5,9 +5,12 @@
 #include "gui_oscilloscope.h"
 #include "imgui_stdlib.h"
 #include "implot.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include "helpers.h"
+#include "imgui_helpers.h"
+#include <memory>
 #include "ImGuiFileDialog.h"
 
 #include "jcs_dev_motor_controller.h"
@@ -32,6 +35,11 @@ gui_oscilloscope::gui_oscilloscope(jcs::jcs_host* host, gui_interface* gui_if, s
 
     is_done_sampling_ = true;
 
+    stream_history_s_ = 10.0f;
+    stream_window_s_ = 0.5f;
+    stream_follow_ = true;
+    stream_captures_ = 0;
+
     for (int i=0; i<n_channels_; i++) {
         channels_[i] = new channel("Channel " + std::to_string(i),
                                    oscilloscope_sources_->at(0),
@@ -49,9 +57,23 @@ int gui_oscilloscope::step_rt() {
 }
 
 int gui_oscilloscope::render() {
-    if (render_interface() != jcs::RET_OK) {
-        // Commands may have failed - return OK to try and continue
-        return jcs::RET_ERROR;
+    bool streaming = stream_active();
+    {
+        ImGuiDisabled ui_disabled((job_ && job_->active()) || streaming);
+        if (render_interface() != jcs::RET_OK) {
+            // Commands may have failed - return OK to try and continue
+            return jcs::RET_ERROR;
+        }
+    }
+    param_worker::render_job(job_);
+    {
+        ImGuiDisabled ui_disabled(job_ && job_->active());
+        render_stream_interface();
+    }
+    ImGui::Separator();
+    if (streaming || !stream_history_.empty()) {
+        render_stream_plot();
+        return jcs::RET_OK;
     }
     return render_plot();
 }
@@ -105,24 +127,7 @@ int gui_oscilloscope::render_interface() {
     }
 
     if (ImGui::Button("Write Settings")) {
-        std::cout << "Writing oscilloscope settings\n";
-        std::cout << "oscilloscope_sample_rate_hz:          " << sample_rate_ << "\n";
-        std::cout << "oscilloscope_trigger_source:          " << trigger_source_ << "\n";
-        std::cout << "oscilloscope_trigger_config:          " << trigger_config_ << "\n";
-        std::cout << "oscilloscope_trigger_level:           " << trigger_level_ << "\n";
-        std::cout << "oscilloscope_trigger_buffer_position: " << trigger_buffer_position_ << "\n";
-        for (int i=0; i<n_channels_; i++) {
-            std::cout << "oscilloscope_channel_" + std::to_string(i) + "_source: " << channels_[i]->source_ << "\n";
-        }
-        PARAM_NOTIFY( host_->write_uint32(target_device_, "oscilloscope_sample_rate_hz", sample_rate_),    "Parameter failed: oscilloscope_sample_rate_hz" )
-        PARAM_NOTIFY( host_->write_enum(target_device_,   "oscilloscope_trigger_source", trigger_source_), "Parameter failed: oscilloscope_trigger_source" )
-        PARAM_NOTIFY( host_->write_enum(target_device_,   "oscilloscope_trigger_config", trigger_config_), "Parameter failed: oscilloscope_trigger_config" )
-        PARAM_NOTIFY( host_->write_float(target_device_,  "oscilloscope_trigger_level",  trigger_level_),  "Parameter failed: oscilloscope_trigger_level" )
-        PARAM_NOTIFY( host_->write_uint32(target_device_, "oscilloscope_trigger_buffer_position", trigger_buffer_position_), "Parameter failed: oscilloscope_trigger_buffer_position" )
-        for (int i=0; i<n_channels_; i++) {
-            PARAM_NOTIFY( host_->write_enum(target_device_,  "oscilloscope_channel_" + std::to_string(i) + "_source", channels_[i]->source_), "Parameter failed: oscilloscope_channel_" + std::to_string(i) + "_source" )
-        }
-        std::cout << "Done\n";
+        write_settings();
     }
     ImGui::Separator();
 
@@ -137,12 +142,23 @@ int gui_oscilloscope::render_interface() {
 
     if (ImGui::Button("Stop")) {
         is_done_sampling_ = true;
-        PARAM_NOTIFY( host_->write_command(target_device_, "oscilloscope_stop"), "Parameter failed: oscilloscope_stop" )
+        job_ = gui_if_->get_param_worker()->submit("Oscilloscope stop", [this](param_job& job) {
+            PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "oscilloscope_stop"), "Parameter failed: oscilloscope_stop" )
+            return jcs::RET_OK;
+        }, nullptr, target_device_);
     }
     ImGui::SameLine();
     // Manually get sampling status
     if (ImGui::Button("Is Sampling?")) {
-        PARAM_NOTIFY( host_->read_bool(target_device_, "oscilloscope_is_done", &is_done_sampling_), "Parameter failed: oscilloscope_is_done")
+        std::shared_ptr<bool> is_done = std::make_shared<bool>(false);
+        job_ = gui_if_->get_param_worker()->submit("Oscilloscope status", [this, is_done](param_job& job) {
+            PARAM_NOTIFY_ERROR( host_->read_bool(target_device_, "oscilloscope_is_done", is_done.get()), "Parameter failed: oscilloscope_is_done")
+            return jcs::RET_OK;
+        }, [this, is_done](param_job& job) {
+            if (job.result() == jcs::RET_OK) {
+                is_done_sampling_ = *is_done;
+            }
+        }, target_device_);
     }
 
     // Disable some controls if we are waiting for trigger or sampling
@@ -154,28 +170,34 @@ int gui_oscilloscope::render_interface() {
     bool is_waiting_for_trigger = false;
     if (ImGui::Button("Wait For Trigger")) {
         is_waiting_for_trigger = true;
-        if (host_->write_command(target_device_, "oscilloscope_wait_trigger") != jcs::RET_OK) {
-            std::cout << "Parameter failed: oscilloscope_wait_trigger\n";
-            is_waiting_for_trigger = false;
-        }
+        job_ = gui_if_->get_param_worker()->submit("Oscilloscope wait trigger", [this](param_job& job) {
+            PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "oscilloscope_wait_trigger"), "Parameter failed: oscilloscope_wait_trigger" )
+            return jcs::RET_OK;
+        }, [this](param_job& job) {
+            if (job.result() != jcs::RET_OK) {
+                is_done_sampling_ = true;
+            }
+        }, target_device_);
     }
 
     if (ImGui::Button("Get All Channels")) {
+        std::vector<int> idx;
         for (int i=0; i<n_channels_; i++) {
-            PARAM_NOTIFY( host_->read_float(target_device_, "oscilloscope_channel_" + std::to_string(i), &channels_[i]->data_), "Parameter failed: oscilloscope_channel_" + std::to_string(i) )
+            idx.push_back(i);
         }
+        read_channels(idx);
     }
     ImGui::SameLine();
     for (int i=0; i<n_channels_-1; i++) {
         if (ImGui::Button( ("Get Channel " + std::to_string(i)).c_str() )) {
-            PARAM_NOTIFY( host_->read_float(target_device_, "oscilloscope_channel_" + std::to_string(i), &channels_[i]->data_), "Parameter failed: oscilloscope_channel_" + std::to_string(i) )
+            read_channels(std::vector<int>(1, i));
         }
         ImGui::SameLine();
     }
     // Last channel
     int ch = n_channels_-1;
     if (ImGui::Button( ("Get Channel " + std::to_string(ch)).c_str() )) {
-        PARAM_NOTIFY( host_->read_float(target_device_, "oscilloscope_channel_" + std::to_string(ch), &channels_[ch]->data_), "Parameter failed: oscilloscope_channel_" + std::to_string(ch) )
+        read_channels(std::vector<int>(1, ch));
     }
 
     if (!is_done_sampling_) {
@@ -191,6 +213,277 @@ int gui_oscilloscope::render_interface() {
     return jcs::RET_OK;
 }
 
+void gui_oscilloscope::write_settings() {
+    std::cout << "Writing oscilloscope settings\n";
+    std::cout << "oscilloscope_sample_rate_hz:          " << sample_rate_ << "\n";
+    std::cout << "oscilloscope_trigger_source:          " << trigger_source_ << "\n";
+    std::cout << "oscilloscope_trigger_config:          " << trigger_config_ << "\n";
+    std::cout << "oscilloscope_trigger_level:           " << trigger_level_ << "\n";
+    std::cout << "oscilloscope_trigger_buffer_position: " << trigger_buffer_position_ << "\n";
+    std::vector<std::string> channel_sources;
+    for (int i=0; i<n_channels_; i++) {
+        std::cout << "oscilloscope_channel_" + std::to_string(i) + "_source: " << channels_[i]->source_ << "\n";
+        channel_sources.push_back(channels_[i]->source_);
+    }
+
+    // Snapshot the settings, the worker does not touch the GUI copies
+    uint32_t sample_rate = sample_rate_;
+    std::string trigger_source = trigger_source_;
+    std::string trigger_config = trigger_config_;
+    float trigger_level = trigger_level_;
+    uint32_t trigger_buffer_position = trigger_buffer_position_;
+
+    job_ = gui_if_->get_param_worker()->submit("Oscilloscope settings", [=](param_job& job) {
+        bool ok = true;
+        PARAM_NOTIFY_ACTION( host_->write_uint32(target_device_, "oscilloscope_sample_rate_hz", sample_rate),    "Parameter failed: oscilloscope_sample_rate_hz", ok = false; )
+        PARAM_NOTIFY_ACTION( host_->write_enum(target_device_,   "oscilloscope_trigger_source", trigger_source), "Parameter failed: oscilloscope_trigger_source", ok = false; )
+        PARAM_NOTIFY_ACTION( host_->write_enum(target_device_,   "oscilloscope_trigger_config", trigger_config), "Parameter failed: oscilloscope_trigger_config", ok = false; )
+        PARAM_NOTIFY_ACTION( host_->write_float(target_device_,  "oscilloscope_trigger_level",  trigger_level),  "Parameter failed: oscilloscope_trigger_level", ok = false; )
+        PARAM_NOTIFY_ACTION( host_->write_uint32(target_device_, "oscilloscope_trigger_buffer_position", trigger_buffer_position), "Parameter failed: oscilloscope_trigger_buffer_position", ok = false; )
+        for (int i=0; i<channel_sources.size(); i++) {
+            PARAM_NOTIFY_ACTION( host_->write_enum(target_device_,  "oscilloscope_channel_" + std::to_string(i) + "_source", channel_sources[i]), "Parameter failed: oscilloscope_channel_" + std::to_string(i) + "_source", ok = false; )
+        }
+        std::cout << "Done\n";
+        return ok ? jcs::RET_OK : jcs::RET_ERROR;
+    }, nullptr, target_device_);
+}
+
+void gui_oscilloscope::read_channels(std::vector<int> const& idx) {
+    // Read into job owned storage, copy to the channels on the GUI thread
+    std::shared_ptr<std::vector<std::vector<float>>> data = std::make_shared<std::vector<std::vector<float>>>(idx.size());
+    for (int i=0; i<idx.size(); i++) {
+        data->at(i) = channels_[idx[i]]->data_;
+    }
+    job_ = gui_if_->get_param_worker()->submit("Oscilloscope read", [this, idx, data](param_job& job) {
+        for (int i=0; i<idx.size(); i++) {
+            if (job.cancel_requested()) {
+                return jcs::RET_ERROR;
+            }
+            std::string name = "oscilloscope_channel_" + std::to_string(idx[i]);
+            job.progress_set((float)i / (float)idx.size(), name);
+            PARAM_NOTIFY_ERROR( host_->read_float(target_device_, name, &data->at(i)), "Parameter failed: " + name )
+        }
+        return jcs::RET_OK;
+    }, [this, idx, data](param_job& job) {
+        // Partial reads are kept, as before
+        for (int i=0; i<idx.size(); i++) {
+            channels_[idx[i]]->data_ = data->at(i);
+        }
+    }, target_device_);
+}
+
+bool gui_oscilloscope::stream_active() {
+    if (!stream_) {
+        return false;
+    }
+    if (stream_->run.load()) {
+        return true;
+    }
+    // Stopping, wait for the capture in flight
+    std::lock_guard<std::mutex> lock(stream_->mutex);
+    return stream_->job && stream_->job->active();
+}
+
+void gui_oscilloscope::stream_start() {
+    stream_ = std::make_shared<stream_control>();
+    stream_->run.store(true);
+    stream_->n_channels = n_channels_;
+    stream_->sample_period_s = 1.0 / (double)sample_rate_;
+    stream_->span_s = (double)sample_length_ / (double)sample_rate_;
+    stream_->t0 = std::chrono::steady_clock::now();
+
+    stream_history_.clear();
+    stream_sources_.clear();
+    for (int i=0; i<n_channels_; i++) {
+        stream_sources_.push_back(channels_[i]->source_);
+    }
+    stream_captures_ = 0;
+    stream_first_start_s_ = 0.0;
+    stream_last_end_s_ = 0.0;
+    stream_captured_s_ = 0.0;
+    stream_download_s_ = 0.0;
+    stream_gaps_ = 0;
+    stream_gap_sum_s_ = 0.0;
+    stream_gap_min_s_ = 0.0;
+    stream_gap_max_s_ = 0.0;
+
+    stream_submit(stream_);
+}
+
+void gui_oscilloscope::stream_stop() {
+    if (!stream_) {
+        return;
+    }
+    stream_->run.store(false);
+    std::lock_guard<std::mutex> lock(stream_->mutex);
+    if (stream_->job) {
+        stream_->job->cancel();
+    }
+}
+
+void gui_oscilloscope::stream_submit(std::shared_ptr<stream_control> ctl) {
+    // Job owned, applied in on_done
+    std::shared_ptr<stream_capture> capture = std::make_shared<stream_capture>();
+
+    param_job_ptr job = gui_if_->get_param_worker()->submit("Oscilloscope stream", [this, ctl, capture](param_job& job) {
+        // Stopped while queued
+        if (!ctl->run.load()) {
+            return jcs::RET_ERROR;
+        }
+        PARAM_NOTIFY_ERROR( host_->write_command(target_device_, "oscilloscope_wait_trigger"), "Parameter failed: oscilloscope_wait_trigger" )
+
+        bool is_done = false;
+        double t_poll = ctl->now_s();
+        double t_poll_prev = t_poll;
+        while (true) {
+            t_poll_prev = t_poll;
+            PARAM_NOTIFY_ERROR( host_->read_bool(target_device_, "oscilloscope_is_done", &is_done), "Parameter failed: oscilloscope_is_done" )
+            t_poll = ctl->now_s();
+            if (is_done) {
+                break;
+            }
+            if (!job.sleep_ms(stream_poll_ms)) {
+                return jcs::RET_ERROR;
+            }
+        }
+        capture->t_end_s = 0.5 * (t_poll_prev + t_poll);
+        capture->t_start_s = capture->t_end_s - ctl->span_s;
+
+        capture->data.resize(ctl->n_channels);
+        for (int i=0; i<ctl->n_channels; i++) {
+            if (job.cancel_requested()) {
+                return jcs::RET_ERROR;
+            }
+            std::string name = "oscilloscope_channel_" + std::to_string(i);
+            PARAM_NOTIFY_ERROR( host_->read_float(target_device_, name, &capture->data[i]), "Parameter failed: " + name )
+        }
+        capture->download_s = ctl->now_s() - t_poll;
+
+        // Re-arm. Queued behind anything already waiting on the device lane.
+        if (ctl->run.load()) {
+            stream_submit(ctl);
+        }
+        return jcs::RET_OK;
+    }, [this, ctl, capture](param_job& job) {
+        // Ignore captures from a previous stream
+        if (ctl != stream_) {
+            return;
+        }
+        if (job.result() == jcs::RET_OK) {
+            stream_apply(*capture);
+        } else if (ctl->run.load()) {
+            std::cout << "gui_oscilloscope: Streaming stopped on error\n";
+            ctl->run.store(false);
+        }
+    }, target_device_);
+
+    std::lock_guard<std::mutex> lock(ctl->mutex);
+    ctl->job = job;
+}
+
+void gui_oscilloscope::stream_apply(stream_capture& capture) {
+    if (stream_captures_ == 0) {
+        stream_first_start_s_ = capture.t_start_s;
+    } else {
+        // Negative gaps are poll timing error
+        double gap = std::max(0.0, capture.t_start_s - stream_last_end_s_);
+        if (stream_gaps_ == 0) {
+            stream_gap_min_s_ = gap;
+            stream_gap_max_s_ = gap;
+        }
+        stream_gap_min_s_ = std::min(stream_gap_min_s_, gap);
+        stream_gap_max_s_ = std::max(stream_gap_max_s_, gap);
+        stream_gap_sum_s_ += gap;
+        stream_gaps_++;
+    }
+    stream_captures_++;
+    stream_captured_s_ += stream_->span_s;
+    stream_download_s_ += capture.download_s;
+    stream_last_end_s_ = capture.t_end_s;
+
+    // Latest capture also feeds the single shot view and file export
+    for (int i=0; i<n_channels_ && i<capture.data.size(); i++) {
+        channels_[i]->data_ = capture.data[i];
+    }
+
+    stream_history_.push_back(stream_capture());
+    stream_history_.back().t_start_s = capture.t_start_s;
+    stream_history_.back().t_end_s = capture.t_end_s;
+    stream_history_.back().download_s = capture.download_s;
+    stream_history_.back().data.swap(capture.data);
+    while (!stream_history_.empty() && stream_history_.front().t_end_s < capture.t_end_s - (double)stream_history_s_) {
+        stream_history_.pop_front();
+    }
+}
+
+void gui_oscilloscope::render_stream_interface() {
+    ImGui::Text("Streaming");
+    ImGuiInputTextFlags input_text_flags = ImGuiInputTextFlags_EscapeClearsAll;
+    if (stream_active()) {
+        if (!stream_->run.load()) {
+            ImGui::Text("Stopping...");
+        } else if (ImGui::Button("Stop Streaming")) {
+            stream_stop();
+        }
+    } else {
+        if (ImGui::Button("Start Streaming")) {
+            stream_start();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear Stream")) {
+            stream_history_.clear();
+        }
+    }
+    ImGui::SameLine();
+    ImGui::Text("Re-arms and downloads back to back. Write Settings first, trigger config should fire every capture.");
+
+    ImGui::PushItemWidth(200.0f);
+    ImGui::InputFloat("History (s)", &stream_history_s_, 1.0f, 10.0f, "%.1f", input_text_flags);
+    stream_history_s_ = std::max(stream_history_s_, 0.1f);
+    ImGui::SameLine();
+    ImGui::InputFloat("Window (s)", &stream_window_s_, 0.01f, 0.1f, "%.3f", input_text_flags);
+    stream_window_s_ = std::max(stream_window_s_, 0.001f);
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    ImGui::Checkbox("Follow", &stream_follow_);
+
+    if (stream_captures_ > 0) {
+        double wall_s = stream_last_end_s_ - stream_first_start_s_;
+        double duty = (wall_s > 0.0) ? 100.0 * stream_captured_s_ / wall_s : 100.0;
+        ImGui::Text("Captures: %d, duty cycle: %.1f %%, download: %.1f ms/capture", stream_captures_, duty,
+            1e3 * stream_download_s_ / (double)stream_captures_);
+        if (stream_gaps_ > 0) {
+            ImGui::Text("Gap (ms): mean %.2f, min %.2f, max %.2f", 1e3 * stream_gap_sum_s_ / (double)stream_gaps_,
+                1e3 * stream_gap_min_s_, 1e3 * stream_gap_max_s_);
+        }
+    }
+}
+
+void gui_oscilloscope::render_stream_plot() {
+    double t_end = stream_history_.empty() ? 0.0 : stream_history_.back().t_end_s;
+    for (int ch=0; ch<n_channels_; ch++) {
+        ImGui::PushID(ch);
+        std::string title = "Stream " + channels_[ch]->name_;
+        if (ImPlot::BeginPlot(title.c_str())) {
+            ImPlot::SetupAxes("t (s)","y");
+            if (stream_follow_) {
+                ImPlot::SetupAxisLimits(ImAxis_X1, t_end - (double)stream_window_s_, t_end, ImGuiCond_Always);
+            }
+            // Only captures on screen
+            ImPlotRect limits = ImPlot::GetPlotLimits();
+            for (int i=0; i<stream_history_.size(); i++) {
+                stream_capture const& c = stream_history_[i];
+                if (ch >= c.data.size() || c.data[ch].empty() || c.t_end_s < limits.X.Min || c.t_start_s > limits.X.Max) {
+                    continue;
+                }
+                ImPlot::PlotLine(stream_sources_[ch].c_str(), &c.data[ch][0], c.data[ch].size(), stream_->sample_period_s, c.t_start_s);
+            }
+            ImPlot::EndPlot();
+        }
+        ImGui::PopID();
+    }
+}
+
 gui_oscilloscope::channel::channel(std::string const& name, std::string const& source, int const sample_length, int const initial_sample_rate) :
     name_(name),
     source_(source),
@@ -8,8 +8,14 @@
 #include "gui_type_base.h"
 #include "gui_interface.h"
 #include "tool_gui_settings.h"
+#include "param_worker.h"
 #include <vector>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include "imgui.h"
 
@@ -57,6 +63,64 @@ private:
     // channel channels_[4];
     std::array<channel*, 4> channels_;
 
+    // Mailbox transaction in flight. Controls are disabled until it finishes.
+    param_job_ptr job_;
+    void write_settings();
+    void read_channels(std::vector<int> const& idx);
+
+    // Streaming. Each capture is one job on the device lane: arm, poll until done, read all
+    // channels, then queue the next capture before releasing the lane. Other transactions for
+    // the device run between captures. Captures are stitched on the host clock, the end of a
+    // capture is taken as the midpoint of the last two oscilloscope_is_done polls.
+    // Polls are stream_poll_ms apart, which bounds that error to about half of it.
+    static const int stream_poll_ms = 2;
+    struct stream_control {
+        std::atomic<bool> run;
+        int n_channels;
+        double span_s;
+        double sample_period_s;
+        std::chrono::steady_clock::time_point t0;
+        // Latest job, to cancel on stop
+        std::mutex mutex;
+        param_job_ptr job;
+
+        double now_s() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+    };
+    struct stream_capture {
+        double t_start_s;
+        double t_end_s;
+        double download_s;
+        std::vector<std::vector<float>> data;
+    };
+    std::shared_ptr<stream_control> stream_;
+    std::deque<stream_capture> stream_history_;
+    std::vector<std::string> stream_sources_;
+    float stream_history_s_;
+    float stream_window_s_;
+    bool stream_follow_;
+
+    // Statistics since stream start
+    int    stream_captures_;
+    double stream_first_start_s_;
+    double stream_last_end_s_;
+    double stream_captured_s_;
+    double stream_download_s_;
+    int    stream_gaps_;
+    double stream_gap_sum_s_;
+    double stream_gap_min_s_;
+    double stream_gap_max_s_;
+
+    bool stream_active();
+    void stream_start();
+    void stream_stop();
+    // Called from the GUI thread, then from the worker for each following capture
+    void stream_submit(std::shared_ptr<stream_control> ctl);
+    void stream_apply(stream_capture& capture);
+    void render_stream_interface();
+    void render_stream_plot();
+
     int render_plot();
     int render_interface();
     int write_channels_to_file();
@@ -9,47 +9,11 @@
 
 #include "ImGuiFileDialog.h"
 
-//////////////////////////////////////////////////////////////////////
-// Parameter read all helpers
-void gui_parameter::parameter_do_all::tick(std::vector<param_base*>* param_store, std::string const& target_device) {
-
-    switch (state_) {
-        case state::stopped:
-            // Read all params?
-            if (ImGui::Button("Read All Parameters")) {
-                param_index_ = 0;
-                increment_ = 1.0f / (float)param_store->size();
-                fraction_ = 0.0f;
-                state_ = state::running;
-            }
-            break;
-
-        case state::running:
-            if (ImGui::Button("Cancel")) {
-                cancel();
-                break;
-            }
-            if (param_store->at(param_index_)->read(target_device) != jcs::RET_OK) {
-                cancel();
-                break;
-            }
-            param_index_++;
-            if (param_index_ >= param_store->size()) {
-                cancel();
-                break;
-            }
-            fraction_ += increment_;
-            ImGui::SameLine();
-            ImGui::ProgressBar(fraction_, ImVec2(0.0f, 0.0f));
-            break;
-    }
-}
-
 //////////////////////////////////////////////////////////////////////
 gui_parameter::gui_parameter(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device, 
         std::vector<jcs::parameter> const* params, std::vector<jcs::parameter_enum> const* enums) :
     gui_type_base("Parameter", host, gui_if, target_device), 
-    params_(params), enums_(enums), do_all_()
+    params_(params), enums_(enums)
 {
     // Note: Cant do anything reliant on host having been initialised here.
     // Host not initialised until after. 
@@ -98,6 +62,9 @@ int gui_parameter::startup() {
                 return jcs::RET_ERROR;
         }
     }
+    for (int i=0; i<param_store_.size(); i++) {
+        param_store_[i]->worker_ = gui_if_->get_param_worker();
+    }
     return jcs::RET_OK;
 }
 
@@ -105,9 +72,44 @@ int gui_parameter::step_rt() {
     return jcs::RET_OK;
 }
 
+param_job_ptr gui_parameter::read_all_parameters() {
+    if (read_all_job_ && read_all_job_->active()) {
+        return read_all_job_;
+    }
+    // Rows are only written by read_apply() on the GUI thread
+    std::shared_ptr<int> n_read = std::make_shared<int>(0);
+    std::vector<param_base*> params = param_store_;
+    read_all_job_ = gui_if_->get_param_worker()->submit("Read all " + target_device_, [this, params, n_read](param_job& job) {
+        for (int i=0; i<params.size(); i++) {
+            if (job.cancel_requested()) {
+                return jcs::RET_ERROR;
+            }
+            if (params[i]->read(target_device_) != jcs::RET_OK) {
+                return jcs::RET_ERROR;
+            }
+            *n_read = i + 1;
+            job.progress_set((float)(i + 1) / (float)params.size(), params[i]->name_);
+        }
+        return jcs::RET_OK;
+    }, [this, n_read](param_job& job) {
+        // Apply whatever was read before a failure or cancel
+        for (int i=0; i<*n_read; i++) {
+            param_store_[i]->read_apply();
+        }
+        if (job.result() != jcs::RET_OK) {
+            std::cout << "gui_parameter: " << target_device_ << " read " << *n_read << " of " << param_store_.size() << " parameters\n";
+        }
+    }, target_device_);
+    return read_all_job_;
+}
+
 int gui_parameter::render() {
 
-    do_all_.tick(&param_store_, target_device_);
+    if (!param_worker::render_job(read_all_job_)) {
+        if (ImGui::Button("Read All Parameters")) {
+            read_all_parameters();
+        }
+    }
     ImGui::SameLine();
     write_config_to_file();
 
@@ -24,6 +24,7 @@ public:
     int startup();
     int step_rt();
     int render();
+    param_job_ptr read_all_parameters();
 
 private:
     std::vector<jcs::parameter> const* params_;
@@ -32,23 +33,8 @@ private:
     // Local parameter storage
     std::vector<param_base*> param_store_;
 
-    // Helper tool for reading all parameters
-    struct parameter_do_all {
-        int param_index_;
-        float fraction_;
-        float increment_;
-        enum class state {
-            running,
-            stopped
-        };
-        state state_;
-
-        parameter_do_all() : state_(state::stopped), param_index_(0), fraction_(0.0f), increment_(0.0f) {}
-        void cancel() { state_ = state::stopped; }
-        void tick(std::vector<param_base*>* param_store, std::string const& target_device);
-    };
-
-    parameter_do_all do_all_;
+    // Read All. Every parameter is read back to back in one worker job on this device's lane.
+    param_job_ptr read_all_job_;
 
     // Tools
     int write_config_to_file();
@@ -6,6 +6,26 @@
 #include <string>
 #include "imgui.h"
 #include "helpers.h"
+#include <memory>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void param_base::submit(std::string const& target_device, std::function<int()> fn, std::function<void()> on_ok) {
+    if (worker_ == nullptr) {
+        return;
+    }
+    job_ = worker_->submit(target_device + ":" + name_, [fn](param_job& job) {
+        return fn();
+    }, [this, on_ok](param_job& job) {
+        if (job.result() != jcs::RET_OK) {
+            std::cout << "Parameter failed " << name_ << "\n";
+            watch_ = false;
+            return;
+        }
+        if (on_ok) {
+            on_ok();
+        }
+    }, target_device);
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 void param_none::render(std::string const& target_device) {
@@ -25,8 +45,7 @@ void param_none::render(std::string const& target_device) {
     // Write
     ImGui::TableNextColumn();
     if (ImGui::Button("Write", ImVec2(-FLT_MIN, 0.0f))) {
-        std::string fail_text = "Parameter failed " + name_;
-        PARAM_NOTIFY( host_->write_command(target_device, name_), fail_text )
+        submit(target_device, [=]() { return host_->write_command(target_device, name_); });
     }
     // Read - N/A
     ImGui::TableNextColumn();
@@ -40,6 +59,7 @@ void param_none::render(std::string const& target_device) {
 int param_none::read(std::string const& target_device) {
     return jcs::RET_OK;
 }
+void param_none::read_apply() {}
 void param_none::write_to_file(YAML::Emitter& yemit) {}
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -59,7 +79,6 @@ void param_boolean::render(std::string const& target_device) {
         ImGui::BeginDisabled();
     }
     // Write - True
-    std::string fail_text = "Parameter failed " + name_;
     ImGui::TableNextColumn();
     ImGui::PushItemWidth(-FLT_MIN); // Right aligned    
     ImGui::Combo("##True/False", &write_select_, "False\0True\0");
@@ -67,24 +86,18 @@ void param_boolean::render(std::string const& target_device) {
     ImGui::TableNextColumn();
     if (ImGui::Button("Write", ImVec2(-FLT_MIN, 0.0f))) {
         bool value = (bool)write_select_;
-        PARAM_NOTIFY( host_->write_bool(target_device, name_, value), fail_text )
+        submit(target_device, [=]() { return host_->write_bool(target_device, name_, value); });
     }
     // Read
     ImGui::TableNextColumn();
-    if (ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f))) {
-        bool value = false;
-        PARAM_NOTIFY( host_->read_bool(target_device, name_, &value), fail_text )
-        val_ = value;
-    }
+    bool do_read = ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f));
     // Watch
     ImGui::TableNextColumn();
     ImGui::Checkbox("##watch", &watch_);
-    if (watch_) {
-        bool value = false;
-        if (host_->read_bool(target_device, name_, &value) != jcs::RET_OK) {
-            watch_ = false;
-        }
-        val_ = value;
+    if (do_read || (watch_ && !busy())) {
+        std::shared_ptr<bool> value = std::make_shared<bool>(false);
+        submit(target_device, [=]() { return host_->read_bool(target_device, name_, value.get()); },
+                              [=]() { val_ = *value; });
     }
     // Print Read
     ImGui::TableNextColumn();
@@ -103,12 +116,14 @@ int param_boolean::read(std::string const& target_device) {
         return jcs::RET_OK;
     }
     std::string fail_text = "Parameter failed " + name_;
-    bool value = false;
-    PARAM_NOTIFY_ERROR( host_->read_bool(target_device, name_, &value), fail_text )
-    val_ = value;
-    write_select_ = (int)value;
+    PARAM_NOTIFY_ERROR( host_->read_bool(target_device, name_, &fetched_), fail_text )
     return jcs::RET_OK;
 }
+void param_boolean::read_apply() {
+    if (length_ == 0) { return; }
+    val_ = fetched_;
+    write_select_ = (int)fetched_;
+}
 void param_boolean::write_to_file(YAML::Emitter& yemit) {
     if (length_ == 0) { return; }
     yemit << YAML::Key << name_ << YAML::Value << val_;
@@ -131,7 +146,6 @@ void param_float32::render(std::string const& target_device) {
     }
     // Write
     ImGui::TableNextColumn();
-    std::string fail_text = "Parameter failed " + name_;
 
     ImGui::PushItemWidth(-FLT_MIN); // Right aligned
     {
@@ -143,24 +157,19 @@ void param_float32::render(std::string const& target_device) {
 
     ImGui::TableNextColumn();
     if (ImGui::Button("Write", ImVec2(-FLT_MIN, 0.0f))) {
-        PARAM_NOTIFY( host_->write_float(target_device, name_, write_val_), fail_text )
+        float value = write_val_;
+        submit(target_device, [=]() { return host_->write_float(target_device, name_, value); });
     }
     
     ImGui::TableNextColumn();
-    if (ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f))) {
-        float value = 0.0f;
-        PARAM_NOTIFY( host_->read_float(target_device, name_, &value), fail_text )
-        read_val_ = value;
-    }
+    bool do_read = ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f));
     // Watch
     ImGui::TableNextColumn();
     ImGui::Checkbox("##watch", &watch_);
-    if (watch_) {
-        float value = 0.0f;
-        if (host_->read_float(target_device, name_, &value) != jcs::RET_OK) {
-            watch_ = false;
-        }
-        read_val_ = value;
+    if (do_read || (watch_ && !busy())) {
+        std::shared_ptr<float> value = std::make_shared<float>(0.0f);
+        submit(target_device, [=]() { return host_->read_float(target_device, name_, value.get()); },
+                              [=]() { read_val_ = *value; });
     }
 
     ImGui::TableNextColumn();
@@ -177,12 +186,14 @@ int param_float32::read(std::string const& target_device) {
         return jcs::RET_OK;
     }
     std::string fail_text = "Parameter failed " + name_;
-    float value = 0.0f;
-    PARAM_NOTIFY_ERROR( host_->read_float(target_device, name_, &value), fail_text )
-    read_val_ = value;
-    write_val_ = value;
+    PARAM_NOTIFY_ERROR( host_->read_float(target_device, name_, &fetched_), fail_text )
     return jcs::RET_OK;
 }
+void param_float32::read_apply() {
+    if (length_ == 0) { return; }
+    read_val_ = fetched_;
+    write_val_ = fetched_;
+}
 void param_float32::write_to_file(YAML::Emitter& yemit) {
     if (length_ == 0) { return; }
     yemit << YAML::Key << name_ << YAML::Value << (double)read_val_;
@@ -194,6 +205,7 @@ param_float32_vec::param_float32_vec(jcs::jcs_host* host, std::string const& nam
 {
     write_val_.resize(length);
     read_val_.resize(length);
+    fetched_.resize(length);
 }
 void param_float32_vec::render(std::string const& target_device) {
     ImGui::PushID((target_device + name_).c_str());
@@ -209,7 +221,6 @@ void param_float32_vec::render(std::string const& target_device) {
 
     // Write
     ImGui::TableNextColumn();
-    std::string fail_text = "Parameter failed " + name_;
 
     ImGui::SetNextItemWidth(-FLT_MIN);
     if (ImGui::BeginPopupContextItem("float_input")) {
@@ -230,22 +241,23 @@ void param_float32_vec::render(std::string const& target_device) {
 
     ImGui::TableNextColumn();
     if (ImGui::Button("Write", ImVec2(-FLT_MIN, 0.0f))) {
-        PARAM_NOTIFY( host_->write_float(target_device, name_, write_val_), fail_text )
+        std::vector<float> value = write_val_;
+        submit(target_device, [=]() { return host_->write_float(target_device, name_, value); });
     }
 
     ImGui::TableNextColumn();
-    if (ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f))) {
-        PARAM_NOTIFY( host_->read_float(target_device, name_, &read_val_), fail_text )
-    }
+    bool do_read = ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f));
 
     // Watch
     ImGui::TableNextColumn();
     // Only watch if small enough
     if (read_val_.size() <= 4) {
         ImGui::Checkbox("##watch", &watch_);
-        if (watch_) {
-            read(target_device);
-        }
+    }
+    if (do_read || (watch_ && !busy())) {
+        std::shared_ptr<std::vector<float>> value = std::make_shared<std::vector<float>>(read_val_);
+        submit(target_device, [=]() { return host_->read_float(target_device, name_, value.get()); },
+                              [=]() { read_val_ = *value; });
     }
 
     ImGui::TableNextColumn();
@@ -280,10 +292,14 @@ int param_float32_vec::read(std::string const& target_device) {
         return jcs::RET_OK;
     }
     std::string fail_text = "Parameter failed " + name_;
-    PARAM_NOTIFY_ERROR( host_->read_float(target_device, name_, &read_val_), fail_text )
-    for (int i=0; i<read_val_.size(); i++) { write_val_[i] = read_val_[i]; }
+    PARAM_NOTIFY_ERROR( host_->read_float(target_device, name_, &fetched_), fail_text )
     return jcs::RET_OK;
 }
+void param_float32_vec::read_apply() {
+    if (length_ == 0) { return; }
+    read_val_ = fetched_;
+    for (int i=0; i<read_val_.size() && i<write_val_.size(); i++) { write_val_[i] = read_val_[i]; }
+}
 void param_float32_vec::write_to_file(YAML::Emitter& yemit) {
     if (length_ == 0) { return; }
 
@@ -311,7 +327,6 @@ void param_uint32::render(std::string const& target_device) {
     }
 
     ImGui::TableNextColumn();
-    std::string fail_text = "Parameter failed " + name_;
     ImGui::PushItemWidth(-FLT_MIN); // Right aligned
     {
         int value = (int)write_val_;
@@ -322,24 +337,19 @@ void param_uint32::render(std::string const& target_device) {
     
     ImGui::TableNextColumn();
     if (ImGui::Button("Write", ImVec2(-FLT_MIN, 0.0f))) {
-        PARAM_NOTIFY( host_->write_uint32(target_device, name_, write_val_), fail_text )
+        uint32_t value = write_val_;
+        submit(target_device, [=]() { return host_->write_uint32(target_device, name_, value); });
     }
     
     ImGui::TableNextColumn();
-    if (ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f))) {
-        uint32_t value = 0;
-        PARAM_NOTIFY( host_->read_uint32(target_device, name_, &value), fail_text )
-        read_val_ = value;
-    }
+    bool do_read = ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f));
     // Watch
     ImGui::TableNextColumn();
     ImGui::Checkbox("##watch", &watch_);
-    if (watch_) {
-        uint32_t value = 0;
-        if (host_->read_uint32(target_device, name_, &value) != jcs::RET_OK) {
-            watch_ = false;
-        }
-        read_val_ = value;
+    if (do_read || (watch_ && !busy())) {
+        std::shared_ptr<uint32_t> value = std::make_shared<uint32_t>(0);
+        submit(target_device, [=]() { return host_->read_uint32(target_device, name_, value.get()); },
+                              [=]() { read_val_ = *value; });
     }
 
     ImGui::TableNextColumn();
@@ -357,12 +367,14 @@ int param_uint32::read(std::string const& target_device) {
         return jcs::RET_OK;
     }
     std::string fail_text = "Parameter failed " + name_;
-    uint32_t value = 0;
-    PARAM_NOTIFY_ERROR( host_->read_uint32(target_device, name_, &value), fail_text )
-    read_val_ = value;
-    write_val_ = value;
+    PARAM_NOTIFY_ERROR( host_->read_uint32(target_device, name_, &fetched_), fail_text )
     return jcs::RET_OK;
 }
+void param_uint32::read_apply() {
+    if (length_ == 0) { return; }
+    read_val_ = fetched_;
+    write_val_ = fetched_;
+}
 void param_uint32::write_to_file(YAML::Emitter& yemit) {
     if (length_ == 0) { return; }
     yemit << YAML::Key << name_ << YAML::Value << (unsigned int)read_val_;
@@ -385,7 +397,6 @@ void param_uint16::render(std::string const& target_device) {
     }
 
     ImGui::TableNextColumn();
-    std::string fail_text = "Parameter failed " + name_;
     ImGui::PushItemWidth(-FLT_MIN); // Right aligned
     {
         int value = (int)write_val_;
@@ -396,24 +407,19 @@ void param_uint16::render(std::string const& target_device) {
     
     ImGui::TableNextColumn();
     if (ImGui::Button("Write", ImVec2(-FLT_MIN, 0.0f))) {
-        PARAM_NOTIFY( host_->write_uint16(target_device, name_, write_val_), fail_text )
+        uint16_t value = write_val_;
+        submit(target_device, [=]() { return host_->write_uint16(target_device, name_, value); });
     }
     
     ImGui::TableNextColumn();
-    if (ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f))) {
-        uint16_t value = 0;
-        PARAM_NOTIFY( host_->read_uint16(target_device, name_, &value), fail_text )
-        read_val_ = value;
-    }
+    bool do_read = ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f));
     // Watch
     ImGui::TableNextColumn();
     ImGui::Checkbox("##watch", &watch_);
-    if (watch_) {
-        uint16_t value = 0;
-        if (host_->read_uint16(target_device, name_, &value) != jcs::RET_OK) {
-            watch_ = false;
-        }
-        read_val_ = value;
+    if (do_read || (watch_ && !busy())) {
+        std::shared_ptr<uint16_t> value = std::make_shared<uint16_t>(0);
+        submit(target_device, [=]() { return host_->read_uint16(target_device, name_, value.get()); },
+                              [=]() { read_val_ = *value; });
     }
 
     ImGui::TableNextColumn();
@@ -431,12 +437,14 @@ int param_uint16::read(std::string const& target_device) {
         return jcs::RET_OK;
     }
     std::string fail_text = "Parameter failed " + name_;
-    uint16_t value = 0;
-    PARAM_NOTIFY_ERROR( host_->read_uint16(target_device, name_, &value), fail_text )
-    read_val_ = value;
-    write_val_ = value;
+    PARAM_NOTIFY_ERROR( host_->read_uint16(target_device, name_, &fetched_), fail_text )
     return jcs::RET_OK;
 }
+void param_uint16::read_apply() {
+    if (length_ == 0) { return; }
+    read_val_ = fetched_;
+    write_val_ = fetched_;
+}
 void param_uint16::write_to_file(YAML::Emitter& yemit) {
     if (length_ == 0) { return; }
     yemit << YAML::Key << name_ << YAML::Value << (unsigned int)read_val_;
@@ -459,7 +467,6 @@ void param_uint8::render(std::string const& target_device) {
     }
 
     ImGui::TableNextColumn();
-    std::string fail_text = "Parameter failed " + name_;
     ImGui::PushItemWidth(-FLT_MIN); // Right aligned
     {
         int value = (int)write_val_;
@@ -470,24 +477,19 @@ void param_uint8::render(std::string const& target_device) {
     
     ImGui::TableNextColumn();
     if (ImGui::Button("Write", ImVec2(-FLT_MIN, 0.0f))) {
-        PARAM_NOTIFY( host_->write_uint8(target_device, name_, write_val_), fail_text )
+        uint8_t value = write_val_;
+        submit(target_device, [=]() { return host_->write_uint8(target_device, name_, value); });
     }
     
     ImGui::TableNextColumn();
-    if (ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f))) {
-        uint8_t value = 0;
-        PARAM_NOTIFY( host_->read_uint8(target_device, name_, &value), fail_text )
-        read_val_ = value;
-    }
+    bool do_read = ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f));
     // Watch
     ImGui::TableNextColumn();
     ImGui::Checkbox("##watch", &watch_);
-    if (watch_) {
-        uint8_t value = 0;
-        if (host_->read_uint8(target_device, name_, &value) != jcs::RET_OK) {
-            watch_ = false;
-        }
-        read_val_ = value;
+    if (do_read || (watch_ && !busy())) {
+        std::shared_ptr<uint8_t> value = std::make_shared<uint8_t>(0);
+        submit(target_device, [=]() { return host_->read_uint8(target_device, name_, value.get()); },
+                              [=]() { read_val_ = *value; });
     }
 
     ImGui::TableNextColumn();
@@ -505,12 +507,14 @@ int param_uint8::read(std::string const& target_device) {
         return jcs::RET_OK;
     }
     std::string fail_text = "Parameter failed " + name_;
-    uint8_t value = 0;
-    PARAM_NOTIFY_ERROR( host_->read_uint8(target_device, name_, &value), fail_text )
-    read_val_ = value;
-    write_val_ = value;
+    PARAM_NOTIFY_ERROR( host_->read_uint8(target_device, name_, &fetched_), fail_text )
     return jcs::RET_OK;
 }
+void param_uint8::read_apply() {
+    if (length_ == 0) { return; }
+    read_val_ = fetched_;
+    write_val_ = fetched_;
+}
 void param_uint8::write_to_file(YAML::Emitter& yemit) {
     if (length_ == 0) { return; }
     yemit << YAML::Key << name_ << YAML::Value << (unsigned int)read_val_;
@@ -534,30 +538,24 @@ void param_enum::render(std::string const& target_device) {
     }
 
     ImGui::TableNextColumn();
-    std::string fail_text = "Parameter failed " + name_;
     ImGui::PushItemWidth(-FLT_MIN); // Right aligned
     enum_get();
     
     ImGui::TableNextColumn();
     if (ImGui::Button("Write", ImVec2(-FLT_MIN, 0.0f))) {
-        PARAM_NOTIFY( host_->write_enum(target_device, name_, write_val_), fail_text )
+        std::string value = write_val_;
+        submit(target_device, [=]() { return host_->write_enum(target_device, name_, value); });
     }
     
     ImGui::TableNextColumn();
-    if (ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f))) {
-        std::string value;
-        PARAM_NOTIFY( host_->read_enum(target_device, name_, &value), fail_text )
-        read_val_ = value;
-    }
+    bool do_read = ImGui::Button("Read", ImVec2(-FLT_MIN, 0.0f));
     // Watch
     ImGui::TableNextColumn();
     ImGui::Checkbox("##watch", &watch_);
-    if (watch_) {
-        std::string value;
-        if (host_->read_enum(target_device, name_, &value) != jcs::RET_OK) {
-            watch_ = false;
-        }
-        read_val_ = value;
+    if (do_read || (watch_ && !busy())) {
+        std::shared_ptr<std::string> value = std::make_shared<std::string>();
+        submit(target_device, [=]() { return host_->read_enum(target_device, name_, value.get()); },
+                              [=]() { read_val_ = *value; });
     }
 
     ImGui::TableNextColumn();
@@ -575,12 +573,14 @@ int param_enum::read(std::string const& target_device) {
         return jcs::RET_OK;
     }
     std::string fail_text = "Parameter failed " + name_;
-    std::string value;
-    PARAM_NOTIFY_ERROR( host_->read_enum(target_device, name_, &value), fail_text )
-    read_val_ = value;
-    write_val_ = value;
+    PARAM_NOTIFY_ERROR( host_->read_enum(target_device, name_, &fetched_), fail_text )
     return jcs::RET_OK;
 }
+void param_enum::read_apply() {
+    if (length_ == 0) { return; }
+    read_val_ = fetched_;
+    write_val_ = fetched_;
+}
 void param_enum::enum_get() {
     const char* combo_preview_value = enums_->at(enum_read_idx_).c_str();
 
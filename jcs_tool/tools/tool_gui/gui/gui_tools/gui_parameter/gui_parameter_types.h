@@ -8,23 +8,38 @@
 #include <string>
 #include "jcs_host.h"
 #include <yaml-cpp/yaml.h>
+#include <functional>
+#include "param_worker.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 class param_base {
 public:
     param_base(jcs::jcs_host* host, std::string const& name, int length) :
-        host_(host), name_(name), length_(length), watch_(false) {}
+        host_(host), name_(name), length_(length), watch_(false), worker_(nullptr) {}
     ~param_base() {}
 
     virtual void render(std::string const& target_device) = 0;
+    // Read All. read() runs on the parameter worker and only touches the fetched value.
+    // read_apply() copies it to the row on the GUI thread.
     virtual int  read(std::string const& target_device) = 0;
+    virtual void read_apply() = 0;
     virtual void write_to_file(YAML::Emitter& yemit) = 0; 
 
     jcs::jcs_host* host_;
     std::string name_;
     int length_;
     bool watch_;
+    param_worker* worker_;
+
+protected:
+    // Row Write/Read/Watch transactions run on the parameter worker, one at a time.
+    // fn runs on the worker and must only touch what it captured.
+    // on_ok runs on the GUI thread if fn succeeded. Failure stops watching.
+    void submit(std::string const& target_device, std::function<int()> fn, std::function<void()> on_ok = nullptr);
+    bool busy() const { return job_ && job_->active(); }
+
+    param_job_ptr job_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -35,6 +50,7 @@ public:
 
     void render(std::string const& target_device);
     int  read(std::string const& target_device);
+    void read_apply();
     void write_to_file(YAML::Emitter& yemit);
 };
 
@@ -42,30 +58,34 @@ public:
 class param_boolean : public param_base {
 public:
     param_boolean(jcs::jcs_host* host, std::string const& name, int length) :
-        param_base(host, name, length), val_(false), write_select_(0) {}
+        param_base(host, name, length), val_(false), write_select_(0), fetched_(false) {}
 
     void render(std::string const& target_device);
     int  read(std::string const& target_device);
+    void read_apply();
     void write_to_file(YAML::Emitter& yemit);
 
 private:
     bool val_;
     int write_select_;
+    bool fetched_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 class param_float32 : public param_base {
 public:
     param_float32(jcs::jcs_host* host, std::string const& name, int length) :
-        param_base(host, name, length), write_val_(0.0f), read_val_(0.0f) {}
+        param_base(host, name, length), write_val_(0.0f), read_val_(0.0f), fetched_(0.0f) {}
 
     void render(std::string const& target_device);
     int  read(std::string const& target_device);
+    void read_apply();
     void write_to_file(YAML::Emitter& yemit);
 
 private:
     float write_val_;
     float read_val_;
+    float fetched_;
 };
 ///////////////////////////////////////////////////////////////////////////////////////////
 class param_float32_vec : public param_base {
@@ -74,56 +94,64 @@ public:
 
     void render(std::string const& target_device);
     int  read(std::string const& target_device);
+    void read_apply();
     void write_to_file(YAML::Emitter& yemit);
 
 private:
     std::vector<float> write_val_;
     std::vector<float> read_val_;
+    std::vector<float> fetched_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 class param_uint32 : public param_base {
 public:
     param_uint32(jcs::jcs_host* host, std::string const& name, int length) :
-        param_base(host, name, length), write_val_(0), read_val_(0) {}
+        param_base(host, name, length), write_val_(0), read_val_(0), fetched_(0) {}
 
     void render(std::string const& target_device);
     int  read(std::string const& target_device);
+    void read_apply();
     void write_to_file(YAML::Emitter& yemit);
 
 private:
     uint32_t write_val_;
     uint32_t read_val_;
+    uint32_t fetched_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 class param_uint16 : public param_base {
 public:
     param_uint16(jcs::jcs_host* host, std::string const& name, int length) :
-        param_base(host, name, length), write_val_(0), read_val_(0) {}
+        param_base(host, name, length), write_val_(0), read_val_(0), fetched_(0) {}
 
     void render(std::string const& target_device);
     int  read(std::string const& target_device);
+    void read_apply();
     void write_to_file(YAML::Emitter& yemit);
 
 private:
     uint16_t write_val_;
     uint16_t read_val_;
+    uint16_t fetched_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 class param_uint8 : public param_base {
 public:
     param_uint8(jcs::jcs_host* host, std::string const& name, int length) :
-        param_base(host, name, length), write_val_(0), read_val_(0) {}
+        param_base(host, name, length), write_val_(0), read_val_(0), fetched_(0) {}
 
     void render(std::string const& target_device);
     int  read(std::string const& target_device);
+    void read_apply();
     void write_to_file(YAML::Emitter& yemit);
 
 private:
     uint8_t write_val_;
     uint8_t read_val_;
+    uint8_t fetched_;
      std::vector<std::string> const* enums_;
 };
 
@@ -138,6 +166,7 @@ public:
 
     void render(std::string const& target_device);
     int  read(std::string const& target_device);
+    void read_apply();
     void write_to_file(YAML::Emitter& yemit);
 
 private:
@@ -147,6 +176,7 @@ private:
     int enum_read_idx_;
     std::string write_val_;
     std::string read_val_;
+    std::string fetched_;
 };
 
 #endif
\ No newline at end of file
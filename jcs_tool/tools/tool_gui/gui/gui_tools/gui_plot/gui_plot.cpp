@@ -35,6 +35,28 @@ int gui_plot::startup() {
         sink_opstate_.push_back(new plot_sink_opstate(node_name, name, &sink_opstate_store_[i]));
     }
 
+    // Decimated sinks, in render order
+    std::vector<std::vector<std::vector<plot_sink*>*>*> sinks = { &sink_f32_, &sink_u32_, &sink_u16_, &sink_u8_ };
+    for (int s=0; s<sinks.size(); s++) {
+        for (int r=0; r<sinks[s]->size(); r++) {
+            for (int i=0; i<sinks[s]->at(r)->size(); i++) {
+                if (sinks[s]->at(r)->at(i)->decimated()) {
+                    sink_decimated_.push_back(sinks[s]->at(r)->at(i));
+                }
+            }
+        }
+    }
+    if (!sink_decimated_.empty()) {
+        // One bin is published per GUI frame, a few frames of slack is plenty
+        if (ring_.startup(8, (int)sink_decimated_.size() * plot_sink::frame_width) != jcs::RET_OK) {
+            std::cout << "gui_plot: Error starting sample ring\n";
+            return jcs::RET_ERROR;
+        }
+    }
+    frame_rt_.resize(sink_decimated_.size() * plot_sink::frame_width, 0.0f);
+    frame_gui_.resize(sink_decimated_.size() * plot_sink::frame_width, 0.0f);
+    dt_ = 1.0 / (double)host_->base_frequency_get();
+
     return jcs::RET_OK;
 }
 
@@ -105,7 +127,9 @@ int gui_plot::configure_storage(jcs::signal_type const type, std::vector<std::ve
                             std::cout << "gui_plot: Error getting output signal units at index " << i << "\n";
                             return jcs::RET_ERROR;
                         }
-                        sink_tmp->push_back(new plot_sink_plot(node_name, name, units, &sink_f32_store_[r][i]));
+                        // Base rate reads the shared per tick signals
+                        float const* val_ptr = (r == 0) ? &(*gui_if_->get_f32_output_signals())[i] : &sink_f32_store_[r][i];
+                        sink_tmp->push_back(new plot_sink_plot(node_name, name, units, val_ptr));
                     }
                     break;
                 case jcs::signal_type::uint32_s:
@@ -299,8 +323,7 @@ int gui_plot::step_rt() {
     // Perform data exchange with RT system
 
     // dev_host -> gui
-    // Base rate is always ticked
-    host_->sig_output_get_rt(0, &sink_f32_store_[0]);
+    // Base rate is always ticked. Float base rate is fetched once per tick by tool_gui
     host_->sig_output_get_rt(0, &sink_u32_store_[0]);
     host_->sig_output_get_rt(0, &sink_u16_store_[0]);
     host_->sig_output_get_rt(0, &sink_u8_store_[0]);
@@ -339,15 +362,46 @@ int gui_plot::step_rt() {
     // Setting the input value validates it for jcs_host
     if (signals_in_active_) {
         for (int r=0; r<host_->sig_input_rate_sz_rt(jcs::signal_type::float32_s); r++) {
+            if (r == 0) {
+                // Base rate is sent once per tick by tool_gui. Tools driving an input override its slider.
+                gui_if_->f32_input_signals_manual_rt(&source_f32_store_[r]);
+                continue;
+            }
             host_->sig_input_set_rt(r, source_f32_store_[r]);
             // host_->sig_input_set_rt(r, &source_u32_store_[r]);
             // host_->sig_input_set_rt(r, &source_u16_store_[r]);
             // host_->sig_input_set_rt(r, &source_u8_store_[r]);
         }
     }
+
+    // Accumulate every tick, publish when the GUI asks for the next bin
+    for (int i=0; i<sink_decimated_.size(); i++) {
+        sink_decimated_[i]->step_rt();
+    }
+    // Only publish if the frame will fit, so a bin is never dropped after its accumulators restart
+    if (publish_request_.load(std::memory_order_relaxed) && ring_.size() < ring_.capacity()) {
+        for (int i=0; i<sink_decimated_.size(); i++) {
+            sink_decimated_[i]->publish_rt(&frame_rt_[i * plot_sink::frame_width]);
+        }
+        ring_.push_rt((double)tick_rt_ * dt_, frame_rt_.data());
+        publish_request_.store(false, std::memory_order_relaxed);
+    }
     return jcs::RET_OK;    
 }
 
 int gui_plot::step_rt_always() {
+    // Time base for the plots, runs while the host is not selected
+    tick_rt_++;
+    return jcs::RET_OK;
+}
+
+int gui_plot::step_gui() {
+    double t;
+    while (ring_.pop(&t, frame_gui_.data())) {
+        for (int i=0; i<sink_decimated_.size(); i++) {
+            sink_decimated_[i]->add_frame(t, &frame_gui_[i * plot_sink::frame_width]);
+        }
+    }
+    publish_request_.store(true, std::memory_order_relaxed);
     return jcs::RET_OK;
 }
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include "gui_type_base.h"
 #include "gui_interface.h"
 #include "gui_device_host_base.h"
+#include "sample_ring.h"
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include "plot_sink.h"
 #include "plot_sink_opstate.h"
@@ -19,6 +22,8 @@ public:
     gui_plot(jcs::jcs_host* host, gui_interface* gui_if, std::string const& target_device) :
         gui_type_base("Signal Plot", host, gui_if, target_device) {
             signals_in_active_ = true;
+            publish_request_.store(false);
+            tick_rt_ = 0;
         }
     ~gui_plot() {}
 
@@ -26,6 +31,7 @@ public:
     int step_rt();
     int step_rt_always();
     int render();
+    int step_gui();
 
 private:
 
@@ -59,6 +65,16 @@ private:
 
     std::vector<plot_sink_opstate*>         sink_opstate_;
 
+    // Sinks with a trace. Sampled every RT tick and published as one min / max / mean
+    // bin per GUI frame, see plot_sink.
+    std::vector<plot_sink*> sink_decimated_;
+    sample_ring ring_;
+    std::vector<float> frame_rt_;
+    std::vector<float> frame_gui_;
+    std::atomic<bool> publish_request_;
+    uint64_t tick_rt_;
+    double dt_;
+
     bool signals_in_active_;
 };
 
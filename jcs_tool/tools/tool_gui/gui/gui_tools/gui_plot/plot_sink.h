@@ -13,9 +13,65 @@ public:
     ~plot_sink() {}
 
     virtual void update() = 0;
+
+    // Decimation, for sinks that plot a trace.
+    // step_rt() is called every RT tick, publish_rt() writes the ticks since the last publish
+    // as frame_width floats (min, max, mean, last) and restarts. add_frame() is called on the
+    // GUI thread with the published frame and the RT time at the end of the bin.
+    enum frame_idx {
+        frame_min = 0,
+        frame_max,
+        frame_mean,
+        frame_last,
+        frame_width
+    };
+    virtual bool decimated() { return false; }
+    virtual void step_rt() {}
+    virtual void publish_rt(float*) {}
+    virtual void add_frame(double, float const*) {}
+
 // private:
     std::string node_name_;
     std::string name_;
 };
 
-#endif
\ No newline at end of file
+// Min / max / mean accumulator for one signal, RT side only
+struct plot_sink_decimator {
+    float min_;
+    float max_;
+    double sum_;
+    float last_;
+    int count_;
+
+    plot_sink_decimator() : min_(0.0f), max_(0.0f), sum_(0.0), last_(0.0f), count_(0) {}
+
+    void add(float value) {
+        if (count_ == 0) {
+            min_ = value;
+            max_ = value;
+            sum_ = 0.0;
+        }
+        if (value < min_) { min_ = value; }
+        if (value > max_) { max_ = value; }
+        sum_ += value;
+        last_ = value;
+        count_++;
+    }
+
+    // An empty bin repeats the last value
+    void publish(float* frame) {
+        if (count_ == 0) {
+            frame[plot_sink::frame_min] = last_;
+            frame[plot_sink::frame_max] = last_;
+            frame[plot_sink::frame_mean] = last_;
+        } else {
+            frame[plot_sink::frame_min] = min_;
+            frame[plot_sink::frame_max] = max_;
+            frame[plot_sink::frame_mean] = (float)(sum_ / (double)count_);
+        }
+        frame[plot_sink::frame_last] = last_;
+        count_ = 0;
+    }
+};
+
+#endif
@@ -34,28 +34,53 @@ plot_sink_int::plot_sink_int(std::string const& node_name, std::string const& na
 void plot_sink_int::reset() {
     history_ = 10.0f;
     t_ = 0.0f;
+    value_ = 0.0f;
+    mean_prev_ = 0.0f;
     max_ = 0.0f;
     min_ = 0.0f;
 }
 
-// Currently just outputting as a plot
-void plot_sink_int::update() {
-    // Update data
-    float value;
+void plot_sink_int::step_rt() {
     switch (bit_width_) {
         default:
             return;
         case width::uint_32:
-            value= (float)(*val_prt_u32_);
+            decimator_.add((float)(*val_prt_u32_));
             break;
         case width::uint_16:
-            value = (float)(*val_prt_u16_);
+            decimator_.add((float)(*val_prt_u16_));
             break;
         case width::uint_8:
-            value = (float)(*val_prt_u8_);
+            decimator_.add((float)(*val_prt_u8_));
             break;
     }
+}
+
+void plot_sink_int::publish_rt(float* frame) {
+    decimator_.publish(frame);
+}
 
+void plot_sink_int::add_frame(double t, float const* frame) {
+    float t_start = (buffer_.data_.size() == 0) ? (float)t : t_;
+    t_ = (float)t;
+    value_ = frame[frame_last];
+
+    if (frame[frame_min] < min_) { min_ = frame[frame_min]; }
+    if (frame[frame_max] > max_) { max_ = frame[frame_max]; }
+
+    float t_mid = 0.5f * (t_start + t_);
+    if (frame[frame_mean] >= mean_prev_) {
+        buffer_.add_point(t_mid, frame[frame_min]);
+        buffer_.add_point(t_, frame[frame_max]);
+    } else {
+        buffer_.add_point(t_mid, frame[frame_max]);
+        buffer_.add_point(t_, frame[frame_min]);
+    }
+    mean_prev_ = frame[frame_mean];
+}
+
+// Currently just outputting as a plot
+void plot_sink_int::update() {
     // Plot column
     ImGui::TableNextRow();
     ImGui::TableSetColumnIndex(0);
@@ -77,17 +102,6 @@ void plot_sink_int::update() {
     
     ImGui::PopItemWidth();
 
-    if (value < min_) {
-        min_ = value;
-    }
-    if (value > max_) {
-        max_ = value;
-    }
-
-    t_ += ImGui::GetIO().DeltaTime;
-
-    buffer_.add_point(t_, value);
-
     static ImPlotAxisFlags flags = ImPlotAxisFlags_NoTickLabels | ImPlotFlags_NoFrame | ImPlotAxisFlags_AutoFit | 
                                    ImPlotAxisFlags_NoTickMarks | ImPlotAxisFlags_NoGridLines;;
 
@@ -99,7 +113,7 @@ void plot_sink_int::update() {
         ImPlot::SetupAxisLimits(ImAxis_X1, t_ - history_, t_, ImGuiCond_Always);
         ImPlot::SetupAxisLimits(ImAxis_Y1, -10, 10);
         ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
-        ImPlot::PlotLine("##", &buffer_.data_[0].x, &buffer_.data_[0].y, buffer_.data_.size(), 0, buffer_.offset_, 2*sizeof(float));
+        buffer_.plot_line("##");
         ImPlot::EndPlot();
     }
 
@@ -107,7 +121,7 @@ void plot_sink_int::update() {
     ImGui::TableSetColumnIndex(1);
     ImGui::Text("%s", node_name_.c_str());
     ImGui::Text("%s", name_.c_str());
-    ImGui::Text("Val: %.3f", value);
+    ImGui::Text("Val: %.3f", value_);
     ImGui::Text("Max: %.3f", max_);
     ImGui::Text("Min: %.3f", min_);
 
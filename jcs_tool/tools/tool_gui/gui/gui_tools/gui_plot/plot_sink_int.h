@@ -23,6 +23,11 @@ public:
     ~plot_sink_int() {}
 
     void update();
+
+    bool decimated() { return true; }
+    void step_rt();
+    void publish_rt(float* frame);
+    void add_frame(double t, float const* frame);
 private:
     void reset();
     width bit_width_;
@@ -30,9 +35,15 @@ private:
     uint16_t* val_prt_u16_;
     uint8_t*  val_prt_u8_;
 
+    // RT side
+    plot_sink_decimator decimator_;
+
+    // GUI side, two points per bin as plot_sink_plot
     helpers::scrolling_buffer buffer_;
     float history_;
     float t_;
+    float value_;
+    float mean_prev_;
 
     float min_;
     float max_;
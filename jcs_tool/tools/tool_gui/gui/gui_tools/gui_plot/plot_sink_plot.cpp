@@ -8,7 +8,7 @@
 #include "helpers.h"
 #include "tool_gui_settings.h"
 
-plot_sink_plot::plot_sink_plot(std::string const& node_name, std::string const& name, std::string const& units, float* val_ptr) :
+plot_sink_plot::plot_sink_plot(std::string const& node_name, std::string const& name, std::string const& units, float const* val_ptr) :
     plot_sink(node_name, name),
     buffer_(tool_gui_settings::signal_plot_max_buffer_length)
 {
@@ -17,20 +17,69 @@ plot_sink_plot::plot_sink_plot(std::string const& node_name, std::string const&
 
     history_ = 10.0f;
     t_ = 0.0f;
+    value_ = 0.0f;
+    mean_prev_ = 0.0f;
     max_ = 0.0f;
     min_ = 0.0f;
 
     ave_time_ = 1.0f;
     average_ = 0.0f;
-    average_count_ = 0;
+    average_sum_ = 0.0;
+    average_dt_ = 0.0;
+}
+
+void plot_sink_plot::step_rt() {
+    decimator_.add(*val_ptr_);
+}
+
+void plot_sink_plot::publish_rt(float* frame) {
+    decimator_.publish(frame);
+}
+
+void plot_sink_plot::add_frame(double t, float const* frame) {
+    // First bin has no start, draw it as a point
+    float t_start = (buffer_.data_.size() == 0) ? (float)t : t_;
+    t_ = (float)t;
+    value_ = frame[frame_last];
+
+    if (frame[frame_min] < min_) { min_ = frame[frame_min]; }
+    if (frame[frame_max] > max_) { max_ = frame[frame_max]; }
+
+    // Draw both extremes of the bin so peaks between GUI frames are not lost
+    float t_mid = 0.5f * (t_start + t_);
+    if (frame[frame_mean] >= mean_prev_) {
+        buffer_.add_point(t_mid, frame[frame_min]);
+        buffer_.add_point(t_, frame[frame_max]);
+    } else {
+        buffer_.add_point(t_mid, frame[frame_max]);
+        buffer_.add_point(t_, frame[frame_min]);
+    }
+    mean_prev_ = frame[frame_mean];
+
+    // Rolling average over time. Bins are weighted by their duration.
+    average_bin bin;
+    bin.t = t_;
+    bin.dt = (double)(t_ - t_start);
+    bin.sum = (double)frame[frame_mean] * bin.dt;
+    average_bins_.push_back(bin);
+    average_sum_ += bin.sum;
+    average_dt_ += bin.dt;
+    while (average_bins_.size() > 1 && average_bins_.front().t < t_ - ave_time_) {
+        average_sum_ -= average_bins_.front().sum;
+        average_dt_ -= average_bins_.front().dt;
+        average_bins_.pop_front();
+    }
+    if (average_dt_ > 0.0) {
+        average_ = (float)(average_sum_ / average_dt_);
+    } else {
+        average_ = frame[frame_mean];
+    }
 }
 
 void plot_sink_plot::update() {
     // Plot column
     ImGui::TableNextRow();
     ImGui::TableSetColumnIndex(0);
-    // Update data
-    float value = (float)(*val_ptr_);
 
     // Imgui internally hashes the text in button to generate an id
     // But! It needs a unique id. Generating heaps of "internal" labelled buttons
@@ -57,27 +106,6 @@ void plot_sink_plot::update() {
 
     ImGui::PopItemWidth();
 
-    if (value < min_) { min_ = value; }
-    if (value > max_) { max_ = value; }
-
-    t_ += ImGui::GetIO().DeltaTime;
-    buffer_.add_point(t_, value);
-
-    // Find time range to compute average over, then compute average
-    average_range_.Max = t_;
-    average_range_.Min = t_ - ave_time_;
-    average_count_ = 0;
-    double ave = 0.0;
-    for (int i=0; i<buffer_.data_.size(); ++i) {
-        if (average_range_.Contains(buffer_.data_[i].x)) {
-            ave += buffer_.data_[i].y;
-            average_count_++;
-        }
-    }
-    if (average_count_ > 0) {
-        average_ = (float)(ave / (double)average_count_);
-    }
-
     static ImPlotAxisFlags flags = ImPlotAxisFlags_NoTickLabels | ImPlotFlags_NoFrame | 
                                    ImPlotAxisFlags_NoTickMarks | ImPlotAxisFlags_NoGridLines;
 
@@ -94,7 +122,7 @@ void plot_sink_plot::update() {
         ImPlot::SetupAxisLimits(ImAxis_Y1, min_ - padding, max_ + padding, ImGuiCond_Always);
 
         ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
-        ImPlot::PlotLine("##", &buffer_.data_[0].x, &buffer_.data_[0].y, buffer_.data_.size(), 0, buffer_.offset_, 2*sizeof(float));
+        buffer_.plot_line("##");
         ImPlot::EndPlot();
     }
 
@@ -102,7 +130,7 @@ void plot_sink_plot::update() {
     ImGui::TableSetColumnIndex(1);
     ImGui::Text("%s", node_name_.c_str());
     ImGui::Text("%s", name_.c_str());
-    ImGui::Text("Val: %.3f", value);
+    ImGui::Text("Val: %.3f", value_);
     ImGui::Text("Ave: %.3f", average_);
     ImGui::Text("Max: %.3f", max_);
     ImGui::Text("Min: %.3f", min_);
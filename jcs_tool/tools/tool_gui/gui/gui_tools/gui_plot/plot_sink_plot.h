@@ -6,29 +6,48 @@
 
 #include "plot_sink.h"
 #include "helpers.h"
+#include <deque>
 
 class plot_sink_plot : public plot_sink {
 public:
-    plot_sink_plot(std::string const& node_name, std::string const& name, std::string const& units, float* val_ptr);
+    plot_sink_plot(std::string const& node_name, std::string const& name, std::string const& units, float const* val_ptr);
     ~plot_sink_plot() {}
 
     void update();
+
+    bool decimated() { return true; }
+    void step_rt();
+    void publish_rt(float* frame);
+    void add_frame(double t, float const* frame);
 private:
     std::string units_;
-    float* val_ptr_;
+    float const* val_ptr_;
+
+    // RT side
+    plot_sink_decimator decimator_;
 
+    // GUI side
+    // Two points per bin, min and max in the order the trace moved
     helpers::scrolling_buffer buffer_;
     float history_;
     float t_;
+    float value_;
+    float mean_prev_;
 
     float min_;
     float max_;
     // bool do_reset_y_axis_;
-    // Averaging
+    // Averaging, running sum over the bins inside ave_time_
+    struct average_bin {
+        float t;
+        double sum;
+        double dt;
+    };
+    std::deque<average_bin> average_bins_;
+    double average_sum_;
+    double average_dt_;
     float ave_time_;
     float average_;
-    int average_count_;
-    ImPlotRange average_range_;
 };
 
 #endif
\ No newline at end of file
@@ -3,16 +3,20 @@
 //
 #include "gui_stimulus.h"
 #include "helpers.h"
+#include "imgui_helpers.h"
 
-gui_stimulus::gui_stimulus(double sample_rate_hz) {
+gui_stimulus::gui_stimulus(double sample_rate_hz, param_worker* worker) {
     active_idx_ = 0;
 
     stimulus_source_.push_back(new stimulus_ramp(sample_rate_hz));
     stimulus_source_.push_back(new stimulus_chirp(sample_rate_hz));
+    stimulus_source_.push_back(new stimulus_multisine(sample_rate_hz));
     stimulus_source_.push_back(new stimulus_step(sample_rate_hz));
     stimulus_source_.push_back(new stimulus_const(sample_rate_hz));
+    stimulus_source_.push_back(new stimulus_csv(sample_rate_hz));
 
     for (int i=0; i<stimulus_source_.size(); i++) {
+        stimulus_source_[i]->worker_set(worker);
         source_names_.push_back(stimulus_source_[i]->name_get());
     }
 }
@@ -26,9 +30,15 @@ void gui_stimulus::stop() {
 bool gui_stimulus::is_running() {
     return stimulus_source_[active_idx_]->is_running();
 }
+bool gui_stimulus::table_ready() {
+    return stimulus_source_[active_idx_]->table_ready();
+}
 float gui_stimulus::value_get() {
     return stimulus_source_[active_idx_]->value_get();
 }
+bool gui_stimulus::periodic_get(stimulus_periodic* periodic) {
+    return stimulus_source_[active_idx_]->periodic_get(periodic);
+}
 
 void gui_stimulus::step_rt() {
     stimulus_source_[active_idx_]->step_rt();
@@ -37,7 +47,14 @@ void gui_stimulus::step_rt() {
 void gui_stimulus::render_parameters() {
 
     ImGui::PushID(this);
-    helpers::combo_select("Stimulus Source", &source_names_, &active_idx_, nullptr);
-    stimulus_source_[active_idx_]->render_parameters();
+    {
+        // The table being played or rendered is left alone
+        ImGuiDisabled running(is_running() || stimulus_source_[active_idx_]->table_building());
+        helpers::combo_select("Stimulus Source", &source_names_, &active_idx_, nullptr);
+        stimulus_source_[active_idx_]->render_parameters();
+    }
+    if (stimulus_source_[active_idx_]->table_truncated_get()) {
+        ImGui::TextColored(ImVec4(0.5f, 0.0f, 0.0f, 1.0f), "Stimulus truncated to %d samples", stimulus_source_[active_idx_]->table_length_get());
+    }
     ImGui::PopID();
 }
\ No newline at end of file
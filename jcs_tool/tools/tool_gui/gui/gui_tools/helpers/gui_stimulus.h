@@ -5,12 +5,14 @@
 #define GUI_STIMULUS_H_
 
 #include "stimulus.h"
+#include "param_worker.h"
 #include <vector>
 #include <string>
 
 class gui_stimulus {
 public:
-    gui_stimulus(double sample_rate_hz);
+    // Tables render on worker, see stimulus
+    gui_stimulus(double sample_rate_hz, param_worker* worker);
 
     void step_rt();
 
@@ -18,7 +20,10 @@ public:
     void start();
     void stop();
     bool is_running();
+    // Table in place for the current parameters. Gate starting on this.
+    bool table_ready();
     float value_get();
+    bool periodic_get(stimulus_periodic* periodic);
 
 private:
     std::vector<stimulus*> stimulus_source_;
@@ -3,38 +3,160 @@
 //
 #include "stimulus.h"
 #include "imgui.h"
+#include "imgui_helpers.h"
 #include "helpers.h"
+#include "tool_gui_settings.h"
+#include "ImGuiFileDialog.h"
+#include <kiss_fftr.h>
 #include <math.h>
+#include <stdlib.h>
+#include <fstream>
 
 #include <iostream>
 
 ////////////////////////////////////////////////////////////////////////////
 stimulus::stimulus(std::string const& name, double sample_rate_hz) :
-    name_(name)
+    name_(name),
+    play_state_(state::off_s),
+    start_pending_(false),
+    worker_(nullptr)
 {
     state_ = state::off_s;
     value_ = 0.0;
     zero_at_off_ = true;
     dt_ = 1.0 / sample_rate_hz;
     do_recompute_ = true;
+    table_truncated_ = false;
+    play_value_ = 0.0f;
+    build_truncated_ = false;
+    build_pending_ = false;
 }
 
 void stimulus::start() {
-    state_ = state::init_s;
+    start_pending_.store(true);
 }
 void stimulus::stop() {
     // Call zero at off here too.
     // Higher level may transition not call step_rt once stop has been called....
+    start_pending_.store(false);
     if (zero_at_off_) {
-        value_ = 0.0;
+        play_value_ = 0.0f;
     }
-    state_ = state::off_s;
+    // A table swap ends off anyway
+    state s = play_state_.load();
+    while (s != state::swap_s && !play_state_.compare_exchange_weak(s, state::off_s)) {}
 }
 bool stimulus::is_running() {
-    return (state_ == state::running_s) || (state_ == state::init_s);
+    state s = play_state_.load();
+    return start_pending_.load() || (s == state::running_s) || (s == state::init_s);
 }
 float stimulus::value_get() {
-    return static_cast<float>(value_);
+    return play_value_;
+}
+
+bool stimulus::table_building() {
+    return build_job_ && build_job_->active();
+}
+bool stimulus::table_ready() {
+    return !table_building() && !build_pending_ && !do_recompute_;
+}
+
+void stimulus::table_build() {
+    table_prepare();
+    // Sample k of the table is the value step k of a live run would have produced
+    build_table_.clear();
+    state_ = state::init_s;
+    value_ = 0.0;
+    while (state_ != state::off_s && (int)build_table_.size() < tool_gui_settings::stimulus_table_max_length) {
+        generate_step();
+        build_table_.push_back(static_cast<float>(value_));
+    }
+    build_truncated_ = (state_ != state::off_s);
+    state_ = state::off_s;
+}
+
+bool stimulus::table_swap() {
+    // Only while playback is off. A start meanwhile waits in start_pending_ for the swap to end.
+    state s = state::off_s;
+    if (start_pending_.load() || !play_state_.compare_exchange_strong(s, state::swap_s)) {
+        return false;
+    }
+    table_.samples().swap(build_table_);
+    table_truncated_ = build_truncated_;
+    play_state_.store(state::off_s);
+    // Release the old table
+    std::vector<float>().swap(build_table_);
+    build_pending_ = false;
+    return true;
+}
+
+void stimulus::table_update() {
+    if (table_building()) {
+        return;
+    }
+    // Retried until playback is off
+    if (build_pending_) {
+        table_swap();
+    }
+    if (!do_recompute_ || is_running()) {
+        return;
+    }
+    do_recompute_ = false;
+    if (worker_ == nullptr) {
+        table_build();
+        build_pending_ = true;
+        table_swap();
+        return;
+    }
+    build_job_ = worker_->submit("Stimulus " + name_, [this](param_job&) {
+        table_build();
+        return jcs::RET_OK;
+    }, [this](param_job& job) {
+        if (job.get_status() != param_job::status::done) {
+            do_recompute_ = true;
+            return;
+        }
+        build_pending_ = true;
+        table_swap();
+    }, "stimulus");
+}
+
+void stimulus::step_rt() {
+    if (start_pending_.exchange(false)) {
+        state s = play_state_.load();
+        while (s != state::swap_s && !play_state_.compare_exchange_weak(s, state::init_s)) {}
+        if (s == state::swap_s) {
+            // Table is being replaced, start once it is in place
+            start_pending_.store(true);
+        }
+    }
+
+    state s = play_state_.load();
+    switch (s) {
+        default:
+        case state::off_s:
+        case state::swap_s:
+            if (zero_at_off_) {
+                play_value_ = 0.0f;
+            }
+            break;
+
+        case state::init_s:
+            table_.reset_rt();
+            if (!play_state_.compare_exchange_strong(s, state::running_s)) {
+                // Stopped
+                break;
+            }
+            // Fall through
+        case state::running_s:
+            play_value_ = table_.step_rt();
+            if (table_.is_done_rt()) {
+                // Done, unless stopped meanwhile
+                s = state::running_s;
+                play_state_.compare_exchange_strong(s, state::off_s);
+            }
+            break;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -63,11 +185,11 @@ void stimulus_ramp::render_parameters() {
 
     if (do_recompute_) {
         ramp_increment_ = ( (ramp_end_ - ramp_start_) / ramp_time_s_) * dt_;
-        do_recompute_ = false;
     }
+    table_update();
 }
 
-void stimulus_ramp::step_rt() {
+void stimulus_ramp::generate_step() {
     switch (state_) {
         default:
         case state::off_s:
@@ -128,7 +250,7 @@ void stimulus_chirp::render_parameters() {
     if (ImGui::InputScalar("Frequency start (Hz)", ImGuiDataType_Double, &frequency_start_hz_, &f64_one)) { do_recompute_ = true; }
     if (ImGui::InputScalar("Frequency end (Hz)",   ImGuiDataType_Double, &frequency_end_hz_, &f64_one))   { do_recompute_ = true; }
 
-    ImGui::InputScalar("Amplitude",                ImGuiDataType_Double, &amplitude_, &f64_one);
+    if (ImGui::InputScalar("Amplitude",            ImGuiDataType_Double, &amplitude_, &f64_one)) { do_recompute_ = true; }
 
     if (ImGui::InputScalar("Chirp time (s)",       ImGuiDataType_Double, &chirp_time_s_, &f64_one)) { do_recompute_ = true;}
 
@@ -139,11 +261,11 @@ void stimulus_chirp::render_parameters() {
     if (do_recompute_) {
         w0_ = 2.0 * M_PI * frequency_start_hz_ * dt_;
         w1_ = 2.0 * M_PI * frequency_end_hz_ * dt_;
-        do_recompute_ = false;
     }
+    table_update();
 }
 
-void stimulus_chirp::step_rt() {
+void stimulus_chirp::generate_step() {
     switch (state_) {
         default:
         case state::off_s:
@@ -176,6 +298,208 @@ void stimulus_chirp::step_rt() {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////
+stimulus_multisine::stimulus_multisine(double sample_rate_hz) :
+    stimulus("Multisine", sample_rate_hz)
+{
+    frequency_start_hz_ = 1.0;
+    frequency_end_hz_ = 100.0;
+    amplitude_ = 1.0;
+    period_s_ = 1.0;
+    line_spacing_ = 1;
+    periods_ = 4;
+    transient_periods_ = 1;
+    crest_iterations_ = 20;
+    crest_factor_schroeder_ = 0.0;
+    crest_factor_ = 0.0;
+    idx_ = 0;
+    period_count_ = 0;
+}
+
+void stimulus_multisine::render_parameters() {
+    const double f64_one = 1.0;
+    const int i32_one = 1;
+
+    ImGui::PushID(this);
+
+    if (ImGui::InputScalar("Frequency start (Hz)", ImGuiDataType_Double, &frequency_start_hz_, &f64_one)) { do_recompute_ = true; }
+    if (ImGui::InputScalar("Frequency end (Hz)",   ImGuiDataType_Double, &frequency_end_hz_, &f64_one))   { do_recompute_ = true; }
+    if (ImGui::InputScalar("Amplitude (peak)",     ImGuiDataType_Double, &amplitude_, &f64_one))          { do_recompute_ = true; }
+    if (ImGui::InputScalar("Period (s)",           ImGuiDataType_Double, &period_s_, &f64_one))           { do_recompute_ = true; }
+    if (ImGui::InputScalar("Line spacing (bins)",  ImGuiDataType_S32,    &line_spacing_, &i32_one))       { do_recompute_ = true; }
+    if (ImGui::InputScalar("Crest iterations",     ImGuiDataType_S32,    &crest_iterations_, &i32_one))   { do_recompute_ = true; }
+    if (ImGui::InputScalar("Transient periods",    ImGuiDataType_S32,    &transient_periods_, &i32_one))  { do_recompute_ = true; }
+    if (ImGui::InputScalar("Measured periods",     ImGuiDataType_S32,    &periods_, &i32_one))            { do_recompute_ = true; }
+    ImGui::Checkbox("Zero at multisine off", &zero_at_off_);
+
+    if (transient_periods_ < 0) { transient_periods_ = 0; }
+    if (periods_ < 1) { periods_ = 1; }
+
+    // The period is rebuilt along with the table
+    table_update();
+
+    if (table_building()) {
+        ImGui::Text("Rendering...");
+    } else if (period_.empty()) {
+        ImGui::TextColored(ImVec4(0.5f, 0.0f, 0.0f, 1.0f), "No lines between the start and end frequency");
+    } else {
+        ImGui::Text("Lines: %d, resolution: %.4f Hz, crest factor: %.3f (Schroeder %.3f), total time: %.2f s",
+            (int)lines_.size(), 1.0 / (period_.size() * dt_), crest_factor_, crest_factor_schroeder_,
+            (double)((transient_periods_ + periods_) * period_.size()) * dt_);
+    }
+    ImGui::PopID();
+}
+
+static double crest_factor_get(std::vector<double> const& x) {
+    double peak = 0.0;
+    double sumsq = 0.0;
+    for (int i=0; i<x.size(); i++) {
+        peak = fmax(peak, fabs(x[i]));
+        sumsq += x[i] * x[i];
+    }
+    if (sumsq <= 0.0) {
+        return 0.0;
+    }
+    return peak / sqrt(sumsq / (double)x.size());
+}
+
+void stimulus_multisine::table_prepare() {
+    period_.clear();
+    lines_.clear();
+
+    int n = (int)round(period_s_ / dt_);
+    n += n % 2;
+    if (n < 4) {
+        return;
+    }
+    double df = 1.0 / ((double)n * dt_);
+    int k_start = (int)ceil(frequency_start_hz_ / df);
+    int k_end = (int)floor(frequency_end_hz_ / df);
+    if (k_start < 1) { k_start = 1; }
+    if (k_end > n/2 - 1) { k_end = n/2 - 1; }
+    if (line_spacing_ < 1) { line_spacing_ = 1; }
+    for (int k=k_start; k<=k_end; k+=line_spacing_) {
+        lines_.push_back(k);
+    }
+    if (lines_.empty()) {
+        return;
+    }
+
+    int n_bins = n/2 + 1;
+    std::vector<kiss_fft_cpx> spectrum(n_bins);
+    std::vector<double> x(n);
+    kiss_fftr_cfg fwd = kiss_fftr_alloc(n, 0, NULL, NULL);
+    kiss_fftr_cfg inv = kiss_fftr_alloc(n, 1, NULL, NULL);
+
+    // Schroeder phases, unit amplitude lines
+    for (int k=0; k<n_bins; k++) {
+        spectrum[k].r = 0.0;
+        spectrum[k].i = 0.0;
+    }
+    double n_lines = (double)lines_.size();
+    for (int i=0; i<lines_.size(); i++) {
+        double phase = -M_PI * (double)i * (double)(i + 1) / n_lines;
+        spectrum[lines_[i]].r = cos(phase);
+        spectrum[lines_[i]].i = sin(phase);
+    }
+    kiss_fftri(inv, spectrum.data(), x.data());
+    crest_factor_schroeder_ = crest_factor_get(x);
+
+    // Clip the peaks, then restore the line amplitudes keeping the new phases
+    std::vector<double> best = x;
+    double best_crest = crest_factor_schroeder_;
+    for (int it=0; it<crest_iterations_; it++) {
+        double peak = 0.0;
+        for (int i=0; i<n; i++) {
+            peak = fmax(peak, fabs(x[i]));
+        }
+        double clip = 0.9 * peak;
+        for (int i=0; i<n; i++) {
+            x[i] = fmin(fmax(x[i], -clip), clip);
+        }
+        kiss_fftr(fwd, x.data(), spectrum.data());
+        int line = 0;
+        for (int k=0; k<n_bins; k++) {
+            if (line < lines_.size() && lines_[line] == k) {
+                double mag = sqrt(spectrum[k].r * spectrum[k].r + spectrum[k].i * spectrum[k].i);
+                if (mag > 0.0) {
+                    spectrum[k].r /= mag;
+                    spectrum[k].i /= mag;
+                } else {
+                    spectrum[k].r = 1.0;
+                }
+                line++;
+            } else {
+                spectrum[k].r = 0.0;
+                spectrum[k].i = 0.0;
+            }
+        }
+        kiss_fftri(inv, spectrum.data(), x.data());
+        double crest = crest_factor_get(x);
+        if (crest < best_crest) {
+            best_crest = crest;
+            best = x;
+        }
+    }
+    kiss_fftr_free(fwd);
+    kiss_fftr_free(inv);
+    crest_factor_ = best_crest;
+
+    // Scale to the requested peak
+    double peak = 0.0;
+    for (int i=0; i<n; i++) {
+        peak = fmax(peak, fabs(best[i]));
+    }
+    period_.resize(n);
+    for (int i=0; i<n; i++) {
+        period_[i] = best[i] * amplitude_ / peak;
+    }
+}
+
+bool stimulus_multisine::periodic_get(stimulus_periodic* periodic) {
+    if (table_building() || period_.empty()) {
+        return false;
+    }
+    periodic->period_samples = period_.size();
+    periodic->transient_periods = transient_periods_;
+    periodic->periods = periods_;
+    periodic->lines = lines_;
+    return true;
+}
+
+void stimulus_multisine::generate_step() {
+    switch (state_) {
+        default:
+        case state::off_s:
+            if (zero_at_off_) {
+                value_ = 0.0;
+            }
+            break;
+
+        case state::init_s:
+            if (period_.empty()) {
+                state_ = state::off_s;
+                break;
+            }
+            idx_ = 0;
+            period_count_ = 0;
+            state_ = state::running_s;
+            // Fall through, first sample of the period goes out on this tick
+        case state::running_s:
+            value_ = period_[idx_];
+            idx_++;
+            if (idx_ >= period_.size()) {
+                idx_ = 0;
+                period_count_++;
+                if (period_count_ >= transient_periods_ + periods_) {
+                    // Done
+                    state_ = state::off_s;
+                }
+            }
+            break;
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////
 stimulus_step::stimulus_step(double sample_rate_hz) : 
     stimulus("Step", sample_rate_hz)
@@ -201,12 +525,10 @@ void stimulus_step::render_parameters() {
 
     ImGui::PopID();
 
-    if (do_recompute_) {
-        do_recompute_ = false;
-    }
+    table_update();
 }
 
-void stimulus_step::step_rt() {
+void stimulus_step::generate_step() {
     switch (state_) {
         default:
         case state::off_s:
@@ -267,12 +589,10 @@ void stimulus_const::render_parameters() {
 
     ImGui::PopID();
 
-    if (do_recompute_) {
-        do_recompute_ = false;
-    }
+    table_update();
 }
 
-void stimulus_const::step_rt() {
+void stimulus_const::generate_step() {
     switch (state_) {
         default:
         case state::off_s:
@@ -294,4 +614,146 @@ void stimulus_const::step_rt() {
             }
             break;
     }
-}
\ No newline at end of file
+}
+////////////////////////////////////////////////////////////////////////////
+stimulus_csv::stimulus_csv(double sample_rate_hz) :
+    stimulus("CSV", sample_rate_hz)
+{
+    time_column_ = false;
+    scale_ = 1.0;
+    idx_ = 0;
+}
+
+void stimulus_csv::render_parameters() {
+    const double f64_one = 1.0;
+
+    ImGui::PushID(this);
+
+    if (ImGui::Button("Load CSV")) {
+        IGFD::FileDialogConfig config;
+        config.path = ".";
+        ImGuiFileDialog::Instance()->OpenDialog("stimulus_csv_key", "Choose File", ".csv", config);
+    }
+    if (ImGuiFileDialog::Instance()->Display("stimulus_csv_key")) {
+        if (ImGuiFileDialog::Instance()->IsOk()) {
+            load(ImGuiFileDialog::Instance()->GetFilePathName());
+            do_recompute_ = true;
+        }
+        ImGuiFileDialog::Instance()->Close();
+    }
+
+    if (ImGui::Checkbox("Time column", &time_column_)) {
+        if (!file_name_.empty()) {
+            load(file_name_);
+        }
+        do_recompute_ = true;
+    }
+    if (ImGui::InputScalar("Scale", ImGuiDataType_Double, &scale_, &f64_one)) { do_recompute_ = true; }
+
+    ImGui::Checkbox("Zero at CSV off", &zero_at_off_);
+
+    ImGui::PopID();
+
+    table_update();
+
+    if (file_name_.empty()) {
+        ImGui::Text("No file loaded");
+    } else {
+        ImGui::Text("%s: %d samples, %.3f s", file_name_.c_str(), (int)samples_.size(), samples_.size() * dt_);
+    }
+}
+
+int stimulus_csv::load(std::string const& path_and_file) {
+    file_name_ = path_and_file;
+    samples_.clear();
+
+    std::ifstream file(path_and_file);
+    if (!file.is_open()) {
+        std::cout << "stimulus_csv: Failed to open " << path_and_file << "\n";
+        return jcs::RET_ERROR;
+    }
+
+    std::vector<double> t;
+    std::vector<double> x;
+    std::string line;
+    while (std::getline(file, line)) {
+        char const* s = line.c_str();
+        char* end;
+        double a = strtod(s, &end);
+        if (end == s) {
+            continue;
+        }
+        if (!time_column_) {
+            x.push_back(a);
+            continue;
+        }
+        // Skip the separator
+        while (*end == ',' || *end == ' ' || *end == '\t') {
+            end++;
+        }
+        s = end;
+        double b = strtod(s, &end);
+        if (end == s) {
+            continue;
+        }
+        // Time must increase
+        if (!t.empty() && a <= t.back()) {
+            continue;
+        }
+        t.push_back(a);
+        x.push_back(b);
+    }
+
+    if (!time_column_) {
+        samples_ = x;
+        return jcs::RET_OK;
+    }
+    if (t.empty()) {
+        return jcs::RET_OK;
+    }
+
+    // Linear resample to the base rate, starting at the first time stamp
+    int j = 0;
+    for (double ts = t[0]; ts <= t.back(); ts = t[0] + samples_.size() * dt_) {
+        while (j + 1 < (int)t.size() - 1 && t[j + 1] <= ts) {
+            j++;
+        }
+        if (t.size() == 1) {
+            samples_.push_back(x[0]);
+            break;
+        }
+        double a = (ts - t[j]) / (t[j + 1] - t[j]);
+        if (a > 1.0) {
+            a = 1.0;
+        }
+        samples_.push_back(x[j] + a * (x[j + 1] - x[j]));
+    }
+    return jcs::RET_OK;
+}
+
+void stimulus_csv::generate_step() {
+    switch (state_) {
+        default:
+        case state::off_s:
+            if (zero_at_off_) {
+                value_ = 0.0;
+            }
+            break;
+
+        case state::init_s:
+            idx_ = 0;
+            state_ = state::running_s;
+            // Fall through
+        case state::running_s:
+            if (samples_.empty()) {
+                state_ = state::off_s;
+                break;
+            }
+            value_ = scale_ * samples_[idx_];
+            idx_++;
+            if (idx_ >= (int)samples_.size()) {
+                state_ = state::off_s;
+            }
+            break;
+    }
+}
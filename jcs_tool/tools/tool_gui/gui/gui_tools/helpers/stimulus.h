@@ -5,35 +5,94 @@
 #ifndef STIMULUS_H_
 #define STIMULUS_H_
 
+#include <atomic>
 #include <string>
+#include <vector>
+#include "waveform_table.h"
+#include "param_worker.h"
+
+// Periodic excitation. A capture that skips the transient periods holds an integer
+// number of periods, so each period can be transformed without a window.
+struct stimulus_periodic {
+    int period_samples;
+    int transient_periods;
+    int periods;
+    std::vector<int> lines;     // Excited bins of a period_samples point FFT
+    stimulus_periodic() : period_samples(0), transient_periods(0), periods(0) {}
+};
 
 ////////////////////////////////////////////////////////////////////////////
+// A stimulus is rendered into a table on the parameter worker whenever its
+// parameters change, by running generate_step() from init_s until it turns itself
+// off. The parameters are locked while the table renders. The new table replaces
+// the played one only while playback is off. step_rt() only plays the table back.
 class stimulus {
 public:
     stimulus(std::string const& name, double sample_rate_hz);
 
     std::string const& name_get() { return name_; }
+    // Renders run inline without a worker
+    void worker_set(param_worker* worker) { worker_ = worker; }
 
-    virtual void step_rt() = 0;
+    void step_rt();
     virtual void render_parameters() = 0;
 
+    // start() may be called from the RT thread, it is taken by the next step_rt()
     void start();
     void stop();
     bool is_running();
     float value_get();
 
+    // Returns false for non periodic stimulus
+    virtual bool periodic_get(stimulus_periodic*) { return false; }
+
+    // Samples rendered, and whether the table hit its maximum length
+    int table_length_get() { return table_.size(); }
+    bool table_truncated_get() { return table_truncated_; }
+    // Rendering, parameters are locked
+    bool table_building();
+    // The played table matches the parameters
+    bool table_ready();
+
 protected:
+    // One sample of the waveform. Uses state_ and value_, never called from the RT thread.
+    virtual void generate_step() = 0;
+    // Runs before the first generate_step() of a render, on the same thread
+    virtual void table_prepare() {}
+    // GUI thread. Start a render if the parameters changed and put a finished one in place.
+    void table_update();
+
     enum class state {
         off_s,
         init_s,
-        running_s
+        running_s,
+        swap_s      // Playback only, the GUI is replacing the table
     };
+    // Generator
     state state_;
     double dt_;
     double value_;
     std::string name_;
     bool zero_at_off_;
     bool do_recompute_;
+
+private:
+    void table_build();
+    bool table_swap();
+
+    // Playback
+    waveform_table table_;
+    bool table_truncated_;
+    std::atomic<state> play_state_;
+    std::atomic<bool> start_pending_;
+    float play_value_;
+
+    // Render, owned by build_job_ while it is active
+    param_worker* worker_;
+    param_job_ptr build_job_;
+    std::vector<float> build_table_;
+    bool build_truncated_;
+    bool build_pending_;
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -42,10 +101,10 @@ public:
     stimulus_ramp(double sample_rate_hz);
     ~stimulus_ramp() {}
 
-    void step_rt();
     void render_parameters();
 
 private:
+    void generate_step();
     double ramp_end_;
     double ramp_start_;
     double ramp_increment_;
@@ -58,10 +117,10 @@ public:
     stimulus_chirp(double sample_rate_hz);
     ~stimulus_chirp() {}
 
-    void step_rt();
     void render_parameters();
 
 private:
+    void generate_step();
     double w0_;
     double w1_;
     double amplitude_;
@@ -72,15 +131,51 @@ private:
     double frequency_end_hz_;
 };
 
+////////////////////////////////////////////////////////////////////////////
+// Multisine with Schroeder phases, refined by clipping to lower the crest factor.
+// One period is computed when the parameters change and repeated for
+// transient + measured periods.
+class stimulus_multisine : public stimulus {
+public:
+    stimulus_multisine(double sample_rate_hz);
+    ~stimulus_multisine() {}
+
+    void render_parameters();
+    bool periodic_get(stimulus_periodic* periodic);
+
+private:
+    void generate_step();
+    void table_prepare();
+
+    double frequency_start_hz_;
+    double frequency_end_hz_;
+    double amplitude_;
+    double period_s_;
+    int line_spacing_;
+    int periods_;
+    int transient_periods_;
+    int crest_iterations_;
+
+    // One period
+    std::vector<double> period_;
+    std::vector<int> lines_;
+    double crest_factor_schroeder_;
+    double crest_factor_;
+
+    int idx_;
+    int period_count_;
+};
+
 ////////////////////////////////////////////////////////////////////////////
 class stimulus_step : public stimulus {
 public:
     stimulus_step(double sample_rate_hz);
     ~stimulus_step() {}
 
-    void step_rt();
     void render_parameters();
+
 private:
+    void generate_step();
     enum class step_state {
         start_s,
         step_s,
@@ -99,13 +194,34 @@ public:
     stimulus_const(double sample_rate_hz);
     ~stimulus_const() {}
 
-    void step_rt();
     void render_parameters();
 
 private:
+    void generate_step();
     double const_value_;
     double const_time_s_;
     double t_;
 };
 
+////////////////////////////////////////////////////////////////////////////
+// User waveform from a CSV file. One value per line at the base rate, or time and value
+// columns resampled to the base rate. Lines that do not parse, e.g. a header, are skipped.
+class stimulus_csv : public stimulus {
+public:
+    stimulus_csv(double sample_rate_hz);
+    ~stimulus_csv() {}
+
+    void render_parameters();
+
+private:
+    void generate_step();
+    int load(std::string const& path_and_file);
+
+    std::string file_name_;
+    bool time_column_;
+    double scale_;
+    std::vector<double> samples_;
+    int idx_;
+};
+
 #endif
\ No newline at end of file
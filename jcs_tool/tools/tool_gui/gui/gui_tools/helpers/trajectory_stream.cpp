@@ -0,0 +1,238 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "trajectory_stream.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "jcs_host.h"
+#include "task_rt_config.h"
+
+static char const trajectory_magic[8] = {'J', 'C', 'S', 'T', 'R', 'A', 'J', '1'};
+static size_t const trajectory_name_length = 64;
+
+trajectory_stream::trajectory_stream() :
+    fd_(-1),
+    map_(nullptr),
+    map_size_(0),
+    data_(nullptr),
+    n_channels_(0),
+    n_frames_(0),
+    sample_rate_hz_(0),
+    fill_frame_(0),
+    released_bytes_(0),
+    fill_slot_(0),
+    read_slot_(0),
+    read_idx_(0),
+    done_(true),
+    last_frame_(nullptr),
+    underruns_(0),
+    frames_played_(0),
+    running_(false)
+{
+    for (int i=0; i<2; i++) {
+        buffers_[i].n = 0;
+        buffers_[i].ready = false;
+        buffers_[i].last = true;
+    }
+}
+
+trajectory_stream::~trajectory_stream() {
+    close();
+}
+
+int trajectory_stream::open(std::string const& path_and_file) {
+    close();
+
+    fd_ = ::open(path_and_file.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        std::cout << "trajectory_stream: Failed to open " << path_and_file << "\n";
+        return jcs::RET_ERROR;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size < 16) {
+        std::cout << "trajectory_stream: " << path_and_file << " is not a trajectory file\n";
+        close();
+        return jcs::RET_ERROR;
+    }
+    map_size_ = st.st_size;
+    map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (map_ == MAP_FAILED) {
+        std::cout << "trajectory_stream: Failed to map " << path_and_file << "\n";
+        map_ = nullptr;
+        close();
+        return jcs::RET_ERROR;
+    }
+    madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+    char const* p = static_cast<char const*>(map_);
+    uint32_t n_channels;
+    memcpy(&n_channels, p + 8, sizeof(uint32_t));
+    memcpy(&sample_rate_hz_, p + 12, sizeof(uint32_t));
+    size_t header = 16 + (size_t)n_channels * trajectory_name_length;
+    if (memcmp(p, trajectory_magic, sizeof(trajectory_magic)) != 0 || n_channels == 0 || header > map_size_) {
+        std::cout << "trajectory_stream: " << path_and_file << " is not a trajectory file\n";
+        close();
+        return jcs::RET_ERROR;
+    }
+    n_channels_ = n_channels;
+    n_frames_ = (map_size_ - header) / (sizeof(float) * n_channels_);
+    for (int i=0; i<n_channels_; i++) {
+        char const* name = p + 16 + i * trajectory_name_length;
+        channel_names_.push_back(std::string(name, strnlen(name, trajectory_name_length)));
+    }
+    data_ = reinterpret_cast<float const*>(p + header);
+
+    for (int i=0; i<2; i++) {
+        buffers_[i].frames.resize(block_frames * n_channels_);
+    }
+    hold_frame_.assign(n_channels_, 0.0f);
+    return jcs::RET_OK;
+}
+
+void trajectory_stream::close() {
+    play_stop();
+    if (map_ != nullptr) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    map_size_ = 0;
+    data_ = nullptr;
+    n_channels_ = 0;
+    n_frames_ = 0;
+    sample_rate_hz_ = 0;
+    channel_names_.clear();
+}
+
+int trajectory_stream::play_start() {
+    play_stop();
+    if (!is_open()) {
+        return jcs::RET_ERROR;
+    }
+    // Released pages fault back in from the file
+    fill_frame_ = 0;
+    released_bytes_ = 0;
+    fill_slot_ = 0;
+    for (int i=0; i<2; i++) {
+        buffers_[i].ready = false;
+    }
+    block_fill(0);
+    block_fill(1);
+
+    read_slot_ = 0;
+    read_idx_ = 0;
+    done_ = false;
+    hold_frame_.assign(n_channels_, 0.0f);
+    last_frame_ = hold_frame_.data();
+    underruns_ = 0;
+    frames_played_ = 0;
+
+    running_ = true;
+    thread_ = std::thread(&trajectory_stream::run, this);
+    return jcs::RET_OK;
+}
+
+void trajectory_stream::play_stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    thread_.join();
+}
+
+bool trajectory_stream::frame_next_rt(float const** frame) {
+    *frame = last_frame_;
+    if (done_) {
+        return false;
+    }
+    buffer& b = buffers_[read_slot_];
+    if (!b.ready.load(std::memory_order_acquire)) {
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (read_idx_ >= b.n) {
+        // Empty last block
+        done_ = true;
+        return false;
+    }
+    last_frame_ = &b.frames[read_idx_ * n_channels_];
+    *frame = last_frame_;
+    read_idx_++;
+    frames_played_.fetch_add(1, std::memory_order_relaxed);
+
+    if (read_idx_ >= b.n) {
+        if (b.last) {
+            // Buffer kept, last_frame_ stays valid
+            done_ = true;
+        } else {
+            memcpy(hold_frame_.data(), last_frame_, n_channels_ * sizeof(float));
+            last_frame_ = hold_frame_.data();
+            read_idx_ = 0;
+            read_slot_ ^= 1;
+            b.ready.store(false, std::memory_order_release);
+        }
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Prefetch thread
+void trajectory_stream::block_fill(int slot) {
+    buffer& b = buffers_[slot];
+    int64_t n = n_frames_ - fill_frame_;
+    if (n > block_frames) {
+        n = block_frames;
+    }
+    if (n < 0) {
+        n = 0;
+    }
+    memcpy(b.frames.data(), data_ + fill_frame_ * n_channels_, n * n_channels_ * sizeof(float));
+    fill_frame_ += n;
+    b.n = n;
+    b.last = (fill_frame_ >= n_frames_);
+    b.ready.store(true, std::memory_order_release);
+
+    // Drop the pages already copied and read the next block ahead
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t offset = reinterpret_cast<char const*>(data_ + fill_frame_ * n_channels_) - static_cast<char const*>(map_);
+    size_t release = (offset / page) * page;
+    if (release > released_bytes_) {
+        madvise(static_cast<char*>(map_) + released_bytes_, release - released_bytes_, MADV_DONTNEED);
+        released_bytes_ = release;
+    }
+    if (!b.last) {
+        size_t ahead = block_frames * n_channels_ * sizeof(float);
+        if (release + ahead > map_size_) {
+            ahead = map_size_ - release;
+        }
+        madvise(static_cast<char*>(map_) + release, ahead, MADV_WILLNEED);
+    }
+}
+
+void trajectory_stream::run() {
+    task_rt::thd_sched sched;
+    if (task_rt::sched_named_get("stream", &sched)) {
+        if (task_rt::sched_apply_self(sched) != jcs::RET_OK) {
+            std::cout << "trajectory_stream: Could not apply stream thread config\n";
+        }
+    }
+
+    while (running_) {
+        // Slots are consumed in turn, so they are refilled in turn
+        buffer& b = buffers_[fill_slot_];
+        if (!b.ready.load(std::memory_order_acquire) && fill_frame_ < n_frames_) {
+            block_fill(fill_slot_);
+            fill_slot_ ^= 1;
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
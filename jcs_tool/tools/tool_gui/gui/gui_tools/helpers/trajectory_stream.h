@@ -0,0 +1,95 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef TRAJECTORY_STREAM_H_
+#define TRAJECTORY_STREAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Multi channel trajectory played from a memory mapped file.
+//
+// A prefetch thread copies blocks of frames from the mapping into two buffers. The RT
+// thread reads frames from one buffer while the other is refilled, so it never touches
+// the mapping and never blocks. Consumed parts of the file are released from the mapping,
+// memory use is two blocks whatever the file length.
+//
+// File format, little endian:
+//   char[8]    "JCSTRAJ1"
+//   uint32     n_channels
+//   uint32     sample_rate_hz
+//   char[64]   channel name, one per channel. Input signal name, zero padded. May be empty.
+//   float32    frames, n_channels values per frame, to the end of the file
+class trajectory_stream {
+public:
+    trajectory_stream();
+    ~trajectory_stream();
+
+    // Non RT side. Not while playing.
+    int open(std::string const& path_and_file);
+    void close();
+    bool is_open() { return data_ != nullptr; }
+    int n_channels() { return n_channels_; }
+    int64_t n_frames() { return n_frames_; }
+    uint32_t sample_rate_hz() { return sample_rate_hz_; }
+    std::vector<std::string> const& channel_names() { return channel_names_; }
+
+    // Fills both buffers from the start of the file, then the RT side may play
+    int play_start();
+    void play_stop();
+    uint64_t underrun_count() { return underruns_.load(std::memory_order_relaxed); }
+    int64_t frames_played() { return frames_played_.load(std::memory_order_relaxed); }
+
+    // RT side. Next frame, n_channels values. Returns false when the file is done.
+    // On underrun the previous frame is repeated.
+    bool frame_next_rt(float const** frame);
+
+private:
+    void run();
+    // Prefetch thread. Copies the next block into slot.
+    void block_fill(int slot);
+
+    static int const block_frames = 4096;
+
+    // Mapping
+    int fd_;
+    void* map_;
+    size_t map_size_;
+    float const* data_;
+    int n_channels_;
+    int64_t n_frames_;
+    uint32_t sample_rate_hz_;
+    std::vector<std::string> channel_names_;
+
+    // Buffers. A slot is owned by the prefetch thread until ready, then by the RT thread
+    // until it sets it empty again.
+    struct buffer {
+        std::vector<float> frames;
+        int n;
+        std::atomic<bool> ready;
+        bool last;
+    };
+    buffer buffers_[2];
+    int64_t fill_frame_;        // Next frame to copy, prefetch thread
+    size_t released_bytes_;     // Mapping before this offset is released
+    int fill_slot_;
+
+    // RT owned
+    int read_slot_;
+    int read_idx_;
+    bool done_;
+    float const* last_frame_;
+    // Last frame of a buffer handed back for refill, held for underruns
+    std::vector<float> hold_frame_;
+
+    std::atomic<uint64_t> underruns_;
+    std::atomic<int64_t> frames_played_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+};
+
+#endif
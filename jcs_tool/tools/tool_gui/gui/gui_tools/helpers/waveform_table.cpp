@@ -0,0 +1,57 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "waveform_table.h"
+#include <cmath>
+
+static uint64_t const fraction_one = (uint64_t)1 << 32;
+
+waveform_table::waveform_table() :
+    position_(0),
+    step_(fraction_one),
+    cyclic_(false),
+    interpolate_(false)
+{
+}
+
+void waveform_table::step_set(double samples_per_tick) {
+    if (samples_per_tick < 0.0) {
+        samples_per_tick = 0.0;
+    }
+    step_ = (uint64_t)llround(samples_per_tick * (double)fraction_one);
+}
+
+bool waveform_table::is_done_rt() const {
+    return !cyclic_ && ((position_ >> 32) >= table_.size());
+}
+
+float waveform_table::step_rt() {
+    uint64_t n = table_.size();
+    if (n == 0) {
+        return 0.0f;
+    }
+    uint64_t idx = position_ >> 32;
+    if (idx >= n) {
+        // One shot tables hold the last sample
+        return table_[n - 1];
+    }
+
+    float value = table_[idx];
+    if (interpolate_) {
+        uint64_t next = idx + 1;
+        if (next >= n) {
+            next = cyclic_ ? 0 : n - 1;
+        }
+        float frac = (float)(position_ & (fraction_one - 1)) * (1.0f / (float)fraction_one);
+        value += (table_[next] - value) * frac;
+    }
+
+    position_ += step_;
+    if (cyclic_) {
+        uint64_t length = n << 32;
+        while (position_ >= length) {
+            position_ -= length;
+        }
+    }
+    return value;
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef WAVEFORM_TABLE_H_
+#define WAVEFORM_TABLE_H_
+
+#include <cstdint>
+#include <vector>
+
+// Precomputed waveform played back from the RT thread.
+//
+// The table is filled on the non RT side while it is not playing. step_rt() is a lookup
+// with a 32.32 fixed point read position, so the cost per tick is constant and playback
+// is exactly reproducible however long it runs. A step of one sample per tick plays the
+// table as rendered. Other steps read between samples, optionally with linear interpolation.
+class waveform_table {
+public:
+    waveform_table();
+
+    // Non RT side
+    std::vector<float>& samples() { return table_; }
+    int size() const { return (int)table_.size(); }
+    // Samples of the table read per tick
+    void step_set(double samples_per_tick);
+    // Cyclic tables wrap, one shot tables stop at the last sample
+    void cyclic_set(bool cyclic) { cyclic_ = cyclic; }
+    void interpolate_set(bool interpolate) { interpolate_ = interpolate; }
+
+    // RT side
+    void reset_rt() { position_ = 0; }
+    // Value at the read position, then advance
+    float step_rt();
+    bool is_done_rt() const;
+
+private:
+    std::vector<float> table_;
+    uint64_t position_;
+    uint64_t step_;
+    bool cyclic_;
+    bool interpolate_;
+};
+
+#endif
@@ -6,6 +6,8 @@
 
 #include "jcs_host.h"
 #include "gui_interface.h"
+#include "param_worker.h"
+#include "rt_profile.h"
 #include <string>
 
 class gui_type_base {
@@ -18,11 +20,26 @@ public:
     virtual int step_rt() = 0;
     virtual int render() = 0;
 
+    // Called from the GUI thread every frame, for every element, whether or not it is being rendered.
+    // Drain anything published by step_rt() here.
+    virtual int step_gui() { return jcs::RET_OK; }
+
+    // Queue a read of every parameter on the parameter worker. Elements without parameters return nullptr.
+    virtual param_job_ptr read_all_parameters() { return nullptr; }
+
+    // True while the element runs a test that must keep stepping when its device is not selected.
+    // Read by the RT thread every tick. Non RT transitions of such a test belong in step_gui().
+    virtual bool job_active() { return false; }
+
 // protected:
     std::string type_name_;
     jcs::jcs_host* host_;
     gui_interface* gui_if_;
     std::string target_device_;
+
+    // RT cost, recorded by the owning device around step_rt() and step_rt_always()
+    rt_profile rt_cost_step_;
+    rt_profile rt_cost_always_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "gui_store.h"
+
+#include "gui_device_joint_controller.h"
+#include "gui_device_motor_controller.h"
+#include "gui_device_encoder_absolute.h"
+#include "gui_device_encoder_absolute_slide_by_hall.h"
+#include "gui_device_braking_chopper.h"
+#include "gui_device_encoder_relative.h"
+#include "gui_device_strain_gauge.h"
+#include "gui_device_brake_clutch.h"
+#include "gui_device_analog.h"
+#include "gui_device_load_switch.h"
+#include "gui_device_thermal_simple.h"
+
+#include "gui_process_pid.h"
+#include "gui_process_pd.h"
+#include "gui_process_interpolator.h"
+#include "gui_process_transform.h"
+
+namespace gui_store {
+
+void build(jcs::jcs_host* host, gui_interface* gui_if, std::vector<jcs::jcs_device>* device_tree,
+           std::vector<gui_device_base*>* store, gui_device_host** host_ptr)
+{
+    *host_ptr = nullptr;
+    for (int i=0; i<device_tree->size(); i++) {
+        std::string const& node_type = device_tree->at(i).node_type;
+        std::string const& name = device_tree->at(i).name;
+        // Add any devices to the store
+        if (node_type == "dev_host") {
+            *host_ptr = new gui_device_host(host, gui_if, name);
+            store->push_back(*host_ptr);
+        }
+        else if (node_type == "dev_joint_controller")                { store->push_back(new gui_device_joint_controller(host, gui_if, name)); }
+        else if (node_type == "dev_motor_controller")                { store->push_back(new gui_device_motor_controller(host, gui_if, name)); }
+        else if (node_type == "dev_encoder_absolute")                { store->push_back(new gui_device_encoder_absolute(host, gui_if, name)); }
+        else if (node_type == "dev_encoder_absolute_slide_by_hall")  { store->push_back(new gui_device_encoder_absolute_slide_by_hall(host, gui_if, name)); }
+        else if (node_type == "dev_braking_chopper")                 { store->push_back(new gui_device_braking_chopper(host, gui_if, name)); }
+        else if (node_type == "dev_encoder_relative")                { store->push_back(new gui_device_encoder_relative(host, gui_if, name)); }
+        else if (node_type == "dev_strain_gauge")                    { store->push_back(new gui_device_strain_gauge(host, gui_if, name)); }
+        else if (node_type == "dev_brake_clutch")                    { store->push_back(new gui_device_brake_clutch(host, gui_if, name)); }
+        else if (node_type == "dev_analog")                          { store->push_back(new gui_device_analog(host, gui_if, name)); }
+        else if (node_type == "dev_load_switch")                     { store->push_back(new gui_device_load_switch(host, gui_if, name)); }
+        else if (node_type == "dev_thermal_simple")                  { store->push_back(new gui_device_thermal_simple(host, gui_if, name)); }
+        // Nothing to do
+        else { }
+
+        // Any processes to add?
+        for (int p=0; p<device_tree->at(i).procs.size(); p++) {
+            std::string const& proc_type = device_tree->at(i).procs[p].node_type;
+            std::string const& proc_name = device_tree->at(i).procs[p].name;
+            if (proc_type == "proc_pid")                 { store->push_back(new gui_process_pid(host, gui_if, proc_name)); }
+            else if (proc_type == "proc_pd")             { store->push_back(new gui_process_pd(host, gui_if, proc_name)); }
+            else if (proc_type == "proc_interpolator")   { store->push_back(new gui_process_interpolator(host, gui_if, proc_name)); }
+            else if (proc_type == "proc_transform")      { store->push_back(new gui_process_transform(host, gui_if, proc_name)); }
+            // Nothing to do
+            else { }
+        }
+    }
+}
+
+} // End namespace gui_store
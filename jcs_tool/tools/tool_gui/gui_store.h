@@ -0,0 +1,22 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef GUI_STORE_H_
+#define GUI_STORE_H_
+
+#include <vector>
+#include "jcs_host.h"
+#include "gui_interface.h"
+#include "gui_device_base.h"
+#include "gui_device_host.h"
+
+namespace gui_store {
+
+// Create a gui device for every device and process in the jcs_host device tree, in tree order.
+// Unknown node types are skipped. host_ptr is set to the dev_host entry, or nullptr if there is none.
+void build(jcs::jcs_host* host, gui_interface* gui_if, std::vector<jcs::jcs_device>* device_tree,
+           std::vector<gui_device_base*>* store, gui_device_host** host_ptr);
+
+} // End namespace gui_store
+
+#endif
@@ -3,6 +3,8 @@
 //
 #include "helpers.h"
 #include "jcs_user_external.h"
+#include "implot_internal.h"
+#include <algorithm>
 #include <cmath>
 
 // Helper to display a little (?) mark which shows a tooltip when hovered.
@@ -255,6 +257,260 @@ long int helpers::time_now_ms() {
     return jcs::external::time_now_ns() / 1e6;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scrolling buffer envelope pyramid and plotting
+void helpers::envelope_pyramid::envelope_level::push(ImVec2 const& a, ImVec2 const& b) {
+    if (data_.size() < 2*max_buckets_) {
+        data_.push_back(a);
+        data_.push_back(b);
+    } else {
+        data_[offset_] = a;
+        data_[offset_ + 1] = b;
+        offset_ = (offset_ + 2) % (2*max_buckets_);
+    }
+}
+
+void helpers::envelope_pyramid::configure(int max_size) {
+    levels_.clear();
+    int bucket_size = envelope_first_bucket;
+    while ((max_size / bucket_size) >= envelope_min_buckets) {
+        envelope_level level;
+        level.bucket_size_ = bucket_size;
+        level.max_buckets_ = (max_size / bucket_size) + 1;
+        level.offset_ = 0;
+        level.count_ = 0;
+        level.data_.reserve(2*level.max_buckets_);
+        levels_.push_back(level);
+        bucket_size *= envelope_factor;
+    }
+}
+
+void helpers::envelope_pyramid::clear() {
+    for (int l=0; l<levels_.size(); l++) {
+        levels_[l].data_.shrink(0);
+        levels_[l].offset_ = 0;
+        levels_[l].count_ = 0;
+    }
+}
+
+void helpers::envelope_pyramid::add(ImVec2 const& point) {
+    // Completed buckets cascade up the levels
+    ImVec2 lo = point;
+    ImVec2 hi = point;
+    for (int l=0; l<levels_.size(); l++) {
+        envelope_level& level = levels_[l];
+        if (level.count_ == 0) {
+            level.min_ = lo;
+            level.max_ = hi;
+        } else {
+            if (lo.y < level.min_.y) { level.min_ = lo; }
+            if (hi.y > level.max_.y) { level.max_ = hi; }
+        }
+        level.count_++;
+
+        // Level 0 counts raw points, levels above count buckets
+        int children = envelope_factor;
+        if (l == 0) {
+            children = level.bucket_size_;
+        }
+        if (level.count_ < children) {
+            return;
+        }
+        level.count_ = 0;
+        if (level.min_.x <= level.max_.x) {
+            level.push(level.min_, level.max_);
+        } else {
+            level.push(level.max_, level.min_);
+        }
+        lo = level.min_;
+        hi = level.max_;
+    }
+}
+
+// Window into a ring of points, plus up to two trailing points
+struct ring_window {
+    helpers::ring_view const* ring;
+    int start;
+    int count;
+    ImVec2 tail[2];
+    int tail_count;
+};
+
+static ImPlotPoint ring_window_get(int idx, void* user_data) {
+    ring_window* window = static_cast<ring_window*>(user_data);
+    if (idx < window->count) {
+        return ImPlotPoint(window->ring->x_at(window->start + idx), window->ring->y_at(window->start + idx));
+    }
+    ImVec2 const& p = window->tail[idx - window->count];
+    return ImPlotPoint(p.x, p.y);
+}
+
+// First logical index with x >= value (lower), or x > value (upper)
+static int ring_bound(helpers::ring_view const& ring, float value, bool upper) {
+    int lo = 0;
+    int hi = ring.size;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        float x = ring.x_at(mid);
+        if (upper ? (x <= value) : (x < value)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Visible logical range, one point either side so lines reach the plot edges.
+// When the view reaches the newest point, keep everything up to the end so auto fit can follow.
+static void ring_range(helpers::ring_view const& ring, ImPlotRange const& x_range, float x_last, bool fit_x, int* start, int* end) {
+    int n = ring.size;
+    // Fitting needs the full extent, not just what is currently visible
+    if (fit_x) {
+        *start = 0;
+        *end = n;
+        return;
+    }
+    *start = ring_bound(ring, (float)x_range.Min, false) - 1;
+    if (*start < 0) { *start = 0; }
+    if (x_range.Max >= x_last) {
+        *end = n;
+    } else {
+        *end = ring_bound(ring, (float)x_range.Max, true) + 1;
+        if (*end > n) { *end = n; }
+    }
+    if (*end < *start) { *end = *start; }
+}
+
+void helpers::plot_ring_line(std::string const& name, ring_view const& raw, envelope_pyramid const& envelope) {
+    ImGui::PushID(name.c_str());
+    if (raw.size == 0) {
+        ImPlotPoint zero = ImPlotPoint(0.0f, 0.0f);
+        ImPlot::PlotLine(name.c_str(), &zero.x, &zero.y, 1, 0, 0, 2*sizeof(float));
+        ImGui::PopID();
+        return;
+    }
+
+    ImPlotRange x_range = ImPlot::GetPlotLimits().X;
+    float width_px = ImPlot::GetPlotSize().x;
+    float x_last = raw.x_at(raw.size - 1);
+    ImPlotPlot* plot = ImPlot::GetCurrentPlot();
+    bool fit_x = plot->FitThisFrame && plot->Axes[plot->CurrentX].FitThisFrame;
+
+    int start;
+    int end;
+    ring_range(raw, x_range, x_last, fit_x, &start, &end);
+
+    // Coarsest level with at least one bucket per pixel
+    std::vector<envelope_pyramid::envelope_level> const& levels = envelope.levels_;
+    int level_idx = -1;
+    if (width_px >= 1.0f) {
+        float points_per_px = (float)(end - start) / width_px;
+        for (int l=0; l<levels.size(); l++) {
+            if (levels[l].bucket_size_ <= points_per_px && levels[l].data_.size() > 0) {
+                level_idx = l;
+            }
+        }
+    }
+
+    ring_window window;
+    window.tail_count = 0;
+    if (level_idx < 0) {
+        window.ring = &raw;
+        window.start = start;
+        window.count = end - start;
+        ImPlot::PlotLineG(name.c_str(), ring_window_get, &window, window.count);
+        ImGui::PopID();
+        return;
+    }
+
+    envelope_pyramid::envelope_level const& level = levels[level_idx];
+    ring_view buckets(&level.data_[0].x, &level.data_[0].y, 2, level.data_.size(), level.offset_);
+    ring_range(buckets, x_range, x_last, fit_x, &start, &end);
+    window.ring = &buckets;
+    window.start = start;
+    window.count = end - start;
+
+    // Points newer than the last complete bucket are held in the partial buckets
+    // of this level and all levels below it
+    if (end == level.data_.size()) {
+        bool have_tail = false;
+        ImVec2 lo;
+        ImVec2 hi;
+        for (int l=0; l<=level_idx; l++) {
+            if (levels[l].count_ == 0) {
+                continue;
+            }
+            if (!have_tail || levels[l].min_.y < lo.y) { lo = levels[l].min_; }
+            if (!have_tail || levels[l].max_.y > hi.y) { hi = levels[l].max_; }
+            have_tail = true;
+        }
+        if (have_tail) {
+            window.tail[0] = (lo.x <= hi.x) ? lo : hi;
+            window.tail[1] = (lo.x <= hi.x) ? hi : lo;
+            window.tail_count = 2;
+        }
+    }
+    ImPlot::PlotLineG(name.c_str(), ring_window_get, &window, window.count + window.tail_count);
+    ImGui::PopID();
+}
+
+void helpers::scrolling_buffer::plot_line(std::string const& name) {
+    ring_view raw(data_.empty() ? nullptr : &data_[0].x, data_.empty() ? nullptr : &data_[0].y, 2, data_.size(), offset_);
+    plot_ring_line(name, raw, envelope_);
+}
+
+void helpers::multi_channel_buffer::configure(int n_channels, int max_size) {
+    n_channels_ = n_channels;
+    max_size_ = max_size;
+    t_.assign(max_size_, 0.0f);
+    y_.assign((size_t)n_channels_ * max_size_, 0.0f);
+    envelopes_.resize(n_channels_);
+    for (int c=0; c<n_channels_; c++) {
+        envelopes_[c].configure(max_size_);
+    }
+    erase();
+}
+
+void helpers::multi_channel_buffer::erase() {
+    offset_ = 0;
+    size_ = 0;
+    for (int c=0; c<envelopes_.size(); c++) {
+        envelopes_[c].clear();
+    }
+}
+
+void helpers::multi_channel_buffer::add_frame(float t, float const* values) {
+    if (max_size_ == 0) {
+        return;
+    }
+    // Fills in order, then overwrites the oldest
+    int idx = offset_;
+    if (size_ < max_size_) {
+        idx = size_;
+        size_++;
+    } else {
+        offset_ = (offset_ + 1) % max_size_;
+    }
+    t_[idx] = t;
+    for (int c=0; c<n_channels_; c++) {
+        y_[c*max_size_ + idx] = values[c];
+    }
+    if (n_channels_ > 0 && !envelopes_[0].levels_.empty()) {
+        for (int c=0; c<n_channels_; c++) {
+            envelopes_[c].add(ImVec2(t, values[c]));
+        }
+    }
+}
+
+void helpers::multi_channel_buffer::plot_line(int channel, std::string const& name) {
+    if (channel < 0 || channel >= n_channels_) {
+        return;
+    }
+    ring_view raw(t_.data(), y_.data() + channel*max_size_, 1, size_, offset_);
+    plot_ring_line(name, raw, envelopes_[channel]);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Nice plotting helper
 helpers::plot_measurement::plot_measurement(std::string const& name, std::string const& x_name, std::string const& y_name, int const size) :
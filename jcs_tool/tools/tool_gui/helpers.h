@@ -77,7 +77,60 @@ namespace helpers {
     bool input_signals_check(std::vector<std::string>* input_signal_names_store, std::vector<std::string>* required_input_signal_names);
     bool output_signals_check(std::vector<std::string>* output_signal_names_store, std::vector<std::string>* required_output_signal_names);
 
+    // Min/max envelope pyramid over a stream of points with non-decreasing x.
+    // Level 0 buckets hold envelope_first_bucket raw points, each level above
+    // holds envelope_factor buckets of the level below. Each bucket stores its
+    // min and max points in x order. Levels are only built while they hold at
+    // least envelope_min_buckets buckets, so short buffers have none.
+    struct envelope_pyramid {
+        static const int envelope_first_bucket = 16;
+        static const int envelope_factor = 4;
+        static const int envelope_min_buckets = 256;
+
+        struct envelope_level {
+            int bucket_size_;           // Raw points per bucket
+            int max_buckets_;
+            int offset_;
+            ImVector<ImVec2> data_;     // Two points per bucket
+            // Bucket being built
+            int count_;
+            ImVec2 min_;
+            ImVec2 max_;
+
+            void push(ImVec2 const& a, ImVec2 const& b);
+        };
+        std::vector<envelope_level> levels_;
+
+        // max_size raw points
+        void configure(int max_size);
+        void clear();
+        void add(ImVec2 const& point);
+    };
+
+    // Strided view of a ring of points with non-decreasing x, oldest at logical index 0.
+    // Interleaved ImVec2 points have stride 2, separate x and y columns stride 1.
+    struct ring_view {
+        float const* x;
+        float const* y;
+        int stride;
+        int size;
+        int offset;
+
+        ring_view(float const* x, float const* y, int stride, int size, int offset) :
+            x(x), y(y), stride(stride), size(size), offset(offset) {}
+        float x_at(int index) const { return x[((offset + index) % size) * stride]; }
+        float y_at(int index) const { return y[((offset + index) % size) * stride]; }
+    };
+
+    // Call between ImPlot::BeginPlot() and ImPlot::EndPlot(), after any axis setup.
+    // Draws the visible x range of raw from the coarsest envelope level that still has
+    // at least one bucket per pixel.
+    void plot_ring_line(std::string const& name, ring_view const& raw, envelope_pyramid const& envelope);
+
     // utility structure for realtime plot
+    // Long buffers also keep a min/max envelope pyramid so plot_line() draws
+    // in the order of the plot pixel width, without losing peaks.
+    // x is expected to be non-decreasing (time).
     struct scrolling_buffer {
         int max_size_;
         int offset_;
@@ -88,6 +141,7 @@ namespace helpers {
             offset_  = 0;
             data_.reserve(max_size_);
             // update_size(max_size);
+            envelope_.configure(max_size_);
         }
         
         void update_size(int new_size) {
@@ -96,6 +150,7 @@ namespace helpers {
             // data_.resize(max_size_);
             erase();
             data_.reserve(max_size_);
+            envelope_.configure(max_size_);
         }
 
         void add_point(float x, float y) {
@@ -105,6 +160,9 @@ namespace helpers {
                 data_[offset_] = ImVec2(x, y);
                 offset_ = (offset_ + 1) % max_size_;
             }
+            if (!envelope_.levels_.empty()) {
+                envelope_.add(ImVec2(x, y));
+            }
         }
 
         ImVec2 first_point() {
@@ -145,18 +203,44 @@ namespace helpers {
                 data_.shrink(0);
                 offset_  = 0;
             }
+            envelope_.clear();
         }
 
-        void plot_line(std::string const& name) {
-            ImGui::PushID(name.c_str());
-            if (data_.size() == 0) {
-                ImPlotPoint zero = ImPlotPoint(0.0f, 0.0f);
-                ImPlot::PlotLine(name.c_str(), &zero.x, &zero.y, 1, 0, 0, 2*sizeof(float));
-            } else {
-                ImPlot::PlotLine(name.c_str(), &data_[0].x, &data_[0].y, data_.size(), 0, offset_, 2*sizeof(float));
-            }
-            ImGui::PopID();
-        }
+        // See plot_ring_line()
+        void plot_line(std::string const& name);
+
+        envelope_pyramid envelope_;
+    };
+
+    // Structure of arrays scrolling buffer for several channels sampled together.
+    // One time column is shared by every channel and each channel's values are one
+    // contiguous column, all written at the same ring offset. Each channel keeps its
+    // own envelope pyramid for plotting.
+    struct multi_channel_buffer {
+        int n_channels_;
+        int max_size_;
+        int offset_;
+        int size_;
+        std::vector<float> t_;
+        std::vector<float> y_;          // Channel c at [c*max_size_, (c+1)*max_size_)
+        std::vector<envelope_pyramid> envelopes_;
+
+        multi_channel_buffer() : n_channels_(0), max_size_(0), offset_(0), size_(0) {}
+
+        // Allocates and erases
+        void configure(int n_channels, int max_size);
+        void erase();
+        // One value per channel
+        void add_frame(float t, float const* values);
+
+        int size() const { return size_; }
+        // Logical index, oldest first
+        float t_at(int index) const { return t_[(offset_ + index) % max_size_]; }
+        float y_at(int channel, int index) const { return y_[channel*max_size_ + (offset_ + index) % max_size_]; }
+        float t_last() const { return (size_ == 0) ? 0.0f : t_at(size_ - 1); }
+
+        // See plot_ring_line()
+        void plot_line(int channel, std::string const& name);
     };
 
     // Normalise [-pi, pi]
@@ -0,0 +1,259 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "param_worker.h"
+#include <chrono>
+#include <iostream>
+#include "imgui.h"
+#include "jcs_host.h"
+#include "task_rt_config.h"
+
+//////////////////////////////////////////////////////////////////////
+param_job::param_job(std::string const& name) :
+    name_(name),
+    status_(status::queued),
+    result_(jcs::RET_ERROR),
+    cancel_(false),
+    progress_(0.0f),
+    handled_(false)
+{
+}
+
+bool param_job::finished() const {
+    status s = status_.load();
+    return (s == status::done) || (s == status::failed) || (s == status::cancelled);
+}
+
+int param_job::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return finished(); });
+    return result_.load();
+}
+
+std::string param_job::progress_text() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return progress_text_;
+}
+
+void param_job::progress_set(float fraction, std::string const& text) {
+    progress_.store(fraction);
+    std::lock_guard<std::mutex> lock(mutex_);
+    progress_text_ = text;
+}
+
+bool param_job::sleep_ms(long ms) {
+    auto t_end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (std::chrono::steady_clock::now() < t_end) {
+        if (cancel_requested()) {
+            return false;
+        }
+        auto t_next = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+        std::this_thread::sleep_until((t_next < t_end) ? t_next : t_end);
+    }
+    return !cancel_requested();
+}
+
+void param_job::finish(status s, int result) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result_.store(result);
+        status_.store(s);
+    }
+    cv_.notify_all();
+}
+
+//////////////////////////////////////////////////////////////////////
+param_worker::param_worker() : running_(false) {
+}
+
+param_worker::~param_worker() {
+    stop();
+}
+
+int param_worker::start(int n_threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return jcs::RET_OK;
+    }
+    running_ = true;
+    for (int i=0; i<((n_threads < 1) ? 1 : n_threads); i++) {
+        threads_.push_back(std::thread(&param_worker::run, this));
+    }
+    return jcs::RET_OK;
+}
+
+void param_worker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        for (int i=0; i<queue_.size(); i++) {
+            queue_[i]->cancel();
+        }
+        for (int i=0; i<active_.size(); i++) {
+            active_[i]->cancel();
+        }
+    }
+    cv_.notify_all();
+    for (int i=0; i<threads_.size(); i++) {
+        threads_[i].join();
+    }
+    threads_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i=0; i<queue_.size(); i++) {
+        queue_[i]->finish(param_job::status::cancelled, jcs::RET_ERROR);
+        queue_[i]->handled_.store(true);
+    }
+    for (int i=0; i<finished_.size(); i++) {
+        finished_[i]->handled_.store(true);
+    }
+    queue_.clear();
+    finished_.clear();
+}
+
+param_job_ptr param_worker::submit(std::string const& name,
+                                   std::function<int(param_job&)> fn,
+                                   std::function<void(param_job&)> on_done,
+                                   std::string const& lane) {
+    param_job_ptr job = std::make_shared<param_job>(name);
+    job->lane_ = lane;
+    job->fn_ = fn;
+    job->on_done_ = on_done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            std::cout << "param_worker: Not running, dropped " << name << "\n";
+            job->finish(param_job::status::cancelled, jcs::RET_ERROR);
+            job->handled_.store(true);
+            return job;
+        }
+        queue_.push_back(job);
+    }
+    cv_.notify_one();
+    return job;
+}
+
+void param_worker::step_gui() {
+    std::vector<param_job_ptr> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done.swap(finished_);
+    }
+    // Outside the lock, callbacks may submit more jobs
+    for (int i=0; i<done.size(); i++) {
+        if (done[i]->get_status() == param_job::status::failed) {
+            std::cout << "param_worker: " << done[i]->name() << " failed\n";
+        }
+        if (done[i]->on_done_) {
+            done[i]->on_done_(*done[i]);
+        }
+        // Drop captures now rather than when the last handle goes
+        done[i]->on_done_ = nullptr;
+        done[i]->handled_.store(true);
+    }
+}
+
+void param_worker::cancel_all() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i=0; i<queue_.size(); i++) {
+        queue_[i]->cancel();
+    }
+    for (int i=0; i<active_.size(); i++) {
+        active_[i]->cancel();
+    }
+}
+
+int param_worker::pending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size() + active_.size();
+}
+
+bool param_worker::render_job(param_job_ptr const& job) {
+    if (!job || !job->active()) {
+        return false;
+    }
+    if (job->finished()) {
+        // Waiting for step_gui()
+        return true;
+    }
+    ImGui::PushID(job.get());
+    if (job->get_status() == param_job::status::queued) {
+        ImGui::Text("%s: Queued", job->name().c_str());
+    } else {
+        std::string text = job->progress_text();
+        ImGui::ProgressBar(job->progress(), ImVec2(300.0f, 0.0f), text.empty() ? nullptr : text.c_str());
+        ImGui::SameLine();
+        ImGui::Text("%s", job->name().c_str());
+    }
+    ImGui::SameLine();
+    if (job->cancel_requested()) {
+        ImGui::TextUnformatted("Cancelling...");
+    } else if (ImGui::Button("Cancel")) {
+        job->cancel();
+    }
+    ImGui::PopID();
+    return true;
+}
+
+void param_worker::run() {
+    task_rt::thd_sched sched;
+    if (task_rt::sched_named_get("param", &sched)) {
+        if (task_rt::sched_apply_self(sched) != jcs::RET_OK) {
+            std::cout << "param_worker: Could not apply param thread config\n";
+        }
+    }
+
+    while (true) {
+        param_job_ptr job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            int idx = -1;
+            cv_.wait(lock, [&]() { return !running_ || (idx = next_runnable()) >= 0; });
+            if (!running_) {
+                break;
+            }
+            job = queue_[idx];
+            queue_.erase(queue_.begin() + idx);
+            active_.push_back(job);
+            lanes_busy_.insert(job->lane_);
+        }
+
+        param_job::status s = param_job::status::cancelled;
+        int ret = jcs::RET_ERROR;
+        if (!job->cancel_requested()) {
+            job->status_.store(param_job::status::running);
+            ret = job->fn_(*job);
+            if (!job->cancel_requested()) {
+                s = (ret == jcs::RET_OK) ? param_job::status::done : param_job::status::failed;
+            }
+        }
+        job->fn_ = nullptr;
+
+        // Queue for step_gui() before anyone can see the job finished
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int i=0; i<active_.size(); i++) {
+                if (active_[i] == job) {
+                    active_.erase(active_.begin() + i);
+                    break;
+                }
+            }
+            lanes_busy_.erase(job->lane_);
+            finished_.push_back(job);
+        }
+        job->finish(s, ret);
+        // The lane is free, a job waiting on it may now run
+        cv_.notify_all();
+    }
+}
+
+int param_worker::next_runnable() {
+    for (int i=0; i<queue_.size(); i++) {
+        if (lanes_busy_.count(queue_[i]->lane_) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
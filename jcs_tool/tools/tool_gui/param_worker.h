@@ -0,0 +1,135 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef PARAM_WORKER_H_
+#define PARAM_WORKER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One queued parameter transaction.
+// Returned by param_worker::submit(). Poll it from the GUI like a future.
+class param_job {
+public:
+    enum class status {
+        queued,
+        running,
+        done,
+        failed,
+        cancelled
+    };
+
+    explicit param_job(std::string const& name);
+
+    std::string const& name() const { return name_; }
+    std::string const& lane() const { return lane_; }
+    status get_status() const { return status_.load(); }
+    bool finished() const;
+    // True until step_gui() has handled the finished job. Use this for GUI state so
+    // controls come back only once on_done has applied the results.
+    bool active() const { return !handled_.load(); }
+    // jcs::RET_OK or jcs::RET_ERROR. Valid once finished.
+    int result() const { return result_.load(); }
+    // Block until finished. Not for use from the GUI thread.
+    int wait();
+
+    float progress() const { return progress_.load(); }
+    std::string progress_text() const;
+
+    // Any thread. A queued job is dropped, a running job sees cancel_requested().
+    void cancel() { cancel_.store(true); }
+
+    // Job side
+    bool cancel_requested() const { return cancel_.load(); }
+    void progress_set(float fraction, std::string const& text);
+    // Sleep in small steps. Returns false if cancelled while sleeping.
+    bool sleep_ms(long ms);
+
+private:
+    friend class param_worker;
+
+    void finish(status s, int result);
+
+    std::string name_;
+    std::string lane_;
+    std::function<int(param_job&)> fn_;
+    std::function<void(param_job&)> on_done_;
+
+    std::atomic<status> status_;
+    std::atomic<int> result_;
+    std::atomic<bool> cancel_;
+    std::atomic<float> progress_;
+    std::atomic<bool> handled_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string progress_text_;
+};
+
+typedef std::shared_ptr<param_job> param_job_ptr;
+
+// Runs blocking jcs_host mailbox transactions on a pool of non RT threads so the
+// GUI keeps its frame rate. Jobs on the same lane run one at a time in submission
+// order. Jobs on different lanes may run in parallel. Use the device name as the
+// lane so each device's mailbox sees one transaction at a time.
+//
+//   job_ = worker->submit("Step response", [=](param_job& job) {
+//       job.progress_set(0.5f, "Waiting");
+//       if (!job.sleep_ms(1000)) { return jcs::RET_ERROR; }
+//       return host->write_command(dev, "controller_stop");
+//   }, [this](param_job& job) {
+//       // GUI thread
+//   }, dev);
+//
+// A job must only write to state it owns (captured shared_ptr or members the
+// GUI leaves alone while the job runs). Results are applied in on_done, which
+// step_gui() calls on the GUI thread. Scheduling uses the "param" entry of the
+// threads config if present.
+class param_worker {
+public:
+    param_worker();
+    ~param_worker();
+
+    int start(int n_threads = 1);
+    // Cancel everything and join. Outstanding on_done callbacks are dropped.
+    void stop();
+
+    param_job_ptr submit(std::string const& name,
+                         std::function<int(param_job&)> fn,
+                         std::function<void(param_job&)> on_done = nullptr,
+                         std::string const& lane = "");
+
+    // GUI thread, once per frame. Runs on_done for every finished job, whatever its status.
+    void step_gui();
+
+    void cancel_all();
+    // Queued plus running
+    int pending();
+
+    // Progress bar and cancel button for a job. Returns true while the job is active.
+    static bool render_job(param_job_ptr const& job);
+
+private:
+    void run();
+    // First queued job whose lane is free. Holding mutex_.
+    int next_runnable();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<param_job_ptr> queue_;
+    std::vector<param_job_ptr> finished_;
+    std::vector<param_job_ptr> active_;
+    std::set<std::string> lanes_busy_;
+    bool running_;
+    std::vector<std::thread> threads_;
+};
+
+#endif
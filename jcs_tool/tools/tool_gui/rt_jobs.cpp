@@ -0,0 +1,68 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "rt_jobs.h"
+#include "gui_device_base.h"
+#include "tool_gui_settings.h"
+
+rt_jobs::rt_jobs() :
+    budget_ticks_(0),
+    overruns_(0),
+    overruns_base_(0)
+{}
+
+void rt_jobs::build(std::vector<gui_device_base*> const* devices) {
+    jobs_.clear();
+    for (int d=0; d<devices->size(); d++) {
+        std::vector<gui_type_base*> const& e = (*devices)[d]->elements_get();
+        for (int i=0; i<e.size(); i++) {
+            job j;
+            j.device = d;
+            j.element = e[i];
+            jobs_.push_back(j);
+        }
+    }
+    // Calibrates the timestamp counter, keep off the RT thread
+    budget_ticks_ = (uint64_t)((double)tool_gui_settings::rt_jobs_budget_us * 1000.0 / rt_profile::ns_per_tick());
+}
+
+int rt_jobs::step_rt(int selected_device) {
+    uint64_t total = 0;
+    bool ran = false;
+    for (int i=0; i<jobs_.size(); i++) {
+        if (jobs_[i].device == selected_device || !jobs_[i].element->job_active()) {
+            continue;
+        }
+        uint64_t t0 = rt_profile::ticks_rt();
+        int ret = jobs_[i].element->step_rt();
+        uint64_t dt = rt_profile::ticks_rt() - t0;
+        jobs_[i].element->rt_cost_step_.add_rt(dt);
+        total += dt;
+        ran = true;
+        if (ret != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+    }
+    if (ran) {
+        cost_.add_rt(total);
+        if (total > budget_ticks_) {
+            overruns_.store(overruns_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+    return jcs::RET_OK;
+}
+
+int rt_jobs::active_get(int device) {
+    int n = 0;
+    for (int i=0; i<jobs_.size(); i++) {
+        if (jobs_[i].device == device && jobs_[i].element->job_active()) {
+            n++;
+        }
+    }
+    return n;
+}
+
+void rt_jobs::reset() {
+    cost_.reset();
+    overruns_base_ = overruns_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef RT_JOBS_H_
+#define RT_JOBS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "rt_profile.h"
+
+class gui_device_base;
+class gui_type_base;
+
+// Steps elements running a job (gui_type_base::job_active()) on devices other than the selected one.
+// The selected device steps all of its elements itself.
+//
+// Every background job's cost lands in its element's rt_cost_step_. The sum over all jobs in a tick
+// is checked against tool_gui_settings::rt_jobs_budget_us. Jobs are never skipped, a test cut
+// short mid sweep is worse than a late tick, so an over budget tick is only counted.
+class rt_jobs {
+public:
+    rt_jobs();
+
+    void build(std::vector<gui_device_base*> const* devices);
+
+    // RT side
+    int step_rt(int selected_device);
+
+    // Non RT side
+    int active_get(int device);
+    rt_profile const& cost_get() const { return cost_; }
+    uint64_t overruns_get() const { return overruns_.load(std::memory_order_relaxed) - overruns_base_; }
+    // Takes effect at once, whether or not any job is running
+    void reset();
+
+private:
+    struct job {
+        int device;
+        gui_type_base* element;
+    };
+    std::vector<job> jobs_;
+    uint64_t budget_ticks_;
+
+    rt_profile cost_;
+    std::atomic<uint64_t> overruns_;
+    uint64_t overruns_base_;            // Non RT side, subtracted on read
+};
+
+#endif
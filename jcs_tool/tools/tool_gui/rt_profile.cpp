@@ -0,0 +1,152 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "rt_profile.h"
+#include <chrono>
+#include <thread>
+
+rt_profile::rt_profile(double unit_ns) :
+    count_(0),
+    sum_(0),
+    min_(UINT64_MAX),
+    max_(0),
+    unit_ns_(unit_ns),
+    generation_(0),
+    generation_ack_(0),
+    generation_rt_(0),
+    base_count_(0),
+    base_sum_(0)
+{
+    for (int i=0; i<n_bins; i++) {
+        bins_[i] = 0;
+        base_bins_[i] = 0;
+    }
+}
+
+// Bins 0..3 hold 0..3 ticks. Above that, four bins per power of two.
+int rt_profile::bin_get(uint64_t ticks) {
+    if (ticks < 4) {
+        return (int)ticks;
+    }
+    int e = 63 - __builtin_clzll(ticks);
+    int sub = (int)((ticks >> (e - 2)) & 3);
+    int bin = (e - 1) * 4 + sub;
+    return bin < n_bins ? bin : n_bins - 1;
+}
+
+uint64_t rt_profile::bin_upper(int bin) {
+    if (bin < 4) {
+        return bin + 1;
+    }
+    int e = bin / 4 + 1;
+    int sub = bin % 4;
+    return (uint64_t)(5 + sub) << (e - 2);
+}
+
+void rt_profile::add_rt(uint64_t ticks) {
+    uint32_t generation = generation_.load(std::memory_order_relaxed);
+    if (generation != generation_rt_) {
+        min_.store(UINT64_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+        generation_rt_ = generation;
+        generation_ack_.store(generation, std::memory_order_release);
+    }
+    // Single writer, plain load and store is enough
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_.store(sum_.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    if (ticks < min_.load(std::memory_order_relaxed)) {
+        min_.store(ticks, std::memory_order_relaxed);
+    }
+    if (ticks > max_.load(std::memory_order_relaxed)) {
+        max_.store(ticks, std::memory_order_relaxed);
+    }
+    std::atomic<uint32_t>& bin = bins_[bin_get(ticks)];
+    bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void rt_profile::reset() {
+    base_count_ = count_.load(std::memory_order_relaxed);
+    base_sum_ = sum_.load(std::memory_order_relaxed);
+    for (int i=0; i<n_bins; i++) {
+        base_bins_[i] = bins_[i].load(std::memory_order_relaxed);
+    }
+    generation_.store(generation_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+rt_profile::summary rt_profile::summary_get() const {
+    summary s;
+    s.count = count_.load(std::memory_order_relaxed) - base_count_;
+    s.min_ns = 0.0;
+    s.mean_ns = 0.0;
+    s.p99_ns = 0.0;
+    s.max_ns = 0.0;
+    if (s.count == 0) {
+        return s;
+    }
+    uint32_t bins[n_bins];
+    uint64_t total = 0;
+    int bin_lo = -1;
+    int bin_hi = 0;
+    for (int i=0; i<n_bins; i++) {
+        bins[i] = bins_[i].load(std::memory_order_relaxed) - base_bins_[i];
+        total += bins[i];
+        if (bins[i] > 0) {
+            bin_lo = (bin_lo < 0) ? i : bin_lo;
+            bin_hi = i;
+        }
+    }
+
+    uint64_t min;
+    uint64_t max;
+    if (generation_ack_.load(std::memory_order_acquire) == generation_.load(std::memory_order_relaxed)) {
+        min = min_.load(std::memory_order_relaxed);
+        max = max_.load(std::memory_order_relaxed);
+    } else {
+        // Recorded across the reset. Bin edges until the RT side restarts min and max.
+        min = (bin_lo > 0) ? bin_upper(bin_lo - 1) : 0;
+        max = bin_upper(bin_hi);
+    }
+    double k = unit_ns_ > 0.0 ? unit_ns_ : ns_per_tick();
+    s.min_ns = k * (double)min;
+    s.mean_ns = k * (double)(sum_.load(std::memory_order_relaxed) - base_sum_) / (double)s.count;
+    s.max_ns = k * (double)max;
+
+    // Upper edge of the bin holding the 99th percentile, no more than the max
+    uint64_t target = total - total / 100;
+    uint64_t seen = 0;
+    for (int i=0; i<n_bins; i++) {
+        seen += bins[i];
+        if (seen >= target) {
+            uint64_t upper = bin_upper(i);
+            s.p99_ns = k * (double)(upper < max ? upper : max);
+            break;
+        }
+    }
+    return s;
+}
+
+double rt_profile::ns_per_tick() {
+#if defined(__x86_64__) || defined(__i386__)
+    // Invariant TSC, measured against the steady clock once
+    static double const k = []() {
+        typedef std::chrono::steady_clock clock;
+        clock::time_point t0 = clock::now();
+        uint64_t c0 = ticks_rt();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        clock::time_point t1 = clock::now();
+        uint64_t c1 = ticks_rt();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        return ns / (double)(c1 - c0);
+    }();
+    return k;
+#elif defined(__aarch64__)
+    static double const k = []() {
+        uint64_t f;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(f));
+        return 1e9 / (double)f;
+    }();
+    return k;
+#else
+    return 1.0;
+#endif
+}
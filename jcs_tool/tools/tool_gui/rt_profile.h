@@ -0,0 +1,96 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef RT_PROFILE_H_
+#define RT_PROFILE_H_
+
+#include <atomic>
+#include <cstdint>
+
+// Cost of a piece of RT code, measured with the CPU timestamp counter.
+// Also takes durations already measured elsewhere, given the unit.
+//
+// One RT thread records, any thread reads. Recording is a handful of relaxed loads and
+// stores, no locks and no read-modify-write. Durations also go into a log scale histogram
+// of quarter octave bins, so p99 is known to within about 19%.
+//
+//   rt_profile::scope timer(&element->rt_cost_step_);
+//   element->step_rt();
+class rt_profile {
+public:
+    // unit_ns: duration of one recorded unit. 0 for timestamp counter ticks.
+    explicit rt_profile(double unit_ns = 0.0);
+
+    // RT side
+    static inline uint64_t ticks_rt();
+    void add_rt(uint64_t ticks);
+
+    class scope {
+    public:
+        scope(rt_profile* profile) : profile_(profile), t0_(ticks_rt()) {}
+        ~scope() { profile_->add_rt(ticks_rt() - t0_); }
+    private:
+        rt_profile* profile_;
+        uint64_t t0_;
+    };
+
+    // Non RT side
+    struct summary {
+        uint64_t count;
+        double min_ns;
+        double mean_ns;
+        double p99_ns;
+        double max_ns;
+    };
+    summary summary_get() const;
+    // Takes effect at once, whether or not the RT side is recording. Call from the
+    // thread that calls summary_get().
+    void reset();
+
+    // Timestamp counter period. Calibrated on first call, call from a non RT thread first.
+    static double ns_per_tick();
+
+private:
+    static const int n_bins = 128;
+    static int bin_get(uint64_t ticks);
+    static uint64_t bin_upper(int bin);
+
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> min_;
+    std::atomic<uint64_t> max_;
+    std::atomic<uint32_t> bins_[n_bins];
+    double unit_ns_;
+
+    // Reset. Counters are never cleared, reset() takes a baseline that summary_get()
+    // subtracts. Min and max cannot be subtracted, the RT side restarts them when it
+    // sees a new generation and acknowledges it.
+    std::atomic<uint32_t> generation_;
+    std::atomic<uint32_t> generation_ack_;
+    uint32_t generation_rt_;            // RT side only
+    uint64_t base_count_;
+    uint64_t base_sum_;
+    uint32_t base_bins_[n_bins];
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+inline uint64_t rt_profile::ticks_rt() {
+    return __rdtsc();
+}
+#elif defined(__aarch64__)
+inline uint64_t rt_profile::ticks_rt() {
+    uint64_t t;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+}
+#else
+#include <time.h>
+inline uint64_t rt_profile::ticks_rt() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#endif
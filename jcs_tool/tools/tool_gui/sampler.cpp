@@ -3,22 +3,25 @@
 //
 #include "sampler.h"
 #include "implot.h"
+#include "imgui_helpers.h"
 #include <iostream>
 #include <iomanip>
+#include <thread>
+#include <chrono>
 #include "ImGuiFileDialog.h"
 
 sampler::sampler(int const base_frequency_hz, std::vector<std::string>* output_signal_names, int const n_channels, int const inital_sample_rate_hz, int const initial_sample_time_s, std::vector<std::string>* channel_labels) :
     base_frequency_hz_(base_frequency_hz),
     f32_output_signal_names_(output_signal_names),
     state_(sampler_state::off_s),
+    rt_active_(false),
     sample_rate_hz_(inital_sample_rate_hz),
     storage_length_(1000),
-    sample_time_s_(initial_sample_time_s)
+    sample_time_s_(initial_sample_time_s),
+    n_channels_(n_channels)
 {
     channel_labels_ = channel_labels;
-    // Channels NOT initialised here. We need true dt
-    // however - size the vector
-    channels_.resize(n_channels);
+    // Channels NOT initialised here, see startup()
     if (inital_sample_rate_hz == base_frequency_hz) {
         using_filter_ = false;
     } else {
@@ -26,76 +29,80 @@ sampler::sampler(int const base_frequency_hz, std::vector<std::string>* output_s
     }
 }
 
-sampler::~sampler() {
-    for (int i=0; i<channels_.size(); i++) {
-        if (channels_[i] != nullptr) {
-            delete channels_[i];
-        }
-    }
-}
+sampler::~sampler() {}
 
 int sampler::startup(double time_now_ns) {
     // Build the channels first
-    if (channel_labels_ != nullptr && channel_labels_->size() != channels_.size()) {
+    if (channel_labels_ != nullptr && channel_labels_->size() != n_channels_) {
         std::cout << "Warning: Sampler channel labels not same size as channels. Using default channel names\n";
     }
-    bool use_labels = (channel_labels_ != nullptr && channel_labels_->size() == channels_.size());
-    for (int i = 0; i < channels_.size(); i++) {
+    bool use_labels = (channel_labels_ != nullptr && channel_labels_->size() == n_channels_);
+    channels_.clear();
+    for (int i = 0; i < n_channels_; i++) {
         std::string label = use_labels ? channel_labels_->at(i) : ("Channel " + std::to_string(i));
-        channels_[i] = new channel(label,
-                                   "None",
-                                   1000,
-                                   static_cast<double>(base_frequency_hz_),
-                                   sample_rate_hz_);
+        channels_.push_back(channel(label, "None", sample_rate_hz_ * 1000));
     }
+    filter_input_.resize(n_channels_, 0.0);
 
     // Configure the sampler
-    if (sampler_reconfigure() != jcs::RET_OK) {
+    if (sampler_reconfigure(sample_rate_hz_, sample_time_s_, using_filter_) != jcs::RET_OK) {
         return jcs::RET_ERROR;
     }
     // Start the channels
     channels_startup(false, storage_length_, sample_rate_hz_);
 
+    // One second of frames at the base rate. GUI drains every frame.
+    if (ring_.startup(base_frequency_hz_, n_channels_) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    frame_rt_.resize(n_channels_, 0.0f);
+    frame_gui_.resize(n_channels_, 0.0f);
+
     t_start_ns_ = time_now_ns;
 
     return jcs::RET_OK;
 }
 
 // Notes:
-// Using dearimgui scrolling buffer which stores x,y points.
-// This means extra memory will be used for storing time (stored in x) multiple times.
-// But this allows us to use striding, which is the most performant way to plot
-void sampler::step_rt(double time_now_ns, std::vector<float>* f32_output_signal_store) {
-
-    switch (state_) {
+// step_rt() does not touch buffer_. Samples are pushed into ring_ and
+// step_gui() moves them into buffer_ on the GUI thread.
+// buffer_ stores time once for all channels, plots read it through strided views.
+void sampler::step_rt(double time_now_ns, std::vector<float> const* f32_output_signal_store) {
+    // Set before state_ is read, see stop()
+    rt_active_.store(true);
+
+    sampler_state state = state_.load();
+    switch (state) {
         default:
         case sampler_state::off_s:
             break;
 
         case sampler_state::filter_seed_s:
-            sample_tick_ = 0;
             channels_seed_filter(f32_output_signal_store);
-            state_ = sampler_state::sampling_s;
+            // Unless the GUI stopped the sampler meanwhile
+            state_.compare_exchange_strong(state, sampler_state::sampling_s);
 
             // fall through
         case sampler_state::sampling_s:
-            channels_step_filter(f32_output_signal_store);
-            sample_tick_++;
-            if (sample_tick_ < sample_tick_max_) {
-                break;
-            }
-            sample_tick_ = 0;
-            // Sample
-            float t_s = (float)((time_now_ns - t_start_ns_) * 1e-9);
-            channels_sample(t_s);
+            // Samples when the decimator has an output due
+            channels_step_filter(f32_output_signal_store, (time_now_ns - t_start_ns_) * 1e-9);
             break;
     }
+
+    rt_active_.store(false);
+}
+
+void sampler::step_gui() {
+    double t_s;
+    while (ring_.pop(&t_s, frame_gui_.data())) {
+        buffer_.add_frame((float)t_s, frame_gui_.data());
+    }
 }
 
 void sampler::render_status() {
     ImGui::Text("Sampler State: ");
     ImGui::SameLine();
-    switch (state_) {
+    switch (state_.load()) {
         default:
         case sampler_state::off_s:
             ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.0f, 1.0f), "Off");
@@ -105,12 +112,18 @@ void sampler::render_status() {
             ImGui::TextColored(ImVec4(0.0f, 0.5f, 0.0f, 1.0f), "Sampling");
             break;
     }
+    uint32_t dropped = ring_.dropped();
+    if (dropped != 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.5f, 0.0f, 0.0f, 1.0f), "Dropped samples: %u", dropped);
+    }
 }
 void sampler::render_interface() {
     ImGui::Text("Sampler Settings");
     ImGui::Separator();
     ImGui::Text("Base frequency: %uHz", base_frequency_hz_);
-    // Get parameters
+    // Get parameters. Fixed while sampling.
+    ImGuiDisabled sampling(state_.load() != sampler_state::off_s);
     {
         int value = sample_rate_hz_;
         ImGui::InputInt("Sample rate (Hz)", &value, 1, 10, ImGuiInputTextFlags_EscapeClearsAll);
@@ -118,12 +131,21 @@ void sampler::render_interface() {
             set_sample_rate_hz(value);
         }
     }
-    ImGui::Checkbox("Using downsample filter", &using_filter_);
+    {
+        bool value = using_filter_;
+        if (ImGui::Checkbox("Using downsample filter", &value)) {
+            set_using_filter(value);
+        }
+    }
+    if (using_filter_ && sample_rate_hz_ < base_frequency_hz_) {
+        ImGui::Text("CIC decimation %d, FIR %d/%d with %d taps per sample. Delay %.1f ms, removed from sample times.",
+            decimator_.cic_decimation_get(), decimator_.interpolation_get(), decimator_.decimation_get(),
+            decimator_.taps_per_output_get(), 1e3 * decimator_.delay_s_get());
+    }
     {
         int value = sample_time_s_;
         ImGui::InputInt("Sample time (s)", &value, 1, 10, ImGuiInputTextFlags_EscapeClearsAll);
         if (ImGui::IsItemDeactivatedAfterEdit()) {
-            // sample_time_s_ = value;
             set_sample_time_s(value);
         }
     }
@@ -132,73 +154,111 @@ void sampler::render_interface() {
 }
 void sampler::render_plots() {
     for (int i=0; i<channels_.size(); i++) {
-        channels_[i]->plot();
+        channels_[i].plot(buffer_, i);
     }
 }
 
 void sampler::start() {
+    if (stop() != jcs::RET_OK) {
+        return;
+    }
+    ring_.clear();
+    ring_.dropped_reset();
     channels_clear();
-    state_ = sampler_state::filter_seed_s;
+    state_.store(sampler_state::filter_seed_s);
 }
-void sampler::stop() {
-    state_ = sampler_state::off_s;
+int sampler::stop() {
+    state_.store(sampler_state::off_s);
+    // A step_rt() that began before the store may still be in the decimator. One that
+    // begins after sees off_s. Waits one step, unless the RT thread has stalled.
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(stop_timeout_ms);
+    while (rt_active_.load()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cout << "sampler: RT step did not finish within " << stop_timeout_ms << "ms\n";
+            return jcs::RET_ERROR;
+        }
+        std::this_thread::yield();
+    }
+    return jcs::RET_OK;
 }
 
 int sampler::set_sample_time_s(int sample_time_s) {
-    stop();
-    sample_time_s_ = sample_time_s;
-    return sampler_reconfigure();
+    if (state_.load() != sampler_state::off_s) {
+        std::cout << "sampler: Stop sampling before changing the sample time\n";
+        return jcs::RET_ERROR;
+    }
+    return sampler_reconfigure(sample_rate_hz_, sample_time_s, using_filter_);
 }
 int sampler::set_sample_rate_hz(int sample_rate_hz) {
-    stop();
-    sample_rate_hz_ = sample_rate_hz;
-    return sampler_reconfigure();
+    if (state_.load() != sampler_state::off_s) {
+        std::cout << "sampler: Stop sampling before changing the sample rate\n";
+        return jcs::RET_ERROR;
+    }
+    return sampler_reconfigure(sample_rate_hz, sample_time_s_, using_filter_);
+}
+int sampler::set_using_filter(bool using_filter) {
+    if (state_.load() != sampler_state::off_s) {
+        std::cout << "sampler: Stop sampling before changing the downsample filter\n";
+        return jcs::RET_ERROR;
+    }
+    return sampler_reconfigure(sample_rate_hz_, sample_time_s_, using_filter);
 }
 
-int sampler::sampler_reconfigure() {
+int sampler::sampler_reconfigure(int sample_rate_hz, int sample_time_s, bool using_filter) {
     // Compute sample rate
-    if (sample_rate_hz_ > (int)base_frequency_hz_ ) {
+    if (sample_rate_hz > (int)base_frequency_hz_ ) {
         std::cout << "sampler: Sample rate must be lower than host base_frequency. Clamping to " << (int)base_frequency_hz_ << "\n";
-        sample_rate_hz_ = (int)base_frequency_hz_;
-    }
-    sample_tick_max_ = (int)base_frequency_hz_ / sample_rate_hz_;
-    if ((sample_tick_max_*sample_rate_hz_) != (int)base_frequency_hz_) {
-        std::cout << "sampler: Sample rate must divide into host base_frequency. Setting to 10Hz\n";
-        sample_rate_hz_ = 10;
-        sample_tick_max_ = (int)base_frequency_hz_ / sample_rate_hz_;
+        sample_rate_hz = (int)base_frequency_hz_;
+    }
+    if (sample_rate_hz < 1) {
+        std::cout << "sampler: Sample rate must be at least 1Hz. Setting to 10Hz\n";
+        sample_rate_hz = 10;
+    }
+    // Allocates, so built aside while step_rt() may still be using the current one
+    int ret = jcs::RET_OK;
+    decimator next;
+    if (next.configure(n_channels_, base_frequency_hz_, sample_rate_hz, using_filter) != jcs::RET_OK) {
+        std::cout << "sampler: Setting to 10Hz\n";
+        sample_rate_hz = 10;
+        next.configure(n_channels_, base_frequency_hz_, sample_rate_hz, using_filter);
+        ret = jcs::RET_ERROR;
+    }
+    if (stop() != jcs::RET_OK) {
+        std::cout << "sampler: Settings unchanged\n";
         return jcs::RET_ERROR;
     }
-    sample_tick_ = 0;
+    decimator_ = std::move(next);
+    sample_rate_hz_ = sample_rate_hz;
+    sample_time_s_ = sample_time_s;
+    using_filter_ = using_filter;
     // Compute storage length
     storage_length_ = sample_rate_hz_ * sample_time_s_;
     channels_compute(storage_length_, sample_rate_hz_);
-    return jcs::RET_OK;
+    return ret;
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-sampler::channel::channel(std::string const& name, std::string const& source, int storage_length, double base_freq_hz, int sample_rate_hz) :
+sampler::channel::channel(std::string const& name, std::string const& source, int span_s) :
     name_(name),
     source_(source),
     source_combo_index_(0),
-    buffer_(storage_length),
-    filter_(sample_rate_hz/2.0, 1.0/base_freq_hz),
     plot_cursors_(false),
     fit_y_(true), fit_x_(true),
-    span_s_(sample_rate_hz * storage_length)
+    span_s_(span_s)
 {
     for (int c=0; c<4; c++) {
         cursor_tag_[c] = 0.0;
     }
 }
 
-void sampler::channel::plot() {
+void sampler::channel::plot(helpers::multi_channel_buffer& buffer, int channel_idx) {
     // Imgui internally hashes the text in button to generate an id
     // But! It needs a unique id. Generating heaps of "internal" labelled buttons
     // will generate a lot of not unique ids. Push "this" and use that to generate a hash
     ImGui::PushID(name_.c_str());
 
-    bool buffer_is_empty = buffer_.data_.empty();
+    bool buffer_is_empty = (buffer.size() == 0);
 
     if (buffer_is_empty) {
         ImGui::Text("Waiting on buffer data");
@@ -227,8 +287,8 @@ void sampler::channel::plot() {
         
         ImPlot::SetupAxes("t", "y", x_flags, y_flags);
 
-        double t_min = buffer_.last_point().x - span_s_;
-        double t_max = buffer_.last_point().x;
+        double t_min = buffer.t_last() - span_s_;
+        double t_max = buffer.t_last();
         // With ImGuiCond_Always the plot is nice, but I can't move the T axis around
         // With ImGuiCond_Once I see some rendering artifacts, but I can move the T axis around....
         ImPlot::SetupAxisLimits(ImAxis_X1, t_min, t_max, ImGuiCond_Once);
@@ -251,7 +311,7 @@ void sampler::channel::plot() {
             ImPlot::TagY(cursor_tag_[3], ImVec4(1,0,0,1), "%.3f", cursor_tag_[3]);
         }
 
-        buffer_.plot_line(source_.c_str());
+        buffer.plot_line(channel_idx, source_);
         ImPlot::EndPlot();
     }
     if (plot_cursors_) {
@@ -305,56 +365,47 @@ void sampler::channel::plot() {
 }
 
 void sampler::channels_startup(bool use_first_source, int storage_length, int sample_rate_hz) {
-    double cutoff_hz = (double)sample_rate_hz / 2.0;
-
     for (int i=0; i<channels_.size(); i++) {
         if (use_first_source) {
-            channels_[i]->source_ = f32_output_signal_names_->at(0);
-            channels_[i]->source_combo_index_ = 0;
+            channels_[i].source_ = f32_output_signal_names_->at(0);
+            channels_[i].source_combo_index_ = 0;
         } else {
             // use incremental sources
             int source_idx = i >= f32_output_signal_names_->size() ? (f32_output_signal_names_->size()-1) : i;
-            channels_[i]->source_ = f32_output_signal_names_->at(source_idx);
-            channels_[i]->source_combo_index_ = source_idx;
+            channels_[i].source_ = f32_output_signal_names_->at(source_idx);
+            channels_[i].source_combo_index_ = source_idx;
         }
     }
     channels_compute(storage_length, sample_rate_hz);
 }
 void sampler::channels_compute(int storage_length, int sample_rate_hz) {
-    double cutoff_hz = (double)sample_rate_hz / 2.0;
     for (int i=0; i<channels_.size(); i++) {
-        channels_[i]->span_s_ = sample_rate_hz * storage_length;
-        channels_[i]->filter_.cutoff_set(cutoff_hz);
-        channels_[i]->buffer_.update_size(storage_length);
+        channels_[i].span_s_ = sample_rate_hz * storage_length;
     }
+    buffer_.configure(n_channels_, storage_length);
 }
 void sampler::channels_clear() {
-    for (int i=0; i<channels_.size(); i++) {
-        channels_[i]->buffer_.erase();
-    }
+    buffer_.erase();
 }
 void sampler::channels_render_select_source() {
     for (int i=0; i<channels_.size(); i++) {
-        helpers::combo_select(channels_[i]->name_ + " Source", f32_output_signal_names_, &channels_[i]->source_combo_index_, &channels_[i]->source_);
+        helpers::combo_select(channels_[i].name_ + " Source", f32_output_signal_names_, &channels_[i].source_combo_index_, &channels_[i].source_);
     }
 }
-void sampler::channels_seed_filter(std::vector<float>* input) {
-    for (int i=0; i<channels_.size(); i++) {
-        channels_[i]->filter_.seed(input->at( channels_[i]->source_combo_index_ ));
+void sampler::channels_gather(std::vector<float> const* input) {
+    for (int i=0; i<n_channels_; i++) {
+        filter_input_[i] = input->at( channels_[i].source_combo_index_ );
     }
 }
-void sampler::channels_step_filter(std::vector<float>* input) {
-    for (int i=0; i<channels_.size(); i++) {
-        if (using_filter_ == true) {
-            channels_[i]->signal_filtered_ = channels_[i]->filter_.step(input->at( channels_[i]->source_combo_index_ ));
-        } else {
-            channels_[i]->signal_filtered_ = input->at( channels_[i]->source_combo_index_ );
-        }
-    }
+void sampler::channels_seed_filter(std::vector<float> const* input) {
+    channels_gather(input);
+    decimator_.seed_rt(filter_input_.data());
 }
-void sampler::channels_sample(float time_s) {
-    for (int i=0; i<channels_.size(); i++) {
-        channels_[i]->buffer_.add_point(time_s, channels_[i]->signal_filtered_);
+void sampler::channels_step_filter(std::vector<float> const* input, double time_s) {
+    channels_gather(input);
+    double t_offset_s;
+    if (decimator_.step_rt(filter_input_.data(), frame_rt_.data(), &t_offset_s)) {
+        ring_.push_rt(time_s + t_offset_s, frame_rt_.data());
     }
 }
 
@@ -382,6 +433,8 @@ int sampler::channels_write_to_file() {
 int sampler::emit_data(std::string const& path_and_file) {
     std::cout << "Writing to: " << path_and_file << "\n";
 
+    step_gui();
+
     std::ofstream config_file(path_and_file);
 
     // Force time to be 3 digits precision, but leave the rest as default
@@ -389,25 +442,22 @@ int sampler::emit_data(std::string const& path_and_file) {
 
     config_file << "t,";
     for (int i=0; i<channels_.size()-1; i++) {
-        config_file << channels_[i]->source_ << ",";
+        config_file << channels_[i].source_ << ",";
     }
-    config_file << channels_[channels_.size()-1]->source_ << "\n";
-
-    for (int i=0; i<channels_[0]->buffer_.data_.size(); i++) {
-        ImVec2 point = channels_[0]->buffer_[i];
+    config_file << channels_[channels_.size()-1].source_ << "\n";
 
+    for (int i=0; i<buffer_.size(); i++) {
         // Time is 6 sig fig
-        config_file << std::fixed << std::setprecision(6) << point.x << ",";
+        config_file << std::fixed << std::setprecision(6) << buffer_.t_at(i) << ",";
 
         // Channel data is default
         config_file.precision(default_precision);
-        config_file << point.y << ",";
-        // Middle channels
-        for (int ch=1; ch<channels_.size()-1; ch++) {
-            config_file << channels_[ch]->buffer_[i].y << ",";
+        // Leading channels
+        for (int ch=0; ch<channels_.size()-1; ch++) {
+            config_file << buffer_.y_at(ch, i) << ",";
         }
         // Last channel
-        config_file << channels_[channels_.size()-1]->buffer_[i].y << "\n";
+        config_file << buffer_.y_at(channels_.size()-1, i) << "\n";
     }
     std::cout << "Done\n";
     return jcs::RET_OK;
@@ -417,8 +467,8 @@ int sampler::get_channel_data(int channel_idx, std::vector<float>* time_out, std
     if (channel_idx < 0 || channel_idx >= static_cast<int>(channels_.size())) {
         return jcs::RET_ERROR;
     }
-    helpers::scrolling_buffer& buf = channels_[channel_idx]->buffer_;
-    int n = static_cast<int>(buf.data_.size());
+    step_gui();
+    int n = buffer_.size();
     if (n == 0) {
         return jcs::RET_ERROR;
     }
@@ -428,14 +478,13 @@ int sampler::get_channel_data(int channel_idx, std::vector<float>* time_out, std
     if (time_out != nullptr) {
         time_out->resize(n);
     }
+    // Logical indices handle the circular offset
     for (int i = 0; i < n; ++i) {
-        // operator[] handles the circular offset
-        ImVec2 pt = buf[i];
         if (time_out != nullptr) {
-            (*time_out)[i] = pt.x;
+            (*time_out)[i] = buffer_.t_at(i);
         }
         if (data_out != nullptr) {
-            (*data_out)[i] = pt.y;
+            (*data_out)[i] = buffer_.y_at(channel_idx, i);
         }
     }
     return jcs::RET_OK;
@@ -3,7 +3,10 @@
 //
 #include "helpers.h"
 #include "jcs_host.h"
+#include "sample_ring.h"
+#include "decimator.h"
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include "imgui.h"
@@ -21,24 +24,33 @@ public:
     ~sampler();
 
     int startup(double time_now_ns);
-    void step_rt(double time_now_ns, std::vector<float>* f32_output_signal_store);
+    void step_rt(double time_now_ns, std::vector<float> const* f32_output_signal_store);
+    // Non-RT. Move samples published by step_rt() into the channel buffers.
+    void step_gui();
 
     void render_status();
     void render_interface();
     void render_plots();
 
+    // Does not start if stop() fails
     void start();
-    void stop();
+    // Returns RET_OK once step_rt() has stopped using the decimator, RET_ERROR if the
+    // RT thread does not finish its step within stop_timeout_ms
+    int stop();
 
     int get_sample_time_s()  { return sample_time_s_; }
     int get_sample_rate_hz() { return sample_rate_hz_; }
 
+    // Rejected with RET_ERROR while sampling
     int set_sample_time_s(int sample_time_s);
     int set_sample_rate_hz(int sample_rate_hz);
+    int set_using_filter(bool using_filter);
+
+    static int const stop_timeout_ms = 100;
 
     int channels_write_to_file();
 
-    int get_channel_count() { return static_cast<int>(channels_.size()); }
+    int get_channel_count() { return n_channels_; }
     int get_channel_data(int channel_idx, std::vector<float>* time_out, std::vector<float>* data_out);
 
 private:
@@ -47,32 +59,31 @@ private:
         filter_seed_s,
         sampling_s
     };
-    sampler_state state_;
+    // Written by the GUI, except filter_seed_s -> sampling_s by step_rt()
+    std::atomic<sampler_state> state_;
+    // True while step_rt() runs. With state_ off_s and this false, the GUI owns the decimator.
+    std::atomic<bool> rt_active_;
 
     std::vector<std::string>* f32_output_signal_names_;
     std::vector<std::string>* channel_labels_;
 
     int base_frequency_hz_;
     int sample_rate_hz_;
-    int sample_tick_max_;
-    int sample_tick_;
     int storage_length_;
 
     int sample_time_s_;
 
     double t_start_ns_;
 
-    int sampler_reconfigure();
+    // Settings take effect only if the decimator could be replaced
+    int sampler_reconfigure(int sample_rate_hz, int sample_time_s, bool using_filter);
 
+    // Per channel plot and source selection. Samples live in buffer_.
     struct channel {
         std::string name_;
         std::string source_;
         int source_combo_index_;
 
-        helpers::scrolling_buffer buffer_;
-        float signal_filtered_;
-        helpers::ma_filter filter_;
-
         bool fit_y_;
         bool fit_x_;
         bool plot_cursors_;
@@ -82,19 +93,32 @@ private:
 
         int span_s_;
 
-        channel(std::string const& name, std::string const& source, int storage_length, double base_freq_hz, int sample_rate_hz);
-        void plot();
+        channel(std::string const& name, std::string const& source, int span_s);
+        void plot(helpers::multi_channel_buffer& buffer, int channel_idx);
     };
-    std::vector<channel*> channels_;
+    int n_channels_;
+    std::vector<channel> channels_;
+    // One time column, one value column per channel
+    helpers::multi_channel_buffer buffer_;
+
+    // Base rate to sample rate, all channels together. Anti-alias filtered when using_filter_.
+    // Rebuilt aside and swapped in after stop().
     bool using_filter_;
+    decimator decimator_;
+    std::vector<double> filter_input_;
+
+    // RT -> GUI sample frames, one float per channel
+    sample_ring ring_;
+    std::vector<float> frame_rt_;
+    std::vector<float> frame_gui_;
 
     void channels_startup(bool use_first_source, int storage_length, int sample_rate_hz);
     void channels_set_signals_size(int size);
     void channels_compute(int storage_length, int sample_rate_hz);
     void channels_clear();
-    void channels_seed_filter(std::vector<float>* input);
-    void channels_step_filter(std::vector<float>* input);
-    void channels_sample(float time_s);
+    void channels_gather(std::vector<float> const* input);
+    void channels_seed_filter(std::vector<float> const* input);
+    void channels_step_filter(std::vector<float> const* input, double time_s);
     void channels_render_select_source();
     int emit_data(std::string const& path_and_file) ;
 };
@@ -0,0 +1,83 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include <iostream>//cout
+#include <cmath>
+#include <vector>
+#include "jcs_host.h"
+#include "../decimator.h"
+
+// Runs n_in input frames of a sine (or DC with frequency_hz 0) through a decimator.
+// Returns the output count, and the output range after the first settle_s seconds.
+static int run(decimator& d, int input_hz, int n_in, double frequency_hz, double settle_s, double* y_min, double* y_max) {
+    const int n_channels = 2;
+    double x[n_channels];
+    float y[n_channels];
+    double t_offset_s;
+    int n_out = 0;
+    *y_min = 1e9;
+    *y_max = -1e9;
+    for (int i=0; i<n_in; i++) {
+        double t = (double)i / (double)input_hz;
+        double v = (frequency_hz == 0.0) ? 1.0 : std::sin(2.0 * M_PI * frequency_hz * t);
+        x[0] = v;
+        x[1] = -v;
+        if (d.step_rt(x, y, &t_offset_s)) {
+            n_out++;
+            if (t > settle_s) {
+                *y_min = std::fmin(*y_min, (double)y[0]);
+                *y_max = std::fmax(*y_max, (double)y[0]);
+            }
+        }
+    }
+    return n_out;
+}
+
+int main(int argc, char* argv[]) {
+    const int input_hz = 20000;
+    // Integer, rational and low ratios
+    const int output_hz[] = {1000, 3000, 10};
+    int errors = 0;
+
+    for (int i=0; i<3; i++) {
+        int out_hz = output_hz[i];
+        decimator d;
+        if (d.configure(2, input_hz, out_hz, true) != jcs::RET_OK) {
+            std::cout << out_hz << "Hz: configure failed\n";
+            errors++;
+            continue;
+        }
+        // Enough input for the filter to settle and many outputs after
+        double settle_s = 2.0 * d.delay_s_get() + 0.1;
+        int n_in = (int)((settle_s + 200.0 / out_hz) * input_hz);
+
+        // DC gain 1, and the output count follows the rate ratio
+        double y_min, y_max;
+        int n_out = run(d, input_hz, n_in, 0.0, settle_s, &y_min, &y_max);
+        int n_expected = (int)((long)n_in * out_hz / input_hz);
+        if (std::abs(n_out - n_expected) > 1) {
+            errors++;
+        }
+        double dc_error = std::fmax(std::fabs(y_max - 1.0), std::fabs(y_min - 1.0));
+        if (dc_error > 1e-4) {
+            errors++;
+        }
+
+        // A tone above the output Nyquist is rejected
+        d.configure(2, input_hz, out_hz, true);
+        run(d, input_hz, n_in, 0.6 * out_hz, settle_s, &y_min, &y_max);
+        double stop_peak = std::fmax(std::fabs(y_min), std::fabs(y_max));
+        double rejection_db = -20.0 * std::log10(std::fmax(stop_peak, 1e-12));
+        if (rejection_db < 60.0) {
+            errors++;
+        }
+
+        std::cout << input_hz << "Hz to " << out_hz << "Hz: L/M " << d.interpolation_get() << "/" << d.decimation_get()
+                  << ", outputs " << n_out << " of " << n_expected
+                  << ", DC error " << dc_error
+                  << ", stopband rejection " << rejection_db << "dB\n";
+    }
+
+    std::cout << "errors: " << errors << "\n";
+    return (errors == 0) ? 0 : 1;
+}
@@ -5,27 +5,13 @@
 #include "imgui.h"
 #include "implot.h"
 #include "tool_gui_settings.h"
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <thread>
+#include "task_rt_config.h"
 
-#include "gui_device_host.h"
-#include "gui_device_joint_controller.h"
-#include "gui_device_motor_controller.h"
-#include "gui_device_encoder_absolute.h"
-#include "gui_device_encoder_absolute_slide_by_hall.h"
-#include "gui_device_braking_chopper.h"
-#include "gui_device_encoder_relative.h"
-#include "gui_device_strain_gauge.h"
-#include "gui_device_brake_clutch.h"
-#include "gui_device_analog.h"
-#include "gui_device_load_switch.h"
-#include "gui_device_thermal_simple.h"
-
-#include "gui_process_pid.h"
-#include "gui_process_pd.h"
-#include "gui_process_interpolator.h"
-#include "gui_process_transform.h"
+#include "gui_store.h"
 
 tool_gui::tool_gui(std::string name, jcs::jcs_host* host) :
     // tool gui does not use mem lock just yet
@@ -34,7 +20,10 @@ tool_gui::tool_gui(std::string name, jcs::jcs_host* host) :
 {
     host_ptr_ = nullptr;
     device_select_idx_ = 0;
+    f32_input_signals_manual_ = nullptr;
+    f32_input_signals_commit_ = false;
     gui_is_init_ = false;
+    job_exclusive_ = false;
     run_status_ = run_status::stopped;
 }
 
@@ -51,6 +40,18 @@ int tool_gui::step_startup_rt() {
 }
 
 int tool_gui::step_rt() {
+    rt_profile::scope timer(&tick_profile_);
+
+    // One copy of the base rate output signals per tick, shared by all elements
+    host_->sig_output_get_rt(0, &f32_output_signals_);
+    // Inputs only carry what elements set this tick
+    if (f32_input_signals_commit_) {
+        std::fill(f32_input_signals_.begin(), f32_input_signals_.end(), 0.0f);
+        std::fill(f32_input_signals_set_.begin(), f32_input_signals_set_.end(), false);
+        f32_input_signals_commit_ = false;
+    }
+    f32_input_signals_manual_ = nullptr;
+
     // Host might have things to always tick over
     // Note: Ok to call on host_ptr_ as this function will not be called
     // until host_ptr_ is attached and store_ is populated
@@ -58,9 +59,25 @@ int tool_gui::step_rt() {
         return jcs::RET_ERROR;
     }
     // Exchange data with graph storage
-    if (store_[device_select_idx_]->step_rt() != jcs::RET_OK) {
+    int selected = device_select_idx_;
+    if (store_[selected]->step_rt() != jcs::RET_OK) {
         return jcs::RET_ERROR;
     }
+    // Tests running on every other device
+    if (rt_jobs_.step_rt(selected) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    // Merged input signals from all elements, manual values where no element set one
+    if (f32_input_signals_manual_ != nullptr) {
+        for (int i=0; i<f32_input_signals_.size(); i++) {
+            if (!f32_input_signals_set_[i]) {
+                f32_input_signals_[i] = (*f32_input_signals_manual_)[i];
+            }
+        }
+    }
+    if (f32_input_signals_commit_) {
+        host_->sig_input_set_rt(0, f32_input_signals_);
+    }
     return jcs::RET_OK;
 }
 
@@ -73,11 +90,14 @@ static void glfw_error_callback(int error, const char* description) {
 }
 
 int tool_gui::step_parameter_startup() {
-    // Ensure this thread stays on CPU 0
-    cpu_set_t cpu_set;
-    CPU_ZERO(&cpu_set);
-    CPU_SET(0, &cpu_set);
-    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    // GUI runs on the non RT thread's CPUs unless given its own
+    task_rt::thd_sched gui_sched;
+    if (task_rt::sched_named_get("gui", &gui_sched)) {
+        if (task_rt::sched_apply_self(gui_sched) != jcs::RET_OK) {
+            std::cout << "tool_gui: Could not apply gui thread config\n";
+            return jcs::RET_ERROR;
+        }
+    }
 
     // Start network configuration
     if (host_->start_network() != jcs::RET_OK) {
@@ -135,6 +155,11 @@ int tool_gui::step_parameter_startup() {
 
     style_dracula_darker();
 
+    // Shared base rate signals. Sized before any element starts, elements may hold pointers into these.
+    f32_output_signals_.resize(host_->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+    f32_input_signals_.resize(host_->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+    f32_input_signals_set_.resize(f32_input_signals_.size());
+
     // Build the device store and startup
     device_tree_ = host_->external_info_tree_get();
     build_store();
@@ -148,6 +173,10 @@ int tool_gui::step_parameter_startup() {
         return jcs::RET_ERROR;
     }
 
+    if (param_worker_.start(tool_gui_settings::param_worker_threads) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+
     for (int i=0; i<store_.size(); i++) {
         if (store_[i]->startup() != jcs::RET_OK) {
             return jcs::RET_ERROR;
@@ -160,37 +189,8 @@ int tool_gui::step_parameter_startup() {
 }
 
 void tool_gui::build_store() {
-    for (int i=0; i<device_tree_->size(); i++) {
-        gui_interface* gui_if = static_cast<gui_interface*>(this);
-        // Add any devices to the store
-        if (device_tree_->at(i).node_type == "dev_host") {
-            store_.push_back(new gui_device_host(host_, gui_if, device_tree_->at(i).name));
-            host_ptr_ = static_cast<gui_device_host*>(store_[0]);
-        }
-        else if (device_tree_->at(i).node_type == "dev_joint_controller")                { store_.push_back(new gui_device_joint_controller(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_motor_controller")                { store_.push_back(new gui_device_motor_controller(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_encoder_absolute")                { store_.push_back(new gui_device_encoder_absolute(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_encoder_absolute_slide_by_hall")  { store_.push_back(new gui_device_encoder_absolute_slide_by_hall(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_braking_chopper")                 { store_.push_back(new gui_device_braking_chopper(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_encoder_relative")                { store_.push_back(new gui_device_encoder_relative(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_strain_gauge")                    { store_.push_back(new gui_device_strain_gauge(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_brake_clutch")                    { store_.push_back(new gui_device_brake_clutch(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_analog")                          { store_.push_back(new gui_device_analog(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_load_switch")                     { store_.push_back(new gui_device_load_switch(host_, gui_if, device_tree_->at(i).name)); }
-        else if (device_tree_->at(i).node_type == "dev_thermal_simple")                  { store_.push_back(new gui_device_thermal_simple(host_, gui_if, device_tree_->at(i).name)); }
-        // Nothing to do
-        else { }
-
-        // Any processes to add?
-        for (int p=0; p<device_tree_->at(i).procs.size(); p++) {
-            if (device_tree_->at(i).procs[p].node_type == "proc_pid")                 { store_.push_back(new gui_process_pid(host_, gui_if, device_tree_->at(i).procs[p].name)); }
-            else if (device_tree_->at(i).procs[p].node_type == "proc_pd")             { store_.push_back(new gui_process_pd(host_, gui_if, device_tree_->at(i).procs[p].name)); }
-            else if (device_tree_->at(i).procs[p].node_type == "proc_interpolator")   { store_.push_back(new gui_process_interpolator(host_, gui_if, device_tree_->at(i).procs[p].name)); }
-            else if (device_tree_->at(i).procs[p].node_type == "proc_transform")      { store_.push_back(new gui_process_transform(host_, gui_if, device_tree_->at(i).procs[p].name)); }
-            // Nothing to do
-            else { }
-        }
-    }
+    gui_store::build(host_, static_cast<gui_interface*>(this), device_tree_, &store_, &host_ptr_);
+    rt_jobs_.build(&store_);
 }
 
 int tool_gui::step_parameter() {
@@ -208,6 +208,16 @@ int tool_gui::step_parameter() {
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
+    // Completed parameter transactions
+    param_worker_.step_gui();
+
+    // Drain RT published data for all devices, not just the one being displayed.
+    for (int i=0; i<store_.size(); i++) {
+        if (store_[i]->step_gui() != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+    }
+
     if (render_display() != jcs::RET_OK) {
         return jcs::RET_ERROR;
     }
@@ -237,6 +247,9 @@ int tool_gui::step_parameter() {
 }
 
 int tool_gui::step_parameter_shutdown() {
+    // Before any element goes away. Jobs may reference them.
+    param_worker_.stop();
+
     // Cleanup
     if (gui_is_init_) {
         ImGui_ImplOpenGL2_Shutdown();
@@ -317,6 +330,8 @@ int tool_gui::render_display() {
         return jcs::RET_ERROR;
     }
     ImGui::SameLine();
+    render_read_all_devices();
+    ImGui::SameLine();
 
     // If an estop is present, has_estop will only return true for one call
     if (host_->has_estop()) {
@@ -359,6 +374,12 @@ int tool_gui::render_display() {
             if (ImGui::Selectable(store_[i]->name_get().c_str(), is_selected)) {
                 device_select_idx_ = i;
             }
+            // Tests running here
+            int jobs = rt_jobs_.active_get(i);
+            if (jobs > 0) {
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(0.0f, 0.8f, 0.0f, 1.0f), "[%d]", jobs);
+            }
         }
         ImGui::EndChild();
     }
@@ -418,6 +439,105 @@ std::vector<std::string>* tool_gui::get_f32_input_signal_names() {
 std::vector<std::string>* tool_gui::get_f32_output_signal_names() {
     return &f32_output_signal_names_;
 }
+std::vector<float> const* tool_gui::get_f32_output_signals() {
+    return &f32_output_signals_;
+}
+void tool_gui::f32_input_signal_set_rt(int index, float value) {
+    f32_input_signals_[index] = value;
+    f32_input_signals_set_[index] = true;
+    f32_input_signals_commit_ = true;
+}
+void tool_gui::f32_input_signals_manual_rt(std::vector<float> const* values) {
+    f32_input_signals_manual_ = values;
+    f32_input_signals_commit_ = true;
+}
+void tool_gui::render_read_all_devices() {
+    int n_active = 0;
+    float progress = 0.0f;
+    for (int i=0; i<read_all_jobs_.size(); i++) {
+        if (read_all_jobs_[i]->active()) {
+            n_active++;
+        }
+        progress += read_all_jobs_[i]->finished() ? 1.0f : read_all_jobs_[i]->progress();
+    }
+
+    if (n_active == 0) {
+        read_all_jobs_.clear();
+        if (ImGui::Button("Read All Devices")) {
+            for (int i=0; i<store_.size(); i++) {
+                std::vector<param_job_ptr> jobs = store_[i]->read_all_parameters();
+                read_all_jobs_.insert(read_all_jobs_.end(), jobs.begin(), jobs.end());
+            }
+        }
+        return;
+    }
+
+    std::string text = std::to_string(read_all_jobs_.size() - n_active) + "/" + std::to_string(read_all_jobs_.size()) + " devices";
+    ImGui::ProgressBar(progress / (float)read_all_jobs_.size(), ImVec2(200.0f, 0.0f), text.c_str());
+    ImGui::SameLine();
+    if (ImGui::Button("Cancel Read All")) {
+        for (int i=0; i<read_all_jobs_.size(); i++) {
+            read_all_jobs_[i]->cancel();
+        }
+    }
+}
+
+param_worker* tool_gui::get_param_worker() {
+    return &param_worker_;
+}
+
+std::vector<gui_device_base*> const* tool_gui::get_devices() {
+    return &store_;
+}
+
+rt_profile* tool_gui::get_tick_profile() {
+    return &tick_profile_;
+}
+
+rt_jobs* tool_gui::get_rt_jobs() {
+    return &rt_jobs_;
+}
+
+bool tool_gui::job_can_start(bool exclusive) {
+    if (job_exclusive_) {
+        return false;
+    }
+    return !exclusive || job_holders_.empty();
+}
+
+int tool_gui::job_start(gui_type_base* job, bool exclusive) {
+    if (!job_can_start(exclusive)) {
+        std::cout << "tool_gui: " << job->target_device_ << " " << job->type_name_ << " can not share the host with running tests\n";
+        return jcs::RET_ERROR;
+    }
+    if (exclusive) {
+        // Stop and reset so device parameters are sampled
+        if (reset() != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+    }
+    if (run_status_ != run_status::running) {
+        if (start() != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+    }
+    job_holders_.push_back(job);
+    job_exclusive_ = exclusive;
+    return jcs::RET_OK;
+}
+
+int tool_gui::job_stop(gui_type_base* job) {
+    std::vector<gui_type_base*>::iterator it = std::find(job_holders_.begin(), job_holders_.end(), job);
+    if (it == job_holders_.end()) {
+        return jcs::RET_OK;
+    }
+    job_holders_.erase(it);
+    if (!job_holders_.empty()) {
+        return jcs::RET_OK;
+    }
+    job_exclusive_ = false;
+    return stop();
+}
 
 
 // Extracted from
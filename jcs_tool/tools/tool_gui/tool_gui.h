@@ -18,6 +18,9 @@
 #include "gui_device_base.h"
 #include "gui_device_host.h"
 #include "gui_interface.h"
+#include "param_worker.h"
+#include "rt_profile.h"
+#include "rt_jobs.h"
 
 class tool_gui : public jcs_tool_if, public gui_interface {
 public:
@@ -39,6 +42,16 @@ public:
     int reset();
     std::vector<std::string>* get_f32_input_signal_names();
     std::vector<std::string>* get_f32_output_signal_names();
+    std::vector<float> const* get_f32_output_signals();
+    void f32_input_signal_set_rt(int index, float value);
+    void f32_input_signals_manual_rt(std::vector<float> const* values);
+    param_worker* get_param_worker();
+    std::vector<gui_device_base*> const* get_devices();
+    rt_profile* get_tick_profile();
+    rt_jobs* get_rt_jobs();
+    bool job_can_start(bool exclusive);
+    int job_start(gui_type_base* job, bool exclusive);
+    int job_stop(gui_type_base* job);
 
 private:
     int render_display();
@@ -49,11 +62,29 @@ private:
     std::vector<jcs::jcs_device>* device_tree_;
     std::vector<gui_device_base*> store_;
     gui_device_host* host_ptr_;
+    rt_profile tick_profile_;
+    // Tests on devices that are not selected
+    rt_jobs rt_jobs_;
+    std::vector<gui_type_base*> job_holders_;
+    bool job_exclusive_;
 
     // Signal helpers
     std::vector<std::string> f32_input_signal_names_;
     std::vector<std::string> f32_output_signal_names_;
 
+    // Per tick base rate signals
+    std::vector<float> f32_output_signals_;
+    std::vector<float> f32_input_signals_;
+    std::vector<bool> f32_input_signals_set_;
+    std::vector<float> const* f32_input_signals_manual_;
+    bool f32_input_signals_commit_;
+
+    // Parameter transactions off the GUI thread
+    param_worker param_worker_;
+    // Read All Devices
+    std::vector<param_job_ptr> read_all_jobs_;
+    void render_read_all_devices();
+
     // Device selection helpers
     int device_select_idx_;
 
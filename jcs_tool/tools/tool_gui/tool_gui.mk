@@ -5,6 +5,11 @@
 JCS_TOOL_GUI_SRC  = build/tools/tool_gui/tool_gui.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/helpers.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/sampler.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/decimator.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/param_worker.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/rt_profile.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/rt_jobs.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui_store.o
 
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_device/gui_device_host.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_device/gui_device_joint_controller.o
@@ -30,10 +35,15 @@ JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_plot/plot_sink_opstat
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_plot/plot_sink_plot.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_plot/plot_source_slider.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_oscilloscope/gui_host_oscilloscope.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_multi_scope/gui_host_multi_scope.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_fleet_tune/gui_host_fleet_tune.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_input_stimulus/gui_host_input_stimulus.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_analysis/gui_host_analysis.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_analysis/etfe_worker.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_network_firmware/gui_host_network_firmware.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/helpers/stimulus.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/helpers/waveform_table.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/helpers/trajectory_stream.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/helpers/gui_stimulus.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/helpers/plot_measurement_multi.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_oscilloscope/gui_oscilloscope.o
@@ -41,10 +51,12 @@ JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_parameter/gui_paramet
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_parameter/gui_parameter_types.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_firmware_update/gui_firmware_update.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_statistics/gui_host_statistics.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_rt_profile/gui_host_rt_profile.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_host_logger/gui_host_logger.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_mc_tune/gui_mc_tune.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_mc_tune/mc_test_step_response.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_mc_cogging/gui_mc_cogging.o
+JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_mc_cogging/cogging_fit.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_mc_encoder/gui_mc_encoder.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_mc_current_test/gui_mc_current_test.o
 JCS_TOOL_GUI_SRC += build/tools/tool_gui/gui/gui_tools/gui_mc_encoder_calib/gui_mc_encoder_calib.o
@@ -105,7 +117,10 @@ JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_device/
 JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_process/
 JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_plot/
 JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_host_statistics/
+JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_host_rt_profile/
 JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_host_oscilloscope/
+JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_host_multi_scope/
+JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_host_fleet_tune/
 JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_host_input_stimulus/
 JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_host_analysis/
 JCS_TOOL_GUI_INC += -I$(TARGET_PATH)tools/tool_gui/gui/gui_tools/gui_host_network_firmware/
@@ -140,4 +155,11 @@ JCS_TOOL_GUI_INC += -I$(JCS_DEV_HOST_PATH)parameter_helpers/process/
 # JCS_TOOL_GUI_CXXFLAGS = `sdl2-config --cflags`
 
 JCS_TOOL_GUI_LIBEXT = -lGL `pkg-config --static --libs glfw3`
-JCS_TOOL_GUI_CXXFLAGS = `pkg-config --cflags glfw3`
\ No newline at end of file
+JCS_TOOL_GUI_CXXFLAGS = `pkg-config --cflags glfw3`
+
+# Headless benchmark, see bench/tool_gui_bench.cpp
+# The GUI without the window: no tool_gui.o, no platform/renderer backends, no GL libraries.
+JCS_TOOL_GUI_BENCH_MAIN = build/tools/tool_gui/bench/tool_gui_bench.o
+JCS_TOOL_GUI_BENCH_SRC  = $(JCS_TOOL_GUI_BENCH_MAIN)
+JCS_TOOL_GUI_BENCH_SRC += $(filter-out build/tools/tool_gui/tool_gui.o,$(JCS_TOOL_GUI_SRC))
+3RD_PARTY_BENCH_SRC     = $(filter-out build/imgui/imgui/backends/%,$(3RD_PARTY_SRC))
\ No newline at end of file
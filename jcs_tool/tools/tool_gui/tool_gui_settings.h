@@ -10,6 +10,16 @@ namespace tool_gui_settings {
     int const signal_plot_max_buffer_length = 10000;
 
     int const oscilloscope_sample_length = 1792;
+
+    // Longest stimulus table, samples. 10 minutes at 10 kHz.
+    int const stimulus_table_max_length = 6000000;
+
+    // Parameter worker threads. Devices are serviced in parallel up to this count.
+    int const param_worker_threads = 4;
+
+    // RT time per tick for jobs on devices that are not selected, all jobs together.
+    // Exceeding it is counted, not enforced.
+    int const rt_jobs_budget_us = 100;
 }
 
 #endif
\ No newline at end of file
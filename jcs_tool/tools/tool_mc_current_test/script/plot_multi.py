@@ -7,6 +7,7 @@ import sys
 import pandas as pd
 import glob
 import os
+import recorder_stream
 
 if (len(sys.argv) < 2):
 	print ("Missing path to data")
@@ -14,9 +15,12 @@ if (len(sys.argv) < 2):
 
 data = []
 filenames = []
-for fname in sorted(glob.glob(sys.argv[1] + '*.csv')):
+for fname in sorted(glob.glob(sys.argv[1] + '*.csv') + glob.glob(sys.argv[1] + '*.jrec')):
 	print (fname)
-	data.append( pd.read_csv(fname))
+	if fname.endswith('.jrec'):
+		data.append( recorder_stream.read(fname))
+	else:
+		data.append( pd.read_csv(fname))
 	# Get just the filenames into a list
 	filenames.append(os.path.split(fname)[1])
 
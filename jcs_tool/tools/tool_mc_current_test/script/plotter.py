@@ -6,6 +6,7 @@ import matplotlib.pyplot as plt
 import pandas as pd
 import math
 import sys
+import recorder_stream
 
 def normalise_angle_2pi(angle):
     while (angle > 2.0*math.pi):
@@ -20,7 +21,10 @@ if (len(sys.argv) != 2):
     sys.exit(2)
 
 print ("data " + sys.argv[1])
-data_rotating = pd.read_csv(sys.argv[1])
+if sys.argv[1].endswith('.jrec'):
+    data_rotating = recorder_stream.read(sys.argv[1])
+else:
+    data_rotating = pd.read_csv(sys.argv[1])
 
 
 data_rotating['timestamp'] = data_rotating['timestamp_ns'].div(1e9)
@@ -0,0 +1,59 @@
+#! /usr/bin/env python
+#
+# Read a recorder_stream binary file (.jrec) into a pandas DataFrame.
+# Run directly to convert to csv: recorder_stream.py data_rotate.jrec [out.csv]
+#
+import numpy as np
+import pandas as pd
+import struct
+import sys
+
+_types = {0: np.int64, 1: np.float32}
+
+def read(path):
+    with open(path, 'rb') as f:
+        buf = f.read()
+
+    if buf[0:8] != b'JCSREC01':
+        raise ValueError(path + ' is not a recorder_stream file')
+    pos = 8
+    (n_columns,) = struct.unpack_from('<I', buf, pos)
+    pos += 4
+
+    names = []
+    types = []
+    for i in range(n_columns):
+        (t, n) = struct.unpack_from('<BH', buf, pos)
+        pos += 3
+        names.append(buf[pos:pos+n].decode())
+        pos += n
+        types.append(np.dtype(_types[t]).newbyteorder('<'))
+
+    row_sz = sum(t.itemsize for t in types)
+    columns = [[] for i in range(n_columns)]
+    while pos + 4 <= len(buf):
+        (n_rows,) = struct.unpack_from('<I', buf, pos)
+        pos += 4
+        if pos + n_rows * row_sz > len(buf):
+            # Truncated final chunk, recording was interrupted
+            break
+        for i in range(n_columns):
+            columns[i].append(np.frombuffer(buf, dtype=types[i], count=n_rows, offset=pos))
+            pos += n_rows * types[i].itemsize
+
+    data = {}
+    for i in range(n_columns):
+        if columns[i]:
+            data[names[i]] = np.concatenate(columns[i])
+        else:
+            data[names[i]] = np.zeros(0, dtype=types[i])
+    return pd.DataFrame(data)
+
+if __name__ == '__main__':
+    if (len(sys.argv) < 2):
+        print ("Missing path to data")
+        sys.exit(2)
+    d = read(sys.argv[1])
+    out = sys.argv[2] if len(sys.argv) > 2 else sys.argv[1].rsplit('.', 1)[0] + '.csv'
+    d.to_csv(out, index=False)
+    print ("wrote " + out + " (" + str(len(d)) + " rows)")
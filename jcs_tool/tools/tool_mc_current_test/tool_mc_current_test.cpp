@@ -6,6 +6,7 @@
 #include "jcs_host.h"
 #include "task_rt.h"
 #include "recorder.h"
+#include "recorder_stream.h"
 #include <string>
 #include <iostream>
 #include "config.h"
@@ -29,6 +30,12 @@ tool_mc_current_test::tool_mc_current_test(std::string name, jcs::jcs_host* host
     rotate_n_rotations_ = 1.0;
     rotate_time_        = 10.0;
 
+    record_binary_ = true;
+    rec_fixed_     = nullptr;
+    rec_rotate_    = nullptr;
+    stream_fixed_  = nullptr;
+    stream_rotate_ = nullptr;
+
     host_sigs_out_sz_ = 0;
     host_sigs_in_sz_  = 0;
     sig_index_i_d_  = 0;
@@ -60,6 +67,11 @@ int tool_mc_current_test::load_config(std::string tool_config) {
     rotate_n_rotations_ = conf["rotate_n_rotations"].as<double>();
     rotate_time_        = conf["rotate_time"].as<double>();
 
+    // Optional
+    if (conf["record_binary"]) {
+        record_binary_ = conf["record_binary"].as<bool>();
+    }
+
     std::cout << "tool_mc_current_test: Got n_rotations: " << rotate_n_rotations_ << std::endl;
     std::cout << "tool_mc_current_test: Got rotate_time: " << rotate_time_ << std::endl;
 
@@ -125,13 +137,20 @@ int tool_mc_current_test::step_startup_rt() {
     signals_record_header_.insert(signals_record_header_.end(), host_sigs_in_names.begin(), host_sigs_in_names.end());
     signals_record_header_.insert(signals_record_header_.end(), host_sigs_out_names.begin(), host_sigs_out_names.end());
 
-    // Configure data recorders
-    int n_points_fixed =  static_cast<int>(ramp_i_ramp_time_ * base_frequency_hz);
-    int n_points_rotate = static_cast<int>(rotate_time_ * base_frequency_hz);
-
     // Initialise the signal recorders
-    rec_fixed_ = new recorder(signals_record_f_.size(), n_points_fixed, "data_fixed.csv");
-    rec_rotate_ = new recorder(signals_record_f_.size(), n_points_rotate, "data_rotate.csv");
+    if (record_binary_) {
+        // Timestamp is its own int64 column
+        std::vector<std::string> stream_header(signals_record_header_.begin()+1, signals_record_header_.end());
+        stream_fixed_  = new recorder_stream(stream_header, "data_fixed.jrec");
+        stream_rotate_ = new recorder_stream(stream_header, "data_rotate.jrec");
+        // Writer threads are started from step_parameter_startup, off the RT thread
+    } else {
+        // Configure data recorders
+        int n_points_fixed =  static_cast<int>(ramp_i_ramp_time_ * base_frequency_hz);
+        int n_points_rotate = static_cast<int>(rotate_time_ * base_frequency_hz);
+        rec_fixed_ = new recorder(signals_record_f_.size(), n_points_fixed, "data_fixed.csv");
+        rec_rotate_ = new recorder(signals_record_f_.size(), n_points_rotate, "data_rotate.csv");
+    }
 
     // Ready to go
     state_ = behaviour_state::ramp_to_current_s;
@@ -147,7 +166,8 @@ int tool_mc_current_test::step_rt() {
     host_->sig_output_get_rt(0, &signals_out_f_);
 
     // Assemble recording vector
-    signals_record_f_[0] = static_cast<float>(jcs::external::time_now_ns() - t_0_data_);
+    int64_t t_data_ns = jcs::external::time_now_ns() - t_0_data_;
+    signals_record_f_[0] = static_cast<float>(t_data_ns);
     std::copy(signals_in_f_.begin(),  signals_in_f_.end(),  signals_record_f_.begin()+1);
     std::copy(signals_out_f_.begin(), signals_out_f_.end(), signals_record_f_.begin()+1+host_sigs_in_sz_);
 
@@ -157,7 +177,11 @@ int tool_mc_current_test::step_rt() {
             signals_in_f_[sig_index_i_d_] = i_ramp_->step();
             // Record dwell data
             if (i_ramp_->in_dwell()) {
-                rec_fixed_->add(signals_record_f_);
+                if (record_binary_) {
+                    stream_fixed_->add_rt(t_data_ns, &signals_record_f_[1]);
+                } else {
+                    rec_fixed_->add(signals_record_f_);
+                }
             }
             if (i_ramp_->is_done()) {
                 i_rotate_->start(rotate_start_, rotate_n_rotations_, true, rotate_time_);
@@ -172,7 +196,11 @@ int tool_mc_current_test::step_rt() {
             signals_in_f_[sig_index_w_m_]  = i_rotate_->omega();
 
             // Record rotating data
-            rec_rotate_->add(signals_record_f_);
+            if (record_binary_) {
+                stream_rotate_->add_rt(t_data_ns, &signals_record_f_[1]);
+            } else {
+                rec_rotate_->add(signals_record_f_);
+            }
 
             if (i_rotate_->is_done()) {
                 // All done. Shut down the system
@@ -186,6 +214,18 @@ int tool_mc_current_test::step_rt() {
 }
 int tool_mc_current_test::step_shutdown_rt() {
     // Write out our recorded data
+    if (record_binary_) {
+        // Writer threads only have the last few chunks left to flush
+        std::cout << "Flushing data" << std::endl;
+        int ret = jcs::RET_OK;
+        if (stream_fixed_ != nullptr && stream_fixed_->stop() != jcs::RET_OK) {
+            ret = jcs::RET_ERROR;
+        }
+        if (stream_rotate_ != nullptr && stream_rotate_->stop() != jcs::RET_OK) {
+            ret = jcs::RET_ERROR;
+        }
+        return ret;
+    }
     std::cout << "Writing out data" << std::endl;
     rec_fixed_->write_to_file(signals_record_header_);
     rec_rotate_->write_to_file(signals_record_header_);
@@ -194,6 +234,13 @@ int tool_mc_current_test::step_shutdown_rt() {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int tool_mc_current_test::step_parameter_startup() {
+    // Writer threads inherit the scheduling of the thread that starts them
+    if (record_binary_) {
+        if (stream_fixed_->start() != jcs::RET_OK || stream_rotate_->start() != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+    }
+
     // Start network configuration
     if (host_->start_network() != jcs::RET_OK) {
         return jcs::RET_ERROR;
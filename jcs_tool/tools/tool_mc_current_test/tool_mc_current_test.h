@@ -10,6 +10,7 @@
 #include "ramp.h"
 #include "rotate.h"
 #include "recorder.h"
+#include "recorder_stream.h"
 
 
 class tool_mc_current_test : public jcs_tool_if {
@@ -53,8 +54,12 @@ private:
     unsigned int sig_index_th_m_;
     unsigned int sig_index_w_m_;
     // Signal recorders
+    // Binary: streamed to disk while running. CSV: held in RAM, written at shutdown.
+    bool record_binary_;
     recorder* rec_fixed_;
     recorder* rec_rotate_;
+    recorder_stream* stream_fixed_;
+    recorder_stream* stream_rotate_;
     std::vector<std::string> signals_record_header_;
     std::vector<float> signals_record_f_;
 
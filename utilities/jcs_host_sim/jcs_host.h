@@ -0,0 +1,217 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef JCS_HOST_SIM_H_
+#define JCS_HOST_SIM_H_
+
+// Simulated jcs_host.
+//
+// Stands in for the jcs_host library so tools can be run and profiled without an
+// EtherCAT network. Only the jcs_host interface used by this repository is provided.
+// Types, return codes and parameter helpers still come from the jcs_host install.
+//
+// The network is built from structure.yaml and the dev_*.yaml / proc_*.yaml files in
+// the config path. Motor controllers are simulated plants, proc_pd and proc_pid run
+// their control law, all other nodes produce zero valued signals. Every node steps
+// once per step_rt() with dt = 1/base_freq_hz, so a run is deterministic for a given
+// config and input sequence. All simulated signals are float32.
+//
+// Optional `simulation` section in dev_HOST.yaml, see jcs_host_sim_nodes.h.
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "jcs_host_types.h"
+#include "jcs_parameter.h"
+#include "jcs_user_external.h"
+#include "jcs_host_sim_nodes.h"
+
+namespace jcs {
+
+class jcs_host {
+public:
+    jcs_host(std::string const& config_path, bool print_debug, bool print_rt_debug);
+    ~jcs_host();
+
+    // Construct and initialise. Returns NULL on failure.
+    static jcs_host* make_jcs_host(std::string const& config_path, bool print_debug, bool print_rt_debug);
+
+    int initialise();
+
+    // Network state
+    int start_network(bool jc_only = false);
+    int ready_devices();
+    int start(bool run_start_script = true);
+    int stop(bool run_stop_script = true);
+    int reset();
+    int shutdown();
+    void trigger_estop();
+    bool has_estop();
+
+    // Cyclic
+    int step_rt(int64_t* cycle_time_ns);
+    bool cyclic_ready();
+    bool data_is_valid_rt();
+    uint32_t base_frequency_get();
+
+    // Signals, host outputs
+    int sig_output_rate_sz_rt(signal_type type);
+    int sig_output_sz_unsafe_rt(signal_type type, int rate);
+    bool sig_output_is_valid_unsafe_rt(signal_type type, int rate);
+    bool sig_output_is_stale_unsafe_rt(signal_type type, int rate);
+    int sig_output_get_rt(int rate, std::vector<float>* values);
+    int sig_output_get_rt(int rate, std::vector<uint32_t>* values);
+    int sig_output_get_rt(int rate, std::vector<uint16_t>* values);
+    int sig_output_get_rt(int rate, std::vector<uint8_t>* values);
+    int sig_output_name_get(signal_type type, int rate, std::vector<std::string>* names);
+    int sig_output_name_get(signal_type type, int rate, int index, std::string* name);
+    int sig_output_node_name_get(signal_type type, int rate, std::vector<std::string>* names);
+    int sig_output_node_name_get(signal_type type, int rate, int index, std::string* name);
+    int sig_output_units_get(signal_type type, int rate, std::vector<std::string>* units);
+    int sig_output_units_get(signal_type type, int rate, int index, std::string* units);
+
+    // Signals, host inputs
+    int sig_input_rate_sz_rt(signal_type type);
+    int sig_input_sz_unsafe_rt(signal_type type, int rate);
+    int sig_input_set_rt(int rate, std::vector<float> const& values);
+    int sig_input_set_rt(int rate, std::vector<uint32_t> const& values);
+    int sig_input_set_rt(int rate, std::vector<uint16_t> const& values);
+    int sig_input_set_rt(int rate, std::vector<uint8_t> const& values);
+    int sig_input_name_get(signal_type type, int rate, std::vector<std::string>* names);
+    int sig_input_name_get(signal_type type, int rate, int index, std::string* name);
+    int sig_input_node_name_get(signal_type type, int rate, std::vector<std::string>* names);
+    int sig_input_node_name_get(signal_type type, int rate, int index, std::string* name);
+    int sig_input_units_get(signal_type type, int rate, std::vector<std::string>* units);
+    int sig_input_units_get(signal_type type, int rate, int index, std::string* units);
+    int sig_input_index_get(signal_type type, int rate, std::string const& name, unsigned int* index);
+    int sig_input_limits_get_by_name(std::string const& name, float* limit_h, float* limit_l);
+
+    // Operational state, one per device
+    int sig_opstate_output_sz_rt();
+    int sig_opstate_output_get_rt(std::vector<uint8_t>* values);
+    int sig_opstate_output_name_get(int index, std::string* name);
+    int sig_opstate_output_node_name_get(int index, std::string* name);
+
+    // Parameters
+    int read_float(std::string const& device, std::string const& name, float* value);
+    int read_float(std::string const& device, std::string const& name, std::vector<float>* value);
+    int read_bool(std::string const& device, std::string const& name, bool* value);
+    int read_enum(std::string const& device, std::string const& name, std::string* value);
+    int read_uint8(std::string const& device, std::string const& name, uint8_t* value);
+    int read_uint16(std::string const& device, std::string const& name, uint16_t* value);
+    int read_uint32(std::string const& device, std::string const& name, uint32_t* value);
+    int write_float(std::string const& device, std::string const& name, float value);
+    int write_float(std::string const& device, std::string const& name, std::vector<float> const& value);
+    int write_bool(std::string const& device, std::string const& name, bool value);
+    int write_enum(std::string const& device, std::string const& name, std::string const& value);
+    int write_uint8(std::string const& device, std::string const& name, uint8_t value);
+    int write_uint16(std::string const& device, std::string const& name, uint16_t value);
+    int write_uint32(std::string const& device, std::string const& name, uint32_t value);
+    int write_command(std::string const& device, std::string const& command);
+
+    // Device information
+    std::vector<jcs_device>* external_info_tree_get();
+    int node_device_id_get(std::string const& jc_name, std::string const& device_name, dev_type* type, dev_id* id);
+
+    // Firmware. Not available in simulation.
+    int write_new_firmware(std::string const& device, std::string const& file_name);
+    int write_new_flashloader(std::string const& device, std::string const& file_name);
+    int write_new_network_firmware(std::vector<std::string>* file_names, bool only_write_listed);
+    int write_new_network_flashloader(std::vector<std::string>* file_names, bool only_write_listed);
+    int validate_network_firmware_filenames(std::vector<std::string>* file_names);
+
+    // Statistics
+    statistics_timing statistics_timing_get();
+    statistics_health statistics_health_get();
+    statistics_transport statistics_transport_get();
+
+    // Reports
+    int dev_jc_ethercat_timing_print();
+    int process_timing_print();
+    int host_overrun_counts_print();
+    int device_error_counts_print();
+    int device_error_estop_print();
+
+private:
+    jcs_host(jcs_host const&);
+    jcs_host& operator=(jcs_host const&);
+
+    // Configuration
+    int structure_load(std::string const& file_name);
+    int host_config_load(std::string const& file_name);
+    int node_config_load(sim_node* node);
+    int routes_resolve();
+    sim_node* node_find(std::string const& name);
+
+    // Parameters
+    int param_read(std::string const& device, std::string const& name, sim_param* value);
+    int param_write(std::string const& device, std::string const& name, sim_param const& value);
+
+    void opstate_set(uint8_t state);
+    void statistics_update_rt(int64_t start_ns, int64_t end_ns);
+
+    std::string config_path_;
+    bool print_debug_;
+    bool print_rt_debug_;
+    bool initialised_;
+
+    sim_settings settings_;
+    uint32_t base_freq_hz_;
+    double dt_;
+
+    // Nodes in structure.yaml order. nodes_[host_idx_] is the host.
+    std::vector<sim_node*> nodes_;
+    int host_idx_;
+    // Indices into nodes_ of devices reporting an opstate
+    std::vector<int> devices_;
+    std::vector<jcs_device> device_tree_;
+
+    // Host output rates. Rate 0 is the base rate.
+    struct output_rate {
+        std::string name;
+        int divider;
+        std::vector<sig_ref> sources;
+        std::vector<float> values;
+        bool valid;
+        bool stale;
+        output_rate() : divider(1), valid(false), stale(true) {}
+    };
+    std::vector<output_rate> output_rates_;
+
+    // Host inputs. All at the base rate.
+    std::vector<float> input_lim_h_;
+    std::vector<float> input_lim_l_;
+    std::vector<std::string> input_units_;
+
+    // Cyclic state
+    std::atomic<uint8_t> opstate_;
+    std::atomic<bool> estop_;
+    std::atomic<bool> cyclic_ready_;
+    std::vector<uint8_t> opstate_rt_;
+    uint64_t tick_;
+
+    // Parameter store per node, guarded by param_mutex_
+    std::mutex param_mutex_;
+    std::map<std::string, std::map<std::string, sim_param>> params_;
+
+    // Statistics. Built by step_rt in the _rt_ copies, published under stats_mutex_
+    // when it is free.
+    std::mutex stats_mutex_;
+    statistics_timing timing_;
+    statistics_health health_;
+    statistics_transport transport_;
+    statistics_timing timing_rt_;
+    statistics_health health_rt_;
+    statistics_transport transport_rt_;
+    int64_t last_start_ns_;
+    uint64_t interval_count_;
+    double interval_mean_;
+    double interval_m2_;
+};
+
+} // End namespace jcs
+
+#endif
@@ -0,0 +1,1068 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "jcs_host.h"
+#include <algorithm>
+#include <cmath>
+#include <dirent.h>
+#include <iostream>
+#include "yaml-cpp/yaml.h"
+
+namespace jcs {
+
+// Operational states as reported by sig_opstate_output_get_rt()
+static const uint8_t opstate_off     = 0;
+static const uint8_t opstate_init    = 1;
+static const uint8_t opstate_running = 2;
+static const uint8_t opstate_error   = 3;
+
+// Search dir and its sub directories for file_name
+static bool file_find(std::string const& dir, std::string const& file_name, std::string* path) {
+    DIR* d = opendir(dir.c_str());
+    if (d == NULL) {
+        return false;
+    }
+    std::vector<std::string> sub_dirs;
+    bool found = false;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        if (entry->d_type == DT_DIR) {
+            sub_dirs.push_back(dir + name + "/");
+        } else if (name == file_name) {
+            *path = dir + name;
+            found = true;
+            break;
+        }
+    }
+    closedir(d);
+    for (int i=0; !found && i<sub_dirs.size(); i++) {
+        found = file_find(sub_dirs[i], file_name, path);
+    }
+    return found;
+}
+
+static sim_param param_from_yaml(YAML::Node const& node) {
+    sim_param p;
+    if (node.IsSequence()) {
+        for (int i=0; i<node.size(); i++) {
+            p.num.push_back(node[i].as<double>());
+        }
+        return p;
+    }
+    p.str = node.Scalar();
+    double d;
+    bool b;
+    if (YAML::convert<double>::decode(node, d)) {
+        p.num.push_back(d);
+    } else if (YAML::convert<bool>::decode(node, b)) {
+        p.num.push_back(b ? 1.0 : 0.0);
+    }
+    return p;
+}
+
+jcs_host::jcs_host(std::string const& config_path, bool print_debug, bool print_rt_debug) :
+    config_path_(config_path),
+    print_debug_(print_debug),
+    print_rt_debug_(print_rt_debug),
+    initialised_(false),
+    base_freq_hz_(1000),
+    dt_(1.0e-3),
+    host_idx_(-1),
+    opstate_(opstate_off),
+    estop_(false),
+    cyclic_ready_(false),
+    tick_(0),
+    timing_(),
+    health_(),
+    transport_(),
+    timing_rt_(),
+    health_rt_(),
+    transport_rt_(),
+    last_start_ns_(0),
+    interval_count_(0),
+    interval_mean_(0.0),
+    interval_m2_(0.0)
+{
+    if (config_path_.empty() || config_path_.back() != '/') {
+        config_path_ += "/";
+    }
+}
+
+jcs_host::~jcs_host() {
+    for (int i=0; i<nodes_.size(); i++) {
+        delete nodes_[i];
+    }
+}
+
+jcs_host* jcs_host::make_jcs_host(std::string const& config_path, bool print_debug, bool print_rt_debug) {
+    jcs_host* host = new jcs_host(config_path, print_debug, print_rt_debug);
+    if (host->initialise() != RET_OK) {
+        delete host;
+        return NULL;
+    }
+    return host;
+}
+
+int jcs_host::initialise() {
+    if (initialised_) {
+        return RET_OK;
+    }
+    std::cout << "jcs_host_sim: Simulated host, no EtherCAT network is used\n";
+
+    if (structure_load(config_path_ + "structure.yaml") != RET_OK) {
+        return RET_ERROR;
+    }
+    if (host_config_load(config_path_ + "dev_HOST.yaml") != RET_OK) {
+        return RET_ERROR;
+    }
+    for (int i=0; i<nodes_.size(); i++) {
+        if (i != host_idx_ && node_config_load(nodes_[i]) != RET_OK) {
+            return RET_ERROR;
+        }
+        nodes_[i]->setup();
+        nodes_[i]->noise_setup(settings_.seed, settings_.noise);
+    }
+    if (routes_resolve() != RET_OK) {
+        return RET_ERROR;
+    }
+    for (int i=0; i<nodes_.size(); i++) {
+        nodes_[i]->configure(params_[nodes_[i]->name_], settings_);
+        nodes_[i]->reset();
+    }
+
+    // Device tree
+    for (int i=0; i<nodes_.size(); i++) {
+        sim_node* n = nodes_[i];
+        if (!n->is_device()) {
+            continue;
+        }
+        jcs_device dev;
+        dev.name = n->name_;
+        dev.node_type = n->type_;
+        for (int k=0; k<3; k++) {
+            dev.id.id[k] = (k < n->device_id_.size()) ? n->device_id_[k] : 0;
+        }
+        for (int p=0; p<n->procs_.size(); p++) {
+            sim_node* proc = node_find(n->procs_[p]);
+            if (proc == NULL) {
+                std::cout << "jcs_host_sim: " << n->name_ << ": Unknown process " << n->procs_[p] << "\n";
+                return RET_ERROR;
+            }
+            jcs_process jp;
+            jp.name = proc->name_;
+            jp.node_type = proc->type_;
+            dev.procs.push_back(jp);
+        }
+        device_tree_.push_back(dev);
+        if (i != host_idx_) {
+            devices_.push_back(i);
+        }
+    }
+    opstate_rt_.resize(devices_.size(), opstate_off);
+
+    if (print_debug_) {
+        std::cout << "jcs_host_sim: " << nodes_.size() << " nodes, " << devices_.size() << " devices at "
+                  << base_freq_hz_ << "Hz\n";
+        for (int r=0; r<output_rates_.size(); r++) {
+            std::cout << "jcs_host_sim: Rate " << r << " (" << output_rates_[r].name << "): "
+                      << output_rates_[r].values.size() << " output signals\n";
+        }
+        std::cout << "jcs_host_sim: " << nodes_[host_idx_]->outputs_.size() << " input signals\n";
+    }
+    initialised_ = true;
+    return RET_OK;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Configuration
+int jcs_host::structure_load(std::string const& file_name) {
+    YAML::Node doc;
+    try {
+        doc = YAML::LoadFile(file_name);
+    } catch (YAML::Exception const& e) {
+        std::cout << "jcs_host_sim: Could not load " << file_name << ": " << e.what() << "\n";
+        return RET_ERROR;
+    }
+    if (!doc.IsSequence()) {
+        std::cout << "jcs_host_sim: " << file_name << " must be a list of nodes\n";
+        return RET_ERROR;
+    }
+
+    try {
+        for (int i=0; i<doc.size(); i++) {
+            YAML::Node const& yn = doc[i];
+            if (!yn["name"] || !yn["type"]) {
+                std::cout << "jcs_host_sim: Node " << i << " needs a name and type\n";
+                return RET_ERROR;
+            }
+            std::string name = yn["name"].as<std::string>();
+            std::string type = yn["type"].as<std::string>();
+            if (node_find(name) != NULL) {
+                std::cout << "jcs_host_sim: Duplicate node " << name << "\n";
+                return RET_ERROR;
+            }
+            sim_node* node = sim_node_make(name, type);
+            nodes_.push_back(node);
+            if (type == "dev_host") {
+                host_idx_ = nodes_.size() - 1;
+            }
+
+            if (yn["processes"]) {
+                for (int p=0; p<yn["processes"].size(); p++) {
+                    YAML::Node const& names = yn["processes"][p]["names"];
+                    for (int k=0; k<names.size(); k++) {
+                        node->procs_.push_back(names[k]["name"].as<std::string>());
+                    }
+                }
+            }
+            if (yn["input_signals"]) {
+                for (int r=0; r<yn["input_signals"].size(); r++) {
+                    YAML::Node const& rate = yn["input_signals"][r];
+                    for (int s=0; s<rate["signals"].size(); s++) {
+                        YAML::Node const& sig = rate["signals"][s];
+                        sim_route route;
+                        route.rate = rate["rate"].as<std::string>();
+                        route.source = sig["source"].as<std::string>();
+                        route.name = sig["name"].as<std::string>();
+                        route.signal_name = sig["signal_name"] ? sig["signal_name"].as<std::string>() : route.name;
+                        node->routes_.push_back(route);
+                    }
+                }
+            }
+        }
+    } catch (YAML::Exception const& e) {
+        std::cout << "jcs_host_sim: " << file_name << ": " << e.what() << "\n";
+        return RET_ERROR;
+    }
+
+    if (host_idx_ < 0) {
+        std::cout << "jcs_host_sim: " << file_name << " has no dev_host node\n";
+        return RET_ERROR;
+    }
+    return RET_OK;
+}
+
+int jcs_host::host_config_load(std::string const& file_name) {
+    YAML::Node doc;
+    try {
+        doc = YAML::LoadFile(file_name);
+    } catch (YAML::Exception const& e) {
+        std::cout << "jcs_host_sim: Could not load " << file_name << ": " << e.what() << "\n";
+        return RET_ERROR;
+    }
+
+    sim_node* host = nodes_[host_idx_];
+    try {
+        if (!doc["base_config"] || !doc["base_config"]["base_freq_hz"]) {
+            std::cout << "jcs_host_sim: " << file_name << " needs base_config: base_freq_hz\n";
+            return RET_ERROR;
+        }
+        YAML::Node const& base = doc["base_config"];
+        base_freq_hz_ = base["base_freq_hz"].as<uint32_t>();
+        if (base_freq_hz_ == 0) {
+            std::cout << "jcs_host_sim: base_freq_hz must be > 0\n";
+            return RET_ERROR;
+        }
+        dt_ = 1.0 / (double)base_freq_hz_;
+
+        if (doc["device_id"]) {
+            host->device_id_ = doc["device_id"].as<std::vector<uint32_t>>();
+        }
+
+        // Rate 0 is the base rate. Sub rates without a frequency run on the devices only.
+        output_rates_.clear();
+        output_rates_.push_back(output_rate());
+        output_rates_[0].name = "base";
+        if (base["sub_rates"]) {
+            for (int i=0; i<base["sub_rates"].size(); i++) {
+                YAML::Node const& sr = base["sub_rates"][i];
+                if (!sr["freq_hz"]) {
+                    continue;
+                }
+                output_rate rate;
+                rate.name = sr["name"].as<std::string>();
+                rate.divider = (int)std::lround((double)base_freq_hz_ / sr["freq_hz"].as<double>());
+                if (rate.divider < 1) {
+                    rate.divider = 1;
+                }
+                output_rates_.push_back(rate);
+            }
+        }
+
+        // Host input signals
+        if (doc["signals"]) {
+            for (int i=0; i<doc["signals"].size(); i++) {
+                YAML::Node const& sig = doc["signals"][i];
+                std::string name = sig["name"].as<std::string>();
+                std::string type = sig["type"] ? sig["type"].as<std::string>() : "float32";
+                if (type != "float32") {
+                    std::cout << "jcs_host_sim: Signal " << name << ": Only float32 signals are simulated, skipping\n";
+                    continue;
+                }
+                std::string units = sig["units"] ? sig["units"].as<std::string>() : "";
+                host->output_add(name, units);
+                input_lim_h_.push_back(sig["lim_h"] ? sig["lim_h"].as<float>() : 0.0f);
+                input_lim_l_.push_back(sig["lim_l"] ? sig["lim_l"].as<float>() : 0.0f);
+                input_units_.push_back(units);
+            }
+        }
+
+        if (doc["simulation"]) {
+            YAML::Node const& s = doc["simulation"];
+            if (s["seed"])                          { settings_.seed = s["seed"].as<uint32_t>(); }
+            if (s["noise"])                         { settings_.noise = s["noise"].as<bool>(); }
+            if (s["param_latency_us"])              { settings_.param_latency_us = s["param_latency_us"].as<int>(); }
+            if (s["mc_current_bandwidth_hz"])       { settings_.mc_current_bandwidth_hz = s["mc_current_bandwidth_hz"].as<double>(); }
+            if (s["mc_inertia"])                    { settings_.mc_inertia = s["mc_inertia"].as<double>(); }
+            if (s["mc_damping"])                    { settings_.mc_damping = s["mc_damping"].as<double>(); }
+            if (s["mc_resistance"])                 { settings_.mc_resistance = s["mc_resistance"].as<double>(); }
+            if (s["mc_thermal_resistance"])         { settings_.mc_thermal_resistance = s["mc_thermal_resistance"].as<double>(); }
+            if (s["mc_thermal_time_constant_s"])    { settings_.mc_thermal_time_constant_s = s["mc_thermal_time_constant_s"].as<double>(); }
+            if (s["mc_ambient_temperature"])        { settings_.mc_ambient_temperature = s["mc_ambient_temperature"].as<double>(); }
+            if (s["mc_v_dc"])                       { settings_.mc_v_dc = s["mc_v_dc"].as<double>(); }
+        }
+    } catch (YAML::Exception const& e) {
+        std::cout << "jcs_host_sim: " << file_name << ": " << e.what() << "\n";
+        return RET_ERROR;
+    }
+    return RET_OK;
+}
+
+int jcs_host::node_config_load(sim_node* node) {
+    std::string prefix = node->is_device() ? "dev_" : "proc_";
+    std::string file_name;
+    if (!file_find(config_path_, prefix + node->name_ + ".yaml", &file_name)) {
+        if (print_debug_) {
+            std::cout << "jcs_host_sim: No config file for " << node->name_ << ", using defaults\n";
+        }
+        return RET_OK;
+    }
+
+    try {
+        YAML::Node doc = YAML::LoadFile(file_name);
+        std::map<std::string, sim_param>& params = params_[node->name_];
+        for (YAML::const_iterator it = doc.begin(); it != doc.end(); ++it) {
+            std::string key = it->first.as<std::string>();
+            if (key == "device_id") {
+                node->device_id_ = it->second.as<std::vector<uint32_t>>();
+            } else if (key == "parameters") {
+                for (YAML::const_iterator p = it->second.begin(); p != it->second.end(); ++p) {
+                    params[p->first.as<std::string>()] = param_from_yaml(p->second);
+                }
+            } else if (it->second.IsScalar()) {
+                node->config_[key] = it->second.Scalar();
+            }
+        }
+    } catch (YAML::Exception const& e) {
+        std::cout << "jcs_host_sim: " << file_name << ": " << e.what() << "\n";
+        return RET_ERROR;
+    }
+    return RET_OK;
+}
+
+int jcs_host::routes_resolve() {
+    for (int i=0; i<nodes_.size(); i++) {
+        sim_node* node = nodes_[i];
+        for (int r=0; r<node->routes_.size(); r++) {
+            sim_route const& route = node->routes_[r];
+            int src = -1;
+            for (int k=0; k<nodes_.size(); k++) {
+                if (nodes_[k]->name_ == route.source) {
+                    src = k;
+                    break;
+                }
+            }
+            if (src < 0) {
+                std::cout << "jcs_host_sim: " << node->name_ << ": Unknown signal source " << route.source << "\n";
+                return RET_ERROR;
+            }
+            int out = nodes_[src]->output_index(route.name);
+            if (out < 0) {
+                if (src == host_idx_) {
+                    std::cout << "jcs_host_sim: " << node->name_ << ": Host has no signal " << route.name << "\n";
+                    return RET_ERROR;
+                }
+                // Not modelled, held at zero
+                out = nodes_[src]->output_add(route.name, "");
+                if (print_debug_) {
+                    std::cout << "jcs_host_sim: " << route.source << "::" << route.name << " is not simulated, held at 0\n";
+                }
+            }
+
+            if (i == host_idx_) {
+                // Routed to the host, becomes a host output signal
+                int rate = -1;
+                for (int k=0; k<output_rates_.size(); k++) {
+                    if (output_rates_[k].name == route.rate) {
+                        rate = k;
+                        break;
+                    }
+                }
+                if (rate < 0) {
+                    std::cout << "jcs_host_sim: Host input rate " << route.rate << " is not in dev_HOST.yaml sub_rates\n";
+                    return RET_ERROR;
+                }
+                output_rates_[rate].sources.push_back(sig_ref(src, out));
+            } else {
+                int in = node->input_add(route.signal_name);
+                node->input_sources_[in] = sig_ref(src, out);
+            }
+        }
+    }
+    for (int r=0; r<output_rates_.size(); r++) {
+        output_rates_[r].values.resize(output_rates_[r].sources.size(), 0.0f);
+    }
+    return RET_OK;
+}
+
+sim_node* jcs_host::node_find(std::string const& name) {
+    for (int i=0; i<nodes_.size(); i++) {
+        if (nodes_[i]->name_ == name) {
+            return nodes_[i];
+        }
+    }
+    return NULL;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Network state
+int jcs_host::start_network(bool jc_only) {
+    opstate_set(opstate_init);
+    return RET_OK;
+}
+
+int jcs_host::ready_devices() {
+    if (estop_) {
+        std::cout << "jcs_host_sim: Cannot ready devices with estop active\n";
+        return RET_ERROR;
+    }
+    return RET_OK;
+}
+
+int jcs_host::start(bool run_start_script) {
+    if (estop_) {
+        std::cout << "jcs_host_sim: Cannot start with estop active\n";
+        return RET_ERROR;
+    }
+    opstate_set(opstate_running);
+    return RET_OK;
+}
+
+int jcs_host::stop(bool run_stop_script) {
+    opstate_set(opstate_init);
+    return RET_OK;
+}
+
+int jcs_host::reset() {
+    estop_ = false;
+    opstate_set(opstate_init);
+    return RET_OK;
+}
+
+int jcs_host::shutdown() {
+    opstate_set(opstate_off);
+    return RET_OK;
+}
+
+void jcs_host::trigger_estop() {
+    estop_ = true;
+}
+
+bool jcs_host::has_estop() {
+    return estop_;
+}
+
+void jcs_host::opstate_set(uint8_t state) {
+    opstate_ = state;
+    if (print_debug_) {
+        std::cout << "jcs_host_sim: Opstate " << (int)state << "\n";
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+// Cyclic
+int jcs_host::step_rt(int64_t* cycle_time_ns) {
+    int64_t start_ns = external::time_now_ns();
+    if (!initialised_) {
+        std::cout << "jcs_host_sim: step_rt before initialise\n";
+        return RET_ERROR;
+    }
+
+    // Parameter writes reach the models on the next tick the store is free
+    for (int i=0; i<nodes_.size(); i++) {
+        sim_node* node = nodes_[i];
+        if (node->params_changed_ && param_mutex_.try_lock()) {
+            node->params_changed_ = false;
+            node->configure(params_[node->name_], settings_);
+            param_mutex_.unlock();
+        }
+    }
+
+    bool estop = estop_;
+    uint8_t opstate = estop ? opstate_error : (uint8_t)opstate_;
+    bool running = (opstate == opstate_running);
+
+    // Nodes step in structure.yaml order. Sources later in the order are one tick old.
+    for (int i=0; i<nodes_.size(); i++) {
+        sim_node* node = nodes_[i];
+        for (int k=0; k<node->inputs_.size(); k++) {
+            sig_ref const& ref = node->input_sources_[k];
+            node->inputs_[k] = nodes_[ref.node]->outputs_[ref.index];
+        }
+        node->step(dt_, running);
+    }
+
+    for (int r=0; r<output_rates_.size(); r++) {
+        output_rate& rate = output_rates_[r];
+        if ((tick_ % rate.divider) != 0) {
+            rate.stale = true;
+            continue;
+        }
+        for (int k=0; k<rate.sources.size(); k++) {
+            rate.values[k] = nodes_[rate.sources[k].node]->outputs_[rate.sources[k].index];
+        }
+        rate.valid = true;
+        rate.stale = false;
+    }
+    for (int i=0; i<opstate_rt_.size(); i++) {
+        opstate_rt_[i] = opstate;
+    }
+    tick_++;
+
+    // No distributed clock to follow
+    *cycle_time_ns = (int64_t)1e9 / (int64_t)base_freq_hz_;
+    cyclic_ready_ = true;
+
+    statistics_update_rt(start_ns, external::time_now_ns());
+    return RET_OK;
+}
+
+bool jcs_host::cyclic_ready() {
+    return cyclic_ready_;
+}
+
+bool jcs_host::data_is_valid_rt() {
+    return cyclic_ready_;
+}
+
+uint32_t jcs_host::base_frequency_get() {
+    return base_freq_hz_;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Signals, host outputs
+int jcs_host::sig_output_rate_sz_rt(signal_type type) {
+    return output_rates_.size();
+}
+
+int jcs_host::sig_output_sz_unsafe_rt(signal_type type, int rate) {
+    if (type != signal_type::float32_s || rate < 0 || rate >= output_rates_.size()) {
+        return 0;
+    }
+    return output_rates_[rate].values.size();
+}
+
+bool jcs_host::sig_output_is_valid_unsafe_rt(signal_type type, int rate) {
+    if (type != signal_type::float32_s || rate < 0 || rate >= output_rates_.size()) {
+        return false;
+    }
+    return output_rates_[rate].valid;
+}
+
+bool jcs_host::sig_output_is_stale_unsafe_rt(signal_type type, int rate) {
+    if (type != signal_type::float32_s || rate < 0 || rate >= output_rates_.size()) {
+        return true;
+    }
+    return output_rates_[rate].stale;
+}
+
+int jcs_host::sig_output_get_rt(int rate, std::vector<float>* values) {
+    if (rate < 0 || rate >= output_rates_.size()) {
+        return RET_ERROR;
+    }
+    std::vector<float> const& src = output_rates_[rate].values;
+    int n = std::min(values->size(), src.size());
+    for (int i=0; i<n; i++) {
+        (*values)[i] = src[i];
+    }
+    return RET_OK;
+}
+
+// Integer signals are not simulated
+int jcs_host::sig_output_get_rt(int rate, std::vector<uint32_t>* values) { return RET_OK; }
+int jcs_host::sig_output_get_rt(int rate, std::vector<uint16_t>* values) { return RET_OK; }
+int jcs_host::sig_output_get_rt(int rate, std::vector<uint8_t>* values)  { return RET_OK; }
+
+int jcs_host::sig_output_name_get(signal_type type, int rate, std::vector<std::string>* names) {
+    names->clear();
+    for (int i=0; i<sig_output_sz_unsafe_rt(type, rate); i++) {
+        sig_ref const& ref = output_rates_[rate].sources[i];
+        names->push_back(nodes_[ref.node]->output_names_[ref.index]);
+    }
+    return RET_OK;
+}
+
+int jcs_host::sig_output_name_get(signal_type type, int rate, int index, std::string* name) {
+    if (index < 0 || index >= sig_output_sz_unsafe_rt(type, rate)) {
+        return RET_ERROR;
+    }
+    sig_ref const& ref = output_rates_[rate].sources[index];
+    *name = nodes_[ref.node]->output_names_[ref.index];
+    return RET_OK;
+}
+
+int jcs_host::sig_output_node_name_get(signal_type type, int rate, std::vector<std::string>* names) {
+    names->clear();
+    for (int i=0; i<sig_output_sz_unsafe_rt(type, rate); i++) {
+        names->push_back(nodes_[output_rates_[rate].sources[i].node]->name_);
+    }
+    return RET_OK;
+}
+
+int jcs_host::sig_output_node_name_get(signal_type type, int rate, int index, std::string* name) {
+    if (index < 0 || index >= sig_output_sz_unsafe_rt(type, rate)) {
+        return RET_ERROR;
+    }
+    *name = nodes_[output_rates_[rate].sources[index].node]->name_;
+    return RET_OK;
+}
+
+int jcs_host::sig_output_units_get(signal_type type, int rate, std::vector<std::string>* units) {
+    units->clear();
+    for (int i=0; i<sig_output_sz_unsafe_rt(type, rate); i++) {
+        sig_ref const& ref = output_rates_[rate].sources[i];
+        units->push_back(nodes_[ref.node]->output_units_[ref.index]);
+    }
+    return RET_OK;
+}
+
+int jcs_host::sig_output_units_get(signal_type type, int rate, int index, std::string* units) {
+    if (index < 0 || index >= sig_output_sz_unsafe_rt(type, rate)) {
+        return RET_ERROR;
+    }
+    sig_ref const& ref = output_rates_[rate].sources[index];
+    *units = nodes_[ref.node]->output_units_[ref.index];
+    return RET_OK;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Signals, host inputs. The host node's outputs hold the input values.
+int jcs_host::sig_input_rate_sz_rt(signal_type type) {
+    return 1;
+}
+
+int jcs_host::sig_input_sz_unsafe_rt(signal_type type, int rate) {
+    if (type != signal_type::float32_s || rate != 0 || host_idx_ < 0) {
+        return 0;
+    }
+    return nodes_[host_idx_]->outputs_.size();
+}
+
+int jcs_host::sig_input_set_rt(int rate, std::vector<float> const& values) {
+    if (rate != 0) {
+        return RET_ERROR;
+    }
+    std::vector<float>& dst = nodes_[host_idx_]->outputs_;
+    int n = std::min(values.size(), dst.size());
+    for (int i=0; i<n; i++) {
+        float v = values[i];
+        if (input_lim_h_[i] > input_lim_l_[i]) {
+            v = std::min(std::max(v, input_lim_l_[i]), input_lim_h_[i]);
+        }
+        dst[i] = v;
+    }
+    return RET_OK;
+}
+
+int jcs_host::sig_input_set_rt(int rate, std::vector<uint32_t> const& values) { return RET_OK; }
+int jcs_host::sig_input_set_rt(int rate, std::vector<uint16_t> const& values) { return RET_OK; }
+int jcs_host::sig_input_set_rt(int rate, std::vector<uint8_t> const& values)  { return RET_OK; }
+
+int jcs_host::sig_input_name_get(signal_type type, int rate, std::vector<std::string>* names) {
+    names->clear();
+    for (int i=0; i<sig_input_sz_unsafe_rt(type, rate); i++) {
+        names->push_back(nodes_[host_idx_]->output_names_[i]);
+    }
+    return RET_OK;
+}
+
+int jcs_host::sig_input_name_get(signal_type type, int rate, int index, std::string* name) {
+    if (index < 0 || index >= sig_input_sz_unsafe_rt(type, rate)) {
+        return RET_ERROR;
+    }
+    *name = nodes_[host_idx_]->output_names_[index];
+    return RET_OK;
+}
+
+int jcs_host::sig_input_node_name_get(signal_type type, int rate, std::vector<std::string>* names) {
+    names->assign(sig_input_sz_unsafe_rt(type, rate), nodes_[host_idx_]->name_);
+    return RET_OK;
+}
+
+int jcs_host::sig_input_node_name_get(signal_type type, int rate, int index, std::string* name) {
+    if (index < 0 || index >= sig_input_sz_unsafe_rt(type, rate)) {
+        return RET_ERROR;
+    }
+    *name = nodes_[host_idx_]->name_;
+    return RET_OK;
+}
+
+int jcs_host::sig_input_units_get(signal_type type, int rate, std::vector<std::string>* units) {
+    units->clear();
+    for (int i=0; i<sig_input_sz_unsafe_rt(type, rate); i++) {
+        units->push_back(input_units_[i]);
+    }
+    return RET_OK;
+}
+
+int jcs_host::sig_input_units_get(signal_type type, int rate, int index, std::string* units) {
+    if (index < 0 || index >= sig_input_sz_unsafe_rt(type, rate)) {
+        return RET_ERROR;
+    }
+    *units = input_units_[index];
+    return RET_OK;
+}
+
+int jcs_host::sig_input_index_get(signal_type type, int rate, std::string const& name, unsigned int* index) {
+    for (int i=0; i<sig_input_sz_unsafe_rt(type, rate); i++) {
+        if (nodes_[host_idx_]->output_names_[i] == name) {
+            *index = i;
+            return RET_OK;
+        }
+    }
+    std::cout << "jcs_host_sim: No input signal " << name << "\n";
+    return RET_ERROR;
+}
+
+int jcs_host::sig_input_limits_get_by_name(std::string const& name, float* limit_h, float* limit_l) {
+    unsigned int index;
+    if (sig_input_index_get(signal_type::float32_s, 0, name, &index) != RET_OK) {
+        return RET_ERROR;
+    }
+    *limit_h = input_lim_h_[index];
+    *limit_l = input_lim_l_[index];
+    return RET_OK;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Operational state
+int jcs_host::sig_opstate_output_sz_rt() {
+    return devices_.size();
+}
+
+int jcs_host::sig_opstate_output_get_rt(std::vector<uint8_t>* values) {
+    int n = std::min(values->size(), opstate_rt_.size());
+    for (int i=0; i<n; i++) {
+        (*values)[i] = opstate_rt_[i];
+    }
+    return RET_OK;
+}
+
+int jcs_host::sig_opstate_output_name_get(int index, std::string* name) {
+    if (index < 0 || index >= devices_.size()) {
+        return RET_ERROR;
+    }
+    *name = "opstate";
+    return RET_OK;
+}
+
+int jcs_host::sig_opstate_output_node_name_get(int index, std::string* name) {
+    if (index < 0 || index >= devices_.size()) {
+        return RET_ERROR;
+    }
+    *name = nodes_[devices_[index]]->name_;
+    return RET_OK;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Parameters
+// Each transaction takes param_latency_us, like a mailbox round trip.
+// Parameters not in the config files read as zero until written.
+int jcs_host::param_read(std::string const& device, std::string const& name, sim_param* value) {
+    if (node_find(device) == NULL) {
+        std::cout << "jcs_host_sim: Unknown device " << device << "\n";
+        return RET_ERROR;
+    }
+    if (settings_.param_latency_us > 0) {
+        external::sleep_us(settings_.param_latency_us);
+    }
+    std::lock_guard<std::mutex> lock(param_mutex_);
+    std::map<std::string, sim_param> const& params = params_[device];
+    std::map<std::string, sim_param>::const_iterator it = params.find(name);
+    *value = (it != params.end()) ? it->second : sim_param();
+    return RET_OK;
+}
+
+int jcs_host::param_write(std::string const& device, std::string const& name, sim_param const& value) {
+    sim_node* node = node_find(device);
+    if (node == NULL) {
+        std::cout << "jcs_host_sim: Unknown device " << device << "\n";
+        return RET_ERROR;
+    }
+    if (settings_.param_latency_us > 0) {
+        external::sleep_us(settings_.param_latency_us);
+    }
+    std::lock_guard<std::mutex> lock(param_mutex_);
+    params_[device][name] = value;
+    node->params_changed_ = true;
+    return RET_OK;
+}
+
+int jcs_host::read_float(std::string const& device, std::string const& name, float* value) {
+    sim_param p;
+    if (param_read(device, name, &p) != RET_OK) {
+        return RET_ERROR;
+    }
+    *value = p.num.empty() ? 0.0f : (float)p.num[0];
+    return RET_OK;
+}
+
+int jcs_host::read_float(std::string const& device, std::string const& name, std::vector<float>* value) {
+    sim_param p;
+    if (param_read(device, name, &p) != RET_OK) {
+        return RET_ERROR;
+    }
+    // Unknown vectors keep the requested length
+    if (p.num.empty()) {
+        std::fill(value->begin(), value->end(), 0.0f);
+        return RET_OK;
+    }
+    value->resize(p.num.size());
+    for (int i=0; i<p.num.size(); i++) {
+        (*value)[i] = (float)p.num[i];
+    }
+    return RET_OK;
+}
+
+int jcs_host::read_bool(std::string const& device, std::string const& name, bool* value) {
+    sim_param p;
+    if (param_read(device, name, &p) != RET_OK) {
+        return RET_ERROR;
+    }
+    *value = !p.num.empty() && p.num[0] != 0.0;
+    return RET_OK;
+}
+
+int jcs_host::read_enum(std::string const& device, std::string const& name, std::string* value) {
+    sim_param p;
+    if (param_read(device, name, &p) != RET_OK) {
+        return RET_ERROR;
+    }
+    *value = p.str;
+    return RET_OK;
+}
+
+int jcs_host::read_uint8(std::string const& device, std::string const& name, uint8_t* value) {
+    sim_param p;
+    if (param_read(device, name, &p) != RET_OK) {
+        return RET_ERROR;
+    }
+    *value = p.num.empty() ? 0 : (uint8_t)p.num[0];
+    return RET_OK;
+}
+
+int jcs_host::read_uint16(std::string const& device, std::string const& name, uint16_t* value) {
+    sim_param p;
+    if (param_read(device, name, &p) != RET_OK) {
+        return RET_ERROR;
+    }
+    *value = p.num.empty() ? 0 : (uint16_t)p.num[0];
+    return RET_OK;
+}
+
+int jcs_host::read_uint32(std::string const& device, std::string const& name, uint32_t* value) {
+    sim_param p;
+    if (param_read(device, name, &p) != RET_OK) {
+        return RET_ERROR;
+    }
+    *value = p.num.empty() ? 0 : (uint32_t)p.num[0];
+    return RET_OK;
+}
+
+int jcs_host::write_float(std::string const& device, std::string const& name, float value) {
+    sim_param p;
+    p.num.push_back(value);
+    return param_write(device, name, p);
+}
+
+int jcs_host::write_float(std::string const& device, std::string const& name, std::vector<float> const& value) {
+    sim_param p;
+    p.num.assign(value.begin(), value.end());
+    return param_write(device, name, p);
+}
+
+int jcs_host::write_bool(std::string const& device, std::string const& name, bool value) {
+    sim_param p;
+    p.num.push_back(value ? 1.0 : 0.0);
+    return param_write(device, name, p);
+}
+
+int jcs_host::write_enum(std::string const& device, std::string const& name, std::string const& value) {
+    sim_param p;
+    p.str = value;
+    return param_write(device, name, p);
+}
+
+int jcs_host::write_uint8(std::string const& device, std::string const& name, uint8_t value) {
+    sim_param p;
+    p.num.push_back(value);
+    return param_write(device, name, p);
+}
+
+int jcs_host::write_uint16(std::string const& device, std::string const& name, uint16_t value) {
+    sim_param p;
+    p.num.push_back(value);
+    return param_write(device, name, p);
+}
+
+int jcs_host::write_uint32(std::string const& device, std::string const& name, uint32_t value) {
+    sim_param p;
+    p.num.push_back(value);
+    return param_write(device, name, p);
+}
+
+int jcs_host::write_command(std::string const& device, std::string const& command) {
+    if (node_find(device) == NULL) {
+        std::cout << "jcs_host_sim: Unknown device " << device << "\n";
+        return RET_ERROR;
+    }
+    if (settings_.param_latency_us > 0) {
+        external::sleep_us(settings_.param_latency_us);
+    }
+    if (print_debug_) {
+        std::cout << "jcs_host_sim: " << device << ": Command " << command << "\n";
+    }
+    return RET_OK;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Device information
+std::vector<jcs_device>* jcs_host::external_info_tree_get() {
+    return &device_tree_;
+}
+
+int jcs_host::node_device_id_get(std::string const& jc_name, std::string const& device_name, dev_type* type, dev_id* id) {
+    std::cout << "jcs_host_sim: Device ID discovery is not available in simulation\n";
+    return RET_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Firmware
+int jcs_host::write_new_firmware(std::string const& device, std::string const& file_name) {
+    std::cout << "jcs_host_sim: Firmware writes are not available in simulation\n";
+    return RET_ERROR;
+}
+
+int jcs_host::write_new_flashloader(std::string const& device, std::string const& file_name) {
+    std::cout << "jcs_host_sim: Firmware writes are not available in simulation\n";
+    return RET_ERROR;
+}
+
+int jcs_host::write_new_network_firmware(std::vector<std::string>* file_names, bool only_write_listed) {
+    std::cout << "jcs_host_sim: Firmware writes are not available in simulation\n";
+    return RET_ERROR;
+}
+
+int jcs_host::write_new_network_flashloader(std::vector<std::string>* file_names, bool only_write_listed) {
+    std::cout << "jcs_host_sim: Firmware writes are not available in simulation\n";
+    return RET_ERROR;
+}
+
+int jcs_host::validate_network_firmware_filenames(std::vector<std::string>* file_names) {
+    return RET_OK;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Statistics
+// The cycle time is the measured interval between step_rt() calls, the data exchange
+// time is the time spent stepping the simulation. Thread offset tracks the cycle
+// interval error, an overrun is an interval more than 1.5 periods long.
+void jcs_host::statistics_update_rt(int64_t start_ns, int64_t end_ns) {
+    int64_t period_ns = (int64_t)1e9 / (int64_t)base_freq_hz_;
+
+    timing_rt_.start_cycle_time_ns = start_ns;
+    timing_rt_.data_exchange_time_ns = end_ns - start_ns;
+    if (last_start_ns_ != 0) {
+        int64_t interval = start_ns - last_start_ns_;
+        int64_t error = interval - period_ns;
+        timing_rt_.total_cycle_time_ns = interval;
+        transport_rt_.thread_offset_error_ns = error;
+        transport_rt_.thread_offset_correction_ns = 0;
+
+        // Welford over the interval error
+        interval_count_++;
+        double delta = (double)error - interval_mean_;
+        interval_mean_ += delta / (double)interval_count_;
+        interval_m2_ += delta * ((double)error - interval_mean_);
+        health_rt_.thread_offset.mean = interval_mean_;
+        health_rt_.thread_offset.variance = (interval_count_ > 1) ? interval_m2_ / (double)(interval_count_ - 1) : 0.0;
+        health_rt_.thread_offset.std_dev = std::sqrt(health_rt_.thread_offset.variance);
+        if (2 * error > period_ns) {
+            health_rt_.thread_offset.overrun_count++;
+            health_rt_.thread_offset.last_timestamp_ns = start_ns;
+        }
+        health_rt_.thread_offset.counts_percent = 100.0 * (double)health_rt_.thread_offset.overrun_count / (double)interval_count_;
+    }
+    last_start_ns_ = start_ns;
+
+    // Readers hold the lock for a copy. If one does, publish on a later tick.
+    if (stats_mutex_.try_lock()) {
+        timing_ = timing_rt_;
+        health_ = health_rt_;
+        transport_ = transport_rt_;
+        stats_mutex_.unlock();
+    }
+}
+
+statistics_timing jcs_host::statistics_timing_get() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return timing_;
+}
+
+statistics_health jcs_host::statistics_health_get() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return health_;
+}
+
+statistics_transport jcs_host::statistics_transport_get() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return transport_;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Reports
+int jcs_host::dev_jc_ethercat_timing_print() {
+    statistics_timing t = statistics_timing_get();
+    std::cout << "jcs_host_sim: Last cycle " << (double)t.total_cycle_time_ns * 1e-3 << "us, step "
+              << (double)t.data_exchange_time_ns * 1e-3 << "us\n";
+    return RET_OK;
+}
+
+int jcs_host::process_timing_print() {
+    return RET_OK;
+}
+
+int jcs_host::host_overrun_counts_print() {
+    statistics_health h = statistics_health_get();
+    std::cout << "jcs_host_sim: Cycle overruns: " << h.thread_offset.overrun_count << " ("
+              << h.thread_offset.counts_percent << "%), interval error mean " << h.thread_offset.mean
+              << "ns, std dev " << h.thread_offset.std_dev << "ns\n";
+    return RET_OK;
+}
+
+int jcs_host::device_error_counts_print() {
+    return RET_OK;
+}
+
+int jcs_host::device_error_estop_print() {
+    if (estop_) {
+        std::cout << "jcs_host_sim: Estop triggered by host\n";
+    }
+    return RET_OK;
+}
+
+} // End namespace jcs
@@ -0,0 +1,338 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "jcs_host_sim_nodes.h"
+#include <algorithm>
+#include <cmath>
+
+static const double pi = 3.14159265358979323846;
+
+//////////////////////////////////////////////////////////////////////
+// sim_node
+sim_node::sim_node(std::string const& name, std::string const& type) :
+    name_(name),
+    type_(type),
+    params_changed_(false),
+    noise_enabled_(false),
+    rng_(1)
+{
+}
+
+void sim_node::reset() {
+    std::fill(outputs_.begin(), outputs_.end(), 0.0f);
+}
+
+int sim_node::input_add(std::string const& name) {
+    int index = input_index(name);
+    if (index >= 0) {
+        return index;
+    }
+    input_names_.push_back(name);
+    input_sources_.push_back(sig_ref());
+    inputs_.push_back(0.0f);
+    return inputs_.size() - 1;
+}
+
+int sim_node::input_index(std::string const& name) const {
+    for (int i=0; i<input_names_.size(); i++) {
+        if (input_names_[i] == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int sim_node::output_add(std::string const& name, std::string const& units) {
+    int index = output_index(name);
+    if (index >= 0) {
+        return index;
+    }
+    output_names_.push_back(name);
+    output_units_.push_back(units);
+    outputs_.push_back(0.0f);
+    return outputs_.size() - 1;
+}
+
+int sim_node::output_index(std::string const& name) const {
+    for (int i=0; i<output_names_.size(); i++) {
+        if (output_names_[i] == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void sim_node::noise_setup(uint32_t seed, bool enabled) {
+    // FNV-1a of the name
+    uint32_t h = 2166136261u;
+    for (int i=0; i<name_.size(); i++) {
+        h ^= (uint8_t)name_[i];
+        h *= 16777619u;
+    }
+    rng_ = h ^ (seed * 2654435761u);
+    if (rng_ == 0) {
+        rng_ = 1;
+    }
+    noise_enabled_ = enabled;
+}
+
+double sim_node::noise(double amplitude) {
+    if (!noise_enabled_) {
+        return 0.0;
+    }
+    // xorshift32
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return amplitude * ((double)(rng_ >> 8) * (2.0 / 16777216.0) - 1.0);
+}
+
+double sim_node::param_get(std::map<std::string, sim_param> const& params, std::string const& name, double def) {
+    std::map<std::string, sim_param>::const_iterator it = params.find(name);
+    if (it == params.end() || it->second.num.empty()) {
+        return def;
+    }
+    return it->second.num[0];
+}
+
+sim_node* sim_node_make(std::string const& name, std::string const& type) {
+    if (type == "dev_motor_controller") { return new sim_motor_controller(name, type); }
+    if (type == "proc_pd")              { return new sim_proc_pd(name, type); }
+    if (type == "proc_pid")             { return new sim_proc_pid(name, type); }
+    return new sim_node(name, type);
+}
+
+//////////////////////////////////////////////////////////////////////
+// sim_motor_controller
+sim_motor_controller::sim_motor_controller(std::string const& name, std::string const& type) :
+    sim_node(name, type),
+    in_i_q_(-1),
+    in_i_d_(-1),
+    out_th_(-1),
+    out_w_(-1),
+    out_i_d_(-1),
+    out_i_q_(-1),
+    out_tau_(-1),
+    out_i_mot_(-1),
+    out_v_dc_(-1),
+    out_t_ave_(-1),
+    i_q_name_("i_q"),
+    i_q_is_torque_(false),
+    kt_(0.1),
+    wc_(0.0),
+    inertia_(1.0),
+    damping_(0.0),
+    resistance_(0.0),
+    thermal_resistance_(0.0),
+    thermal_tau_s_(1.0),
+    ambient_(0.0),
+    v_dc_(0.0),
+    i_d_(0.0),
+    i_q_(0.0),
+    th_(0.0),
+    w_(0.0),
+    temp_(0.0)
+{
+}
+
+void sim_motor_controller::setup() {
+    // The current command may be renamed, e.g. to tau with units Nm
+    std::map<std::string, std::string>::const_iterator it = config_.find("i_q_name");
+    if (it != config_.end()) {
+        i_q_name_ = it->second;
+    }
+    it = config_.find("i_q_units");
+    i_q_is_torque_ = (it != config_.end()) && (it->second == "Nm");
+
+    out_th_    = output_add("th_m_0", "rad");
+    out_w_     = output_add("w_m_0", "rad/s");
+    out_i_d_   = output_add("i_d", "A");
+    out_i_q_   = output_add("i_q", "A");
+    out_i_mot_ = output_add("i_mot", "A");
+    out_v_dc_  = output_add("v_dc", "V");
+    out_t_ave_ = output_add("t_ave", "C");
+    output_add("encoder_error_rate_0", "");
+    if (i_q_name_ != "i_q") {
+        out_tau_ = output_add(i_q_name_, i_q_is_torque_ ? "Nm" : "A");
+    }
+}
+
+void sim_motor_controller::configure(std::map<std::string, sim_param> const& params, sim_settings const& settings) {
+    in_i_q_ = input_index(i_q_name_);
+    in_i_d_ = input_index("i_d");
+
+    kt_ = param_get(params, "motor_Kt", 0.1);
+    if (kt_ <= 0.0) {
+        kt_ = 0.1;
+    }
+    wc_                 = 2.0 * pi * settings.mc_current_bandwidth_hz;
+    inertia_            = settings.mc_inertia;
+    damping_            = settings.mc_damping;
+    resistance_         = settings.mc_resistance;
+    thermal_resistance_ = settings.mc_thermal_resistance;
+    thermal_tau_s_      = settings.mc_thermal_time_constant_s;
+    ambient_            = settings.mc_ambient_temperature;
+    v_dc_               = settings.mc_v_dc;
+}
+
+void sim_motor_controller::reset() {
+    sim_node::reset();
+    i_d_  = 0.0;
+    i_q_  = 0.0;
+    th_   = 0.0;
+    w_    = 0.0;
+    temp_ = ambient_;
+}
+
+void sim_motor_controller::step(double dt, bool running) {
+    double i_q_ref = 0.0;
+    double i_d_ref = 0.0;
+    if (running) {
+        i_q_ref = input_get(in_i_q_);
+        if (i_q_is_torque_) {
+            i_q_ref /= kt_;
+        }
+        i_d_ref = input_get(in_i_d_);
+    }
+
+    // Current loop closes as a first order lag, exact for any dt
+    double a = 1.0 - std::exp(-wc_ * dt);
+    i_q_ += (i_q_ref - i_q_) * a;
+    i_d_ += (i_d_ref - i_d_) * a;
+
+    // Mechanics, semi-implicit Euler
+    double tau = kt_ * i_q_;
+    w_  += dt * (tau - damping_ * w_) / inertia_;
+    th_ += dt * w_;
+
+    // Winding temperature
+    double power = 1.5 * resistance_ * (i_d_ * i_d_ + i_q_ * i_q_);
+    double t_ss  = ambient_ + power * thermal_resistance_;
+    temp_ += (t_ss - temp_) * (1.0 - std::exp(-dt / thermal_tau_s_));
+
+    double i_d_meas = i_d_ + noise(0.01);
+    double i_q_meas = i_q_ + noise(0.01);
+    outputs_[out_th_]    = (float)(th_ + noise(1.0e-4));
+    outputs_[out_w_]     = (float)(w_ + noise(0.02));
+    outputs_[out_i_d_]   = (float)i_d_meas;
+    outputs_[out_i_q_]   = (float)i_q_meas;
+    outputs_[out_i_mot_] = (float)std::sqrt(i_d_meas * i_d_meas + i_q_meas * i_q_meas);
+    outputs_[out_v_dc_]  = (float)(v_dc_ + noise(0.05));
+    outputs_[out_t_ave_] = (float)(temp_ + noise(0.05));
+    if (out_tau_ >= 0) {
+        outputs_[out_tau_] = i_q_is_torque_ ? (float)(kt_ * i_q_meas) : (float)i_q_meas;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+// sim_proc_pd
+sim_proc_pd::sim_proc_pd(std::string const& name, std::string const& type) :
+    sim_node(name, type),
+    in_p_sp_(-1),
+    in_p_fb_(-1),
+    in_d_sp_(-1),
+    in_d_fb_(-1),
+    out_u_(-1),
+    kp_(0.0),
+    kd_(0.0),
+    lim_h_(0.0),
+    lim_l_(0.0),
+    p_rotational_(false)
+{
+}
+
+void sim_proc_pd::setup() {
+    out_u_ = output_add("u", "");
+}
+
+void sim_proc_pd::configure(std::map<std::string, sim_param> const& params, sim_settings const& settings) {
+    in_p_sp_ = input_index("p_setpoint");
+    in_p_fb_ = input_index("p_feedback");
+    in_d_sp_ = input_index("d_setpoint");
+    in_d_fb_ = input_index("d_feedback");
+    kp_ = param_get(params, "proc_pd_kp", 0.0);
+    kd_ = param_get(params, "proc_pd_kd", 0.0);
+    lim_h_ = param_get(params, "proc_pd_limit_out_h", 0.0);
+    lim_l_ = param_get(params, "proc_pd_limit_out_l", 0.0);
+    p_rotational_ = param_get(params, "proc_pd_p_is_rotational_error", 0.0) != 0.0;
+}
+
+void sim_proc_pd::step(double dt, bool running) {
+    if (!running) {
+        outputs_[out_u_] = 0.0f;
+        return;
+    }
+    double e_p = input_get(in_p_sp_) - input_get(in_p_fb_);
+    if (p_rotational_) {
+        e_p = std::remainder(e_p, 2.0 * pi);
+    }
+    double e_d = input_get(in_d_sp_) - input_get(in_d_fb_);
+    double u = kp_ * e_p + kd_ * e_d;
+    if (lim_h_ > lim_l_) {
+        u = std::min(std::max(u, lim_l_), lim_h_);
+    }
+    outputs_[out_u_] = (float)u;
+}
+
+//////////////////////////////////////////////////////////////////////
+// sim_proc_pid
+sim_proc_pid::sim_proc_pid(std::string const& name, std::string const& type) :
+    sim_node(name, type),
+    in_sp_(-1),
+    in_fb_(-1),
+    out_u_(-1),
+    kp_(0.0),
+    ki_(0.0),
+    kd_(0.0),
+    lim_h_(0.0),
+    lim_l_(0.0),
+    integral_(0.0),
+    e_old_(0.0)
+{
+}
+
+void sim_proc_pid::setup() {
+    out_u_ = output_add("u", "");
+}
+
+void sim_proc_pid::configure(std::map<std::string, sim_param> const& params, sim_settings const& settings) {
+    in_sp_ = input_index("setpoint");
+    in_fb_ = input_index("feedback");
+    kp_ = param_get(params, "proc_pid_kp", 0.0);
+    ki_ = param_get(params, "proc_pid_ki", 0.0);
+    kd_ = param_get(params, "proc_pid_kd", 0.0);
+    lim_h_ = param_get(params, "proc_pid_limit_out_h", 0.0);
+    lim_l_ = param_get(params, "proc_pid_limit_out_l", 0.0);
+}
+
+void sim_proc_pid::reset() {
+    sim_node::reset();
+    integral_ = 0.0;
+    e_old_ = 0.0;
+}
+
+void sim_proc_pid::step(double dt, bool running) {
+    if (!running) {
+        integral_ = 0.0;
+        e_old_ = 0.0;
+        outputs_[out_u_] = 0.0f;
+        return;
+    }
+    double e = input_get(in_sp_) - input_get(in_fb_);
+    double integral = integral_ + ki_ * e * dt;
+    double u = kp_ * e + integral + kd_ * (e - e_old_) / dt;
+    e_old_ = e;
+    if (lim_h_ > lim_l_) {
+        // Conditional integration for anti-windup
+        if (u > lim_h_) {
+            u = lim_h_;
+        } else if (u < lim_l_) {
+            u = lim_l_;
+        } else {
+            integral_ = integral;
+        }
+    } else {
+        integral_ = integral;
+    }
+    outputs_[out_u_] = (float)u;
+}
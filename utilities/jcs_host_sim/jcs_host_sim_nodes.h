@@ -0,0 +1,211 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef JCS_HOST_SIM_NODES_H_
+#define JCS_HOST_SIM_NODES_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Parameter value. Numbers are held as a vector so float vectors share the type.
+struct sim_param {
+    std::vector<double> num;
+    std::string str;
+};
+
+// Settings from the optional `simulation` section of dev_HOST.yaml
+struct sim_settings {
+    uint32_t seed;
+    bool     noise;
+    int      param_latency_us;
+    // Motor controller plant
+    double   mc_current_bandwidth_hz;
+    double   mc_inertia;                 // kg.m^2
+    double   mc_damping;                 // Nm/(rad/s)
+    double   mc_resistance;              // Ohm, phase
+    double   mc_thermal_resistance;      // K/W
+    double   mc_thermal_time_constant_s;
+    double   mc_ambient_temperature;     // C
+    double   mc_v_dc;                    // V
+
+    sim_settings() :
+        seed(1),
+        noise(true),
+        param_latency_us(500),
+        mc_current_bandwidth_hz(1000.0),
+        mc_inertia(1.0e-4),
+        mc_damping(1.0e-4),
+        mc_resistance(0.2),
+        mc_thermal_resistance(2.0),
+        mc_thermal_time_constant_s(120.0),
+        mc_ambient_temperature(25.0),
+        mc_v_dc(48.0) {}
+};
+
+// Reference to a node output
+struct sig_ref {
+    int node;
+    int index;
+    sig_ref() : node(-1), index(-1) {}
+    sig_ref(int n, int i) : node(n), index(i) {}
+};
+
+// Input routing entry from structure.yaml
+struct sim_route {
+    std::string rate;
+    std::string signal_name;
+    std::string source;
+    std::string name;
+};
+
+// A simulated network node.
+// Outputs are defined by the model in setup(). Outputs requested by other nodes
+// that the model does not produce are added and held at zero.
+class sim_node {
+public:
+    sim_node(std::string const& name, std::string const& type);
+    virtual ~sim_node() {}
+
+    // Define outputs once config_ is loaded
+    virtual void setup() {}
+    // Refresh coefficients and input indices from parameters.
+    // Called at start up and from the RT thread after a parameter write.
+    virtual void configure(std::map<std::string, sim_param> const& params, sim_settings const& settings) {}
+    // Advance one tick. Inputs are current. running is false unless the network is started.
+    virtual void step(double dt, bool running) {}
+    virtual void reset();
+
+    int input_add(std::string const& name);
+    int input_index(std::string const& name) const;
+    int output_add(std::string const& name, std::string const& units);
+    int output_index(std::string const& name) const;
+
+    // Noise generator seeded from the node name, so it does not depend on node order
+    void noise_setup(uint32_t seed, bool enabled);
+
+    bool is_device() const { return type_.compare(0, 4, "dev_") == 0; }
+
+    std::string name_;
+    std::string type_;
+    // Top level scalar config entries from dev_/proc_ yaml, other than parameters
+    std::map<std::string, std::string> config_;
+    std::vector<uint32_t> device_id_;
+    std::vector<sim_route> routes_;
+    std::vector<std::string> procs_;
+
+    std::vector<std::string> input_names_;
+    std::vector<sig_ref>     input_sources_;
+    std::vector<float>       inputs_;
+    std::vector<std::string> output_names_;
+    std::vector<std::string> output_units_;
+    std::vector<float>       outputs_;
+
+    std::atomic<bool> params_changed_;
+
+protected:
+    float input_get(int index) const { return (index < 0) ? 0.0f : inputs_[index]; }
+    // Uniform noise in [-amplitude, amplitude], from a per node generator
+    double noise(double amplitude);
+    static double param_get(std::map<std::string, sim_param> const& params, std::string const& name, double def);
+
+    bool noise_enabled_;
+    uint32_t rng_;
+};
+
+sim_node* sim_node_make(std::string const& name, std::string const& type);
+
+// Motor controller: first order current loop, rigid inertia with viscous damping and
+// a first order winding temperature.
+class sim_motor_controller : public sim_node {
+public:
+    sim_motor_controller(std::string const& name, std::string const& type);
+
+    void setup();
+    void configure(std::map<std::string, sim_param> const& params, sim_settings const& settings);
+    void step(double dt, bool running);
+    void reset();
+
+private:
+    // Inputs
+    int in_i_q_;
+    int in_i_d_;
+    // Outputs
+    int out_th_;
+    int out_w_;
+    int out_i_d_;
+    int out_i_q_;
+    int out_tau_;
+    int out_i_mot_;
+    int out_v_dc_;
+    int out_t_ave_;
+
+    std::string i_q_name_;
+    bool i_q_is_torque_;
+
+    double kt_;
+    double wc_;
+    double inertia_;
+    double damping_;
+    double resistance_;
+    double thermal_resistance_;
+    double thermal_tau_s_;
+    double ambient_;
+    double v_dc_;
+
+    // State
+    double i_d_;
+    double i_q_;
+    double th_;
+    double w_;
+    double temp_;
+};
+
+// proc_pd: u = kp*(p_setpoint - p_feedback) + kd*(d_setpoint - d_feedback)
+class sim_proc_pd : public sim_node {
+public:
+    sim_proc_pd(std::string const& name, std::string const& type);
+
+    void setup();
+    void configure(std::map<std::string, sim_param> const& params, sim_settings const& settings);
+    void step(double dt, bool running);
+
+private:
+    int in_p_sp_;
+    int in_p_fb_;
+    int in_d_sp_;
+    int in_d_fb_;
+    int out_u_;
+    double kp_;
+    double kd_;
+    double lim_h_;
+    double lim_l_;
+    bool p_rotational_;
+};
+
+// proc_pid: u = kp*e + ki*integral(e) + kd*de/dt, e = setpoint - feedback
+class sim_proc_pid : public sim_node {
+public:
+    sim_proc_pid(std::string const& name, std::string const& type);
+
+    void setup();
+    void configure(std::map<std::string, sim_param> const& params, sim_settings const& settings);
+    void step(double dt, bool running);
+    void reset();
+
+private:
+    int in_sp_;
+    int in_fb_;
+    int out_u_;
+    double kp_;
+    double ki_;
+    double kd_;
+    double lim_h_;
+    double lim_l_;
+    double integral_;
+    double e_old_;
+};
+
+#endif
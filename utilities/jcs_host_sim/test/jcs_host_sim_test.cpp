@@ -0,0 +1,86 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+// Usage: jcs_host_sim_test <config path>, e.g. examples_configuration/system_16dof_torque_control
+//
+#include <cmath>
+#include <ctime>
+#include <iostream>//cout
+#include <unistd.h>
+#include "../jcs_host.h"
+
+namespace jcs {
+namespace external {
+void sleep_us(long int us) {
+    usleep(us);
+}
+long int time_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+}
+}
+
+// Run n ticks with a sine on every input, return the output history
+static std::vector<float> run(std::string const& config_path, int n_ticks, double* step_us) {
+    std::vector<float> history;
+    jcs::jcs_host* host = jcs::jcs_host::make_jcs_host(config_path, false, false);
+    if (host == NULL) {
+        return history;
+    }
+    std::vector<float> in(host->sig_input_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+    std::vector<float> out(host->sig_output_sz_unsafe_rt(jcs::signal_type::float32_s, 0));
+    double dt = 1.0 / (double)host->base_frequency_get();
+
+    host->start_network();
+    host->ready_devices();
+    host->start();
+
+    int64_t cycle_time_ns;
+    long int t0 = jcs::external::time_now_ns();
+    for (int t=0; t<n_ticks; t++) {
+        for (int i=0; i<in.size(); i++) {
+            in[i] = (float)(0.1 * std::sin(2.0 * M_PI * (1.0 + i) * t * dt));
+        }
+        host->sig_input_set_rt(0, in);
+        host->step_rt(&cycle_time_ns);
+        host->sig_output_get_rt(0, &out);
+        history.insert(history.end(), out.begin(), out.end());
+    }
+    *step_us = (double)(jcs::external::time_now_ns() - t0) * 1e-3 / (double)n_ticks;
+    delete host;
+    return history;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: jcs_host_sim_test <config path>\n";
+        return -1;
+    }
+    const int n_ticks = 20000;
+
+    double step_us_a;
+    double step_us_b;
+    std::vector<float> a = run(argv[1], n_ticks, &step_us_a);
+    std::vector<float> b = run(argv[1], n_ticks, &step_us_b);
+    if (a.empty()) {
+        std::cout << "Failed to start\n";
+        return -1;
+    }
+
+    int mismatches = 0;
+    for (int i=0; i<a.size(); i++) {
+        if (a[i] != b[i]) {
+            mismatches++;
+        }
+    }
+    int n_out = a.size() / n_ticks;
+    std::cout << "outputs: " << n_out << ", ticks: " << n_ticks << ", mismatches: " << mismatches << "\n";
+    std::cout << "last outputs:";
+    for (int i=0; i<n_out; i++) {
+        std::cout << " " << a[a.size() - n_out + i];
+    }
+    std::cout << "\nmean step time: " << step_us_a << "us, " << step_us_b << "us\n";
+    return (mismatches == 0) ? 0 : -1;
+}
@@ -0,0 +1,221 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "recorder_stream.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include "jcs_host_types.h"
+
+static const char recorder_stream_magic[8] = {'J', 'C', 'S', 'R', 'E', 'C', '0', '1'};
+
+void recorder_stream::index_queue::startup(int n) {
+    uint32_t sz = 1;
+    while (sz < (uint32_t)n) {
+        sz <<= 1;
+    }
+    idx.assign(sz, 0);
+    mask = sz - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_release);
+}
+
+bool recorder_stream::index_queue::push(int i) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if ((h - tail.load(std::memory_order_acquire)) > mask) {
+        return false;
+    }
+    idx[h & mask] = i;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool recorder_stream::index_queue::pop(int* i) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+        return false;
+    }
+    *i = idx[t & mask];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+recorder_stream::recorder_stream(std::vector<std::string> const& header, std::string filename, int chunk_rows, int n_chunks) {
+    header_ = header;
+    filename_ = filename;
+    chunk_rows_ = (chunk_rows < 1) ? 1 : chunk_rows;
+    n_columns_ = header_.size();
+    if (n_chunks < 2) {
+        n_chunks = 2;
+    }
+
+    // All storage allocated up front
+    chunks_.resize(n_chunks);
+    for (int i=0; i<chunks_.size(); i++) {
+        chunks_[i].n_rows = 0;
+        chunks_[i].t.resize(chunk_rows_);
+        chunks_[i].values.resize((size_t)chunk_rows_ * n_columns_);
+    }
+    free_.startup(n_chunks);
+    ready_.startup(n_chunks);
+    for (int i=0; i<chunks_.size(); i++) {
+        free_.push(i);
+    }
+    active_ = -1;
+
+    file_ = nullptr;
+    running_.store(false);
+    write_error_.store(false);
+    rows_written_.store(0);
+    dropped_.store(0);
+}
+
+recorder_stream::~recorder_stream() {
+    stop();
+}
+
+int recorder_stream::start() {
+    if (file_ != nullptr) {
+        return jcs::RET_ERROR;
+    }
+    file_ = std::fopen(filename_.c_str(), "wb");
+    if (file_ == nullptr) {
+        std::cout << "recorder_stream: Could not open " << filename_ << "\n";
+        return jcs::RET_ERROR;
+    }
+    if (write_header() != jcs::RET_OK) {
+        std::cout << "recorder_stream: Could not write header to " << filename_ << "\n";
+        std::fclose(file_);
+        file_ = nullptr;
+        return jcs::RET_ERROR;
+    }
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&recorder_stream::writer, this);
+    return jcs::RET_OK;
+}
+
+int recorder_stream::stop() {
+    if (file_ == nullptr) {
+        return jcs::RET_OK;
+    }
+
+    // Hand over whatever is left in the active chunk
+    if (active_ >= 0) {
+        if (chunks_[active_].n_rows > 0) {
+            ready_.push(active_);
+        } else {
+            free_.push(active_);
+        }
+        active_ = -1;
+    }
+
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    std::fclose(file_);
+    file_ = nullptr;
+
+    if (write_error_.load()) {
+        std::cout << "recorder_stream: Write error on " << filename_ << "\n";
+        return jcs::RET_ERROR;
+    }
+    if (dropped_.load() > 0) {
+        std::cout << "recorder_stream: " << filename_ << " dropped " << dropped_.load() << " records\n";
+    }
+    return jcs::RET_OK;
+}
+
+int recorder_stream::add_rt(int64_t timestamp_ns, float const* values) {
+    // start() may run on another thread
+    if (!running_.load(std::memory_order_acquire)) {
+        return jcs::RET_ERROR;
+    }
+    if (active_ < 0) {
+        if (!free_.pop(&active_)) {
+            // Writer is behind
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return jcs::RET_ERROR;
+        }
+        chunks_[active_].n_rows = 0;
+    }
+
+    chunk& c = chunks_[active_];
+    int row = c.n_rows;
+    c.t[row] = timestamp_ns;
+    for (int i=0; i<n_columns_; i++) {
+        c.values[(size_t)i*chunk_rows_ + row] = values[i];
+    }
+    c.n_rows++;
+
+    if (c.n_rows == chunk_rows_) {
+        // Cannot fail, ready_ holds every chunk
+        ready_.push(active_);
+        active_ = -1;
+    }
+    return jcs::RET_OK;
+}
+
+int64_t recorder_stream::rows_written() const {
+    return rows_written_.load(std::memory_order_relaxed);
+}
+
+uint32_t recorder_stream::dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+void recorder_stream::writer() {
+    int idx;
+    while (true) {
+        // Read running_ before draining so nothing pushed before stop() is missed
+        bool running = running_.load(std::memory_order_acquire);
+        bool wrote = false;
+        while (ready_.pop(&idx)) {
+            if (!write_error_.load(std::memory_order_relaxed) && write_chunk(chunks_[idx]) != jcs::RET_OK) {
+                write_error_.store(true);
+            }
+            rows_written_.fetch_add(chunks_[idx].n_rows, std::memory_order_relaxed);
+            free_.push(idx);
+            wrote = true;
+        }
+        if (!running) {
+            break;
+        }
+        if (!wrote) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    std::fflush(file_);
+}
+
+int recorder_stream::write_header() {
+    bool ok = true;
+    uint32_t n_columns = n_columns_ + 1;
+    ok &= std::fwrite(recorder_stream_magic, sizeof(recorder_stream_magic), 1, file_) == 1;
+    ok &= std::fwrite(&n_columns, sizeof(n_columns), 1, file_) == 1;
+
+    for (int i=0; i<n_columns; i++) {
+        std::string name = (i == 0) ? "timestamp_ns" : header_[i-1];
+        uint8_t type = static_cast<uint8_t>((i == 0) ? column_type::int64_t_s : column_type::float32_t_s);
+        uint16_t name_sz = name.size();
+        ok &= std::fwrite(&type, sizeof(type), 1, file_) == 1;
+        ok &= std::fwrite(&name_sz, sizeof(name_sz), 1, file_) == 1;
+        if (name_sz > 0) {
+            ok &= std::fwrite(name.data(), name_sz, 1, file_) == 1;
+        }
+    }
+    return ok ? jcs::RET_OK : jcs::RET_ERROR;
+}
+
+int recorder_stream::write_chunk(chunk const& c) {
+    bool ok = true;
+    uint32_t n_rows = c.n_rows;
+    ok &= std::fwrite(&n_rows, sizeof(n_rows), 1, file_) == 1;
+    ok &= std::fwrite(c.t.data(), sizeof(int64_t), n_rows, file_) == n_rows;
+    for (int i=0; i<n_columns_; i++) {
+        ok &= std::fwrite(&c.values[(size_t)i*chunk_rows_], sizeof(float), n_rows, file_) == n_rows;
+    }
+    return ok ? jcs::RET_OK : jcs::RET_ERROR;
+}
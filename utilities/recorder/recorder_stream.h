@@ -0,0 +1,103 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef RECORDER_STREAM_HELPER_H_
+#define RECORDER_STREAM_HELPER_H_
+
+#include <stdint.h>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+
+// Streams records to a binary columnar file from a background writer thread.
+// RT thread fills preallocated chunks with add_rt(). Full chunks are handed to the
+// writer through a lock-free queue. add_rt() never blocks, never allocates and never
+// formats text. If the writer falls behind the record is dropped and counted.
+//
+// File layout (native little endian):
+//   Header:
+//     char[8]   magic "JCSREC01"
+//     uint32_t  n_columns
+//     Per column:
+//       uint8_t   type (column_type)
+//       uint16_t  name length
+//       char[]    name
+//   Chunks, until end of file:
+//     uint32_t  n_rows
+//     Per column, n_rows values of the column type
+//
+// Column 0 is always "timestamp_ns" int64. The remaining columns are float32.
+// tool_mc_current_test/script/recorder_stream.py reads the format.
+class recorder_stream {
+public:
+    enum class column_type : uint8_t {
+        int64_t_s   = 0,
+        float32_t_s = 1
+    };
+
+    // header: Names of the float columns. The timestamp column is added automatically.
+    recorder_stream(std::vector<std::string> const& header, std::string filename, int chunk_rows=1024, int n_chunks=64);
+    ~recorder_stream();
+
+    // Non RT. Open the file, write the header and start the writer thread.
+    // The writer inherits the calling thread's scheduling and CPU affinity, so do not call from RT.
+    int start();
+    // Non RT. Flush the partially filled chunk, drain the queue and close the file.
+    int stop();
+
+    // RT. values must point to one value per float column.
+    int add_rt(int64_t timestamp_ns, float const* values);
+
+    int64_t rows_written() const;
+    uint32_t dropped() const;
+
+private:
+    struct chunk {
+        int n_rows;
+        std::vector<int64_t> t;
+        std::vector<float> values; // Column major: values[col*chunk_rows_ + row]
+    };
+
+    // Lock-free single producer / single consumer queue of chunk indices.
+    // head and tail on separate cache lines. Padded rather than alignas(64), which plain
+    // new does not honour before C++17.
+    struct index_queue {
+        static const int cache_line = 64;
+        std::vector<int> idx;
+        uint32_t mask;
+        char pad_0[cache_line];
+        std::atomic<uint32_t> head;
+        char pad_1[cache_line];
+        std::atomic<uint32_t> tail;
+        char pad_2[cache_line];
+
+        void startup(int n);
+        bool push(int i);
+        bool pop(int* i);
+    };
+
+    void writer();
+    int write_header();
+    int write_chunk(chunk const& c);
+
+    std::vector<std::string> header_;
+    std::string filename_;
+    int chunk_rows_;
+    int n_columns_;
+
+    std::vector<chunk> chunks_;
+    index_queue free_;  // Writer -> RT
+    index_queue ready_; // RT -> Writer
+    int active_;        // Chunk being filled by RT, -1 if none
+
+    FILE* file_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> write_error_;
+    std::atomic<int64_t> rows_written_;
+    std::atomic<uint32_t> dropped_;
+};
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include <iostream>//cout
+#include <fstream>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include "../recorder_stream.h"
+
+// Stream records at roughly RT rate, then read the file back and check every value.
+int main(int argc, char* argv[]) {
+    const int n_cols = 8;
+    const int n_records = 200000;
+    std::vector<std::string> header;
+    for (int i=0; i<n_cols; i++) {
+        header.push_back("sig_" + std::to_string(i));
+    }
+
+    recorder_stream rec(header, "recorder_stream_test.jrec");
+    if (rec.start() != 0) {
+        std::cout << "start failed\n";
+        return 1;
+    }
+    std::vector<float> values(n_cols);
+    for (int r=0; r<n_records; r++) {
+        for (int i=0; i<n_cols; i++) {
+            values[i] = (float)(r + i);
+        }
+        // Large timestamps must survive intact
+        rec.add_rt(1000000000000LL + r, values.data());
+        if ((r % 1000) == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+    rec.stop();
+    std::cout << "written: " << rec.rows_written() << ", dropped: " << rec.dropped() << "\n";
+
+    // Read back
+    std::ifstream ifs("recorder_stream_test.jrec", std::ios::binary);
+    char magic[8];
+    uint32_t n_columns;
+    ifs.read(magic, 8);
+    ifs.read((char*)&n_columns, 4);
+    for (int i=0; i<n_columns; i++) {
+        uint8_t type;
+        uint16_t sz;
+        ifs.read((char*)&type, 1);
+        ifs.read((char*)&sz, 2);
+        ifs.ignore(sz);
+    }
+
+    int errors = 0;
+    int64_t expected = 0;
+    uint32_t n_rows;
+    while (ifs.read((char*)&n_rows, 4)) {
+        std::vector<int64_t> t(n_rows);
+        std::vector<float> v(n_rows);
+        ifs.read((char*)t.data(), n_rows * sizeof(int64_t));
+        for (int r=0; r<n_rows; r++) {
+            if (t[r] < 1000000000000LL + expected + r) {
+                errors++;
+            }
+        }
+        for (int i=0; i<n_cols; i++) {
+            ifs.read((char*)v.data(), n_rows * sizeof(float));
+            for (int r=0; r<n_rows; r++) {
+                if (v[r] != (float)(t[r] - 1000000000000LL + i)) {
+                    errors++;
+                }
+            }
+        }
+        expected += n_rows;
+    }
+    std::cout << "read back: " << expected << ", errors: " << errors << "\n";
+    return (errors == 0 && expected == rec.rows_written() && (expected + rec.dropped()) == n_records) ? 0 : 1;
+}
@@ -4,10 +4,16 @@
 #include "task_rt.h"
 #include <stdint.h>
 #include <iostream>
+#include <iomanip>
 #include <sys/mman.h>   // Needed for mlockall()
 #include <malloc.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <mutex>
+#include <atomic>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <climits>
 
 #include "jcs_host.h"
 
@@ -19,6 +25,40 @@ namespace task_rt {
     int ready_for_rt(bool do_mem_lock);
     int configure_memory_rt();
     void advance_timespec(struct timespec *ts, int64_t nsec);
+    int thread_create(pthread_t* thread, thd_sched const& s, void* (*fn)(void*), void* args);
+    int sched_deadline_set_self(thd_sched const& s);
+    int64_t timespec_diff_ns(struct timespec const& a, struct timespec const& b);
+    void cycle_stats_lateness(cycle_stats* stats, int64_t lateness_ns, struct timespec const& now);
+    void cycle_stats_exec(cycle_stats* stats, int64_t exec_ns);
+
+    // Process wide RT preparation is done once, however many RT threads are started
+    std::mutex ready_mutex;
+    bool ready_done = false;
+    bool ready_mem_locked = false;
+
+    // Layout from linux/sched/types.h. Not all libc versions provide it.
+    struct sched_attr_dl {
+        uint32_t size;
+        uint32_t sched_policy;
+        uint64_t sched_flags;
+        int32_t  sched_nice;
+        uint32_t sched_priority;
+        uint64_t sched_runtime;
+        uint64_t sched_deadline;
+        uint64_t sched_period;
+    };
+
+    // SCHED_DEADLINE can only be set on a running thread.
+    // The new thread applies it, reports back, then runs the user function.
+    // The creator frees the args once status is set, unless it gave up waiting.
+    struct thread_start_args {
+        void* (*fn)(void*);
+        void* args;
+        thd_sched sched;
+        std::atomic<int> status; // 0: pending, 1: ok, -1: failed, -2: creator gave up
+    };
+    const int thread_start_timeout_ms = 1000;
+    void* thread_start_deadline(void* arg);
 }
 
 //
@@ -34,56 +74,15 @@ namespace task_rt {
 // 
 // Assume > 1 processor
 int task_rt::task_start_rt(thd_context* ctx, bool do_mem_lock) {
-    pthread_attr_t attr;
-    int r = 0;
-
     if (ctx->rt_thread_fn == NULL) {
         std::cout << "rt_thread_fn cannot be NULL\n";
         return jcs::RET_ERROR;
     }
-
-    r = pthread_attr_init(&attr);
-    if (r < 0) {
-        std::cout << "pthread_attr_init failed: " << r << std::endl;
-        return jcs::RET_ERROR;
-    }
-
-
-    r = pthread_attr_setstacksize(&attr, pre_alloc_size);
-    if (r < 0) {
-        std::cout << "pthread_attr_setstacksize failed: " << r << std::endl;
-        return jcs::RET_ERROR;
-    }
-
-    r = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
-    if (r < 0) {
-        std::cout << "pthread_attr_setinheritsched failed: " << r << std::endl;
-        return jcs::RET_ERROR;
-    }
-    int policy = SCHED_FIFO;
-    r = pthread_attr_setschedpolicy(&attr, policy);
-    if (r < 0) {
-        std::cout << "pthread_attr_setschedpolicy failed: " << r << std::endl;
-        return jcs::RET_ERROR;
-    }
-
-    struct sched_param schedparam;
-    schedparam.sched_priority = 87; // preempt_rt
-    
-    r = pthread_attr_setschedparam(&attr, &schedparam);
-    if (r < 0) {
-        std::cout << "pthread_attr_setschedparam failed: " << r << std::endl;
+    if (ctx->rt_sched.policy == SCHED_OTHER) {
+        std::cout << "task_start_rt: RT thread needs an RT policy\n";
         return jcs::RET_ERROR;
     }
-
-    // Pin the RT application to CPU 1
-    cpu_set_t cpu_set;
-    CPU_ZERO(&cpu_set);
-    CPU_SET(1, &cpu_set);
-
-    r = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
-    if (r < 0) {
-        std::cout << "pthread_attr_setaffinity_np failed: " << r << std::endl;
+    if (sched_check(ctx->rt_sched) != jcs::RET_OK) {
         return jcs::RET_ERROR;
     }
 
@@ -92,12 +91,7 @@ int task_rt::task_start_rt(thd_context* ctx, bool do_mem_lock) {
     }
 
     // Start the thread
-    r = pthread_create(&ctx->rt_thread, &attr, ctx->rt_thread_fn, ctx->thread_args);
-    if (r < 0) {
-        std::cout << "pthread_create failed: " << r << std::endl;
-        return jcs::RET_ERROR;
-    }
-    return jcs::RET_OK;
+    return thread_create(&ctx->rt_thread, ctx->rt_sched, ctx->rt_thread_fn, ctx->thread_args);
 }
 
 void task_rt::task_stop_rt(thd_context* ctx) {
@@ -158,11 +152,16 @@ int task_rt::configure_memory_rt() {
 }
 
 int task_rt::ready_for_rt(bool do_mem_lock) {
+    std::lock_guard<std::mutex> lock(ready_mutex);
 
-    if (do_mem_lock) {
+    if (do_mem_lock && !ready_mem_locked) {
         if (configure_memory_rt() != jcs::RET_OK) {
             return jcs::RET_ERROR;
         }
+        ready_mem_locked = true;
+    }
+    if (ready_done) {
+        return jcs::RET_OK;
     }
 
     // Prohibit machine from entering sleep states
@@ -178,33 +177,250 @@ int task_rt::ready_for_rt(bool do_mem_lock) {
         std::cout << "Writing to /dev/cpu_dma_latency failed: " << r << std::endl;
         return jcs::RET_ERROR;
     }
+    ready_done = true;
 
     // Go and start RT tasks
     return jcs::RET_OK;
 }
 
 void task_rt::ready_cycle_rt(thd_context* ctx, int64_t cycle_time_ns) {
+    ctx->rt_stats.clear();
     clock_gettime(CLOCK_MONOTONIC, &ctx->rt_cycle_ts);
-    // Round to nearest ms
-    int ht = (ctx->rt_cycle_ts.tv_nsec / 1000000) + 1;
-    ctx->rt_cycle_ts.tv_nsec = ht * 1000000;
+    // First cycle starts on the next multiple of the cycle time
+    int64_t period_ns = (cycle_time_ns > 0) ? cycle_time_ns : 1000000;
+    int64_t now_ns = (int64_t)ctx->rt_cycle_ts.tv_sec * nsec_per_sec + ctx->rt_cycle_ts.tv_nsec;
+    int64_t start_ns = (now_ns / period_ns + 1) * period_ns;
+    ctx->rt_cycle_ts.tv_sec = start_ns / nsec_per_sec;
+    ctx->rt_cycle_ts.tv_nsec = start_ns % nsec_per_sec;
 }
 
 void task_rt::wait_next_cycle_rt(thd_context* ctx, int64_t cycle_time_ns) {
+    cycle_stats* stats = &ctx->rt_stats;
+    if (stats->reset_request.load(std::memory_order_relaxed)) {
+        stats->clear();
+    }
+
     // Compute next cycle start time
     advance_timespec(&ctx->rt_cycle_ts, cycle_time_ns);
 
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
+    if (stats->have_wake) {
+        cycle_stats_exec(stats, timespec_diff_ns(now, stats->wake_ts));
+    }
+
     if (timespec_less_than(ctx->rt_cycle_ts, now)) {
-        ctx->rt_cycle_ts = now;  // Reset to now
-        // std::cout << "OVERRUN\n";
         // Overrun happened - Dont sleep!
+        stats->overruns.store(stats->overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        cycle_stats_lateness(stats, timespec_diff_ns(now, ctx->rt_cycle_ts), now);
+        ctx->rt_cycle_ts = now;  // Reset to now
+        stats->wake_ts = now;
+        stats->have_wake = true;
         return;
     }
 
     // Wait for next cycle
     clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ctx->rt_cycle_ts, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    cycle_stats_lateness(stats, timespec_diff_ns(now, ctx->rt_cycle_ts), now);
+    stats->wake_ts = now;
+    stats->have_wake = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Cycle statistics
+// Single writer (the RT thread): plain load + store instead of locked read-modify-write.
+template<typename T>
+static inline void stats_add(std::atomic<T>& a, T v) {
+    a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+static inline void stats_worst_begin(task_rt::cycle_stats* stats) {
+    stats->worst_seq.store(stats->worst_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+static inline void stats_worst_end(task_rt::cycle_stats* stats) {
+    stats->worst_seq.store(stats->worst_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void task_rt::cycle_stats::clear() {
+    cycles.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+    lateness_last_ns.store(0, std::memory_order_relaxed);
+    lateness_min_ns.store(INT64_MAX, std::memory_order_relaxed);
+    lateness_max_ns.store(0, std::memory_order_relaxed);
+    lateness_sum_ns.store(0, std::memory_order_relaxed);
+    exec_max_ns.store(0, std::memory_order_relaxed);
+    exec_sum_ns.store(0, std::memory_order_relaxed);
+    for (int i=0; i<n_bins; i++) {
+        lateness_hist[i].store(0, std::memory_order_relaxed);
+        exec_hist[i].store(0, std::memory_order_relaxed);
+    }
+
+    stats_worst_begin(this);
+    for (int i=0; i<n_worst; i++) {
+        worst[i].lateness_ns.store(-1, std::memory_order_relaxed);
+        worst[i].time_ns.store(0, std::memory_order_relaxed);
+        worst[i].cycle.store(0, std::memory_order_relaxed);
+    }
+    stats_worst_end(this);
+
+    reset_request.store(false, std::memory_order_relaxed);
+    have_wake = false;
+}
+
+int64_t task_rt::timespec_diff_ns(struct timespec const& a, struct timespec const& b) {
+    return (int64_t)(a.tv_sec - b.tv_sec) * nsec_per_sec + (a.tv_nsec - b.tv_nsec);
+}
+
+// Half octave bins: 0, 1, 2, 3, 4, 6, 8, 12, 16, 24, ...
+static int cycle_stats_bin(int64_t v) {
+    if (v < 4) {
+        return (v < 0) ? 0 : (int)v;
+    }
+    int msb = 63 - __builtin_clzll((unsigned long long)v);
+    int bin = 2*msb + ((v >> (msb - 1)) & 1);
+    return (bin < task_rt::cycle_stats::n_bins) ? bin : (task_rt::cycle_stats::n_bins - 1);
+}
+
+int64_t task_rt::cycle_stats_bin_ns(int bin) {
+    if (bin < 4) {
+        return bin;
+    }
+    int msb = bin / 2;
+    return ((int64_t)1 << msb) + (int64_t)(bin % 2) * ((int64_t)1 << (msb - 1));
+}
+
+void task_rt::cycle_stats_lateness(cycle_stats* stats, int64_t lateness_ns, struct timespec const& now) {
+    uint64_t cycle = stats->cycles.load(std::memory_order_relaxed);
+    stats->cycles.store(cycle + 1, std::memory_order_relaxed);
+    stats->lateness_last_ns.store(lateness_ns, std::memory_order_relaxed);
+    stats_add(stats->lateness_sum_ns, lateness_ns);
+    if (lateness_ns < stats->lateness_min_ns.load(std::memory_order_relaxed)) {
+        stats->lateness_min_ns.store(lateness_ns, std::memory_order_relaxed);
+    }
+    if (lateness_ns > stats->lateness_max_ns.load(std::memory_order_relaxed)) {
+        stats->lateness_max_ns.store(lateness_ns, std::memory_order_relaxed);
+    }
+    stats_add(stats->lateness_hist[cycle_stats_bin(lateness_ns)], (uint32_t)1);
+
+    // Keep the worst N, sorted largest first
+    int last = cycle_stats::n_worst - 1;
+    if (lateness_ns <= stats->worst[last].lateness_ns.load(std::memory_order_relaxed)) {
+        return;
+    }
+    stats_worst_begin(stats);
+    int i = last;
+    while (i > 0 && stats->worst[i-1].lateness_ns.load(std::memory_order_relaxed) < lateness_ns) {
+        stats->worst[i].lateness_ns.store(stats->worst[i-1].lateness_ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        stats->worst[i].time_ns.store(stats->worst[i-1].time_ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        stats->worst[i].cycle.store(stats->worst[i-1].cycle.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        i--;
+    }
+    stats->worst[i].lateness_ns.store(lateness_ns, std::memory_order_relaxed);
+    stats->worst[i].time_ns.store((int64_t)now.tv_sec * nsec_per_sec + now.tv_nsec, std::memory_order_relaxed);
+    stats->worst[i].cycle.store(cycle, std::memory_order_relaxed);
+    stats_worst_end(stats);
+}
+
+void task_rt::cycle_stats_exec(cycle_stats* stats, int64_t exec_ns) {
+    stats_add(stats->exec_sum_ns, exec_ns);
+    if (exec_ns > stats->exec_max_ns.load(std::memory_order_relaxed)) {
+        stats->exec_max_ns.store(exec_ns, std::memory_order_relaxed);
+    }
+    stats_add(stats->exec_hist[cycle_stats_bin(exec_ns)], (uint32_t)1);
+}
+
+int task_rt::cycle_stats_get(thd_context* ctx, cycle_stats_snapshot* s) {
+    cycle_stats* stats = &ctx->rt_stats;
+
+    s->cycles   = stats->cycles.load(std::memory_order_relaxed);
+    s->overruns = stats->overruns.load(std::memory_order_relaxed);
+    s->lateness_last_ns = stats->lateness_last_ns.load(std::memory_order_relaxed);
+    s->lateness_min_ns  = (s->cycles == 0) ? 0 : stats->lateness_min_ns.load(std::memory_order_relaxed);
+    s->lateness_max_ns  = stats->lateness_max_ns.load(std::memory_order_relaxed);
+    s->lateness_mean_ns = (s->cycles == 0) ? 0 : stats->lateness_sum_ns.load(std::memory_order_relaxed) / (int64_t)s->cycles;
+    s->exec_max_ns  = stats->exec_max_ns.load(std::memory_order_relaxed);
+    // First cycle after a clear has no exec sample
+    s->exec_mean_ns = (s->cycles < 2) ? 0 : stats->exec_sum_ns.load(std::memory_order_relaxed) / (int64_t)(s->cycles - 1);
+    for (int i=0; i<cycle_stats::n_bins; i++) {
+        s->lateness_hist[i] = stats->lateness_hist[i].load(std::memory_order_relaxed);
+        s->exec_hist[i] = stats->exec_hist[i].load(std::memory_order_relaxed);
+    }
+
+    // Retry if the RT thread updated the worst list mid copy
+    s->n_worst = 0;
+    bool consistent = false;
+    for (int attempt=0; attempt<100 && !consistent; attempt++) {
+        uint32_t seq_0 = stats->worst_seq.load(std::memory_order_acquire);
+        if (seq_0 & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (int i=0; i<cycle_stats::n_worst; i++) {
+            s->worst_lateness_ns[i] = stats->worst[i].lateness_ns.load(std::memory_order_relaxed);
+            s->worst_time_ns[i] = stats->worst[i].time_ns.load(std::memory_order_relaxed);
+            s->worst_cycle[i] = stats->worst[i].cycle.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        consistent = (stats->worst_seq.load(std::memory_order_relaxed) == seq_0);
+    }
+    if (!consistent) {
+        // Torn copy, report no worst events
+        return jcs::RET_ERROR;
+    }
+    while (s->n_worst < cycle_stats::n_worst && s->worst_lateness_ns[s->n_worst] >= 0) {
+        s->n_worst++;
+    }
+    return jcs::RET_OK;
+}
+
+void task_rt::cycle_stats_reset(thd_context* ctx) {
+    ctx->rt_stats.reset_request.store(true, std::memory_order_relaxed);
+}
+
+void task_rt::cycle_stats_print(std::string const& name, thd_context* ctx, int64_t cycle_time_ns, bool detail) {
+    cycle_stats_snapshot s;
+    bool have_worst = (cycle_stats_get(ctx, &s) == jcs::RET_OK);
+
+    // Same fields as cyclictest, in us
+    std::cout << "T: " << name
+              << " P:" << ctx->rt_sched.priority
+              << " I:" << cycle_time_ns / 1000
+              << " C:" << std::setw(9) << s.cycles
+              << " Min:" << std::setw(7) << s.lateness_min_ns / 1000
+              << " Act:" << std::setw(7) << s.lateness_last_ns / 1000
+              << " Avg:" << std::setw(7) << s.lateness_mean_ns / 1000
+              << " Max:" << std::setw(7) << s.lateness_max_ns / 1000
+              << " Overruns: " << s.overruns
+              << " Exec Avg:" << std::setw(7) << s.exec_mean_ns / 1000
+              << " Max:" << std::setw(7) << s.exec_max_ns / 1000
+              << std::endl;
+    if (!detail) {
+        return;
+    }
+
+    std::cout << "# Histogram (bin lower bound us, lateness count, exec count)\n";
+    for (int i=0; i<cycle_stats::n_bins; i++) {
+        if (s.lateness_hist[i] == 0 && s.exec_hist[i] == 0) {
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << cycle_stats_bin_ns(i) / 1000.0
+                  << " " << std::setw(10) << s.lateness_hist[i]
+                  << " " << std::setw(10) << s.exec_hist[i] << "\n";
+    }
+    std::cout << "# Worst lateness (us, cycle, CLOCK_MONOTONIC s)\n";
+    if (!have_worst) {
+        std::cout << "# Not available, the RT thread kept updating it\n";
+    }
+    for (int i=0; i<s.n_worst; i++) {
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << s.worst_lateness_ns[i] / 1000.0
+                  << " " << std::setw(10) << s.worst_cycle[i]
+                  << " " << std::setprecision(6) << s.worst_time_ns[i] / 1e9 << "\n";
+    }
+    std::cout << std::defaultfloat;
 }
 
 // Non RT thread
@@ -213,46 +429,236 @@ int task_rt::task_start(thd_context* ctx) {
         std::cout << "thread_fn cannot be NULL\n";
         return jcs::RET_ERROR;
     }
-    pthread_attr_t attr;
-    int r = 0;
+    if (sched_check(ctx->sched) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+
+    // Start the thread
+    return thread_create(&ctx->thread, ctx->sched, ctx->thread_fn, ctx->thread_args);
+}
+
+void task_rt::task_wait(thd_context* ctx) {
+    // pthread_cancel(ctx->thread);
+    pthread_join(ctx->thread, NULL);
+}
+
+int task_rt::sched_check(thd_sched const& s) {
+    long n_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    for (int i=0; i<s.cpus.size(); i++) {
+        if (s.cpus[i] < 0 || s.cpus[i] >= n_cpus || s.cpus[i] >= CPU_SETSIZE) {
+            std::cout << "sched: CPU " << s.cpus[i] << " does not exist. Machine has " << n_cpus << " CPUs\n";
+            return jcs::RET_ERROR;
+        }
+    }
+    if (s.stack_size < PTHREAD_STACK_MIN) {
+        std::cout << "sched: Stack size " << s.stack_size << " is less than " << PTHREAD_STACK_MIN << "\n";
+        return jcs::RET_ERROR;
+    }
+
+    switch (s.policy) {
+        case SCHED_OTHER:
+            break;
+
+        case SCHED_FIFO:
+        case SCHED_RR:
+            if (s.priority < sched_get_priority_min(s.policy) || s.priority > sched_get_priority_max(s.policy)) {
+                std::cout << "sched: Priority " << s.priority << " out of range ["
+                          << sched_get_priority_min(s.policy) << ", " << sched_get_priority_max(s.policy) << "]\n";
+                return jcs::RET_ERROR;
+            }
+            break;
+
+        case SCHED_DEADLINE: {
+            int64_t deadline = (s.dl_deadline_ns == 0) ? s.dl_period_ns : s.dl_deadline_ns;
+            if (s.dl_runtime_ns <= 0 || s.dl_runtime_ns > deadline || deadline > s.dl_period_ns) {
+                std::cout << "sched: SCHED_DEADLINE needs 0 < runtime <= deadline <= period\n";
+                return jcs::RET_ERROR;
+            }
+            break;
+        }
+
+        default:
+            std::cout << "sched: Unsupported policy " << s.policy << "\n";
+            return jcs::RET_ERROR;
+    }
+    return jcs::RET_OK;
+}
+
+int task_rt::sched_apply_self(thd_sched const& s) {
+    if (sched_check(s) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    int r;
+    if (!s.cpus.empty()) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (int i=0; i<s.cpus.size(); i++) {
+            CPU_SET(s.cpus[i], &cpu_set);
+        }
+        r = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (r != 0) {
+            std::cout << "pthread_setaffinity_np failed: " << r << std::endl;
+            return jcs::RET_ERROR;
+        }
+    }
+
+    if (s.policy == SCHED_DEADLINE) {
+        return sched_deadline_set_self(s);
+    }
+    if (s.policy == SCHED_FIFO || s.policy == SCHED_RR) {
+        struct sched_param schedparam;
+        schedparam.sched_priority = s.priority;
+        r = pthread_setschedparam(pthread_self(), s.policy, &schedparam);
+        if (r != 0) {
+            std::cout << "pthread_setschedparam failed: " << r << std::endl;
+            return jcs::RET_ERROR;
+        }
+    }
+    return jcs::RET_OK;
+}
+
+int task_rt::sched_deadline_set_self(thd_sched const& s) {
+    sched_attr_dl attr = {};
+    attr.size           = sizeof(attr);
+    attr.sched_policy   = SCHED_DEADLINE;
+    attr.sched_runtime  = s.dl_runtime_ns;
+    attr.sched_deadline = (s.dl_deadline_ns == 0) ? s.dl_period_ns : s.dl_deadline_ns;
+    attr.sched_period   = s.dl_period_ns;
+
+    if (syscall(SYS_sched_setattr, 0, &attr, 0) != 0) {
+        int e = errno;
+        std::cout << "sched_setattr SCHED_DEADLINE failed: " << e << std::endl;
+        if (e == EPERM && !s.cpus.empty()) {
+            // Kernel rule: a deadline task's affinity must span its whole root domain
+            std::cout << "sched: SCHED_DEADLINE with a CPU list needs an exclusive cpuset covering exactly those CPUs\n";
+        }
+        return jcs::RET_ERROR;
+    }
+    return jcs::RET_OK;
+}
+
+void* task_rt::thread_start_deadline(void* arg) {
+    thread_start_args* start = static_cast<thread_start_args*>(arg);
+    void* (*fn)(void*) = start->fn;
+    void* args = start->args;
+
+    int status = (sched_apply_self(start->sched) == jcs::RET_OK) ? 1 : -1;
+    int pending = 0;
+    if (!start->status.compare_exchange_strong(pending, status)) {
+        // Creator timed out and returned an error, do not run fn
+        delete start;
+        return 0;
+    }
+    // Creator frees start once status is set
+    if (status < 0) {
+        return 0;
+    }
+    return fn(args);
+}
 
-    r = pthread_attr_init(&attr);
-    if (r < 0) {
+int task_rt::thread_create(pthread_t* thread, thd_sched const& s, void* (*fn)(void*), void* args) {
+    pthread_attr_t attr;
+    int r = pthread_attr_init(&attr);
+    if (r != 0) {
         std::cout << "pthread_attr_init failed: " << r << std::endl;
         return jcs::RET_ERROR;
     }
 
-    r = pthread_attr_setstacksize(&attr, pre_alloc_size);
-    if (r < 0) {
+    r = pthread_attr_setstacksize(&attr, s.stack_size);
+    if (r != 0) {
         std::cout << "pthread_attr_setstacksize failed: " << r << std::endl;
+        pthread_attr_destroy(&attr);
         return jcs::RET_ERROR;
     }
 
-    // Pin to cpu 0 for non-rt task
-    cpu_set_t cpu_set;
-    CPU_ZERO(&cpu_set);
-    CPU_SET(0, &cpu_set);
+    if (s.policy == SCHED_FIFO || s.policy == SCHED_RR) {
+        r = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        if (r != 0) {
+            std::cout << "pthread_attr_setinheritsched failed: " << r << std::endl;
+            pthread_attr_destroy(&attr);
+            return jcs::RET_ERROR;
+        }
+        r = pthread_attr_setschedpolicy(&attr, s.policy);
+        if (r != 0) {
+            std::cout << "pthread_attr_setschedpolicy failed: " << r << std::endl;
+            pthread_attr_destroy(&attr);
+            return jcs::RET_ERROR;
+        }
+        struct sched_param schedparam;
+        schedparam.sched_priority = s.priority;
+        r = pthread_attr_setschedparam(&attr, &schedparam);
+        if (r != 0) {
+            std::cout << "pthread_attr_setschedparam failed: " << r << std::endl;
+            pthread_attr_destroy(&attr);
+            return jcs::RET_ERROR;
+        }
+    }
 
-    r = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
-    if (r < 0) {
-        std::cout << "pthread_attr_setaffinity_np failed: " << r << std::endl;
-        return jcs::RET_ERROR;
+    if (s.policy != SCHED_DEADLINE) {
+        if (!s.cpus.empty()) {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            for (int i=0; i<s.cpus.size(); i++) {
+                CPU_SET(s.cpus[i], &cpu_set);
+            }
+            r = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
+            if (r != 0) {
+                std::cout << "pthread_attr_setaffinity_np failed: " << r << std::endl;
+                pthread_attr_destroy(&attr);
+                return jcs::RET_ERROR;
+            }
+        }
+
+        r = pthread_create(thread, &attr, fn, args);
+        pthread_attr_destroy(&attr);
+        if (r != 0) {
+            std::cout << "pthread_create failed: " << r << std::endl;
+            return jcs::RET_ERROR;
+        }
+        return jcs::RET_OK;
     }
 
-    // Start the thread
-    r = pthread_create(&ctx->thread, &attr, ctx->thread_fn, ctx->thread_args);
-    if (r < 0) {
+    // SCHED_DEADLINE: Thread sets its own affinity and policy before running fn
+    thread_start_args* start = new thread_start_args;
+    start->fn = fn;
+    start->args = args;
+    start->sched = s;
+    start->status.store(0);
+
+    r = pthread_create(thread, &attr, &thread_start_deadline, start);
+    pthread_attr_destroy(&attr);
+    if (r != 0) {
         std::cout << "pthread_create failed: " << r << std::endl;
+        delete start;
+        return jcs::RET_ERROR;
+    }
+    struct timespec ts_timeout;
+    clock_gettime(CLOCK_MONOTONIC, &ts_timeout);
+    advance_timespec(&ts_timeout, (int64_t)thread_start_timeout_ms * 1000000);
+    while (start->status.load() == 0) {
+        struct timespec ts_now;
+        clock_gettime(CLOCK_MONOTONIC, &ts_now);
+        if (timespec_diff_ns(ts_now, ts_timeout) >= 0) {
+            int pending = 0;
+            if (start->status.compare_exchange_strong(pending, -2)) {
+                // Thread frees start and exits without running fn if it ever reports
+                std::cout << "sched: SCHED_DEADLINE thread did not start within " << thread_start_timeout_ms << "ms\n";
+                pthread_detach(*thread);
+                return jcs::RET_ERROR;
+            }
+            break;
+        }
+        sleep_us(100);
+    }
+    int status = start->status.load();
+    delete start;
+    if (status < 0) {
+        pthread_join(*thread, NULL);
         return jcs::RET_ERROR;
     }
     return jcs::RET_OK;
 }
 
-void task_rt::task_wait(thd_context* ctx) {
-    // pthread_cancel(ctx->thread);
-    pthread_join(ctx->thread, NULL);
-}
-
 
 void task_rt::sleep_us(long int us) {
     struct timespec ts;
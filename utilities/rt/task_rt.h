@@ -6,11 +6,103 @@
 
 #include <thread>
 #include <ctime>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <stdint.h>
+#include <sched.h>
 
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
 
 namespace task_rt {
 
+    const size_t stack_size_default = 1024*1024*32;
+
+    // Scheduling of one thread
+    struct thd_sched {
+        std::vector<int> cpus;  // Allowed CPUs. Empty: inherit
+        int policy;             // SCHED_OTHER, SCHED_FIFO, SCHED_RR or SCHED_DEADLINE
+        int priority;           // SCHED_FIFO and SCHED_RR only
+        size_t stack_size;
+
+        // SCHED_DEADLINE only. runtime <= deadline <= period
+        int64_t dl_runtime_ns;
+        int64_t dl_deadline_ns;
+        int64_t dl_period_ns;
+
+        thd_sched() : cpus(),
+                      policy(SCHED_OTHER),
+                      priority(0),
+                      stack_size(stack_size_default),
+                      dl_runtime_ns(0),
+                      dl_deadline_ns(0),
+                      dl_period_ns(0) {}
+    };
+
+    // Cycle timing statistics for an RT loop, recorded by wait_next_cycle_rt().
+    // Written only by the RT thread: fixed size, no allocation, no locks.
+    // Read from any thread with cycle_stats_get().
+    //   Lateness: Wakeup time - scheduled cycle start. Overruns count as late by the miss.
+    //   Exec:     Time from wakeup to the next wait_next_cycle_rt() call.
+    // Histograms use half octave bins of ns. See cycle_stats_bin_ns().
+    struct cycle_stats {
+        static const int n_bins = 64;
+        static const int n_worst = 8;
+
+        struct event {
+            std::atomic<int64_t> lateness_ns;
+            std::atomic<int64_t> time_ns;   // CLOCK_MONOTONIC of the wakeup
+            std::atomic<uint64_t> cycle;
+        };
+
+        std::atomic<uint64_t> cycles;
+        std::atomic<uint64_t> overruns;
+        std::atomic<int64_t> lateness_last_ns;
+        std::atomic<int64_t> lateness_min_ns;
+        std::atomic<int64_t> lateness_max_ns;
+        std::atomic<int64_t> lateness_sum_ns;
+        std::atomic<int64_t> exec_max_ns;
+        std::atomic<int64_t> exec_sum_ns;
+        std::atomic<uint32_t> lateness_hist[n_bins];
+        std::atomic<uint32_t> exec_hist[n_bins];
+
+        // Worst lateness events, largest first. Odd worst_seq: update in progress.
+        std::atomic<uint32_t> worst_seq;
+        event worst[n_worst];
+
+        // Set by cycle_stats_reset(), actioned by the RT thread
+        std::atomic<bool> reset_request;
+
+        // RT thread only
+        bool have_wake;
+        struct timespec wake_ts;
+
+        cycle_stats() { clear(); }
+        void clear();
+    };
+
+    // Plain copy of cycle_stats
+    struct cycle_stats_snapshot {
+        uint64_t cycles;
+        uint64_t overruns;
+        int64_t lateness_last_ns;
+        int64_t lateness_min_ns;
+        int64_t lateness_max_ns;
+        int64_t lateness_mean_ns;
+        int64_t exec_max_ns;
+        int64_t exec_mean_ns;
+        uint32_t lateness_hist[cycle_stats::n_bins];
+        uint32_t exec_hist[cycle_stats::n_bins];
+        int n_worst;
+        int64_t worst_lateness_ns[cycle_stats::n_worst];
+        int64_t worst_time_ns[cycle_stats::n_worst];
+        uint64_t worst_cycle[cycle_stats::n_worst];
+    };
+
     // Some helpers for starting Preempt-RT threads
+    // Any number of contexts may be started, each with its own scheduling.
     struct thd_context {
         pthread_t rt_thread;
         struct timespec rt_cycle_ts;
@@ -25,12 +117,24 @@ namespace task_rt {
         // Attach your thread args to thread_args
         void* thread_args;
 
+        // Defaults: RT thread SCHED_FIFO 87 on CPU 1, non RT thread on CPU 0
+        thd_sched rt_sched;
+        thd_sched sched;
+
+        // RT loop timing
+        cycle_stats rt_stats;
+
         thd_context() : rt_thread(),
                         rt_cycle_ts{0},
                         rt_thread_fn(nullptr),
                         thread(),
                         thread_fn(nullptr),
-                        thread_args() {}
+                        thread_args() {
+            rt_sched.cpus.push_back(1);
+            rt_sched.policy = SCHED_FIFO;
+            rt_sched.priority = 87; // preempt_rt
+            sched.cpus.push_back(0);
+        }
     };
 
     // Start and stop the thread
@@ -38,7 +142,7 @@ namespace task_rt {
     void task_wait_rt(thd_context* ctx);
     void task_stop_rt(thd_context* ctx);
 
-    // Compute initial timespec.
+    // Compute initial timespec, the next multiple of cycle_time_ns.
     // Call just prior to entering periodic loop
     void ready_cycle_rt(thd_context* ctx, int64_t cycle_time_ns);
     // Sleep until next cycle
@@ -48,6 +152,20 @@ namespace task_rt {
     int task_start(thd_context* ctx);
     void task_wait(thd_context* ctx);
 
+    // Cycle statistics. Safe to call from any thread while the RT loop runs.
+    // RET_ERROR if the worst events could not be copied consistently, n_worst is then 0.
+    int cycle_stats_get(thd_context* ctx, cycle_stats_snapshot* s);
+    void cycle_stats_reset(thd_context* ctx);
+    // Lower bound in ns of a histogram bin
+    int64_t cycle_stats_bin_ns(int bin);
+    // cyclictest style summary. Optionally with histograms and worst events.
+    void cycle_stats_print(std::string const& name, thd_context* ctx, int64_t cycle_time_ns, bool detail);
+
+    // Check a scheduling config against this machine
+    int sched_check(thd_sched const& s);
+    // Apply a scheduling config to the calling thread
+    int sched_apply_self(thd_sched const& s);
+
     void sleep_us(long int us);
     void sleep_ms(long int ms);
     // int64_t time_now_ns();
@@ -0,0 +1,219 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "task_rt_config.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+#include "jcs_host.h"
+
+namespace task_rt {
+    std::mutex sched_named_mutex;
+    std::map<std::string, thd_sched> sched_named;
+
+    int sched_node_load(std::string const& name, YAML::Node const& node, thd_sched* s);
+    int sched_cmd_cpus(cmd_input_parser& cmd, std::string const& option, std::string const& name);
+}
+
+void task_rt::sched_named_set(std::string const& name, thd_sched const& s) {
+    std::lock_guard<std::mutex> lock(sched_named_mutex);
+    sched_named[name] = s;
+}
+
+bool task_rt::sched_named_get(std::string const& name, thd_sched* s) {
+    std::lock_guard<std::mutex> lock(sched_named_mutex);
+    std::map<std::string, thd_sched>::const_iterator it = sched_named.find(name);
+    if (it == sched_named.end()) {
+        return false;
+    }
+    *s = it->second;
+    return true;
+}
+
+int task_rt::sched_config_load_file(std::string const& filename) {
+    std::ifstream fin(filename.c_str());
+    if (fin.fail()) {
+        return jcs::RET_OK;
+    }
+    YAML::Node doc;
+    try {
+        doc = YAML::Load(fin);
+    } catch (YAML::Exception const& e) {
+        std::cout << "sched: Could not parse " << filename << ": " << e.what() << "\n";
+        return jcs::RET_ERROR;
+    }
+    if (!doc["threads"]) {
+        return jcs::RET_OK;
+    }
+    return sched_config_load(doc["threads"]);
+}
+
+int task_rt::sched_config_load(YAML::Node const& threads) {
+    if (!threads.IsMap()) {
+        std::cout << "sched: threads must be a map of thread name to config\n";
+        return jcs::RET_ERROR;
+    }
+    for (YAML::const_iterator it = threads.begin(); it != threads.end(); ++it) {
+        std::string name = it->first.as<std::string>();
+        // Start from the existing config so defaults carry through
+        thd_sched s;
+        sched_named_get(name, &s);
+        if (sched_node_load(name, it->second, &s) != jcs::RET_OK) {
+            return jcs::RET_ERROR;
+        }
+        sched_named_set(name, s);
+    }
+    return jcs::RET_OK;
+}
+
+int task_rt::sched_node_load(std::string const& name, YAML::Node const& node, thd_sched* s) {
+    try {
+        if (node["cpus"]) {
+            s->cpus = node["cpus"].as<std::vector<int>>();
+        }
+        if (node["policy"]) {
+            if (sched_policy_from_string(node["policy"].as<std::string>(), &s->policy) != jcs::RET_OK) {
+                std::cout << "sched: " << name << ": Unknown policy " << node["policy"].as<std::string>() << "\n";
+                return jcs::RET_ERROR;
+            }
+        }
+        if (node["priority"]) {
+            s->priority = node["priority"].as<int>();
+        }
+        if (node["stack_kb"]) {
+            s->stack_size = node["stack_kb"].as<size_t>() * 1024;
+        }
+        if (node["runtime_us"]) {
+            s->dl_runtime_ns = node["runtime_us"].as<int64_t>() * 1000;
+        }
+        if (node["deadline_us"]) {
+            s->dl_deadline_ns = node["deadline_us"].as<int64_t>() * 1000;
+        }
+        if (node["period_us"]) {
+            s->dl_period_ns = node["period_us"].as<int64_t>() * 1000;
+        }
+    } catch (YAML::Exception const& e) {
+        std::cout << "sched: " << name << ": " << e.what() << "\n";
+        return jcs::RET_ERROR;
+    }
+
+    if (sched_check(*s) != jcs::RET_OK) {
+        std::cout << "sched: " << name << ": Invalid config\n";
+        return jcs::RET_ERROR;
+    }
+    return jcs::RET_OK;
+}
+
+int task_rt::sched_cmd_cpus(cmd_input_parser& cmd, std::string const& option, std::string const& name) {
+    std::string v = cmd.cmd_option_get(option);
+    if (v.empty()) {
+        return jcs::RET_OK;
+    }
+    thd_sched s;
+    sched_named_get(name, &s);
+    if (sched_cpus_from_string(v, &s.cpus) != jcs::RET_OK) {
+        std::cout << "sched: Bad CPU list for " << option << ": " << v << "\n";
+        return jcs::RET_ERROR;
+    }
+    sched_named_set(name, s);
+    return jcs::RET_OK;
+}
+
+int task_rt::sched_config_cmd(cmd_input_parser& cmd) {
+    if (sched_cmd_cpus(cmd, "-rt_cpus", "rt") != jcs::RET_OK ||
+        sched_cmd_cpus(cmd, "-nrt_cpus", "non_rt") != jcs::RET_OK ||
+        sched_cmd_cpus(cmd, "-gui_cpus", "gui") != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+
+    thd_sched rt;
+    sched_named_get("rt", &rt);
+    std::string policy = cmd.cmd_option_get("-rt_policy");
+    if (!policy.empty()) {
+        if (sched_policy_from_string(policy, &rt.policy) != jcs::RET_OK) {
+            std::cout << "sched: Unknown policy for -rt_policy: " << policy << "\n";
+            return jcs::RET_ERROR;
+        }
+    }
+    std::string prio = cmd.cmd_option_get("-rt_prio");
+    if (!prio.empty()) {
+        rt.priority = std::atoi(prio.c_str());
+    }
+    if (sched_check(rt) != jcs::RET_OK) {
+        return jcs::RET_ERROR;
+    }
+    sched_named_set("rt", rt);
+    return jcs::RET_OK;
+}
+
+int task_rt::sched_policy_from_string(std::string const& policy, int* p) {
+    if (policy == "other") {
+        *p = SCHED_OTHER;
+    } else if (policy == "fifo") {
+        *p = SCHED_FIFO;
+    } else if (policy == "rr") {
+        *p = SCHED_RR;
+    } else if (policy == "deadline") {
+        *p = SCHED_DEADLINE;
+    } else {
+        return jcs::RET_ERROR;
+    }
+    return jcs::RET_OK;
+}
+
+// Accepts "3", "2,3" and "2-5"
+int task_rt::sched_cpus_from_string(std::string const& cpus, std::vector<int>* c) {
+    std::vector<int> out;
+    std::stringstream ss(cpus);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            return jcs::RET_ERROR;
+        }
+        size_t dash = item.find('-');
+        char* end;
+        if (dash == std::string::npos) {
+            long v = std::strtol(item.c_str(), &end, 10);
+            if (*end != '\0' || v < 0) {
+                return jcs::RET_ERROR;
+            }
+            out.push_back(v);
+        } else {
+            long lo = std::strtol(item.substr(0, dash).c_str(), &end, 10);
+            if (*end != '\0') {
+                return jcs::RET_ERROR;
+            }
+            long hi = std::strtol(item.substr(dash+1).c_str(), &end, 10);
+            if (*end != '\0' || lo < 0 || hi < lo) {
+                return jcs::RET_ERROR;
+            }
+            for (long v=lo; v<=hi; v++) {
+                out.push_back(v);
+            }
+        }
+    }
+    if (out.empty()) {
+        return jcs::RET_ERROR;
+    }
+    *c = out;
+    return jcs::RET_OK;
+}
+
+void task_rt::sched_print(std::string const& name, thd_sched const& s) {
+    std::cout << "sched: " << name << ": cpus [";
+    for (int i=0; i<s.cpus.size(); i++) {
+        std::cout << s.cpus[i] << ((i+1 < s.cpus.size()) ? "," : "");
+    }
+    std::cout << "] ";
+    switch (s.policy) {
+        case SCHED_FIFO:     std::cout << "fifo " << s.priority; break;
+        case SCHED_RR:       std::cout << "rr " << s.priority; break;
+        case SCHED_DEADLINE: std::cout << "deadline " << s.dl_runtime_ns/1000 << "/" << s.dl_deadline_ns/1000 << "/" << s.dl_period_ns/1000 << " us"; break;
+        default:             std::cout << "other"; break;
+    }
+    std::cout << ", stack " << s.stack_size/1024 << " kB\n";
+}
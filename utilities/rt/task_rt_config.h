@@ -0,0 +1,57 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef HELPER_TASK_RT_CONFIG_H_
+#define HELPER_TASK_RT_CONFIG_H_
+
+#include <string>
+#include "task_rt.h"
+#include "cmd_input_parser.h"
+#include "yaml-cpp/yaml.h"
+
+// Named thread scheduling configs, loaded from the `threads` section of dev_HOST.yaml
+// and the command line. Each name maps to one task_rt::thd_sched.
+//
+// threads:
+//   rt:                  # Host cyclic (EtherCAT) thread
+//     cpus: [2]
+//     policy: fifo       # other, fifo, rr, deadline
+//     priority: 87
+//     stack_kb: 32768
+//   non_rt:              # Parameter thread
+//     cpus: [0]
+//   gui:                 # Optional. Applied by tool_gui to its own thread
+//     cpus: [4]
+//   param:               # Optional. tool_gui parameter worker thread
+//     cpus: [4]
+//   analysis:            # Optional. tool_gui background analysis (frequency response)
+//     cpus: [5]
+//   stream:              # Optional. tool_gui trajectory file prefetch
+//     cpus: [5]
+//   control:             # Any other name. Tools start their own RT threads with it
+//     cpus: [3]
+//     policy: deadline
+//     runtime_us: 100
+//     deadline_us: 500
+//     period_us: 500
+//
+// Command line overrides:
+//   -rt_cpus 2,3  -rt_policy fifo  -rt_prio 90  -nrt_cpus 0  -gui_cpus 4
+namespace task_rt {
+
+    void sched_named_set(std::string const& name, thd_sched const& s);
+    // Returns false if no config exists for name
+    bool sched_named_get(std::string const& name, thd_sched* s);
+
+    // Missing file or missing `threads` section is not an error
+    int sched_config_load_file(std::string const& filename);
+    int sched_config_load(YAML::Node const& threads);
+    int sched_config_cmd(cmd_input_parser& cmd);
+
+    int sched_policy_from_string(std::string const& policy, int* p);
+    int sched_cpus_from_string(std::string const& cpus, std::vector<int>* c);
+    void sched_print(std::string const& name, thd_sched const& s);
+
+} // End namespace task_rt
+
+#endif
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include "sample_ring.h"
+#include <cstring>
+#include "jcs_host.h"
+
+sample_ring::sample_ring() {
+    mask_ = 0;
+    frame_width_ = 0;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+}
+
+sample_ring::~sample_ring() {
+}
+
+int sample_ring::startup(int n_frames, int frame_width) {
+    if (n_frames < 1 || frame_width < 1) {
+        return jcs::RET_ERROR;
+    }
+
+    uint32_t n = 1;
+    while (n < (uint32_t)n_frames) {
+        n <<= 1;
+    }
+
+    mask_ = n - 1;
+    frame_width_ = frame_width;
+    t_.assign(n, 0.0);
+    values_.assign((size_t)n * frame_width, 0.0f);
+
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_release);
+    return jcs::RET_OK;
+}
+
+bool sample_ring::push_rt(double t, float const* values) {
+    if (frame_width_ == 0) {
+        return false;
+    }
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    if ((head - tail) > mask_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t idx = head & mask_;
+    t_[idx] = t;
+    std::memcpy(&values_[(size_t)idx * frame_width_], values, sizeof(float) * frame_width_);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool sample_ring::pop(double* t, float* values) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+
+    uint32_t idx = tail & mask_;
+    *t = t_[idx];
+    std::memcpy(values, &values_[(size_t)idx * frame_width_], sizeof(float) * frame_width_);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+void sample_ring::clear() {
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+int sample_ring::size() const {
+    return (int)(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+}
+
+int sample_ring::capacity() const {
+    return (frame_width_ == 0) ? 0 : (int)(mask_ + 1);
+}
+
+int sample_ring::frame_width() const {
+    return frame_width_;
+}
+
+uint32_t sample_ring::dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+void sample_ring::dropped_reset() {
+    dropped_.store(0, std::memory_order_relaxed);
+}
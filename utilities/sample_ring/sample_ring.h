@@ -0,0 +1,57 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#ifndef SAMPLE_RING_HELPER_H_
+#define SAMPLE_RING_HELPER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+// Lock-free single producer / single consumer ring of fixed width sample frames.
+// A frame is a timestamp plus frame_width float values.
+// Producer: RT thread, push_rt(). Never blocks, never allocates. Drops the frame if the ring is full.
+// Consumer: Non-RT thread, pop() / clear().
+// startup() must be called before either thread touches the ring.
+class sample_ring {
+public:
+    sample_ring();
+    ~sample_ring();
+
+    // n_frames is rounded up to the next power of two.
+    int startup(int n_frames, int frame_width);
+
+    // Producer side
+    bool push_rt(double t, float const* values);
+
+    // Consumer side
+    bool pop(double* t, float* values);
+    void clear();
+
+    int size() const;
+    int capacity() const;
+    int frame_width() const;
+
+    // Frames dropped by push_rt() due to a full ring. Either side may read.
+    uint32_t dropped() const;
+    void dropped_reset();
+
+private:
+    std::vector<double> t_;
+    std::vector<float> values_;
+    uint32_t mask_;
+    int frame_width_;
+
+    // Producer and consumer indices on separate cache lines. Padded rather than alignas(64),
+    // which plain new does not honour before C++17.
+    static const int cache_line = 64;
+    char pad_0_[cache_line];
+    std::atomic<uint32_t> head_;
+    char pad_1_[cache_line];
+    std::atomic<uint32_t> tail_;
+    char pad_2_[cache_line];
+    std::atomic<uint32_t> dropped_;
+    char pad_3_[cache_line];
+};
+
+#endif
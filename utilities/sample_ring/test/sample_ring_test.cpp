@@ -0,0 +1,62 @@
+// Copyright (c) 2024 Arbite Robotics Pty Ltd
+// https://arbite.io
+//
+#include <iostream>//cout
+#include <thread>
+#include "../sample_ring.h"
+
+int main(int argc, char* argv[]) {
+    sample_ring ring;
+    const int width = 4;
+    const int n_push = 1000000;
+
+    // 100 frames rounds up to 128
+    ring.startup(100, width);
+    std::cout << "capacity: " << ring.capacity() << "\n";
+
+    // Fill until full, check the drop counter
+    float frame[width] = {0.0f, 1.0f, 2.0f, 3.0f};
+    int pushed = 0;
+    while (ring.push_rt((double)pushed, frame)) {
+        pushed++;
+    }
+    std::cout << "pushed until full: " << pushed << ", dropped: " << ring.dropped() << "\n";
+    ring.clear();
+    ring.dropped_reset();
+
+    // Producer and consumer on separate threads. Frames must arrive in order and intact.
+    std::thread producer([&ring, n_push, width]() {
+        float values[width];
+        int i = 0;
+        while (i < n_push) {
+            for (int j = 0; j < width; j++) {
+                values[j] = (float)(i + j);
+            }
+            if (ring.push_rt((double)i, values)) {
+                i++;
+            }
+        }
+    });
+
+    int received = 0;
+    int errors = 0;
+    double t;
+    float values[width];
+    while (received < n_push) {
+        if (ring.pop(&t, values)) {
+            if ((int)t != received) {
+                errors++;
+            }
+            for (int j = 0; j < width; j++) {
+                if (values[j] != (float)(received + j)) {
+                    errors++;
+                }
+            }
+            received++;
+        }
+    }
+    producer.join();
+
+    std::cout << "received: " << received << ", errors: " << errors << "\n";
+    return (errors == 0) ? 0 : 1;
+}